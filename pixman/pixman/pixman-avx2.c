@@ -0,0 +1,1303 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * Based on pixman-sse2.c; the arithmetic is the same, eight pixels at a
+ * time.  Anything not implemented here falls through to the SSSE3 and
+ * SSE2 implementations.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <immintrin.h>
+#include "pixman-private.h"
+#include "pixman-combine32.h"
+#include "pixman-inlines.h"
+
+static __m256i mask_0080;
+static __m256i mask_00ff;
+static __m256i mask_0101;
+static __m256i mask_ff000000;
+
+static __m256i tail_index;
+
+static force_inline __m256i
+load_256_unaligned (const __m256i *src)
+{
+    return _mm256_loadu_si256 (src);
+}
+
+static force_inline void
+save_256_unaligned (__m256i *dst, __m256i data)
+{
+    _mm256_storeu_si256 (dst, data);
+}
+
+/* The first w of eight pixels; masked loads and stores don't touch
+ * memory past the end of the line.
+ */
+static force_inline __m256i
+tail_mask (int w)
+{
+    return _mm256_cmpgt_epi32 (_mm256_set1_epi32 (w), tail_index);
+}
+
+static force_inline __m256i
+load_8x32 (const uint32_t *p, int w)
+{
+    if (w >= 8)
+	return load_256_unaligned ((const __m256i *)p);
+
+    return _mm256_maskload_epi32 ((const int *)p, tail_mask (w));
+}
+
+static force_inline void
+save_8x32 (uint32_t *p, int w, __m256i data)
+{
+    if (w >= 8)
+	save_256_unaligned ((__m256i *)p, data);
+    else
+	_mm256_maskstore_epi32 ((int *)p, tail_mask (w), data);
+}
+
+static force_inline void
+unpack_256_2x256 (__m256i data, __m256i *data_lo, __m256i *data_hi)
+{
+    *data_lo = _mm256_unpacklo_epi8 (data, _mm256_setzero_si256 ());
+    *data_hi = _mm256_unpackhi_epi8 (data, _mm256_setzero_si256 ());
+}
+
+/* The unpacks and packs work within each 128 bit lane, so packing
+ * undoes unpacking without any reordering.
+ */
+static force_inline __m256i
+pack_2x256_256 (__m256i lo, __m256i hi)
+{
+    return _mm256_packus_epi16 (lo, hi);
+}
+
+static force_inline void
+pix_multiply_2x256 (__m256i *data_lo, __m256i *data_hi,
+		    __m256i *alpha_lo, __m256i *alpha_hi,
+		    __m256i *ret_lo, __m256i *ret_hi)
+{
+    __m256i lo, hi;
+
+    lo = _mm256_mullo_epi16 (*data_lo, *alpha_lo);
+    hi = _mm256_mullo_epi16 (*data_hi, *alpha_hi);
+    lo = _mm256_adds_epu16 (lo, mask_0080);
+    hi = _mm256_adds_epu16 (hi, mask_0080);
+    *ret_lo = _mm256_mulhi_epu16 (lo, mask_0101);
+    *ret_hi = _mm256_mulhi_epu16 (hi, mask_0101);
+}
+
+static force_inline void
+expand_alpha_2x256 (__m256i data_lo, __m256i data_hi,
+		    __m256i *alpha_lo, __m256i *alpha_hi)
+{
+    __m256i lo, hi;
+
+    lo = _mm256_shufflelo_epi16 (data_lo, _MM_SHUFFLE (3, 3, 3, 3));
+    hi = _mm256_shufflelo_epi16 (data_hi, _MM_SHUFFLE (3, 3, 3, 3));
+
+    *alpha_lo = _mm256_shufflehi_epi16 (lo, _MM_SHUFFLE (3, 3, 3, 3));
+    *alpha_hi = _mm256_shufflehi_epi16 (hi, _MM_SHUFFLE (3, 3, 3, 3));
+}
+
+static force_inline void
+expand_alpha_rev_2x256 (__m256i data_lo, __m256i data_hi,
+			__m256i *alpha_lo, __m256i *alpha_hi)
+{
+    __m256i lo, hi;
+
+    lo = _mm256_shufflelo_epi16 (data_lo, _MM_SHUFFLE (0, 0, 0, 0));
+    hi = _mm256_shufflelo_epi16 (data_hi, _MM_SHUFFLE (0, 0, 0, 0));
+
+    *alpha_lo = _mm256_shufflehi_epi16 (lo, _MM_SHUFFLE (0, 0, 0, 0));
+    *alpha_hi = _mm256_shufflehi_epi16 (hi, _MM_SHUFFLE (0, 0, 0, 0));
+}
+
+static force_inline void
+negate_2x256 (__m256i data_lo, __m256i data_hi,
+	      __m256i *neg_lo, __m256i *neg_hi)
+{
+    *neg_lo = _mm256_xor_si256 (data_lo, mask_00ff);
+    *neg_hi = _mm256_xor_si256 (data_hi, mask_00ff);
+}
+
+static force_inline void
+over_2x256 (__m256i *src_lo, __m256i *src_hi,
+	    __m256i *alpha_lo, __m256i *alpha_hi,
+	    __m256i *dst_lo, __m256i *dst_hi)
+{
+    __m256i t1, t2;
+
+    negate_2x256 (*alpha_lo, *alpha_hi, &t1, &t2);
+
+    pix_multiply_2x256 (dst_lo, dst_hi, &t1, &t2, dst_lo, dst_hi);
+
+    *dst_lo = _mm256_adds_epu8 (*src_lo, *dst_lo);
+    *dst_hi = _mm256_adds_epu8 (*src_hi, *dst_hi);
+}
+
+static force_inline void
+in_over_2x256 (__m256i *src_lo, __m256i *src_hi,
+	       __m256i *alpha_lo, __m256i *alpha_hi,
+	       __m256i *mask_lo, __m256i *mask_hi,
+	       __m256i *dst_lo, __m256i *dst_hi)
+{
+    __m256i s_lo, s_hi;
+    __m256i a_lo, a_hi;
+
+    pix_multiply_2x256 (src_lo, src_hi, mask_lo, mask_hi, &s_lo, &s_hi);
+    pix_multiply_2x256 (alpha_lo, alpha_hi, mask_lo, mask_hi, &a_lo, &a_hi);
+
+    over_2x256 (&s_lo, &s_hi, &a_lo, &a_hi, dst_lo, dst_hi);
+}
+
+static force_inline int
+is_opaque_256 (__m256i x)
+{
+    __m256i ffs = _mm256_cmpeq_epi8 (x, x);
+
+    return (_mm256_movemask_epi8 (_mm256_cmpeq_epi8 (x, ffs)) & 0x88888888)
+	== 0x88888888;
+}
+
+static force_inline int
+is_zero_256 (__m256i x)
+{
+    return _mm256_testz_si256 (x, x);
+}
+
+static force_inline int
+is_transparent_256 (__m256i x)
+{
+    return _mm256_testz_si256 (x, mask_ff000000);
+}
+
+/* Single pixels, for the ends of the bilinear scanlines */
+
+static force_inline uint32_t
+over_1x32 (uint32_t s, uint32_t d)
+{
+    uint32_t a = ALPHA_8 (s);
+
+    if (a == 0xff)
+	return s;
+
+    if (s)
+	UN8x4_MUL_UN8_ADD_UN8x4 (d, a ^ 0xff, s);
+
+    return d;
+}
+
+static force_inline __m256i
+combine8 (__m256i s, const uint32_t *pm, int w)
+{
+    __m256i src_lo, src_hi;
+    __m256i msk_lo, msk_hi;
+
+    if (pm)
+    {
+	msk_lo = load_8x32 (pm, w);
+
+	if (is_transparent_256 (msk_lo))
+	    return _mm256_setzero_si256 ();
+
+	unpack_256_2x256 (s, &src_lo, &src_hi);
+	unpack_256_2x256 (msk_lo, &msk_lo, &msk_hi);
+
+	expand_alpha_2x256 (msk_lo, msk_hi, &msk_lo, &msk_hi);
+
+	pix_multiply_2x256 (&src_lo, &src_hi,
+			    &msk_lo, &msk_hi,
+			    &src_lo, &src_hi);
+
+	s = pack_2x256_256 (src_lo, src_hi);
+    }
+
+    return s;
+}
+
+static force_inline __m256i
+over_8x32 (__m256i src, __m256i dst)
+{
+    __m256i src_lo, src_hi, dst_lo, dst_hi;
+    __m256i alpha_lo, alpha_hi;
+
+    unpack_256_2x256 (src, &src_lo, &src_hi);
+    unpack_256_2x256 (dst, &dst_lo, &dst_hi);
+
+    expand_alpha_2x256 (src_lo, src_hi, &alpha_lo, &alpha_hi);
+    over_2x256 (&src_lo, &src_hi, &alpha_lo, &alpha_hi, &dst_lo, &dst_hi);
+
+    return pack_2x256_256 (dst_lo, dst_hi);
+}
+
+/* Multiplies a by the alpha of b, or of its inverse */
+static force_inline __m256i
+pix_multiply_alpha_8x32 (__m256i a, __m256i b, pixman_bool_t negate)
+{
+    __m256i a_lo, a_hi, b_lo, b_hi;
+
+    unpack_256_2x256 (a, &a_lo, &a_hi);
+    unpack_256_2x256 (b, &b_lo, &b_hi);
+
+    expand_alpha_2x256 (b_lo, b_hi, &b_lo, &b_hi);
+    if (negate)
+	negate_2x256 (b_lo, b_hi, &b_lo, &b_hi);
+    pix_multiply_2x256 (&a_lo, &a_hi, &b_lo, &b_hi, &a_lo, &a_hi);
+
+    return pack_2x256_256 (a_lo, a_hi);
+}
+
+/* The combiners go eight pixels at a time; the last few pixels of a
+ * line use masked loads and stores.
+ */
+
+static void
+avx2_combine_over_u (pixman_implementation_t *imp,
+		     pixman_op_t              op,
+		     uint32_t *               pd,
+		     const uint32_t *         ps,
+		     const uint32_t *         pm,
+		     int                      w)
+{
+    while (w > 0)
+    {
+	int n = w < 8 ? w : 8;
+	__m256i src = combine8 (load_8x32 (ps, w), pm, w);
+
+	if (!is_zero_256 (src))
+	{
+	    if (n == 8 && is_opaque_256 (src))
+		save_8x32 (pd, w, src);
+	    else
+		save_8x32 (pd, w, over_8x32 (src, load_8x32 (pd, w)));
+	}
+
+	pd += n;
+	ps += n;
+	if (pm)
+	    pm += n;
+	w -= n;
+    }
+}
+
+static void
+avx2_combine_over_reverse_u (pixman_implementation_t *imp,
+			     pixman_op_t              op,
+			     uint32_t *               pd,
+			     const uint32_t *         ps,
+			     const uint32_t *         pm,
+			     int                      w)
+{
+    while (w > 0)
+    {
+	int n = w < 8 ? w : 8;
+	__m256i dst = load_8x32 (pd, w);
+
+	if (n < 8 || !is_opaque_256 (dst))
+	    save_8x32 (pd, w, over_8x32 (dst, combine8 (load_8x32 (ps, w), pm, w)));
+
+	pd += n;
+	ps += n;
+	if (pm)
+	    pm += n;
+	w -= n;
+    }
+}
+
+static void
+avx2_combine_in_u (pixman_implementation_t *imp,
+		   pixman_op_t              op,
+		   uint32_t *               pd,
+		   const uint32_t *         ps,
+		   const uint32_t *         pm,
+		   int                      w)
+{
+    while (w > 0)
+    {
+	int n = w < 8 ? w : 8;
+
+	save_8x32 (pd, w, pix_multiply_alpha_8x32 (
+		       combine8 (load_8x32 (ps, w), pm, w),
+		       load_8x32 (pd, w), FALSE));
+
+	pd += n;
+	ps += n;
+	if (pm)
+	    pm += n;
+	w -= n;
+    }
+}
+
+static void
+avx2_combine_in_reverse_u (pixman_implementation_t *imp,
+			   pixman_op_t              op,
+			   uint32_t *               pd,
+			   const uint32_t *         ps,
+			   const uint32_t *         pm,
+			   int                      w)
+{
+    while (w > 0)
+    {
+	int n = w < 8 ? w : 8;
+
+	save_8x32 (pd, w, pix_multiply_alpha_8x32 (
+		       load_8x32 (pd, w),
+		       combine8 (load_8x32 (ps, w), pm, w), FALSE));
+
+	pd += n;
+	ps += n;
+	if (pm)
+	    pm += n;
+	w -= n;
+    }
+}
+
+static void
+avx2_combine_out_reverse_u (pixman_implementation_t *imp,
+			    pixman_op_t              op,
+			    uint32_t *               pd,
+			    const uint32_t *         ps,
+			    const uint32_t *         pm,
+			    int                      w)
+{
+    while (w > 0)
+    {
+	int n = w < 8 ? w : 8;
+
+	save_8x32 (pd, w, pix_multiply_alpha_8x32 (
+		       load_8x32 (pd, w),
+		       combine8 (load_8x32 (ps, w), pm, w), TRUE));
+
+	pd += n;
+	ps += n;
+	if (pm)
+	    pm += n;
+	w -= n;
+    }
+}
+
+static void
+avx2_combine_add_u (pixman_implementation_t *imp,
+		    pixman_op_t              op,
+		    uint32_t *               pd,
+		    const uint32_t *         ps,
+		    const uint32_t *         pm,
+		    int                      w)
+{
+    while (w > 0)
+    {
+	int n = w < 8 ? w : 8;
+
+	save_8x32 (pd, w, _mm256_adds_epu8 (
+		       combine8 (load_8x32 (ps, w), pm, w),
+		       load_8x32 (pd, w)));
+
+	pd += n;
+	ps += n;
+	if (pm)
+	    pm += n;
+	w -= n;
+    }
+}
+
+static void
+avx2_composite_over_8888_8888 (pixman_implementation_t *imp,
+			       pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    int dst_stride, src_stride;
+    uint32_t    *dst_line;
+    uint32_t    *src_line;
+
+    PIXMAN_IMAGE_GET_LINE (
+	dest_image, dest_x, dest_y, uint32_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (
+	src_image, src_x, src_y, uint32_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	avx2_combine_over_u (imp, op, dst_line, src_line, NULL, width);
+
+	dst_line += dst_stride;
+	src_line += src_stride;
+    }
+}
+
+static void
+avx2_composite_add_8888_8888 (pixman_implementation_t *imp,
+			      pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    int dst_stride, src_stride;
+    uint32_t    *dst_line;
+    uint32_t    *src_line;
+
+    PIXMAN_IMAGE_GET_LINE (
+	dest_image, dest_x, dest_y, uint32_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (
+	src_image, src_x, src_y, uint32_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	avx2_combine_add_u (imp, op, dst_line, src_line, NULL, width);
+
+	dst_line += dst_stride;
+	src_line += src_stride;
+    }
+}
+
+static void
+avx2_composite_src_x888_8888 (pixman_implementation_t *imp,
+			      pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint32_t    *dst_line, *dst;
+    uint32_t    *src_line, *src;
+    int32_t w;
+    int dst_stride, src_stride;
+
+    PIXMAN_IMAGE_GET_LINE (
+	dest_image, dest_x, dest_y, uint32_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (
+	src_image, src_x, src_y, uint32_t, src_stride, src_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	src = src_line;
+	src_line += src_stride;
+	w = width;
+
+	while (w >= 32)
+	{
+	    __m256i src1, src2, src3, src4;
+
+	    src1 = load_256_unaligned ((__m256i *)src + 0);
+	    src2 = load_256_unaligned ((__m256i *)src + 1);
+	    src3 = load_256_unaligned ((__m256i *)src + 2);
+	    src4 = load_256_unaligned ((__m256i *)src + 3);
+
+	    save_256_unaligned ((__m256i *)dst + 0, _mm256_or_si256 (src1, mask_ff000000));
+	    save_256_unaligned ((__m256i *)dst + 1, _mm256_or_si256 (src2, mask_ff000000));
+	    save_256_unaligned ((__m256i *)dst + 2, _mm256_or_si256 (src3, mask_ff000000));
+	    save_256_unaligned ((__m256i *)dst + 3, _mm256_or_si256 (src4, mask_ff000000));
+
+	    dst += 32;
+	    src += 32;
+	    w -= 32;
+	}
+
+	while (w > 0)
+	{
+	    int n = w < 8 ? w : 8;
+
+	    save_8x32 (dst, w, _mm256_or_si256 (load_8x32 (src, w),
+						mask_ff000000));
+
+	    dst += n;
+	    src += n;
+	    w -= n;
+	}
+    }
+}
+
+static void
+avx2_composite_over_n_8_8888 (pixman_implementation_t *imp,
+			      pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint32_t src, srca;
+    uint32_t *dst_line, *dst;
+    uint8_t *mask_line, *mask;
+    int dst_stride, mask_stride;
+    int32_t w;
+    uint64_t m;
+
+    __m256i xmm_src, xmm_alpha, xmm_def;
+    __m256i xmm_dst_lo, xmm_dst_hi;
+    __m256i xmm_mask, xmm_mask_lo, xmm_mask_hi;
+
+    src = _pixman_image_get_solid (imp, src_image, dest_image->bits.format);
+
+    srca = src >> 24;
+    if (src == 0)
+	return;
+
+    PIXMAN_IMAGE_GET_LINE (
+	dest_image, dest_x, dest_y, uint32_t, dst_stride, dst_line, 1);
+    PIXMAN_IMAGE_GET_LINE (
+	mask_image, mask_x, mask_y, uint8_t, mask_stride, mask_line, 1);
+
+    xmm_def = _mm256_set1_epi32 (src);
+    xmm_src = _mm256_unpacklo_epi8 (xmm_def, _mm256_setzero_si256 ());
+    expand_alpha_2x256 (xmm_src, xmm_src, &xmm_alpha, &xmm_alpha);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	mask = mask_line;
+	mask_line += mask_stride;
+	w = width;
+
+	while (w > 0)
+	{
+	    int n = w < 8 ? w : 8;
+
+	    m = 0;
+	    memcpy (&m, mask, n);
+
+	    if (srca == 0xff && m == UINT64_MAX)
+	    {
+		save_256_unaligned ((__m256i *)dst, xmm_def);
+	    }
+	    else if (m)
+	    {
+		xmm_mask = _mm256_cvtepu8_epi32 (
+		    _mm_cvtsi64_si128 ((int64_t)m));
+
+		unpack_256_2x256 (load_8x32 (dst, w), &xmm_dst_lo, &xmm_dst_hi);
+		unpack_256_2x256 (xmm_mask, &xmm_mask_lo, &xmm_mask_hi);
+
+		expand_alpha_rev_2x256 (xmm_mask_lo, xmm_mask_hi,
+					&xmm_mask_lo, &xmm_mask_hi);
+
+		in_over_2x256 (&xmm_src, &xmm_src,
+			       &xmm_alpha, &xmm_alpha,
+			       &xmm_mask_lo, &xmm_mask_hi,
+			       &xmm_dst_lo, &xmm_dst_hi);
+
+		save_8x32 (dst, w, pack_2x256_256 (xmm_dst_lo, xmm_dst_hi));
+	    }
+
+	    w -= n;
+	    dst += n;
+	    mask += n;
+	}
+    }
+}
+
+static void
+avx2_composite_in_n_8 (pixman_implementation_t *imp,
+		       pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint8_t     *dst_line, *dst;
+    int dst_stride;
+    uint32_t d;
+    uint32_t src;
+    int32_t w;
+
+    __m256i xmm_alpha;
+    __m256i xmm_dst_lo, xmm_dst_hi;
+
+    PIXMAN_IMAGE_GET_LINE (
+	dest_image, dest_x, dest_y, uint8_t, dst_stride, dst_line, 1);
+
+    src = _pixman_image_get_solid (imp, src_image, dest_image->bits.format);
+
+    src = src >> 24;
+
+    if (src == 0xff)
+	return;
+
+    if (src == 0x00)
+    {
+	pixman_fill (dest_image->bits.bits, dest_image->bits.rowstride,
+		     8, dest_x, dest_y, width, height, src);
+
+	return;
+    }
+
+    xmm_alpha = _mm256_set1_epi16 (src);
+
+    while (height--)
+    {
+	dst = dst_line;
+	dst_line += dst_stride;
+	w = width;
+
+	while (w >= 32)
+	{
+	    unpack_256_2x256 (load_256_unaligned ((__m256i *)dst),
+			      &xmm_dst_lo, &xmm_dst_hi);
+
+	    pix_multiply_2x256 (&xmm_alpha, &xmm_alpha,
+				&xmm_dst_lo, &xmm_dst_hi,
+				&xmm_dst_lo, &xmm_dst_hi);
+
+	    save_256_unaligned (
+		(__m256i *)dst, pack_2x256_256 (xmm_dst_lo, xmm_dst_hi));
+
+	    dst += 32;
+	    w -= 32;
+	}
+
+	while (w)
+	{
+	    d = *dst;
+	    *dst++ = MUL_UN8 (src, d, d);
+	    w--;
+	}
+    }
+}
+
+static void
+avx2_composite_add_8_8 (pixman_implementation_t *imp,
+			pixman_composite_info_t *info)
+{
+    PIXMAN_COMPOSITE_ARGS (info);
+    uint8_t     *dst_line, *dst;
+    uint8_t     *src_line, *src;
+    int dst_stride, src_stride;
+    int32_t w;
+    uint16_t t;
+
+    PIXMAN_IMAGE_GET_LINE (
+	src_image, src_x, src_y, uint8_t, src_stride, src_line, 1);
+    PIXMAN_IMAGE_GET_LINE (
+	dest_image, dest_x, dest_y, uint8_t, dst_stride, dst_line, 1);
+
+    while (height--)
+    {
+	dst = dst_line;
+	src = src_line;
+
+	dst_line += dst_stride;
+	src_line += src_stride;
+	w = width;
+
+	while (w >= 32)
+	{
+	    save_256_unaligned (
+		(__m256i *)dst,
+		_mm256_adds_epu8 (load_256_unaligned ((__m256i *)src),
+				  load_256_unaligned ((__m256i *)dst)));
+
+	    dst += 32;
+	    src += 32;
+	    w -= 32;
+	}
+
+	while (w)
+	{
+	    t = (*dst) + (*src++);
+	    *dst++ = t | (0 - (t >> 8));
+	    w--;
+	}
+    }
+}
+
+/*
+ * Bilinear scaling.  Like the SSE2 code, each pixel is interpolated
+ * vertically first and then horizontally, with a single rounding at
+ * the end, so the results are identical; four pixels are done in one
+ * register.
+ */
+
+static force_inline uint32_t
+bilinear_weights (intptr_t vx)
+{
+    uint32_t w = pixman_fixed_to_bilinear_weight (vx);
+
+    return (w << 16) | (BILINEAR_INTERPOLATION_RANGE - w);
+}
+
+static force_inline uint32_t
+bilinear_interpolate_one (const uint32_t *src_top,
+			  const uint32_t *src_bottom,
+			  intptr_t        vx,
+			  int             wt,
+			  int             wb)
+{
+    int x = vx >> 16;
+    uint32_t tl = src_top[x], tr = src_top[x + 1];
+    uint32_t bl = src_bottom[x], br = src_bottom[x + 1];
+    int wr = pixman_fixed_to_bilinear_weight (vx);
+    int wl = BILINEAR_INTERPOLATION_RANGE - wr;
+    uint32_t r = 0;
+    int shift;
+
+    for (shift = 0; shift < 32; shift += 8)
+    {
+	uint32_t l = ((tl >> shift) & 0xff) * wt + ((bl >> shift) & 0xff) * wb;
+	uint32_t rt = ((tr >> shift) & 0xff) * wt + ((br >> shift) & 0xff) * wb;
+
+	r |= ((l * wl + rt * wr) >> (BILINEAR_INTERPOLATION_BITS * 2)) << shift;
+    }
+
+    return r;
+}
+
+static force_inline __m256i
+bilinear_load_four (const uint32_t *line, intptr_t vx, intptr_t unit_x)
+{
+    __m128i p01, p23;
+
+    p01 = _mm_unpacklo_epi64 (
+	_mm_loadl_epi64 ((__m128i *)&line[vx >> 16]),
+	_mm_loadl_epi64 ((__m128i *)&line[(vx + unit_x) >> 16]));
+    p23 = _mm_unpacklo_epi64 (
+	_mm_loadl_epi64 ((__m128i *)&line[(vx + unit_x * 2) >> 16]),
+	_mm_loadl_epi64 ((__m128i *)&line[(vx + unit_x * 3) >> 16]));
+
+    return _mm256_inserti128_si256 (_mm256_castsi128_si256 (p01), p23, 1);
+}
+
+static force_inline __m256i
+bilinear_horizontal (__m256i a, __m256i weights)
+{
+    __m256i tl = _mm256_unpacklo_epi64 (a, a);
+
+    a = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (tl, a), weights);
+
+    return _mm256_srli_epi32 (a, BILINEAR_INTERPOLATION_BITS * 2);
+}
+
+/* Returns pixels 0 and 1 in the low lane and 2 and 3 in the high lane,
+ * 16 bits per channel.
+ */
+static force_inline __m256i
+bilinear_interpolate_four (const uint32_t *src_top,
+			   const uint32_t *src_bottom,
+			   intptr_t        vx,
+			   intptr_t        unit_x,
+			   __m256i         wt,
+			   __m256i         wb)
+{
+    __m256i top = bilinear_load_four (src_top, vx, unit_x);
+    __m256i bottom = bilinear_load_four (src_bottom, vx, unit_x);
+    __m256i top_lo, top_hi, bottom_lo, bottom_hi;
+    __m256i w02, w13;
+    uint32_t w0 = bilinear_weights (vx);
+    uint32_t w1 = bilinear_weights (vx + unit_x);
+    uint32_t w2 = bilinear_weights (vx + unit_x * 2);
+    uint32_t w3 = bilinear_weights (vx + unit_x * 3);
+
+    w02 = _mm256_setr_epi32 (w0, w0, w0, w0, w2, w2, w2, w2);
+    w13 = _mm256_setr_epi32 (w1, w1, w1, w1, w3, w3, w3, w3);
+
+    unpack_256_2x256 (top, &top_lo, &top_hi);
+    unpack_256_2x256 (bottom, &bottom_lo, &bottom_hi);
+
+    /* top_lo and top_hi now hold pixels 0, 2 and 1, 3 */
+    top_lo = _mm256_add_epi16 (_mm256_mullo_epi16 (top_lo, wt),
+			       _mm256_mullo_epi16 (bottom_lo, wb));
+    top_hi = _mm256_add_epi16 (_mm256_mullo_epi16 (top_hi, wt),
+			       _mm256_mullo_epi16 (bottom_hi, wb));
+
+    return _mm256_packs_epi32 (bilinear_horizontal (top_lo, w02),
+			       bilinear_horizontal (top_hi, w13));
+}
+
+static force_inline __m256i
+bilinear_interpolate_eight (const uint32_t *src_top,
+			    const uint32_t *src_bottom,
+			    intptr_t        vx,
+			    intptr_t        unit_x,
+			    __m256i         wt,
+			    __m256i         wb)
+{
+    __m256i p0123 = bilinear_interpolate_four (
+	src_top, src_bottom, vx, unit_x, wt, wb);
+    __m256i p4567 = bilinear_interpolate_four (
+	src_top, src_bottom, vx + unit_x * 4, unit_x, wt, wb);
+
+    /* 0 1 4 5 | 2 3 6 7 */
+    return _mm256_permute4x64_epi64 (_mm256_packus_epi16 (p0123, p4567),
+				     _MM_SHUFFLE (3, 1, 2, 0));
+}
+
+static force_inline void
+scaled_bilinear_scanline_avx2_8888_8888_SRC (uint32_t *       dst,
+					     const uint32_t * mask,
+					     const uint32_t * src_top,
+					     const uint32_t * src_bottom,
+					     int32_t          w,
+					     int              wt,
+					     int              wb,
+					     pixman_fixed_t   vx_,
+					     pixman_fixed_t   unit_x_,
+					     pixman_fixed_t   max_vx,
+					     pixman_bool_t    zero_src)
+{
+    intptr_t vx = vx_;
+    intptr_t unit_x = unit_x_;
+    __m256i ymm_wt = _mm256_set1_epi16 (wt);
+    __m256i ymm_wb = _mm256_set1_epi16 (wb);
+
+    while (w >= 8)
+    {
+	save_256_unaligned ((__m256i *)dst, bilinear_interpolate_eight (
+			      src_top, src_bottom, vx, unit_x, ymm_wt, ymm_wb));
+	vx += unit_x * 8;
+	dst += 8;
+	w -= 8;
+    }
+
+    while (w)
+    {
+	*dst++ = bilinear_interpolate_one (src_top, src_bottom, vx, wt, wb);
+	vx += unit_x;
+	w--;
+    }
+}
+
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_cover_SRC,
+			       scaled_bilinear_scanline_avx2_8888_8888_SRC,
+			       uint32_t, uint32_t, uint32_t,
+			       COVER, FLAG_NONE)
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_pad_SRC,
+			       scaled_bilinear_scanline_avx2_8888_8888_SRC,
+			       uint32_t, uint32_t, uint32_t,
+			       PAD, FLAG_NONE)
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_none_SRC,
+			       scaled_bilinear_scanline_avx2_8888_8888_SRC,
+			       uint32_t, uint32_t, uint32_t,
+			       NONE, FLAG_NONE)
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_normal_SRC,
+			       scaled_bilinear_scanline_avx2_8888_8888_SRC,
+			       uint32_t, uint32_t, uint32_t,
+			       NORMAL, FLAG_NONE)
+
+static force_inline void
+scaled_bilinear_scanline_avx2_8888_8888_OVER (uint32_t *       dst,
+					      const uint32_t * mask,
+					      const uint32_t * src_top,
+					      const uint32_t * src_bottom,
+					      int32_t          w,
+					      int              wt,
+					      int              wb,
+					      pixman_fixed_t   vx_,
+					      pixman_fixed_t   unit_x_,
+					      pixman_fixed_t   max_vx,
+					      pixman_bool_t    zero_src)
+{
+    intptr_t vx = vx_;
+    intptr_t unit_x = unit_x_;
+    __m256i ymm_wt = _mm256_set1_epi16 (wt);
+    __m256i ymm_wb = _mm256_set1_epi16 (wb);
+    uint32_t s;
+
+    while (w >= 8)
+    {
+	__m256i src = bilinear_interpolate_eight (
+	    src_top, src_bottom, vx, unit_x, ymm_wt, ymm_wb);
+
+	if (!is_zero_256 (src))
+	{
+	    if (is_opaque_256 (src))
+		save_256_unaligned ((__m256i *)dst, src);
+	    else
+		save_256_unaligned ((__m256i *)dst, over_8x32 (
+					src, load_256_unaligned ((__m256i *)dst)));
+	}
+
+	vx += unit_x * 8;
+	dst += 8;
+	w -= 8;
+    }
+
+    while (w)
+    {
+	s = bilinear_interpolate_one (src_top, src_bottom, vx, wt, wb);
+	*dst = over_1x32 (s, *dst);
+	vx += unit_x;
+	dst++;
+	w--;
+    }
+}
+
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_cover_OVER,
+			       scaled_bilinear_scanline_avx2_8888_8888_OVER,
+			       uint32_t, uint32_t, uint32_t,
+			       COVER, FLAG_NONE)
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_pad_OVER,
+			       scaled_bilinear_scanline_avx2_8888_8888_OVER,
+			       uint32_t, uint32_t, uint32_t,
+			       PAD, FLAG_NONE)
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_none_OVER,
+			       scaled_bilinear_scanline_avx2_8888_8888_OVER,
+			       uint32_t, uint32_t, uint32_t,
+			       NONE, FLAG_NONE)
+FAST_BILINEAR_MAINLOOP_COMMON (avx2_8888_8888_normal_OVER,
+			       scaled_bilinear_scanline_avx2_8888_8888_OVER,
+			       uint32_t, uint32_t, uint32_t,
+			       NORMAL, FLAG_NONE)
+
+/*
+ * Separable convolution of affine transformed images.  The sums are
+ * the same as in bits_image_fetch_separable_convolution_affine() in
+ * pixman-fast-path.c: the weight of every tap is rounded on its own,
+ * and the four channels of a pixel are accumulated as 32 bit integers,
+ * two pixels per register.
+ */
+
+typedef uint32_t (* convert_pixel_t) (const uint8_t *row, int x);
+
+static force_inline uint32_t
+convert_a8r8g8b8 (const uint8_t *row, int x)
+{
+    return *(((uint32_t *)row) + x);
+}
+
+static force_inline uint32_t
+convert_x8r8g8b8 (const uint8_t *row, int x)
+{
+    return *(((uint32_t *)row) + x);
+}
+
+static force_inline uint32_t
+convert_r5g6b5 (const uint8_t *row, int x)
+{
+    return convert_0565_to_0888 (*((uint16_t *)row + x));
+}
+
+/* convert_0565_to_0888() on up to eight pixels */
+static force_inline __m256i
+load_8x0565 (const uint16_t *src, int n)
+{
+    uint16_t tmp[8];
+    __m256i s, rb, g;
+
+    memcpy (tmp, src, n * sizeof (uint16_t));
+    s = _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((__m128i *)tmp));
+
+    rb = _mm256_or_si256 (
+	_mm256_and_si256 (_mm256_slli_epi32 (s, 3), _mm256_set1_epi32 (0xf800f8)),
+	_mm256_and_si256 (_mm256_srli_epi32 (s, 2), _mm256_set1_epi32 (0x7)));
+    rb = _mm256_or_si256 (
+	rb, _mm256_and_si256 (_mm256_slli_epi32 (s, 8), _mm256_set1_epi32 (0xf80000)));
+    rb = _mm256_or_si256 (
+	rb, _mm256_and_si256 (_mm256_slli_epi32 (s, 3), _mm256_set1_epi32 (0x70000)));
+    g = _mm256_or_si256 (
+	_mm256_and_si256 (_mm256_slli_epi32 (s, 5), _mm256_set1_epi32 (0xfc00)),
+	_mm256_and_si256 (_mm256_srli_epi32 (s, 1), _mm256_set1_epi32 (0x300)));
+
+    return _mm256_or_si256 (rb, g);
+}
+
+/* ((pixman_fixed_32_32_t)fx * fy + 0x8000) >> 16 for up to eight
+ * taps, truncated to 32 bits like the C code does.  Taps past n get a
+ * weight of zero.
+ */
+static force_inline __m256i
+convolution_weights (const pixman_fixed_t *x_params, int n, __m256i fy)
+{
+    const __m256i round = _mm256_set1_epi64x (0x8000);
+    __m256i fx, even, odd;
+
+    fx = load_8x32 ((const uint32_t *)x_params, n);
+
+    even = _mm256_add_epi64 (_mm256_mul_epi32 (fx, fy), round);
+    odd = _mm256_add_epi64 (
+	_mm256_mul_epi32 (_mm256_srli_epi64 (fx, 32), fy), round);
+
+    return _mm256_blend_epi32 (_mm256_srli_epi64 (even, 16),
+			       _mm256_slli_epi64 (odd, 16), 0xaa);
+}
+
+/* Multiplies eight pixels by their weights and adds them to acc */
+static force_inline __m256i
+convolution_accumulate (__m256i acc, __m256i pixels, __m256i weights, int n)
+{
+    __m128i lo = _mm256_castsi256_si128 (pixels);
+    __m128i hi = _mm256_extracti128_si256 (pixels, 1);
+
+#define ACCUMULATE(p, i)						\
+    acc = _mm256_add_epi32 (						\
+	acc, _mm256_mullo_epi32 (					\
+	    _mm256_cvtepu8_epi32 (p),					\
+	    _mm256_permutevar8x32_epi32 (				\
+		weights, _mm256_setr_epi32 (i, i, i, i,			\
+					    i + 1, i + 1, i + 1, i + 1))))
+
+    ACCUMULATE (lo, 0);
+    if (n > 2)
+	ACCUMULATE (_mm_srli_si128 (lo, 8), 2);
+    if (n > 4)
+	ACCUMULATE (hi, 4);
+    if (n > 6)
+	ACCUMULATE (_mm_srli_si128 (hi, 8), 6);
+
+#undef ACCUMULATE
+
+    return acc;
+}
+
+static force_inline void
+avx2_fetch_separable_convolution_affine (pixman_iter_t        *iter,
+					 convert_pixel_t       convert_pixel,
+					 pixman_format_code_t  format,
+					 pixman_repeat_t       repeat_mode)
+{
+    pixman_image_t *image = iter->image;
+    bits_image_t *bits = &image->bits;
+    uint32_t *buffer = iter->buffer;
+    pixman_fixed_t *params = image->common.filter_params;
+    int cwidth = pixman_fixed_to_int (params[0]);
+    int cheight = pixman_fixed_to_int (params[1]);
+    int x_off = ((cwidth << 16) - pixman_fixed_1) >> 1;
+    int y_off = ((cheight << 16) - pixman_fixed_1) >> 1;
+    int x_phase_bits = pixman_fixed_to_int (params[2]);
+    int y_phase_bits = pixman_fixed_to_int (params[3]);
+    int x_phase_shift = 16 - x_phase_bits;
+    int y_phase_shift = 16 - y_phase_bits;
+    uint32_t amask = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
+    pixman_fixed_t vx, vy;
+    pixman_fixed_t ux, uy;
+    pixman_vector_t v;
+    int k;
+
+    /* reference point is the center of the pixel */
+    v.vector[0] = pixman_int_to_fixed (iter->x) + pixman_fixed_1 / 2;
+    v.vector[1] = pixman_int_to_fixed (iter->y) + pixman_fixed_1 / 2;
+    v.vector[2] = pixman_fixed_1;
+
+    if (!pixman_transform_point_3d (image->common.transform, &v))
+	return;
+
+    ux = image->common.transform->matrix[0][0];
+    uy = image->common.transform->matrix[1][0];
+
+    vx = v.vector[0];
+    vy = v.vector[1];
+
+    for (k = 0; k < iter->width; ++k)
+    {
+	pixman_fixed_t *y_params;
+	pixman_fixed_t x, y;
+	int32_t x1, y1, y2;
+	int32_t px, py;
+	__m256i acc = _mm256_setzero_si256 ();
+	__m128i sum;
+	int i, j;
+
+	/* Round x and y to the middle of the closest phase, as the C
+	 * code does.
+	 */
+	x = ((vx >> x_phase_shift) << x_phase_shift) + ((1 << x_phase_shift) >> 1);
+	y = ((vy >> y_phase_shift) << y_phase_shift) + ((1 << y_phase_shift) >> 1);
+
+	px = (x & 0xffff) >> x_phase_shift;
+	py = (y & 0xffff) >> y_phase_shift;
+
+	x1 = pixman_fixed_to_int (x - pixman_fixed_e - x_off);
+	y1 = pixman_fixed_to_int (y - pixman_fixed_e - y_off);
+	y2 = y1 + cheight;
+
+	y_params = params + 4 + (1 << x_phase_bits) * cwidth + py * cheight;
+
+	for (i = y1; i < y2; ++i)
+	{
+	    pixman_fixed_t fy = *y_params++;
+	    pixman_fixed_t *x_params = params + 4 + px * cwidth;
+	    const uint8_t *row;
+	    __m256i vfy;
+	    int ry = i;
+
+	    if (!fy)
+		continue;
+
+	    /* Rows outside an image that isn't repeated add nothing */
+	    if (!repeat (repeat_mode, &ry, bits->height))
+		continue;
+
+	    row = (uint8_t *)bits->bits + bits->rowstride * 4 * ry;
+	    vfy = _mm256_set1_epi32 (fy);
+
+	    for (j = 0; j < cwidth; j += 8)
+	    {
+		int n = cwidth - j < 8 ? cwidth - j : 8;
+		__m256i pixels;
+
+		if (x1 + j >= 0 && x1 + j + n <= bits->width)
+		{
+		    if (PIXMAN_FORMAT_BPP (format) == 32)
+			pixels = load_8x32 ((uint32_t *)row + x1 + j, n);
+		    else
+			pixels = load_8x0565 ((uint16_t *)row + x1 + j, n);
+
+		    pixels = _mm256_or_si256 (pixels, _mm256_set1_epi32 (amask));
+		}
+		else
+		{
+		    uint32_t tmp[8];
+		    int t;
+
+		    for (t = 0; t < n; ++t)
+		    {
+			int rx = x1 + j + t;
+
+			if (repeat (repeat_mode, &rx, bits->width))
+			    tmp[t] = convert_pixel (row, rx) | amask;
+			else
+			    tmp[t] = 0;
+		    }
+
+		    pixels = load_8x32 (tmp, n);
+		}
+
+		acc = convolution_accumulate (
+		    acc, pixels, convolution_weights (x_params + j, n, vfy), n);
+	    }
+	}
+
+	sum = _mm_add_epi32 (_mm256_castsi256_si128 (acc),
+			     _mm256_extracti128_si256 (acc, 1));
+	sum = _mm_srai_epi32 (_mm_add_epi32 (sum, _mm_set1_epi32 (0x8000)), 16);
+
+	/* The saturating packs clamp to [0, 255] */
+	sum = _mm_packs_epi32 (sum, sum);
+	buffer[k] = _mm_cvtsi128_si32 (_mm_packus_epi16 (sum, sum));
+
+	vx += ux;
+	vy += uy;
+    }
+}
+
+#define MAKE_SEPARABLE_CONVOLUTION_FETCHER(name, format, repeat_mode)	\
+    static uint32_t *							\
+    avx2_fetch_separable_convolution_affine_ ## name (			\
+	pixman_iter_t *iter, const uint32_t *mask)			\
+    {									\
+	avx2_fetch_separable_convolution_affine (iter,			\
+						 convert_ ## format,	\
+						 PIXMAN_ ## format,	\
+						 repeat_mode);		\
+	iter->y++;							\
+	return iter->buffer;						\
+    }
+
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (pad_a8r8g8b8,     a8r8g8b8, PIXMAN_REPEAT_PAD)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (none_a8r8g8b8,    a8r8g8b8, PIXMAN_REPEAT_NONE)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (reflect_a8r8g8b8, a8r8g8b8, PIXMAN_REPEAT_REFLECT)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (normal_a8r8g8b8,  a8r8g8b8, PIXMAN_REPEAT_NORMAL)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (pad_x8r8g8b8,     x8r8g8b8, PIXMAN_REPEAT_PAD)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (none_x8r8g8b8,    x8r8g8b8, PIXMAN_REPEAT_NONE)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (reflect_x8r8g8b8, x8r8g8b8, PIXMAN_REPEAT_REFLECT)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (normal_x8r8g8b8,  x8r8g8b8, PIXMAN_REPEAT_NORMAL)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (pad_r5g6b5,       r5g6b5,   PIXMAN_REPEAT_PAD)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (none_r5g6b5,      r5g6b5,   PIXMAN_REPEAT_NONE)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (reflect_r5g6b5,   r5g6b5,   PIXMAN_REPEAT_REFLECT)
+MAKE_SEPARABLE_CONVOLUTION_FETCHER (normal_r5g6b5,    r5g6b5,   PIXMAN_REPEAT_NORMAL)
+
+#define SEPARABLE_CONVOLUTION_AFFINE_FLAGS				\
+    (FAST_PATH_NO_ALPHA_MAP		|				\
+     FAST_PATH_NO_ACCESSORS		|				\
+     FAST_PATH_HAS_TRANSFORM		|				\
+     FAST_PATH_AFFINE_TRANSFORM		|				\
+     FAST_PATH_SEPARABLE_CONVOLUTION_FILTER)
+
+#define SEPARABLE_CONVOLUTION_AFFINE_ITER(name, format, repeat)		\
+    { PIXMAN_ ## format,						\
+      SEPARABLE_CONVOLUTION_AFFINE_FLAGS | FAST_PATH_ ## repeat ## _REPEAT, \
+      ITER_NARROW | ITER_SRC,						\
+      NULL, avx2_fetch_separable_convolution_affine_ ## name, NULL	\
+    },
+
+static const pixman_iter_info_t avx2_iters[] =
+{
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (pad_a8r8g8b8, a8r8g8b8, PAD)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (none_a8r8g8b8, a8r8g8b8, NONE)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (reflect_a8r8g8b8, a8r8g8b8, REFLECT)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (normal_a8r8g8b8, a8r8g8b8, NORMAL)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (pad_x8r8g8b8, x8r8g8b8, PAD)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (none_x8r8g8b8, x8r8g8b8, NONE)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (reflect_x8r8g8b8, x8r8g8b8, REFLECT)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (normal_x8r8g8b8, x8r8g8b8, NORMAL)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (pad_r5g6b5, r5g6b5, PAD)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (none_r5g6b5, r5g6b5, NONE)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (reflect_r5g6b5, r5g6b5, REFLECT)
+    SEPARABLE_CONVOLUTION_AFFINE_ITER (normal_r5g6b5, r5g6b5, NORMAL)
+
+    { PIXMAN_null },
+};
+
+static const pixman_fast_path_t avx2_fast_paths[] =
+{
+    /* PIXMAN_OP_OVER */
+    PIXMAN_STD_FAST_PATH (OVER, a8r8g8b8, null, a8r8g8b8, avx2_composite_over_8888_8888),
+    PIXMAN_STD_FAST_PATH (OVER, a8r8g8b8, null, x8r8g8b8, avx2_composite_over_8888_8888),
+    PIXMAN_STD_FAST_PATH (OVER, a8b8g8r8, null, a8b8g8r8, avx2_composite_over_8888_8888),
+    PIXMAN_STD_FAST_PATH (OVER, a8b8g8r8, null, x8b8g8r8, avx2_composite_over_8888_8888),
+    PIXMAN_STD_FAST_PATH (OVER, solid, a8, a8r8g8b8, avx2_composite_over_n_8_8888),
+    PIXMAN_STD_FAST_PATH (OVER, solid, a8, x8r8g8b8, avx2_composite_over_n_8_8888),
+    PIXMAN_STD_FAST_PATH (OVER, solid, a8, a8b8g8r8, avx2_composite_over_n_8_8888),
+    PIXMAN_STD_FAST_PATH (OVER, solid, a8, x8b8g8r8, avx2_composite_over_n_8_8888),
+
+    /* PIXMAN_OP_ADD */
+    PIXMAN_STD_FAST_PATH (ADD, a8, null, a8, avx2_composite_add_8_8),
+    PIXMAN_STD_FAST_PATH (ADD, a8r8g8b8, null, a8r8g8b8, avx2_composite_add_8888_8888),
+    PIXMAN_STD_FAST_PATH (ADD, a8b8g8r8, null, a8b8g8r8, avx2_composite_add_8888_8888),
+
+    /* PIXMAN_OP_SRC */
+    PIXMAN_STD_FAST_PATH (SRC, x8r8g8b8, null, a8r8g8b8, avx2_composite_src_x888_8888),
+    PIXMAN_STD_FAST_PATH (SRC, x8b8g8r8, null, a8b8g8r8, avx2_composite_src_x888_8888),
+
+    /* PIXMAN_OP_IN */
+    PIXMAN_STD_FAST_PATH (IN, solid, null, a8, avx2_composite_in_n_8),
+
+    SIMPLE_BILINEAR_FAST_PATH (SRC, a8r8g8b8, a8r8g8b8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (SRC, a8r8g8b8, x8r8g8b8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (SRC, x8r8g8b8, x8r8g8b8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (SRC, a8b8g8r8, a8b8g8r8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (SRC, a8b8g8r8, x8b8g8r8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (SRC, x8b8g8r8, x8b8g8r8, avx2_8888_8888),
+
+    SIMPLE_BILINEAR_FAST_PATH (OVER, a8r8g8b8, x8r8g8b8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (OVER, a8b8g8r8, x8b8g8r8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (OVER, a8r8g8b8, a8r8g8b8, avx2_8888_8888),
+    SIMPLE_BILINEAR_FAST_PATH (OVER, a8b8g8r8, a8b8g8r8, avx2_8888_8888),
+
+    { PIXMAN_OP_NONE },
+};
+
+pixman_implementation_t *
+_pixman_implementation_create_avx2 (pixman_implementation_t *fallback)
+{
+    pixman_implementation_t *imp =
+	_pixman_implementation_create (fallback, avx2_fast_paths);
+
+    mask_0080 = _mm256_set1_epi16 (0x0080);
+    mask_00ff = _mm256_set1_epi16 (0x00ff);
+    mask_0101 = _mm256_set1_epi16 (0x0101);
+    mask_ff000000 = _mm256_set1_epi32 (0xff000000);
+    tail_index = _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7);
+
+    imp->iter_info = avx2_iters;
+
+    imp->combine_32[PIXMAN_OP_OVER] = avx2_combine_over_u;
+    imp->combine_32[PIXMAN_OP_OVER_REVERSE] = avx2_combine_over_reverse_u;
+    imp->combine_32[PIXMAN_OP_IN] = avx2_combine_in_u;
+    imp->combine_32[PIXMAN_OP_IN_REVERSE] = avx2_combine_in_reverse_u;
+    imp->combine_32[PIXMAN_OP_OUT_REVERSE] = avx2_combine_out_reverse_u;
+    imp->combine_32[PIXMAN_OP_ADD] = avx2_combine_add_u;
+
+    return imp;
+}
@@ -103,6 +103,28 @@ conical_get_scanline_narrow (pixman_iter_t *iter, const uint32_t *mask)
 	rx -= conical->center.x / 65536.;
 	ry -= conical->center.y / 65536.;
 
+	if (_pixman_gradient_use_ramp (gradient))
+	{
+	    float pos[64];
+
+	    while (buffer < end)
+	    {
+		int n = end - buffer < 64 ? end - buffer : 64;
+		int i;
+
+		for (i = 0; i < n; ++i)
+		{
+		    pos[i] = coordinates_to_parameter (rx, ry, conical->angle);
+
+		    rx += cx;
+		    ry += cy;
+		}
+
+		_pixman_gradient_ramp_fetch (gradient, buffer, pos, n);
+		buffer += n;
+	    }
+	}
+
 	while (buffer < end)
 	{
 	    if (!mask || *mask++)
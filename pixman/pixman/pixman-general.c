@@ -160,7 +160,8 @@ general_composite_rect  (pixman_implementation_t *imp,
 
     if (width * Bpp * 3 > sizeof (stack_scanline_buffer) - 15 * 3)
     {
-	scanline_buffer = pixman_malloc_ab_plus_c (width, Bpp * 3, 15 * 3);
+	scanline_buffer = _pixman_scanline_buffer_get (
+	    (size_t)width * Bpp * 3 + 15 * 3);
 
 	if (!scanline_buffer)
 	    return;
@@ -233,7 +234,7 @@ general_composite_rect  (pixman_implementation_t *imp,
 	dest_iter.fini (&dest_iter);
     
     if (scanline_buffer != (uint8_t *) stack_scanline_buffer)
-	free (scanline_buffer);
+	_pixman_scanline_buffer_put (scanline_buffer);
 }
 
 static const pixman_fast_path_t general_fast_path[] =
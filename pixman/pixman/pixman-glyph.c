@@ -28,20 +28,32 @@
 #include <config.h>
 #endif
 #include "pixman-private.h"
+#include "pixman-combine32.h"
 
 #include <stdlib.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLYPH_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 typedef struct glyph_metrics_t glyph_metrics_t;
 typedef struct glyph_t glyph_t;
 
 #define TOMBSTONE ((glyph_t *)0x1)
 
-/* XXX: These numbers are arbitrary---we've never done any measurements.
+/* The glyph images a cache holds on to, in bytes.  When a thaw finds the
+ * cache above this budget, the least recently used glyphs are thrown out
+ * until it is down to three quarters of it.
  */
-#define N_GLYPHS_HIGH_WATER  (16384)
-#define N_GLYPHS_LOW_WATER   (8192)
-#define HASH_SIZE (2 * N_GLYPHS_HIGH_WATER)
-#define HASH_MASK (HASH_SIZE - 1)
+#define BUDGET			(8 * 1024 * 1024)
+#define LOW_WATER		(BUDGET / 4 * 3)
+
+/* The hash table starts out this big, and is doubled whenever glyphs and
+ * tombstones take up more than half of it.
+ */
+#define MIN_HASH_SIZE		(1024)
 
 struct glyph_t
 {
@@ -49,6 +61,7 @@ struct glyph_t
     void *		glyph_key;
     int			origin_x;
     int			origin_y;
+    size_t		size;
     pixman_image_t *	image;
     pixman_link_t	mru_link;
 };
@@ -58,8 +71,10 @@ struct pixman_glyph_cache_t
     int			n_glyphs;
     int			n_tombstones;
     int			freeze_count;
+    size_t		size;
     pixman_list_t	mru;
-    glyph_t *		glyphs[HASH_SIZE];
+    unsigned int	hash_mask;
+    glyph_t **		glyphs;
 };
 
 static void
@@ -100,7 +115,7 @@ lookup_glyph (pixman_glyph_cache_t *cache,
     glyph_t *g;
 
     idx = hash (font_key, glyph_key);
-    while ((g = cache->glyphs[idx++ & HASH_MASK]))
+    while ((g = cache->glyphs[idx++ & cache->hash_mask]))
     {
 	if (g != TOMBSTONE			&&
 	    g->font_key == font_key		&&
@@ -127,12 +142,13 @@ insert_glyph (pixman_glyph_cache_t *cache,
      */
     do
     {
-	loc = &cache->glyphs[idx++ & HASH_MASK];
+	loc = &cache->glyphs[idx++ & cache->hash_mask];
     } while (*loc && *loc != TOMBSTONE);
 
     if (*loc == TOMBSTONE)
 	cache->n_tombstones--;
     cache->n_glyphs++;
+    cache->size += glyph->size;
 
     *loc = glyph;
 }
@@ -144,31 +160,72 @@ remove_glyph (pixman_glyph_cache_t *cache,
     unsigned idx;
 
     idx = hash (glyph->font_key, glyph->glyph_key);
-    while (cache->glyphs[idx & HASH_MASK] != glyph)
+    while (cache->glyphs[idx & cache->hash_mask] != glyph)
 	idx++;
 
-    cache->glyphs[idx & HASH_MASK] = TOMBSTONE;
+    cache->glyphs[idx & cache->hash_mask] = TOMBSTONE;
     cache->n_tombstones++;
     cache->n_glyphs--;
+    cache->size -= glyph->size;
 
     /* Eliminate tombstones if possible */
-    if (cache->glyphs[(idx + 1) & HASH_MASK] == NULL)
+    if (cache->glyphs[(idx + 1) & cache->hash_mask] == NULL)
     {
-	while (cache->glyphs[idx & HASH_MASK] == TOMBSTONE)
+	while (cache->glyphs[idx & cache->hash_mask] == TOMBSTONE)
 	{
-	    cache->glyphs[idx & HASH_MASK] = NULL;
+	    cache->glyphs[idx & cache->hash_mask] = NULL;
 	    cache->n_tombstones--;
 	    idx--;
 	}
     }
 }
 
+/* Moves the glyphs into a table that has room for at least n_glyphs
+ * of them at half load, which also gets rid of all tombstones.
+ */
+static pixman_bool_t
+resize_table (pixman_glyph_cache_t *cache, int n_glyphs)
+{
+    glyph_t **old_glyphs = cache->glyphs;
+    unsigned int old_size = cache->hash_mask + 1;
+    unsigned int size = MIN_HASH_SIZE;
+    unsigned int i;
+
+    while (size < 2 * (unsigned int)n_glyphs)
+    {
+	if (size >= (1U << 30))
+	    return FALSE;
+	size *= 2;
+    }
+
+    if (!(cache->glyphs = calloc (size, sizeof (glyph_t *))))
+    {
+	cache->glyphs = old_glyphs;
+	return FALSE;
+    }
+
+    cache->hash_mask = size - 1;
+    cache->n_glyphs = 0;
+    cache->n_tombstones = 0;
+    cache->size = 0;
+
+    for (i = 0; i < old_size; ++i)
+    {
+	if (old_glyphs[i] && old_glyphs[i] != TOMBSTONE)
+	    insert_glyph (cache, old_glyphs[i]);
+    }
+
+    free (old_glyphs);
+
+    return TRUE;
+}
+
 static void
 clear_table (pixman_glyph_cache_t *cache)
 {
-    int i;
+    unsigned int i;
 
-    for (i = 0; i < HASH_SIZE; ++i)
+    for (i = 0; i <= cache->hash_mask; ++i)
     {
 	glyph_t *glyph = cache->glyphs[i];
 
@@ -180,6 +237,7 @@ clear_table (pixman_glyph_cache_t *cache)
 
     cache->n_glyphs = 0;
     cache->n_tombstones = 0;
+    cache->size = 0;
 }
 
 PIXMAN_EXPORT pixman_glyph_cache_t *
@@ -190,10 +248,17 @@ pixman_glyph_cache_create (void)
     if (!(cache = malloc (sizeof *cache)))
 	return NULL;
 
-    memset (cache->glyphs, 0, sizeof (cache->glyphs));
+    if (!(cache->glyphs = calloc (MIN_HASH_SIZE, sizeof (glyph_t *))))
+    {
+	free (cache);
+	return NULL;
+    }
+
+    cache->hash_mask = MIN_HASH_SIZE - 1;
     cache->n_glyphs = 0;
     cache->n_tombstones = 0;
     cache->freeze_count = 0;
+    cache->size = 0;
 
     pixman_list_init (&cache->mru);
 
@@ -207,6 +272,7 @@ pixman_glyph_cache_destroy (pixman_glyph_cache_t *cache)
 
     clear_table (cache);
 
+    free (cache->glyphs);
     free (cache);
 }
 
@@ -219,18 +285,12 @@ pixman_glyph_cache_freeze (pixman_glyph_cache_t  *cache)
 PIXMAN_EXPORT void
 pixman_glyph_cache_thaw (pixman_glyph_cache_t  *cache)
 {
-    if (--cache->freeze_count == 0					&&
-	cache->n_glyphs + cache->n_tombstones > N_GLYPHS_HIGH_WATER)
-    {
-	if (cache->n_tombstones > N_GLYPHS_HIGH_WATER)
-	{
-	    /* More than half the entries are
-	     * tombstones. Just dump the whole table.
-	     */
-	    clear_table (cache);
-	}
+    if (--cache->freeze_count != 0)
+	return;
 
-	while (cache->n_glyphs > N_GLYPHS_LOW_WATER)
+    if (cache->size > BUDGET)
+    {
+	while (cache->size > LOW_WATER)
 	{
 	    glyph_t *glyph = CONTAINER_OF (glyph_t, mru_link, cache->mru.tail);
 
@@ -238,6 +298,16 @@ pixman_glyph_cache_thaw (pixman_glyph_cache_t  *cache)
 	    free_glyph (glyph);
 	}
     }
+
+    /* Shrink the table after a big eviction, and get rid of the
+     * tombstones once they slow down the lookups.
+     */
+    if ((cache->hash_mask + 1 > MIN_HASH_SIZE &&
+	 (unsigned int)cache->n_glyphs * 8 < cache->hash_mask + 1) ||
+	(unsigned int)cache->n_tombstones * 4 > cache->hash_mask + 1)
+    {
+	resize_table (cache, cache->n_glyphs);
+    }
 }
 
 PIXMAN_EXPORT const void *
@@ -245,7 +315,12 @@ pixman_glyph_cache_lookup (pixman_glyph_cache_t  *cache,
 			   void                  *font_key,
 			   void                  *glyph_key)
 {
-    return lookup_glyph (cache, font_key, glyph_key);
+    glyph_t *glyph = lookup_glyph (cache, font_key, glyph_key);
+
+    if (glyph)
+	pixman_list_move_to_front (&cache->mru, &glyph->mru_link);
+
+    return glyph;
 }
 
 PIXMAN_EXPORT const void *
@@ -265,8 +340,13 @@ pixman_glyph_cache_insert (pixman_glyph_cache_t  *cache,
     width = image->bits.width;
     height = image->bits.height;
 
-    if (cache->n_glyphs >= HASH_SIZE)
-	return NULL;
+    /* Keep the table at most half full */
+    if ((unsigned int)(cache->n_glyphs + cache->n_tombstones + 1) * 2 >
+	cache->hash_mask + 1)
+    {
+	if (!resize_table (cache, cache->n_glyphs + 1))
+	    return NULL;
+    }
 
     if (!(glyph = malloc (sizeof *glyph)))
 	return NULL;
@@ -283,6 +363,9 @@ pixman_glyph_cache_insert (pixman_glyph_cache_t  *cache,
 	return NULL;
     }
 
+    glyph->size = sizeof (glyph_t) +
+	(size_t)glyph->image->bits.rowstride * 4 * height;
+
     pixman_image_composite32 (PIXMAN_OP_SRC,
 			      image, NULL, glyph->image, 0, 0, 0, 0, 0, 0,
 			      width, height);
@@ -391,6 +474,138 @@ box32_intersect (pixman_box32_t *dest,
     return dest->x2 > dest->x1 && dest->y2 > dest->y1;
 }
 
+#define DIRECT_GLYPH_FLAGS						\
+    (FAST_PATH_NO_ACCESSORS | FAST_PATH_NO_ALPHA_MAP | FAST_PATH_UNIFIED_ALPHA)
+
+/* The common text case, a solid color through a8 glyphs OVER an 8888
+ * destination, is blended straight into the destination.  The result is
+ * the same as that of the fast_composite_over_n_8_8888() fast paths: each
+ * pixel becomes (src IN m) OVER dest, which leaves it alone where m is 0.
+ */
+static pixman_bool_t
+blend_directly (pixman_op_t op, pixman_image_t *src, pixman_image_t *dest)
+{
+    pixman_format_code_t format = dest->common.extended_format_code;
+
+    return op == PIXMAN_OP_OVER						&&
+	src->common.extended_format_code == PIXMAN_solid		&&
+	(src->common.flags & SOURCE_FLAGS (solid)) == SOURCE_FLAGS (solid) &&
+	(dest->common.flags & FAST_PATH_STD_DEST_FLAGS) ==
+	    FAST_PATH_STD_DEST_FLAGS					&&
+	(format == PIXMAN_a8r8g8b8 || format == PIXMAN_x8r8g8b8 ||
+	 format == PIXMAN_a8b8g8r8 || format == PIXMAN_x8b8g8r8);
+}
+
+#ifdef GLYPH_USE_SSE2
+
+/* (a * b) / 255, rounded, in each 16 bit lane */
+static force_inline __m128i
+mul_un8_sse2 (__m128i a, __m128i b)
+{
+    __m128i t = _mm_adds_epu16 (_mm_mullo_epi16 (a, b), _mm_set1_epi16 (0x80));
+
+    return _mm_mulhi_epu16 (t, _mm_set1_epi16 (0x101));
+}
+
+/* (src IN m) OVER dest for two pixels unpacked to 16 bit channels, with
+ * each pixel's mask value repeated over its four lanes.
+ */
+static force_inline __m128i
+in_over_sse2 (__m128i src, __m128i m, __m128i dest)
+{
+    __m128i s = mul_un8_sse2 (src, m);
+    __m128i ia;
+
+    ia = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (s, _MM_SHUFFLE (3, 3, 3, 3)),
+			      _MM_SHUFFLE (3, 3, 3, 3));
+    ia = _mm_xor_si128 (ia, _mm_set1_epi16 (0xff));
+
+    return _mm_adds_epu8 (mul_un8_sse2 (dest, ia), s);
+}
+
+#endif
+
+static void
+blend_glyph_over_n_8_8888 (uint32_t       src,
+			   uint32_t      *dest,
+			   int            dest_stride,
+			   const uint8_t *mask,
+			   int            mask_stride,
+			   int            width,
+			   int            height)
+{
+#ifdef GLYPH_USE_SSE2
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i xsrc4 = _mm_set1_epi32 (src);
+    __m128i xsrc = _mm_unpacklo_epi8 (xsrc4, zero);
+#endif
+    uint32_t srca = src >> 24;
+
+    while (height--)
+    {
+	uint32_t *d = dest;
+	const uint8_t *m = mask;
+	int w = width;
+
+	dest += dest_stride;
+	mask += mask_stride;
+
+#ifdef GLYPH_USE_SSE2
+	while (w >= 4)
+	{
+	    uint32_t m4;
+
+	    memcpy (&m4, m, sizeof (m4));
+
+	    if (m4 == 0xffffffff && srca == 0xff)
+	    {
+		_mm_storeu_si128 ((__m128i *)d, xsrc4);
+	    }
+	    else if (m4)
+	    {
+		__m128i xd = _mm_loadu_si128 ((__m128i *)d);
+		__m128i xm = _mm_unpacklo_epi8 (_mm_cvtsi32_si128 (m4), zero);
+		__m128i lo, hi;
+
+		xm = _mm_unpacklo_epi16 (xm, xm);
+
+		lo = in_over_sse2 (xsrc, _mm_unpacklo_epi32 (xm, xm),
+				   _mm_unpacklo_epi8 (xd, zero));
+		hi = in_over_sse2 (xsrc, _mm_unpackhi_epi32 (xm, xm),
+				   _mm_unpackhi_epi8 (xd, zero));
+
+		_mm_storeu_si128 ((__m128i *)d, _mm_packus_epi16 (lo, hi));
+	    }
+
+	    d += 4;
+	    m += 4;
+	    w -= 4;
+	}
+#endif
+
+	while (w--)
+	{
+	    uint32_t ma = *m++;
+
+	    if (ma == 0xff && srca == 0xff)
+	    {
+		*d = src;
+	    }
+	    else if (ma)
+	    {
+		uint32_t s = src;
+		uint32_t dd = *d;
+
+		UN8x4_MUL_UN8 (s, ma);
+		UN8x4_MUL_UN8_ADD_UN8x4 (dd, ~s >> 24, s);
+		*d = dd;
+	    }
+
+	    d++;
+	}
+    }
+}
+
 #if defined(__GNUC__) && !defined(__x86_64__) && !defined(__amd64__)
 __attribute__((__force_align_arg_pointer__))
 #endif
@@ -414,6 +629,8 @@ pixman_composite_glyphs_no_mask (pixman_op_t            op,
     pixman_composite_func_t func = NULL;
     pixman_implementation_t *implementation = NULL;
     pixman_composite_info_t info;
+    pixman_bool_t direct;
+    uint32_t solid = 0;
     int i;
 
     _pixman_image_validate (src);
@@ -421,6 +638,9 @@ pixman_composite_glyphs_no_mask (pixman_op_t            op,
     
     dest_format = dest->common.extended_format_code;
     dest_flags = dest->common.flags;
+
+    if ((direct = blend_directly (op, src, dest)))
+	solid = _pixman_image_get_solid (get_implementation (), src, dest_format);
     
     pixman_region32_init (&region);
     if (!_pixman_compute_composite_region32 (
@@ -457,40 +677,69 @@ pixman_composite_glyphs_no_mask (pixman_op_t            op,
 	
 	info.mask_image = glyph_img;
 
-	while (n--)
+	if (direct && glyph_img->common.extended_format_code == PIXMAN_a8 &&
+	    (glyph_img->common.flags & DIRECT_GLYPH_FLAGS) == DIRECT_GLYPH_FLAGS)
 	{
-	    if (box32_intersect (&composite_box, pbox, &glyph_box))
+	    int stride = glyph_img->bits.rowstride;
+
+	    while (solid && n--)
 	    {
-		if (glyph_img->common.extended_format_code != glyph_format	||
-		    glyph_img->common.flags != glyph_flags)
+		if (box32_intersect (&composite_box, pbox, &glyph_box))
 		{
-		    glyph_format = glyph_img->common.extended_format_code;
-		    glyph_flags = glyph_img->common.flags;
-
-		    _pixman_implementation_lookup_composite (
-			get_implementation(), op,
-			src->common.extended_format_code, src->common.flags,
-			glyph_format, glyph_flags | extra,
-			dest_format, dest_flags,
-			&implementation, &func);
+		    blend_glyph_over_n_8_8888 (
+			solid,
+			dest->bits.bits + composite_box.y1 * dest->bits.rowstride +
+			composite_box.x1,
+			dest->bits.rowstride,
+			(uint8_t *)(glyph_img->bits.bits +
+				    (composite_box.y1 - glyph_box.y1) * stride) +
+			composite_box.x1 - glyph_box.x1,
+			stride * 4,
+			composite_box.x2 - composite_box.x1,
+			composite_box.y2 - composite_box.y1);
 		}
 
-		info.src_x = src_x + composite_box.x1 - dest_x;
-		info.src_y = src_y + composite_box.y1 - dest_y;
-		info.mask_x = composite_box.x1 - (dest_x + glyphs[i].x - glyph->origin_x);
-		info.mask_y = composite_box.y1 - (dest_y + glyphs[i].y - glyph->origin_y);
-		info.dest_x = composite_box.x1;
-		info.dest_y = composite_box.y1;
-		info.width = composite_box.x2 - composite_box.x1;
-		info.height = composite_box.y2 - composite_box.y1;
-
-		info.mask_flags = glyph_flags;
-
-		func (implementation, &info);
+		pbox++;
 	    }
+	}
+	else
+	{
+	    while (n--)
+	    {
+		if (box32_intersect (&composite_box, pbox, &glyph_box))
+		{
+		    if (glyph_img->common.extended_format_code != glyph_format ||
+			glyph_img->common.flags != glyph_flags)
+		    {
+			glyph_format = glyph_img->common.extended_format_code;
+			glyph_flags = glyph_img->common.flags;
+
+			_pixman_implementation_lookup_composite (
+			    get_implementation(), op,
+			    src->common.extended_format_code, src->common.flags,
+			    glyph_format, glyph_flags | extra,
+			    dest_format, dest_flags,
+			    &implementation, &func);
+		    }
+
+		    info.src_x = src_x + composite_box.x1 - dest_x;
+		    info.src_y = src_y + composite_box.y1 - dest_y;
+		    info.mask_x = composite_box.x1 - glyph_box.x1;
+		    info.mask_y = composite_box.y1 - glyph_box.y1;
+		    info.dest_x = composite_box.x1;
+		    info.dest_y = composite_box.y1;
+		    info.width = composite_box.x2 - composite_box.x1;
+		    info.height = composite_box.y2 - composite_box.y1;
+
+		    info.mask_flags = glyph_flags;
+
+		    func (implementation, &info);
+		}
 
-	    pbox++;
+		pbox++;
+	    }
 	}
+
 	pixman_list_move_to_front (&cache->mru, &glyph->mru_link);
     }
 
@@ -617,6 +866,34 @@ out:
 	pixman_image_unref (white_img);
 }
 
+/* Operators for which a transparent source leaves the destination
+ * alone, so that only the pixels covered by glyphs need compositing.
+ */
+static pixman_bool_t
+op_ignores_transparent_source (pixman_op_t op)
+{
+    switch (op)
+    {
+    case PIXMAN_OP_DST:
+    case PIXMAN_OP_OVER:
+    case PIXMAN_OP_OVER_REVERSE:
+    case PIXMAN_OP_OUT_REVERSE:
+    case PIXMAN_OP_ATOP:
+    case PIXMAN_OP_XOR:
+    case PIXMAN_OP_ADD:
+    case PIXMAN_OP_SATURATE:
+	return TRUE;
+
+    default:
+	return FALSE;
+    }
+}
+
+/* Beyond this many boxes, compositing the whole extents of the glyphs
+ * at once is cheaper than going box by box.
+ */
+#define MAX_GLYPH_RUNS	16
+
 /* Conceptually, for each glyph, (white IN glyph) is PIXMAN_OP_ADDed to an
  * infinitely big mask image at the position such that the glyph origin point
  * is positioned at the (glyphs[i].x, glyphs[i].y) point.
@@ -629,9 +906,12 @@ out:
  *
  * rectangle.
  *
+ * When the operator ignores a transparent source and the mask format has
+ * an alpha channel, the mask only covers the glyphs, and only the runs of
+ * pixels under them are composited.
+ *
  * TODO:
  *   - Trim the mask to the destination clip/image?
- *   - Trim composite region based on sources, when the op ignores 0s.
  */
 #if defined(__GNUC__) && !defined(__x86_64__) && !defined(__amd64__)
 __attribute__((__force_align_arg_pointer__))
@@ -653,24 +933,102 @@ pixman_composite_glyphs (pixman_op_t            op,
 			 int			n_glyphs,
 			 const pixman_glyph_t  *glyphs)
 {
+    pixman_box32_t stack_boxes[64];
+    pixman_box32_t *boxes = stack_boxes;
+    pixman_region32_t region;
+    pixman_box32_t whole, extents;
+    const pixman_box32_t *runs;
     pixman_image_t *mask;
+    int i, n_boxes, n_runs;
 
-    if (!(mask = pixman_image_create_bits (mask_format, width, height, NULL, -1)))
+    if (width <= 0 || height <= 0)
 	return;
 
+    whole.x1 = 0;
+    whole.y1 = 0;
+    whole.x2 = width;
+    whole.y2 = height;
+
+    pixman_region32_init (&region);
+
+    /* Without an alpha channel, the mask is opaque outside the glyphs */
+    if (PIXMAN_FORMAT_A (mask_format) != 0 && op_ignores_transparent_source (op))
+    {
+	if (n_glyphs > (int)(sizeof (stack_boxes) / sizeof (stack_boxes[0])))
+	{
+	    boxes = pixman_malloc_ab (n_glyphs, sizeof (pixman_box32_t));
+	    if (!boxes)
+		return;
+	}
+
+	/* The glyph boxes in mask space, clipped to the composite */
+	for (i = 0, n_boxes = 0; i < n_glyphs; ++i)
+	{
+	    const glyph_t *glyph = glyphs[i].glyph;
+	    pixman_box32_t *box = &boxes[n_boxes];
+
+	    box->x1 = MAX (glyphs[i].x - glyph->origin_x - mask_x, 0);
+	    box->y1 = MAX (glyphs[i].y - glyph->origin_y - mask_y, 0);
+	    box->x2 = MIN (glyphs[i].x - glyph->origin_x - mask_x +
+			   glyph->image->bits.width, width);
+	    box->y2 = MIN (glyphs[i].y - glyph->origin_y - mask_y +
+			   glyph->image->bits.height, height);
+
+	    if (box->x1 < box->x2 && box->y1 < box->y2)
+		n_boxes++;
+	}
+
+	pixman_region32_fini (&region);
+	if (!pixman_region32_init_rects (&region, boxes, n_boxes))
+	    pixman_region32_reset (&region, &whole);
+
+	if (boxes != stack_boxes)
+	    free (boxes);
+    }
+    else
+    {
+	pixman_region32_reset (&region, &whole);
+    }
+
+    if (!pixman_region32_not_empty (&region))
+	goto out;
+
+    extents = *pixman_region32_extents (&region);
+
+    if (!(mask = pixman_image_create_bits (
+	      mask_format, extents.x2 - extents.x1, extents.y2 - extents.y1,
+	      NULL, -1)))
+    {
+	goto out;
+    }
+
     if (PIXMAN_FORMAT_A   (mask_format) != 0 &&
 	PIXMAN_FORMAT_RGB (mask_format) != 0)
     {
 	pixman_image_set_component_alpha (mask, TRUE);
     }
 
-    add_glyphs (cache, mask, - mask_x, - mask_y, n_glyphs, glyphs);
+    add_glyphs (cache, mask, - mask_x - extents.x1, - mask_y - extents.y1,
+		n_glyphs, glyphs);
 
-    pixman_image_composite32 (op, src, mask, dest,
-			      src_x, src_y,
-			      0, 0,
-			      dest_x, dest_y,
-			      width, height);
+    runs = pixman_region32_rectangles (&region, &n_runs);
+    if (n_runs > MAX_GLYPH_RUNS)
+    {
+	runs = &extents;
+	n_runs = 1;
+    }
+
+    for (i = 0; i < n_runs; ++i)
+    {
+	pixman_image_composite32 (op, src, mask, dest,
+				  src_x + runs[i].x1, src_y + runs[i].y1,
+				  runs[i].x1 - extents.x1, runs[i].y1 - extents.y1,
+				  dest_x + runs[i].x1, dest_y + runs[i].y1,
+				  runs[i].x2 - runs[i].x1, runs[i].y2 - runs[i].y1);
+    }
 
     pixman_image_unref (mask);
+
+out:
+    pixman_region32_fini (&region);
 }
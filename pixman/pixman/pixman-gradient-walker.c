@@ -26,8 +26,15 @@
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#include <stdlib.h>
 #include "pixman-private.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GRADIENT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 void
 _pixman_gradient_walker_init (pixman_gradient_walker_t *walker,
                               gradient_t *              gradient,
@@ -200,3 +207,228 @@ _pixman_gradient_walker_pixel (pixman_gradient_walker_t *walker,
 
     return v;
 }
+
+/*
+ * Color ramps
+ *
+ * The ramp holds GRADIENT_RAMP_SIZE colors sampled at the centers of
+ * equal intervals of [0, 1), followed by the colors used before the
+ * start and after the end of the gradient with PIXMAN_REPEAT_PAD and
+ * PIXMAN_REPEAT_NONE, and by transparent black for invalid positions.
+ */
+#define RAMP_BEFORE	(GRADIENT_RAMP_SIZE)
+#define RAMP_AFTER	(GRADIENT_RAMP_SIZE + 1)
+#define RAMP_INVALID	(GRADIENT_RAMP_SIZE + 2)
+#define RAMP_LENGTH	(GRADIENT_RAMP_SIZE + 3)
+
+/* Scaled positions are clamped to this before being converted to
+ * integers. Beyond it a float has no fractional bits left anyway.
+ */
+#define RAMP_LIMIT	1073741824.0f
+
+pixman_bool_t
+_pixman_gradient_update_ramp (gradient_t *gradient)
+{
+    pixman_gradient_walker_t walker;
+    pixman_repeat_t repeat = gradient->common.repeat;
+    uint32_t *ramp = gradient->ramp;
+    int i;
+
+    /* The stops of a gradient never change, so the ramp only has to be
+     * rebuilt when the repeat mode does.
+     */
+    if (ramp && gradient->ramp_repeat == repeat)
+	return TRUE;
+
+    if (!ramp)
+    {
+	ramp = malloc (RAMP_LENGTH * sizeof (uint32_t));
+	if (!ramp)
+	    return FALSE;
+
+	gradient->ramp = ramp;
+    }
+
+    _pixman_gradient_walker_init (&walker, gradient, repeat);
+
+    for (i = 0; i < GRADIENT_RAMP_SIZE; ++i)
+    {
+	pixman_fixed_48_16_t x =
+	    ((pixman_fixed_48_16_t)(2 * i + 1) * pixman_fixed_1) >>
+	    (GRADIENT_RAMP_BITS + 1);
+
+	ramp[i] = _pixman_gradient_walker_pixel (&walker, x);
+    }
+
+    ramp[RAMP_BEFORE] = _pixman_gradient_walker_pixel (&walker, -pixman_fixed_1);
+    ramp[RAMP_AFTER] = _pixman_gradient_walker_pixel (&walker, 2 * pixman_fixed_1);
+    ramp[RAMP_INVALID] = 0;
+
+    gradient->ramp_repeat = repeat;
+
+    return TRUE;
+}
+
+static force_inline int
+ramp_index (float pos, pixman_repeat_t repeat)
+{
+    float s = pos * GRADIENT_RAMP_SIZE;
+    int i;
+
+    if (s != s)
+	return RAMP_INVALID;
+
+    if (s < -RAMP_LIMIT)
+	s = -RAMP_LIMIT;
+    else if (s > RAMP_LIMIT)
+	s = RAMP_LIMIT;
+
+    i = (int)s;
+    if (s < i)
+	i--;
+
+    switch (repeat)
+    {
+    case PIXMAN_REPEAT_NORMAL:
+	return i & (GRADIENT_RAMP_SIZE - 1);
+
+    case PIXMAN_REPEAT_REFLECT:
+	/* For i in [SIZE, 2 * SIZE), 2 * SIZE - 1 - i == i ^ (2 * SIZE - 1) */
+	i &= 2 * GRADIENT_RAMP_SIZE - 1;
+	if (i >= GRADIENT_RAMP_SIZE)
+	    i ^= 2 * GRADIENT_RAMP_SIZE - 1;
+	return i;
+
+    default:
+	if (i < 0)
+	    return RAMP_BEFORE;
+	else if (i >= GRADIENT_RAMP_SIZE)
+	    return RAMP_AFTER;
+	return i;
+    }
+}
+
+#ifdef GRADIENT_USE_SSE2
+
+static force_inline __m128i
+select_epi32 (__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128 (_mm_and_si128 (mask, a), _mm_andnot_si128 (mask, b));
+}
+
+/* Four at a time version of ramp_index() */
+static force_inline __m128i
+ramp_index_sse2 (__m128 pos, pixman_repeat_t repeat)
+{
+    const __m128i size_1 = _mm_set1_epi32 (GRADIENT_RAMP_SIZE - 1);
+    __m128 s = _mm_mul_ps (pos, _mm_set1_ps (GRADIENT_RAMP_SIZE));
+    __m128 nan = _mm_cmpunord_ps (s, s);
+    __m128i i;
+
+    /* Zero the NaNs before anything but the unordered compare sees
+     * them: max, min and the ordered compares raise the invalid
+     * exception on a NaN, which applications may have unmasked.
+     */
+    s = _mm_andnot_ps (nan, s);
+    s = _mm_max_ps (s, _mm_set1_ps (-RAMP_LIMIT));
+    s = _mm_min_ps (s, _mm_set1_ps (RAMP_LIMIT));
+
+    /* Truncate, then step down where that rounded up */
+    i = _mm_cvttps_epi32 (s);
+    i = _mm_add_epi32 (
+	i, _mm_castps_si128 (_mm_cmplt_ps (s, _mm_cvtepi32_ps (i))));
+
+    switch (repeat)
+    {
+    case PIXMAN_REPEAT_NORMAL:
+	i = _mm_and_si128 (i, size_1);
+	break;
+
+    case PIXMAN_REPEAT_REFLECT:
+    {
+	const __m128i period_1 = _mm_set1_epi32 (2 * GRADIENT_RAMP_SIZE - 1);
+
+	i = _mm_and_si128 (i, period_1);
+	i = _mm_xor_si128 (
+	    i, _mm_and_si128 (_mm_cmpgt_epi32 (i, size_1), period_1));
+	break;
+    }
+
+    default:
+	i = select_epi32 (_mm_cmpgt_epi32 (i, size_1),
+			  _mm_set1_epi32 (RAMP_AFTER), i);
+	i = select_epi32 (_mm_cmplt_epi32 (i, _mm_setzero_si128 ()),
+			  _mm_set1_epi32 (RAMP_BEFORE), i);
+	break;
+    }
+
+    return select_epi32 (_mm_castps_si128 (nan),
+			 _mm_set1_epi32 (RAMP_INVALID), i);
+}
+
+static force_inline void
+ramp_store4_sse2 (const uint32_t *ramp,
+		  pixman_repeat_t repeat,
+		  uint32_t       *buffer,
+		  __m128          pos)
+{
+    int32_t idx[4];
+
+    _mm_storeu_si128 ((__m128i *)idx, ramp_index_sse2 (pos, repeat));
+
+    buffer[0] = ramp[idx[0]];
+    buffer[1] = ramp[idx[1]];
+    buffer[2] = ramp[idx[2]];
+    buffer[3] = ramp[idx[3]];
+}
+
+#endif
+
+void
+_pixman_gradient_ramp_fetch (const gradient_t *gradient,
+			     uint32_t         *buffer,
+			     const float      *pos,
+			     int               width)
+{
+    const uint32_t *ramp = gradient->ramp;
+    pixman_repeat_t repeat = gradient->ramp_repeat;
+    int i = 0;
+
+#ifdef GRADIENT_USE_SSE2
+    for (; i + 4 <= width; i += 4)
+	ramp_store4_sse2 (ramp, repeat, buffer + i, _mm_loadu_ps (pos + i));
+#endif
+
+    for (; i < width; ++i)
+	buffer[i] = ramp[ramp_index (pos[i], repeat)];
+}
+
+void
+_pixman_gradient_ramp_fetch_linear (const gradient_t *gradient,
+				    uint32_t         *buffer,
+				    int               width,
+				    float             pos,
+				    float             inc)
+{
+    const uint32_t *ramp = gradient->ramp;
+    pixman_repeat_t repeat = gradient->ramp_repeat;
+    int i = 0;
+
+#ifdef GRADIENT_USE_SSE2
+    {
+	__m128 p = _mm_set1_ps (pos);
+	__m128 vinc = _mm_set1_ps (inc);
+	__m128 k = _mm_setr_ps (0.f, 1.f, 2.f, 3.f);
+
+	for (; i + 4 <= width; i += 4)
+	{
+	    ramp_store4_sse2 (ramp, repeat, buffer + i,
+			      _mm_add_ps (p, _mm_mul_ps (k, vinc)));
+	    k = _mm_add_ps (k, _mm_set1_ps (4.f));
+	}
+    }
+#endif
+
+    for (; i < width; ++i)
+	buffer[i] = ramp[ramp_index (pos + (float)i * inc, repeat)];
+}
@@ -73,6 +73,10 @@ gradient_property_changed (pixman_image_t *image)
 	end->color = stops[n - 1].color;
 	break;
     }
+
+    /* If that fails the gradient is simply evaluated exactly */
+    if (gradient->common.filter != PIXMAN_FILTER_BEST)
+	_pixman_gradient_update_ramp (gradient);
 }
 
 pixman_bool_t
@@ -100,6 +104,7 @@ _pixman_init_gradient (gradient_t *                  gradient,
     gradient->stops += 1;
     memcpy (gradient->stops, stops, n_stops * sizeof (pixman_gradient_stop_t));
     gradient->n_stops = n_stops;
+    gradient->ramp = NULL;
 
     gradient->common.property_changed = gradient_property_changed;
 
@@ -161,6 +166,8 @@ _pixman_image_fini (pixman_image_t *image)
 		free (image->gradient.stops - 1);
 	    }
 
+	    free (image->gradient.ramp);
+
 	    /* This will trigger if someone adds a property_changed
 	     * method to the linear/radial/conical gradient overwriting
 	     * the general one.
@@ -291,6 +291,100 @@ get_scanline_null (pixman_iter_t *iter, const uint32_t *mask)
     return NULL;
 }
 
+/* The iterators found for the last few combinations of format and flags,
+ * most recently used first, so that repeating a composite doesn't walk
+ * the iterator tables of every implementation again.
+ */
+#define N_CACHED_ITERS 8
+
+typedef struct
+{
+    struct
+    {
+	pixman_implementation_t *	imp;
+	pixman_format_code_t		format;
+	iter_flags_t			iter_flags;
+	uint32_t			image_flags;
+	const pixman_iter_info_t *	info;
+    } cache [N_CACHED_ITERS];
+} iter_cache_t;
+
+PIXMAN_DEFINE_THREAD_LOCAL (iter_cache_t, iter_cache);
+
+static const pixman_iter_info_t *
+lookup_iter_info (pixman_implementation_t *toplevel,
+		  pixman_format_code_t     format,
+		  iter_flags_t             iter_flags,
+		  uint32_t                 image_flags)
+{
+    const pixman_iter_info_t *info = NULL;
+    pixman_implementation_t *imp;
+    iter_cache_t *cache;
+    int i;
+
+    cache = PIXMAN_GET_THREAD_LOCAL (iter_cache);
+
+    if (cache)
+    {
+	for (i = 0; i < N_CACHED_ITERS; ++i)
+	{
+	    if (cache->cache[i].imp == toplevel		&&
+		cache->cache[i].format == format		&&
+		cache->cache[i].iter_flags == iter_flags	&&
+		cache->cache[i].image_flags == image_flags	&&
+		cache->cache[i].info)
+	    {
+		info = cache->cache[i].info;
+		goto update_cache;
+	    }
+	}
+    }
+
+    for (imp = toplevel; imp != NULL && !info; imp = imp->fallback)
+    {
+	const pixman_iter_info_t *candidate;
+
+	if (!imp->iter_info)
+	    continue;
+
+	for (candidate = imp->iter_info;
+	     candidate->format != PIXMAN_null;
+	     ++candidate)
+	{
+	    if ((candidate->format == PIXMAN_any ||
+		 candidate->format == format)				&&
+		(candidate->image_flags & image_flags) ==
+		candidate->image_flags					&&
+		(candidate->iter_flags & iter_flags) ==
+		candidate->iter_flags)
+	    {
+		info = candidate;
+		break;
+	    }
+	}
+    }
+
+    if (!info || !cache)
+	return info;
+
+    /* Set i to the last spot in the cache so that the move-to-front
+     * code below will work
+     */
+    i = N_CACHED_ITERS - 1;
+
+update_cache:
+    while (i--)
+	cache->cache[i + 1] = cache->cache[i];
+
+    cache->cache[0].imp = toplevel;
+    cache->cache[0].format = format;
+    cache->cache[0].iter_flags = iter_flags;
+    cache->cache[0].image_flags = image_flags;
+    cache->cache[0].info = info;
+
+    return info;
+}
+
 void
 _pixman_implementation_iter_init (pixman_implementation_t *imp,
                                   pixman_iter_t           *iter,
@@ -303,7 +397,7 @@ _pixman_implementation_iter_init (pixman_implementation_t *imp,
                                   iter_flags_t             iter_flags,
                                   uint32_t                 image_flags)
 {
-    pixman_format_code_t format;
+    const pixman_iter_info_t *info;
 
     iter->image = image;
     iter->buffer = (uint32_t *)buffer;
@@ -321,31 +415,15 @@ _pixman_implementation_iter_init (pixman_implementation_t *imp,
 	return;
     }
 
-    format = iter->image->common.extended_format_code;
-
-    while (imp)
+    info = lookup_iter_info (imp, iter->image->common.extended_format_code,
+			     iter_flags, image_flags);
+    if (info)
     {
-        if (imp->iter_info)
-        {
-            const pixman_iter_info_t *info;
-
-            for (info = imp->iter_info; info->format != PIXMAN_null; ++info)
-            {
-                if ((info->format == PIXMAN_any || info->format == format) &&
-                    (info->image_flags & image_flags) == info->image_flags &&
-                    (info->iter_flags & iter_flags) == info->iter_flags)
-                {
-                    iter->get_scanline = info->get_scanline;
-                    iter->write_back = info->write_back;
-
-                    if (info->initializer)
-                        info->initializer (iter, info);
-                    return;
-                }
-            }
-        }
-
-        imp = imp->fallback;
+	iter->get_scanline = info->get_scanline;
+	iter->write_back = info->write_back;
+
+	if (info->initializer)
+	    info->initializer (iter, info);
     }
 }
 
@@ -166,6 +166,12 @@ linear_get_scanline_narrow (pixman_iter_t  *iter,
 	    while (buffer < end)
 		*buffer++ = color;
 	}
+	else if (_pixman_gradient_use_ramp (gradient))
+	{
+	    _pixman_gradient_ramp_fetch_linear (
+		gradient, buffer, width,
+		t * (1. / pixman_fixed_1), inc * (1. / pixman_fixed_1));
+	}
 	else
 	{
 	    int i;
@@ -133,6 +133,10 @@ struct gradient
     image_common_t	    common;
     int                     n_stops;
     pixman_gradient_stop_t *stops;
+
+    /* Color ramp used unless the filter is PIXMAN_FILTER_BEST */
+    uint32_t *		    ramp;
+    pixman_repeat_t	    ramp_repeat;
 };
 
 struct linear_gradient
@@ -367,6 +371,44 @@ uint32_t
 _pixman_gradient_walker_pixel (pixman_gradient_walker_t *walker,
                                pixman_fixed_48_16_t      x);
 
+/*
+ * Gradient color ramps
+ *
+ * The colors of a gradient are looked up in a table of
+ * GRADIENT_RAMP_SIZE premultiplied colors sampled across one period of
+ * the gradient, instead of being evaluated from the stops for every
+ * pixel. PIXMAN_FILTER_BEST asks for the exact evaluation instead, as
+ * does a gradient whose table couldn't be allocated.
+ *
+ * Positions passed to the fetch functions are in units of the gradient,
+ * so 1.0 corresponds to pixman_fixed_1 in the gradient walker. A NaN
+ * position produces transparent black.
+ */
+#define GRADIENT_RAMP_BITS	10
+#define GRADIENT_RAMP_SIZE	(1 << GRADIENT_RAMP_BITS)
+
+pixman_bool_t
+_pixman_gradient_update_ramp (gradient_t *gradient);
+
+void
+_pixman_gradient_ramp_fetch (const gradient_t *gradient,
+			     uint32_t         *buffer,
+			     const float      *pos,
+			     int               width);
+
+void
+_pixman_gradient_ramp_fetch_linear (const gradient_t *gradient,
+				    uint32_t         *buffer,
+				    int               width,
+				    float             pos,
+				    float             inc);
+
+static force_inline pixman_bool_t
+_pixman_gradient_use_ramp (const gradient_t *gradient)
+{
+    return gradient->common.filter != PIXMAN_FILTER_BEST && gradient->ramp;
+}
+
 /*
  * Edges
  */
@@ -391,6 +433,34 @@ _pixman_gradient_walker_pixel (pixman_gradient_walker_t *walker,
     ((n) == 1? 0 : (pixman_fixed_frac (x) +				\
 		    X_FRAC_FIRST (n)) / STEP_X_SMALL (n))
 
+/*
+ * Step across a small sample grid gap
+ */
+#define RENDER_EDGE_STEP_SMALL(edge)					\
+    {									\
+	edge->x += edge->stepx_small;					\
+	edge->e += edge->dx_small;					\
+	if (edge->e > 0)						\
+	{								\
+	    edge->e -= edge->dy;					\
+	    edge->x += edge->signdx;					\
+	}								\
+    }
+
+/*
+ * Step across a large sample grid gap
+ */
+#define RENDER_EDGE_STEP_BIG(edge)					\
+    {									\
+	edge->x += edge->stepx_big;					\
+	edge->e += edge->dx_big;					\
+	if (edge->e > 0)						\
+	{								\
+	    edge->e -= edge->dy;					\
+	    edge->x += edge->signdx;					\
+	}								\
+    }
+
 void
 pixman_rasterize_edges_accessors (pixman_image_t *image,
                                   pixman_edge_t * l,
@@ -590,6 +660,9 @@ _pixman_implementation_create_mmx (pixman_implementation_t *fallback);
 #ifdef USE_SSE2
 pixman_implementation_t *
 _pixman_implementation_create_sse2 (pixman_implementation_t *fallback);
+
+pixman_implementation_t *
+_pixman_implementation_create_sse2_float (pixman_implementation_t *fallback);
 #endif
 
 #ifdef USE_SSSE3
@@ -597,6 +670,11 @@ pixman_implementation_t *
 _pixman_implementation_create_ssse3 (pixman_implementation_t *fallback);
 #endif
 
+#ifdef USE_AVX2
+pixman_implementation_t *
+_pixman_implementation_create_avx2 (pixman_implementation_t *fallback);
+#endif
+
 #ifdef USE_ARM_SIMD
 pixman_implementation_t *
 _pixman_implementation_create_arm_simd (pixman_implementation_t *fallback);
@@ -639,6 +717,37 @@ pixman_bool_t
 _pixman_disabled (const char *name);
 
 
+/* Runs func over boxes on the worker threads. Returns FALSE, having
+ * done nothing, when the composite should run on the calling thread.
+ */
+pixman_bool_t
+_pixman_composite_parallel (pixman_implementation_t *      imp,
+			    pixman_composite_func_t        func,
+			    const pixman_composite_info_t *info,
+			    const pixman_box32_t *         boxes,
+			    int                            n_boxes,
+			    int32_t                        src_dx,
+			    int32_t                        src_dy,
+			    int32_t                        mask_dx,
+			    int32_t                        mask_dy);
+
+/* Composite profiling, see pixman-profile.c */
+pixman_bool_t
+_pixman_profiling (void);
+
+uint64_t
+_pixman_profile_stamp (void);
+
+void
+_pixman_profile_record (pixman_implementation_t *      imp,
+			pixman_composite_func_t        func,
+			const pixman_composite_info_t *info,
+			pixman_format_code_t           src_format,
+			pixman_format_code_t           mask_format,
+			pixman_format_code_t           dest_format,
+			pixman_region32_t *            region,
+			uint64_t                       ticks);
+
 /*
  * Utilities
  */
@@ -794,6 +903,16 @@ pixman_malloc_abc (unsigned int a, unsigned int b, unsigned int c);
 void *
 pixman_malloc_ab_plus_c (unsigned int a, unsigned int b, unsigned int c);
 
+/* Scanline buffers for composites too wide for a stack buffer.  They
+ * come from a per thread pool and go back to it with
+ * _pixman_scanline_buffer_put().
+ */
+uint8_t *
+_pixman_scanline_buffer_get (size_t size);
+
+void
+_pixman_scanline_buffer_put (uint8_t *buffer);
+
 pixman_bool_t
 _pixman_multiply_overflows_size (size_t a, size_t b);
 
@@ -0,0 +1,555 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Composite profiling
+ *
+ * When PIXMAN_PROFILE is set in the environment, every call to
+ * pixman_image_composite32() is counted against the operator, formats
+ * and flags it was looked up with and the composite function that was
+ * found for them.  Composites that found no fast path and ended up in
+ * general_composite_rect() are marked as such, so the report shows
+ * which combinations are worth a new fast path.
+ *
+ * The report, sorted by time spent, is written to stderr at exit unless
+ * the application asks for it first with pixman_profile_report().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "pixman-private.h"
+
+#if defined(_WIN32)
+#   define _NO_W32_PSEUDO_MODIFIERS
+#   include <windows.h>
+#ifdef IN
+#undef IN
+#endif
+
+typedef SRWLOCK profile_lock_t;
+
+#   define PROFILE_LOCK_INITIALIZER	SRWLOCK_INIT
+#   define profile_lock(m)		AcquireSRWLockExclusive (m)
+#   define profile_unlock(m)		ReleaseSRWLockExclusive (m)
+
+#elif defined(HAVE_PTHREADS)
+#   include <pthread.h>
+
+typedef pthread_mutex_t profile_lock_t;
+
+#   define PROFILE_LOCK_INITIALIZER	PTHREAD_MUTEX_INITIALIZER
+#   define profile_lock(m)		pthread_mutex_lock (m)
+#   define profile_unlock(m)		pthread_mutex_unlock (m)
+
+#else
+
+typedef int profile_lock_t;
+
+#   define PROFILE_LOCK_INITIALIZER	0
+#   define profile_lock(m)
+#   define profile_unlock(m)
+
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#   include <intrin.h>
+#elif defined(HAVE_GETTIMEOFDAY)
+#   include <sys/time.h>
+#endif
+
+/* Distinct tuples that are kept apart; anything beyond that is
+ * counted in one "other" entry.
+ */
+#define N_ENTRIES	4096
+#define MAX_ENTRIES	(N_ENTRIES * 3 / 4)
+
+typedef struct
+{
+    pixman_op_t			op;
+    pixman_format_code_t	src_format;
+    uint32_t			src_flags;
+    pixman_format_code_t	mask_format;
+    uint32_t			mask_flags;
+    pixman_format_code_t	dest_format;
+    uint32_t			dest_flags;
+    pixman_composite_func_t	func;
+    pixman_bool_t		fallback;
+
+    uint64_t			hits;
+    uint64_t			pixels;
+    uint64_t			ticks;
+} entry_t;
+
+static profile_lock_t lock = PROFILE_LOCK_INITIALIZER;
+static int enabled = -1;
+static pixman_bool_t reported;
+static entry_t *entries;
+static entry_t other;
+static int n_entries;
+
+static void
+dump_profile (void)
+{
+    if (!reported)
+	pixman_profile_report (NULL, NULL);
+}
+
+pixman_bool_t
+_pixman_profiling (void)
+{
+    if (enabled < 0)
+    {
+	int e = getenv ("PIXMAN_PROFILE") != NULL;
+
+	profile_lock (&lock);
+	if (enabled < 0)
+	{
+	    if (e)
+	    {
+		entries = calloc (N_ENTRIES, sizeof (entry_t));
+		if (entries)
+		    atexit (dump_profile);
+		else
+		    e = 0;
+	    }
+
+	    enabled = e;
+	}
+	profile_unlock (&lock);
+    }
+
+    return enabled;
+}
+
+/* A time stamp in whatever unit is cheapest to read: cycles on x86,
+ * microseconds elsewhere.
+ */
+uint64_t
+_pixman_profile_stamp (void)
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    return __rdtsc ();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    uint32_t hi, lo;
+
+    __asm__ __volatile__ ("rdtsc\n" : "=a" (lo), "=d" (hi));
+
+    return lo | (((uint64_t)hi) << 32);
+#elif defined(HAVE_GETTIMEOFDAY)
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+
+    return tv.tv_sec * (uint64_t)1000000 + tv.tv_usec;
+#else
+    return 0;
+#endif
+}
+
+static uint32_t
+hash_entry (const entry_t *e)
+{
+    uint32_t h = e->op;
+
+    h = h * 31 + e->src_format;
+    h = h * 31 + e->src_flags;
+    h = h * 31 + e->mask_format;
+    h = h * 31 + e->mask_flags;
+    h = h * 31 + e->dest_format;
+    h = h * 31 + e->dest_flags;
+    h = h * 31 + (uint32_t)(uintptr_t)e->func;
+
+    return h ^ (h >> 16);
+}
+
+static pixman_bool_t
+same_entry (const entry_t *a, const entry_t *b)
+{
+    return a->op == b->op			&&
+	a->src_format == b->src_format		&&
+	a->src_flags == b->src_flags		&&
+	a->mask_format == b->mask_format	&&
+	a->mask_flags == b->mask_flags		&&
+	a->dest_format == b->dest_format	&&
+	a->dest_flags == b->dest_flags		&&
+	a->func == b->func;
+}
+
+void
+_pixman_profile_record (pixman_implementation_t *      imp,
+			pixman_composite_func_t        func,
+			const pixman_composite_info_t *info,
+			pixman_format_code_t           src_format,
+			pixman_format_code_t           mask_format,
+			pixman_format_code_t           dest_format,
+			pixman_region32_t *            region,
+			uint64_t                       ticks)
+{
+    const pixman_box32_t *box;
+    uint64_t pixels = 0;
+    entry_t key, *e;
+    uint32_t i;
+    int n;
+
+    box = pixman_region32_rectangles (region, &n);
+    while (n--)
+    {
+	pixels += (uint64_t)(box->x2 - box->x1) * (box->y2 - box->y1);
+	box++;
+    }
+
+    key.op = info->op;
+    key.src_format = src_format;
+    key.src_flags = info->src_flags;
+    key.mask_format = mask_format;
+    key.mask_flags = info->mask_flags;
+    key.dest_format = dest_format;
+    key.dest_flags = info->dest_flags;
+    key.func = func;
+
+    profile_lock (&lock);
+
+    /* Open addressing with linear probing.  Entries are never removed,
+     * and the table is never filled up so that the probes stay short.
+     */
+    e = &other;
+    for (i = hash_entry (&key); ; ++i)
+    {
+	entry_t *candidate = &entries[i % N_ENTRIES];
+
+	if (!candidate->hits)
+	{
+	    if (n_entries < MAX_ENTRIES)
+	    {
+		*candidate = key;
+		candidate->fallback = imp && !imp->fallback;
+		n_entries++;
+		e = candidate;
+	    }
+	    break;
+	}
+
+	if (same_entry (candidate, &key))
+	{
+	    e = candidate;
+	    break;
+	}
+    }
+
+    e->hits++;
+    e->pixels += pixels;
+    e->ticks += ticks;
+
+    profile_unlock (&lock);
+}
+
+static const char *
+op_name (pixman_op_t op)
+{
+    static const struct
+    {
+	pixman_op_t op;
+	const char *name;
+    } names[] =
+    {
+#define NAME(op, name) { PIXMAN_OP_ ## op, name }
+	NAME (CLEAR, "clear"),
+	NAME (SRC, "src"),
+	NAME (DST, "dst"),
+	NAME (OVER, "over"),
+	NAME (OVER_REVERSE, "over_reverse"),
+	NAME (IN, "in"),
+	NAME (IN_REVERSE, "in_reverse"),
+	NAME (OUT, "out"),
+	NAME (OUT_REVERSE, "out_reverse"),
+	NAME (ATOP, "atop"),
+	NAME (ATOP_REVERSE, "atop_reverse"),
+	NAME (XOR, "xor"),
+	NAME (ADD, "add"),
+	NAME (SATURATE, "saturate"),
+	NAME (DISJOINT_CLEAR, "disjoint_clear"),
+	NAME (DISJOINT_SRC, "disjoint_src"),
+	NAME (DISJOINT_DST, "disjoint_dst"),
+	NAME (DISJOINT_OVER, "disjoint_over"),
+	NAME (DISJOINT_OVER_REVERSE, "disjoint_over_reverse"),
+	NAME (DISJOINT_IN, "disjoint_in"),
+	NAME (DISJOINT_IN_REVERSE, "disjoint_in_reverse"),
+	NAME (DISJOINT_OUT, "disjoint_out"),
+	NAME (DISJOINT_OUT_REVERSE, "disjoint_out_reverse"),
+	NAME (DISJOINT_ATOP, "disjoint_atop"),
+	NAME (DISJOINT_ATOP_REVERSE, "disjoint_atop_reverse"),
+	NAME (DISJOINT_XOR, "disjoint_xor"),
+	NAME (CONJOINT_CLEAR, "conjoint_clear"),
+	NAME (CONJOINT_SRC, "conjoint_src"),
+	NAME (CONJOINT_DST, "conjoint_dst"),
+	NAME (CONJOINT_OVER, "conjoint_over"),
+	NAME (CONJOINT_OVER_REVERSE, "conjoint_over_reverse"),
+	NAME (CONJOINT_IN, "conjoint_in"),
+	NAME (CONJOINT_IN_REVERSE, "conjoint_in_reverse"),
+	NAME (CONJOINT_OUT, "conjoint_out"),
+	NAME (CONJOINT_OUT_REVERSE, "conjoint_out_reverse"),
+	NAME (CONJOINT_ATOP, "conjoint_atop"),
+	NAME (CONJOINT_ATOP_REVERSE, "conjoint_atop_reverse"),
+	NAME (CONJOINT_XOR, "conjoint_xor"),
+	NAME (MULTIPLY, "multiply"),
+	NAME (SCREEN, "screen"),
+	NAME (OVERLAY, "overlay"),
+	NAME (DARKEN, "darken"),
+	NAME (LIGHTEN, "lighten"),
+	NAME (COLOR_DODGE, "color_dodge"),
+	NAME (COLOR_BURN, "color_burn"),
+	NAME (HARD_LIGHT, "hard_light"),
+	NAME (SOFT_LIGHT, "soft_light"),
+	NAME (DIFFERENCE, "difference"),
+	NAME (EXCLUSION, "exclusion"),
+	NAME (HSL_HUE, "hsl_hue"),
+	NAME (HSL_SATURATION, "hsl_saturation"),
+	NAME (HSL_COLOR, "hsl_color"),
+	NAME (HSL_LUMINOSITY, "hsl_luminosity"),
+#undef NAME
+    };
+    int i;
+
+    for (i = 0; i < sizeof (names) / sizeof (names[0]); ++i)
+    {
+	if (names[i].op == op)
+	    return names[i].name;
+    }
+
+    return "unknown";
+}
+
+/* Spells out the channels of a format the way the PIXMAN_ names do,
+ * such as "x8r8g8b8" or "a8".
+ */
+static void
+format_name (pixman_format_code_t format, char *name, int size)
+{
+    static const char *const orders[] =
+    {
+	NULL, NULL, "argb", "abgr", NULL, NULL, NULL, NULL, "bgra", "rgba",
+    };
+    static const char *const extended[] =
+    {
+	"null", "solid", "pixbuf", "rpixbuf", "unknown", "any",
+    };
+    int type = PIXMAN_FORMAT_TYPE (format);
+    int bpp = PIXMAN_FORMAT_BPP (format);
+    int bits[4];
+    const char *order;
+    int i, pad, len = 0;
+
+    /* The formats made up for fast path lookups, see pixman-private.h */
+    if (bpp == 0 && type < sizeof (extended) / sizeof (extended[0]))
+    {
+	snprintf (name, size, "%s", extended[type]);
+	return;
+    }
+
+    switch (type)
+    {
+    case PIXMAN_TYPE_A:
+	snprintf (name, size, "a%d", PIXMAN_FORMAT_A (format));
+	return;
+    case PIXMAN_TYPE_COLOR:
+	snprintf (name, size, "c%d", bpp);
+	return;
+    case PIXMAN_TYPE_GRAY:
+	snprintf (name, size, "g%d", bpp);
+	return;
+    case PIXMAN_TYPE_YUY2:
+	snprintf (name, size, "yuy2");
+	return;
+    case PIXMAN_TYPE_YV12:
+	snprintf (name, size, "yv12");
+	return;
+    default:
+	break;
+    }
+
+    order = type < sizeof (orders) / sizeof (orders[0]) ? orders[type] : NULL;
+    if (!order)
+    {
+	snprintf (name, size, "%08x", format);
+	return;
+    }
+
+    for (i = 0; i < 4; ++i)
+    {
+	switch (order[i])
+	{
+	case 'a': bits[i] = PIXMAN_FORMAT_A (format); break;
+	case 'r': bits[i] = PIXMAN_FORMAT_R (format); break;
+	case 'g': bits[i] = PIXMAN_FORMAT_G (format); break;
+	default:  bits[i] = PIXMAN_FORMAT_B (format); break;
+	}
+    }
+
+    pad = bpp - bits[0] - bits[1] - bits[2] - bits[3];
+
+    /* Padding takes the place of a missing alpha channel */
+    if (pad && order[0] == 'a')
+	len += snprintf (name + len, size - len, "x%d", pad);
+
+    for (i = 0; i < 4; ++i)
+    {
+	if (bits[i] && len < size)
+	    len += snprintf (name + len, size - len, "%c%d", order[i], bits[i]);
+    }
+
+    if (pad && order[3] == 'a' && len < size)
+	snprintf (name + len, size - len, "x%d", pad);
+}
+
+static int
+compare_ticks (const void *a, const void *b)
+{
+    const entry_t *ea = *(const entry_t * const *)a;
+    const entry_t *eb = *(const entry_t * const *)b;
+
+    if (ea->ticks != eb->ticks)
+	return ea->ticks < eb->ticks ? 1 : -1;
+
+    return ea->hits < eb->hits ? 1 : ea->hits > eb->hits ? -1 : 0;
+}
+
+static void
+print_line (pixman_profile_print_func_t print, void *closure, const char *line)
+{
+    if (print)
+	print (line, closure);
+    else
+	fprintf (stderr, "%s\n", line);
+}
+
+PIXMAN_EXPORT void
+pixman_profile_report (pixman_profile_print_func_t print, void *closure)
+{
+    uint64_t hits = 0, ticks = 0, fallback_hits = 0, fallback_ticks = 0;
+    entry_t **sorted;
+    char line[256];
+    int i, n;
+
+    if (!_pixman_profiling ())
+	return;
+
+    profile_lock (&lock);
+
+    reported = TRUE;
+
+    sorted = malloc ((N_ENTRIES + 1) * sizeof (entry_t *));
+    if (!sorted)
+    {
+	profile_unlock (&lock);
+	return;
+    }
+
+    n = 0;
+    for (i = 0; i < N_ENTRIES; ++i)
+    {
+	if (entries[i].hits)
+	    sorted[n++] = &entries[i];
+    }
+    if (other.hits)
+	sorted[n++] = &other;
+
+    qsort (sorted, n, sizeof (entry_t *), compare_ticks);
+
+    for (i = 0; i < n; ++i)
+    {
+	hits += sorted[i]->hits;
+	ticks += sorted[i]->ticks;
+
+	if (sorted[i]->fallback)
+	{
+	    fallback_hits += sorted[i]->hits;
+	    fallback_ticks += sorted[i]->ticks;
+	}
+    }
+
+    snprintf (line, sizeof (line),
+	      "pixman: %llu composites, %llu (%.1f%% of the time) "
+	      "without a fast path",
+	      (unsigned long long)hits, (unsigned long long)fallback_hits,
+	      ticks ? 100.0 * fallback_ticks / ticks : 0.0);
+    print_line (print, closure, line);
+
+    snprintf (line, sizeof (line), "%10s %12s %14s  %-14s %-26s %-26s %-26s %s",
+	      "hits", "pixels", "ticks", "op",
+	      "src/flags", "mask/flags", "dest/flags", "function");
+    print_line (print, closure, line);
+
+    for (i = 0; i < n; ++i)
+    {
+	const entry_t *e = sorted[i];
+	char src[32], mask[32], dest[32];
+	char fsrc[48], fmask[48], fdest[48];
+
+	if (e == &other)
+	{
+	    snprintf (line, sizeof (line), "%10llu %12llu %14llu  (other)",
+		      (unsigned long long)e->hits,
+		      (unsigned long long)e->pixels,
+		      (unsigned long long)e->ticks);
+	    print_line (print, closure, line);
+	    continue;
+	}
+
+	format_name (e->src_format, src, sizeof (src));
+	format_name (e->mask_format, mask, sizeof (mask));
+	format_name (e->dest_format, dest, sizeof (dest));
+
+	snprintf (fsrc, sizeof (fsrc), "%s/%08x", src, e->src_flags);
+	snprintf (fmask, sizeof (fmask), "%s/%08x", mask, e->mask_flags);
+	snprintf (fdest, sizeof (fdest), "%s/%08x", dest, e->dest_flags);
+
+	if (e->fallback)
+	{
+	    snprintf (line, sizeof (line),
+		      "%10llu %12llu %14llu  %-14s %-26s %-26s %-26s general",
+		      (unsigned long long)e->hits,
+		      (unsigned long long)e->pixels,
+		      (unsigned long long)e->ticks,
+		      op_name (e->op), fsrc, fmask, fdest);
+	}
+	else
+	{
+	    snprintf (line, sizeof (line),
+		      "%10llu %12llu %14llu  %-14s %-26s %-26s %-26s %p",
+		      (unsigned long long)e->hits,
+		      (unsigned long long)e->pixels,
+		      (unsigned long long)e->ticks,
+		      op_name (e->op), fsrc, fmask, fdest,
+		      (void *)(uintptr_t)e->func);
+	}
+	print_line (print, closure, line);
+    }
+
+    free (sorted);
+
+    profile_unlock (&lock);
+}
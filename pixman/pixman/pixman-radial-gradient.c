@@ -34,6 +34,12 @@
 #include <math.h>
 #include "pixman-private.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RADIAL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 static inline pixman_fixed_32_32_t
 dot (pixman_fixed_48_16_t x1,
      pixman_fixed_48_16_t y1,
@@ -155,6 +161,114 @@ radial_compute_color (double                    a,
     return 0;
 }
 
+#ifdef RADIAL_USE_SSE2
+
+#define RAMP_CHUNK 64
+
+static force_inline __m128d
+radial_valid_sse2 (__m128d t, pixman_bool_t none, __m128d dr, __m128d mindr)
+{
+    if (none)
+    {
+	return _mm_and_pd (_mm_cmpge_pd (t, _mm_setzero_pd ()),
+			   _mm_cmple_pd (t, _mm_set1_pd (pixman_fixed_1)));
+    }
+
+    return _mm_cmpge_pd (_mm_mul_pd (t, dr), mindr);
+}
+
+/*
+ * Ramp version of the affine loop of radial_get_scanline_narrow(). It
+ * solves for t two pixels at a time in the same way as
+ * radial_compute_color(), and then looks the colors up in the color
+ * ramp of the gradient. Pixels without a valid t get a NaN position,
+ * which the ramp turns into transparent black.
+ */
+static void
+radial_fetch_ramp_sse2 (radial_gradient_t   *radial,
+			uint32_t            *buffer,
+			int                  width,
+			pixman_fixed_32_32_t b,
+			pixman_fixed_32_32_t db,
+			pixman_fixed_32_32_t c,
+			pixman_fixed_32_32_t dc,
+			pixman_fixed_32_32_t ddc)
+{
+    gradient_t *gradient = &radial->common;
+    pixman_bool_t none = gradient->common.repeat == PIXMAN_REPEAT_NONE;
+    const __m128d a = _mm_set1_pd (radial->a);
+    const __m128d inva = _mm_set1_pd (radial->inva);
+    const __m128d dr = _mm_set1_pd (radial->delta.radius);
+    const __m128d mindr = _mm_set1_pd (radial->mindr);
+    const __m128d zero = _mm_setzero_pd ();
+    const __m128d ones = _mm_castsi128_pd (_mm_set1_epi32 (-1));
+    float pos[RAMP_CHUNK];
+
+    while (width > 0)
+    {
+	int n = width < RAMP_CHUNK ? width : RAMP_CHUNK;
+	int i;
+
+	/* An odd n computes one position too many, but that only
+	 * happens in the last chunk.
+	 */
+	for (i = 0; i < n; i += 2)
+	{
+	    __m128d vb = _mm_set_pd ((double)(b + db), (double)b);
+	    __m128d vc = _mm_set_pd ((double)(c + dc), (double)c);
+	    __m128d t, invalid;
+
+	    if (radial->a == 0)
+	    {
+		__m128d bz = _mm_cmpeq_pd (vb, zero);
+
+		t = _mm_div_pd (_mm_mul_pd (_mm_set1_pd (pixman_fixed_1 / 2), vc),
+				_mm_or_pd (_mm_andnot_pd (bz, vb),
+					   _mm_and_pd (bz, _mm_set1_pd (1.))));
+		invalid = _mm_or_pd (
+		    bz, _mm_andnot_pd (radial_valid_sse2 (t, none, dr, mindr),
+				       ones));
+	    }
+	    else
+	    {
+		__m128d discr, sqrtdiscr, t0, t1, valid0, valid1;
+
+		discr = _mm_sub_pd (_mm_mul_pd (vb, vb), _mm_mul_pd (a, vc));
+		invalid = _mm_cmpnge_pd (discr, zero);
+
+		sqrtdiscr = _mm_sqrt_pd (_mm_max_pd (discr, zero));
+		t0 = _mm_mul_pd (_mm_add_pd (vb, sqrtdiscr), inva);
+		t1 = _mm_mul_pd (_mm_sub_pd (vb, sqrtdiscr), inva);
+
+		valid0 = radial_valid_sse2 (t0, none, dr, mindr);
+		valid1 = radial_valid_sse2 (t1, none, dr, mindr);
+
+		t = _mm_or_pd (_mm_and_pd (valid0, t0),
+			       _mm_andnot_pd (valid0, t1));
+		invalid = _mm_or_pd (
+		    invalid, _mm_andnot_pd (_mm_or_pd (valid0, valid1), ones));
+	    }
+
+	    /* All ones is a NaN */
+	    t = _mm_or_pd (t, invalid);
+	    _mm_storel_pi ((__m64 *)(pos + i),
+			   _mm_cvtpd_ps (_mm_mul_pd (
+					     t, _mm_set1_pd (1. / pixman_fixed_1))));
+
+	    b += 2 * db;
+	    c += 2 * dc + ddc;
+	    dc += 2 * ddc;
+	}
+
+	_pixman_gradient_ramp_fetch (gradient, buffer, pos, n);
+
+	buffer += n;
+	width -= n;
+    }
+}
+
+#endif
+
 static uint32_t *
 radial_get_scanline_narrow (pixman_iter_t *iter, const uint32_t *mask)
 {
@@ -326,6 +440,14 @@ radial_get_scanline_narrow (pixman_iter_t *iter, const uint32_t *mask)
 	ddc = 2 * dot (unit.vector[0], unit.vector[1], 0,
 		       unit.vector[0], unit.vector[1], 0);
 
+#ifdef RADIAL_USE_SSE2
+	if (_pixman_gradient_use_ramp (gradient))
+	{
+	    radial_fetch_ramp_sse2 (radial, buffer, width, b, db, c, dc, ddc);
+	    buffer = end;
+	}
+#endif
+
 	while (buffer < end)
 	{
 	    if (!mask || *mask++)
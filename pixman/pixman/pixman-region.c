@@ -69,6 +69,12 @@
 #include <stdio.h>
 #include "pixman-private.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REGION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #define PIXREGION_NIL(reg) ((reg)->data && !(reg)->data->numRects)
 /* not a region */
 #define PIXREGION_NAR(reg)      ((reg)->data == pixman_broken_data)
@@ -546,6 +552,164 @@ PREFIX (_copy) (region_type_t *dst, region_type_t *src)
  *	    Generic Region Operator
  *====================================================================*/
 
+#ifdef REGION_USE_SSE2
+
+/* The vector code works on as many boxes as fit in 16 bytes: one
+ * pixman_box32_t or two pixman_box16_t.  The sizeof tests are resolved
+ * at compile time.
+ */
+#define BOXES_PER_VECTOR ((int)(16 / sizeof (box_type_t)))
+
+static force_inline __m128i
+box_x_mask (void)
+{
+    if (sizeof (box_type_t) == 16)
+	return _mm_setr_epi32 (-1, 0, -1, 0);
+    else
+	return _mm_setr_epi16 (-1, 0, -1, 0, -1, 0, -1, 0);
+}
+
+static force_inline __m128i
+box_xy_vector (int x, int y)
+{
+    if (sizeof (box_type_t) == 16)
+	return _mm_setr_epi32 (x, y, x, y);
+    else
+	return _mm_setr_epi16 (x, y, x, y, x, y, x, y);
+}
+
+static force_inline __m128i
+box_add (__m128i a, __m128i b)
+{
+    if (sizeof (box_type_t) == 16)
+	return _mm_add_epi32 (a, b);
+    else
+	return _mm_add_epi16 (a, b);
+}
+
+static force_inline __m128i
+box_min (__m128i a, __m128i b)
+{
+    if (sizeof (box_type_t) == 16)
+    {
+	__m128i gt = _mm_cmpgt_epi32 (a, b);
+
+	return _mm_or_si128 (_mm_and_si128 (gt, b), _mm_andnot_si128 (gt, a));
+    }
+    else
+    {
+	return _mm_min_epi16 (a, b);
+    }
+}
+
+static force_inline __m128i
+box_sub (__m128i a, __m128i b)
+{
+    if (sizeof (box_type_t) == 16)
+	return _mm_sub_epi32 (a, b);
+    else
+	return _mm_sub_epi16 (a, b);
+}
+
+/* Negates x2, so that the smallest value in those lanes is the largest x2 */
+static force_inline __m128i
+box_negate_x2 (__m128i box)
+{
+    __m128i sign;
+
+    if (sizeof (box_type_t) == 16)
+	sign = _mm_setr_epi32 (0, 0, -1, 0);
+    else
+	sign = _mm_setr_epi16 (0, 0, -1, 0, 0, 0, -1, 0);
+
+    return box_sub (_mm_xor_si128 (box, sign), sign);
+}
+
+static force_inline __m128i
+box_cmpgt (__m128i a, __m128i b)
+{
+    if (sizeof (box_type_t) == 16)
+	return _mm_cmpgt_epi32 (a, b);
+    else
+	return _mm_cmpgt_epi16 (a, b);
+}
+
+/* Compared greater than by boxes with y1 > y or x2 > x; the x1 and y2
+ * lanes hold the largest value, which nothing is greater than.
+ */
+static force_inline __m128i
+box_y1_x2_limit (int x, int y)
+{
+    if (sizeof (box_type_t) == 16)
+	return _mm_setr_epi32 (INT32_MAX, y, x, INT32_MAX);
+    else
+	return _mm_setr_epi16 (INT16_MAX, y, x, INT16_MAX,
+			       INT16_MAX, y, x, INT16_MAX);
+}
+
+static force_inline int
+is_zero_128 (__m128i x)
+{
+    return _mm_movemask_epi8 (_mm_cmpeq_epi8 (x, _mm_setzero_si128 ())) == 0xffff;
+}
+
+#endif
+
+/* Whether the boxes in two bands line up, i.e. have the same x1 and x2 */
+static force_inline pixman_bool_t
+pixman_bands_match (const box_type_t *a, const box_type_t *b, int n)
+{
+#ifdef REGION_USE_SSE2
+    const __m128i mask = box_x_mask ();
+
+    while (n >= 4 * BOXES_PER_VECTOR)
+    {
+	__m128i d0 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)a + 0),
+				    _mm_loadu_si128 ((const __m128i *)b + 0));
+	__m128i d1 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)a + 1),
+				    _mm_loadu_si128 ((const __m128i *)b + 1));
+	__m128i d2 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)a + 2),
+				    _mm_loadu_si128 ((const __m128i *)b + 2));
+	__m128i d3 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)a + 3),
+				    _mm_loadu_si128 ((const __m128i *)b + 3));
+
+	if (!is_zero_128 (_mm_and_si128 (
+			      _mm_or_si128 (_mm_or_si128 (d0, d1),
+					    _mm_or_si128 (d2, d3)), mask)))
+	{
+	    return FALSE;
+	}
+
+	a += 4 * BOXES_PER_VECTOR;
+	b += 4 * BOXES_PER_VECTOR;
+	n -= 4 * BOXES_PER_VECTOR;
+    }
+
+    while (n >= BOXES_PER_VECTOR)
+    {
+	__m128i d = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)a),
+				   _mm_loadu_si128 ((const __m128i *)b));
+
+	if (!is_zero_128 (_mm_and_si128 (d, mask)))
+	    return FALSE;
+
+	a += BOXES_PER_VECTOR;
+	b += BOXES_PER_VECTOR;
+	n -= BOXES_PER_VECTOR;
+    }
+#endif
+
+    while (n--)
+    {
+	if (a->x1 != b->x1 || a->x2 != b->x2)
+	    return FALSE;
+	a++;
+	b++;
+    }
+
+    return TRUE;
+}
+
 /*-
  *-----------------------------------------------------------------------
  * pixman_coalesce --
@@ -598,28 +762,19 @@ pixman_coalesce (region_type_t * region,      /* Region to coalesce		 */
      */
     y2 = cur_box->y2;
 
-    do
-    {
-	if ((prev_box->x1 != cur_box->x1) || (prev_box->x2 != cur_box->x2))
-	    return (cur_start);
-	
-	prev_box++;
-	cur_box++;
-	numRects--;
-    }
-    while (numRects);
+    if (!pixman_bands_match (prev_box, cur_box, numRects))
+	return (cur_start);
 
     /*
      * The bands may be merged, so set the bottom y of each box
      * in the previous band to the bottom y of the current band.
      */
-    numRects = cur_start - prev_start;
     region->data->numRects -= numRects;
 
     do
     {
-	prev_box--;
 	prev_box->y2 = y2;
+	prev_box++;
 	numRects--;
     }
     while (numRects);
@@ -1075,6 +1230,34 @@ pixman_set_extents (region_type_t *region)
 
     critical_if_fail (region->extents.y1 < region->extents.y2);
 
+#ifdef REGION_USE_SSE2
+    if (box_end - box >= BOXES_PER_VECTOR)
+    {
+	box_type_t min[BOXES_PER_VECTOR];
+	__m128i m;
+	int i;
+
+	m = box_negate_x2 (_mm_loadu_si128 ((__m128i *)box));
+	box += BOXES_PER_VECTOR;
+
+	while (box_end - box >= BOXES_PER_VECTOR - 1)
+	{
+	    m = box_min (m, box_negate_x2 (_mm_loadu_si128 ((__m128i *)box)));
+	    box += BOXES_PER_VECTOR;
+	}
+
+	_mm_storeu_si128 ((__m128i *)min, m);
+
+	for (i = 0; i < BOXES_PER_VECTOR; i++)
+	{
+	    if (min[i].x1 < region->extents.x1)
+		region->extents.x1 = min[i].x1;
+	    if (-min[i].x2 > region->extents.x2)
+		region->extents.x2 = -min[i].x2;
+	}
+    }
+#endif
+
     while (box <= box_end)
     {
         if (box->x1 < region->extents.x1)
@@ -2062,6 +2245,51 @@ PREFIX (_inverse) (region_type_t *new_reg,  /* Destination region */
     return TRUE;
 }
 
+/* Skips the boxes from @begin on that lie in the band containing @y and
+ * end at or left of @x, i.e. have y1 <= y and x2 <= x.  Returns the first
+ * box that can still overlap x, or @end.  @x and @y must fit in a box
+ * coordinate.
+ */
+static force_inline box_type_t *
+skip_boxes_left_of (box_type_t *begin, box_type_t *end, int x, int y)
+{
+#ifdef REGION_USE_SSE2
+    const __m128i limit = box_y1_x2_limit (x, y);
+
+    while (end - begin >= 4 * BOXES_PER_VECTOR)
+    {
+	__m128i g0 = box_cmpgt (_mm_loadu_si128 ((const __m128i *)begin + 0), limit);
+	__m128i g1 = box_cmpgt (_mm_loadu_si128 ((const __m128i *)begin + 1), limit);
+	__m128i g2 = box_cmpgt (_mm_loadu_si128 ((const __m128i *)begin + 2), limit);
+	__m128i g3 = box_cmpgt (_mm_loadu_si128 ((const __m128i *)begin + 3), limit);
+
+	if (!is_zero_128 (_mm_or_si128 (_mm_or_si128 (g0, g1),
+					_mm_or_si128 (g2, g3))))
+	{
+	    break;
+	}
+
+	begin += 4 * BOXES_PER_VECTOR;
+    }
+
+    while (end - begin >= BOXES_PER_VECTOR)
+    {
+	if (!is_zero_128 (box_cmpgt (_mm_loadu_si128 ((const __m128i *)begin),
+				     limit)))
+	{
+	    break;
+	}
+
+	begin += BOXES_PER_VECTOR;
+    }
+#endif
+
+    while (begin != end && begin->y1 <= y && begin->x2 <= x)
+	begin++;
+
+    return begin;
+}
+
 /* In time O(log n), locate the first box whose y2 is greater than y.
  * Return @end if no such box exists.
  */
@@ -2167,7 +2395,12 @@ PREFIX (_contains_rectangle) (region_type_t *  region,
 	}
 
         if (pbox->x2 <= x)
-	    continue;           /* not far enough over yet */
+        {
+            /* not far enough over yet, and neither are the boxes after it
+             * that also end left of x */
+            pbox = skip_boxes_left_of (pbox, pbox_end, x, y) - 1;
+	    continue;
+	}
 
         if (pbox->x1 > x)
         {
@@ -2238,7 +2471,22 @@ PREFIX (_translate) (region_type_t *region, int x, int y)
     {
         if (region->data && (nbox = region->data->numRects))
         {
-            for (pbox = PIXREGION_BOXPTR (region); nbox--; pbox++)
+            pbox = PIXREGION_BOXPTR (region);
+
+#ifdef REGION_USE_SSE2
+	    {
+		const __m128i d = box_xy_vector (x, y);
+
+		for (; nbox >= BOXES_PER_VECTOR; nbox -= BOXES_PER_VECTOR)
+		{
+		    _mm_storeu_si128 ((__m128i *)pbox, box_add (
+					  _mm_loadu_si128 ((__m128i *)pbox), d));
+		    pbox += BOXES_PER_VECTOR;
+		}
+	    }
+#endif
+
+            for (; nbox--; pbox++)
             {
                 pbox->x1 += x;
                 pbox->y1 += y;
@@ -2368,22 +2616,15 @@ PREFIX (_contains_point) (region_type_t * region,
     pbox_end = pbox + numRects;
 
     pbox = find_box_for_y (pbox, pbox_end, y);
+    pbox = skip_boxes_left_of (pbox, pbox_end, x, y);
 
-    for (;pbox != pbox_end; pbox++)
-    {
-        if ((y < pbox->y1) || (x < pbox->x1))
-	    break;              /* missed it */
-
-        if (x >= pbox->x2)
-	    continue;           /* not there yet */
-
-        if (box)
-	    *box = *pbox;
+    if (pbox == pbox_end || (y < pbox->y1) || (x < pbox->x1))
+	return(FALSE);          /* missed it */
 
-        return(TRUE);
-    }
+    if (box)
+	*box = *pbox;
 
-    return(FALSE);
+    return(TRUE);
 }
 
 PIXMAN_EXPORT int
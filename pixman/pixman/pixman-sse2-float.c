@@ -0,0 +1,815 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * SSE2 versions of the floating point combiners in pixman-combine-float.c
+ * and of the wide fetchers and storers for the common 32 bpp formats.
+ *
+ * One argb_t pixel fills one register, so each operator is the scalar
+ * per-channel function applied to all four channels at once.  Branches
+ * become selects, and the arithmetic is done in the same order as the
+ * scalar code, so the results are bit for bit the same.  Divisions in
+ * lanes that the scalar code would not have divided in get a denominator
+ * of one, so no exception is raised that the scalar code would not raise.
+ *
+ * The non-separable HSL modes are left to the generic implementation.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <float.h>
+#include <string.h>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#include "pixman-private.h"
+
+typedef __m128 (* combine_vector_t) (__m128 sa, __m128 s, __m128 da, __m128 d);
+
+static force_inline __m128
+broadcast_alpha (__m128 v)
+{
+    return _mm_shuffle_ps (v, v, _MM_SHUFFLE (0, 0, 0, 0));
+}
+
+/* mask ? a : b */
+static force_inline __m128
+select_ps (__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b));
+}
+
+static force_inline __m128
+alpha_lane (void)
+{
+    return _mm_castsi128_ps (_mm_setr_epi32 (-1, 0, 0, 0));
+}
+
+/* FLOAT_IS_ZERO () */
+static force_inline __m128
+is_zero (__m128 f)
+{
+    return _mm_and_ps (_mm_cmplt_ps (_mm_set1_ps (-FLT_MIN), f),
+		       _mm_cmplt_ps (f, _mm_set1_ps (FLT_MIN)));
+}
+
+/* n / d in the lanes where d is not zero */
+static force_inline __m128
+safe_div (__m128 n, __m128 d, __m128 d_is_zero)
+{
+    return _mm_div_ps (n, select_ps (d_is_zero, _mm_set1_ps (1.0f), d));
+}
+
+/* CLAMP () */
+static force_inline __m128
+clamp (__m128 f)
+{
+    return _mm_max_ps (_mm_setzero_ps (), _mm_min_ps (_mm_set1_ps (1.0f), f));
+}
+
+static force_inline void
+combine_inner (pixman_bool_t component,
+	       float *dest, const float *src, const float *mask, int n_pixels,
+	       combine_vector_t combine)
+{
+    int i;
+
+    if (!mask)
+    {
+	for (i = 0; i < 4 * n_pixels; i += 4)
+	{
+	    __m128 s = _mm_loadu_ps (src + i);
+	    __m128 d = _mm_loadu_ps (dest + i);
+
+	    _mm_storeu_ps (dest + i, combine (broadcast_alpha (s), s,
+					      broadcast_alpha (d), d));
+	}
+    }
+    else
+    {
+	for (i = 0; i < 4 * n_pixels; i += 4)
+	{
+	    __m128 s = _mm_loadu_ps (src + i);
+	    __m128 m = _mm_loadu_ps (mask + i);
+	    __m128 d = _mm_loadu_ps (dest + i);
+	    __m128 sa;
+
+	    if (component)
+	    {
+		sa = _mm_mul_ps (m, broadcast_alpha (s));
+		s = _mm_mul_ps (s, m);
+	    }
+	    else
+	    {
+		s = _mm_mul_ps (s, broadcast_alpha (m));
+		sa = broadcast_alpha (s);
+	    }
+
+	    _mm_storeu_ps (dest + i, combine (sa, s, broadcast_alpha (d), d));
+	}
+    }
+}
+
+#define MAKE_COMBINER(name, component, combine)				\
+    static void								\
+    sse2_combine_ ## name ## _float (pixman_implementation_t *imp,	\
+				     pixman_op_t              op,	\
+				     float                   *dest,	\
+				     const float             *src,	\
+				     const float             *mask,	\
+				     int                      n_pixels)	\
+    {									\
+	combine_inner (component, dest, src, mask, n_pixels, combine);	\
+    }
+
+#define MAKE_COMBINERS(name, combine)					\
+    MAKE_COMBINER(name ## _ca, TRUE, combine)				\
+    MAKE_COMBINER(name ## _u, FALSE, combine)
+
+/*
+ * Porter/Duff operators
+ */
+typedef enum
+{
+    ZERO,
+    ONE,
+    SRC_ALPHA,
+    DEST_ALPHA,
+    INV_SA,
+    INV_DA,
+    SA_OVER_DA,
+    DA_OVER_SA,
+    INV_SA_OVER_DA,
+    INV_DA_OVER_SA,
+    ONE_MINUS_SA_OVER_DA,
+    ONE_MINUS_DA_OVER_SA,
+    ONE_MINUS_INV_DA_OVER_SA,
+    ONE_MINUS_INV_SA_OVER_DA
+} combine_factor_t;
+
+static force_inline __m128
+get_factor (combine_factor_t factor, __m128 sa, __m128 da)
+{
+    __m128 zero = _mm_setzero_ps ();
+    __m128 one = _mm_set1_ps (1.0f);
+    __m128 z;
+
+    switch (factor)
+    {
+    case ZERO:
+	return zero;
+
+    case ONE:
+	return one;
+
+    case SRC_ALPHA:
+	return sa;
+
+    case DEST_ALPHA:
+	return da;
+
+    case INV_SA:
+	return _mm_sub_ps (one, sa);
+
+    case INV_DA:
+	return _mm_sub_ps (one, da);
+
+    case SA_OVER_DA:
+	z = is_zero (da);
+	return select_ps (z, one, clamp (safe_div (sa, da, z)));
+
+    case DA_OVER_SA:
+	z = is_zero (sa);
+	return select_ps (z, one, clamp (safe_div (da, sa, z)));
+
+    case INV_SA_OVER_DA:
+	z = is_zero (da);
+	return select_ps (z, one, clamp (safe_div (_mm_sub_ps (one, sa), da, z)));
+
+    case INV_DA_OVER_SA:
+	z = is_zero (sa);
+	return select_ps (z, one, clamp (safe_div (_mm_sub_ps (one, da), sa, z)));
+
+    case ONE_MINUS_SA_OVER_DA:
+	z = is_zero (da);
+	return _mm_andnot_ps (
+	    z, clamp (_mm_sub_ps (one, safe_div (sa, da, z))));
+
+    case ONE_MINUS_DA_OVER_SA:
+	z = is_zero (sa);
+	return _mm_andnot_ps (
+	    z, clamp (_mm_sub_ps (one, safe_div (da, sa, z))));
+
+    case ONE_MINUS_INV_DA_OVER_SA:
+	z = is_zero (sa);
+	return _mm_andnot_ps (
+	    z, clamp (_mm_sub_ps (one, safe_div (_mm_sub_ps (one, da), sa, z))));
+
+    case ONE_MINUS_INV_SA_OVER_DA:
+	z = is_zero (da);
+	return _mm_andnot_ps (
+	    z, clamp (_mm_sub_ps (one, safe_div (_mm_sub_ps (one, sa), da, z))));
+    }
+
+    return _mm_set1_ps (-1.0f);
+}
+
+#define MAKE_PD_COMBINERS(name, a, b)					\
+    static force_inline __m128						\
+    pd_combine_ ## name (__m128 sa, __m128 s, __m128 da, __m128 d)	\
+    {									\
+	const __m128 fa = get_factor (a, sa, da);			\
+	const __m128 fb = get_factor (b, sa, da);			\
+									\
+	return _mm_min_ps (_mm_set1_ps (1.0f),				\
+			   _mm_add_ps (_mm_mul_ps (s, fa),		\
+				       _mm_mul_ps (d, fb)));		\
+    }									\
+									\
+    MAKE_COMBINERS(name, pd_combine_ ## name)
+
+MAKE_PD_COMBINERS (clear,			ZERO,				ZERO)
+MAKE_PD_COMBINERS (src,				ONE,				ZERO)
+MAKE_PD_COMBINERS (dst,				ZERO,				ONE)
+MAKE_PD_COMBINERS (over,			ONE,				INV_SA)
+MAKE_PD_COMBINERS (over_reverse,		INV_DA,				ONE)
+MAKE_PD_COMBINERS (in,				DEST_ALPHA,			ZERO)
+MAKE_PD_COMBINERS (in_reverse,			ZERO,				SRC_ALPHA)
+MAKE_PD_COMBINERS (out,				INV_DA,				ZERO)
+MAKE_PD_COMBINERS (out_reverse,			ZERO,				INV_SA)
+MAKE_PD_COMBINERS (atop,			DEST_ALPHA,			INV_SA)
+MAKE_PD_COMBINERS (atop_reverse,		INV_DA,				SRC_ALPHA)
+MAKE_PD_COMBINERS (xor,				INV_DA,				INV_SA)
+MAKE_PD_COMBINERS (add,				ONE,				ONE)
+
+MAKE_PD_COMBINERS (saturate,			INV_DA_OVER_SA,			ONE)
+
+MAKE_PD_COMBINERS (disjoint_clear,		ZERO,				ZERO)
+MAKE_PD_COMBINERS (disjoint_src,		ONE,				ZERO)
+MAKE_PD_COMBINERS (disjoint_dst,		ZERO,				ONE)
+MAKE_PD_COMBINERS (disjoint_over,		ONE,				INV_SA_OVER_DA)
+MAKE_PD_COMBINERS (disjoint_over_reverse,	INV_DA_OVER_SA,			ONE)
+MAKE_PD_COMBINERS (disjoint_in,			ONE_MINUS_INV_DA_OVER_SA,	ZERO)
+MAKE_PD_COMBINERS (disjoint_in_reverse,		ZERO,				ONE_MINUS_INV_SA_OVER_DA)
+MAKE_PD_COMBINERS (disjoint_out,		INV_DA_OVER_SA,			ZERO)
+MAKE_PD_COMBINERS (disjoint_out_reverse,	ZERO,				INV_SA_OVER_DA)
+MAKE_PD_COMBINERS (disjoint_atop,		ONE_MINUS_INV_DA_OVER_SA,	INV_SA_OVER_DA)
+MAKE_PD_COMBINERS (disjoint_atop_reverse,	INV_DA_OVER_SA,			ONE_MINUS_INV_SA_OVER_DA)
+MAKE_PD_COMBINERS (disjoint_xor,		INV_DA_OVER_SA,			INV_SA_OVER_DA)
+
+MAKE_PD_COMBINERS (conjoint_clear,		ZERO,				ZERO)
+MAKE_PD_COMBINERS (conjoint_src,		ONE,				ZERO)
+MAKE_PD_COMBINERS (conjoint_dst,		ZERO,				ONE)
+MAKE_PD_COMBINERS (conjoint_over,		ONE,				ONE_MINUS_SA_OVER_DA)
+MAKE_PD_COMBINERS (conjoint_over_reverse,	ONE_MINUS_DA_OVER_SA,		ONE)
+MAKE_PD_COMBINERS (conjoint_in,			DA_OVER_SA,			ZERO)
+MAKE_PD_COMBINERS (conjoint_in_reverse,		ZERO,				SA_OVER_DA)
+MAKE_PD_COMBINERS (conjoint_out,		ONE_MINUS_DA_OVER_SA,		ZERO)
+MAKE_PD_COMBINERS (conjoint_out_reverse,	ZERO,				ONE_MINUS_SA_OVER_DA)
+MAKE_PD_COMBINERS (conjoint_atop,		DA_OVER_SA,			ONE_MINUS_SA_OVER_DA)
+MAKE_PD_COMBINERS (conjoint_atop_reverse,	ONE_MINUS_DA_OVER_SA,		SA_OVER_DA)
+MAKE_PD_COMBINERS (conjoint_xor,		ONE_MINUS_DA_OVER_SA,		ONE_MINUS_SA_OVER_DA)
+
+/*
+ * Separable PDF blend modes.  See pixman-combine-float.c for the
+ * derivation of each blend function.  The alpha lane is
+ *
+ *     αr = αs + αb - αb × αs
+ *
+ * and the color lanes are
+ *
+ *     cr = (1 – αs) × cb  +  (1 – αb) × cs  +  αb × αs × B (cb/αb, cs/αs)
+ */
+#define MAKE_SEPARABLE_PDF_COMBINERS(name)				\
+    static force_inline __m128						\
+    combine_ ## name (__m128 sa, __m128 s, __m128 da, __m128 d)		\
+    {									\
+	__m128 one = _mm_set1_ps (1.0f);				\
+	__m128 a = _mm_sub_ps (_mm_add_ps (da, sa), _mm_mul_ps (da, sa)); \
+	__m128 f = _mm_add_ps (_mm_mul_ps (_mm_sub_ps (one, sa), d),	\
+			       _mm_mul_ps (_mm_sub_ps (one, da), s));	\
+									\
+	return select_ps (alpha_lane (), a,				\
+			  _mm_add_ps (f, blend_ ## name (sa, s, da, d))); \
+    }									\
+									\
+    MAKE_COMBINERS (name, combine_ ## name)
+
+static force_inline __m128
+blend_multiply (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    return _mm_mul_ps (d, s);
+}
+
+static force_inline __m128
+blend_screen (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    return _mm_sub_ps (_mm_add_ps (_mm_mul_ps (d, sa), _mm_mul_ps (s, da)),
+		       _mm_mul_ps (s, d));
+}
+
+/* as * ad - 2 * (ad - d) * (as - s), shared by overlay and hard light */
+static force_inline __m128
+blend_screen_2 (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    __m128 two = _mm_set1_ps (2.0f);
+
+    return _mm_sub_ps (_mm_mul_ps (sa, da),
+		       _mm_mul_ps (_mm_mul_ps (two, _mm_sub_ps (da, d)),
+				   _mm_sub_ps (sa, s)));
+}
+
+static force_inline __m128
+blend_overlay (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    __m128 two = _mm_set1_ps (2.0f);
+
+    return select_ps (_mm_cmplt_ps (_mm_mul_ps (two, d), da),
+		      _mm_mul_ps (_mm_mul_ps (two, s), d),
+		      blend_screen_2 (sa, s, da, d));
+}
+
+static force_inline __m128
+blend_darken (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    return _mm_min_ps (_mm_mul_ps (d, sa), _mm_mul_ps (s, da));
+}
+
+static force_inline __m128
+blend_lighten (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    return _mm_max_ps (_mm_mul_ps (s, da), _mm_mul_ps (d, sa));
+}
+
+static force_inline __m128
+blend_color_dodge (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    __m128 sada = _mm_mul_ps (sa, da);
+    __m128 sa_s = _mm_sub_ps (sa, s);
+    __m128 z = is_zero (sa_s);
+    __m128 r;
+
+    r = safe_div (_mm_mul_ps (_mm_mul_ps (sa, sa), d), sa_s, z);
+    r = select_ps (
+	_mm_or_ps (_mm_cmpge_ps (_mm_mul_ps (d, sa),
+				 _mm_sub_ps (sada, _mm_mul_ps (s, da))), z),
+	sada, r);
+
+    return _mm_andnot_ps (is_zero (d), r);
+}
+
+static force_inline __m128
+blend_color_burn (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    __m128 sa_da_d = _mm_mul_ps (sa, _mm_sub_ps (da, d));
+    __m128 z = is_zero (s);
+    __m128 r;
+
+    r = _mm_mul_ps (sa, _mm_sub_ps (da, safe_div (sa_da_d, s, z)));
+    r = _mm_andnot_ps (
+	_mm_or_ps (_mm_cmpge_ps (sa_da_d, _mm_mul_ps (s, da)), z), r);
+
+    return select_ps (_mm_cmpge_ps (d, da), _mm_mul_ps (sa, da), r);
+}
+
+static force_inline __m128
+blend_hard_light (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    __m128 two = _mm_set1_ps (2.0f);
+
+    return select_ps (_mm_cmplt_ps (_mm_mul_ps (two, s), sa),
+		      _mm_mul_ps (_mm_mul_ps (two, s), d),
+		      blend_screen_2 (sa, s, da, d));
+}
+
+static force_inline __m128
+blend_soft_light (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    __m128 two = _mm_set1_ps (2.0f);
+    __m128 dsa = _mm_mul_ps (d, sa);
+    __m128 z = is_zero (da);
+    __m128 da1 = select_ps (z, _mm_set1_ps (1.0f), da);
+    __m128 low_s = _mm_cmple_ps (_mm_mul_ps (two, s), sa);
+    __m128 low_d = _mm_cmple_ps (_mm_mul_ps (_mm_set1_ps (4.0f), d), da);
+    __m128 two_s_sa = _mm_sub_ps (_mm_mul_ps (two, s), sa);
+    __m128 root, t, r;
+
+    t = _mm_div_ps (_mm_mul_ps (_mm_set1_ps (16.0f), d), da1);
+    t = _mm_div_ps (_mm_mul_ps (_mm_sub_ps (t, _mm_set1_ps (12.0f)), d), da1);
+    t = _mm_add_ps (t, _mm_set1_ps (3.0f));
+
+    root = _mm_andnot_ps (_mm_or_ps (_mm_or_ps (low_s, low_d), z),
+			  _mm_mul_ps (d, da));
+    root = _mm_sqrt_ps (root);
+
+    r = select_ps (
+	low_d,
+	_mm_add_ps (dsa, _mm_mul_ps (_mm_mul_ps (two_s_sa, d), t)),
+	_mm_add_ps (dsa, _mm_mul_ps (_mm_sub_ps (root, d), two_s_sa)));
+    r = select_ps (
+	low_s,
+	_mm_sub_ps (dsa,
+		    _mm_div_ps (_mm_mul_ps (_mm_mul_ps (d, _mm_sub_ps (da, d)),
+					    _mm_sub_ps (sa, _mm_mul_ps (two, s))),
+				da1)),
+	r);
+
+    return select_ps (z, dsa, r);
+}
+
+static force_inline __m128
+blend_difference (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    __m128 dsa = _mm_mul_ps (d, sa);
+    __m128 sda = _mm_mul_ps (s, da);
+
+    return select_ps (_mm_cmplt_ps (sda, dsa),
+		      _mm_sub_ps (dsa, sda), _mm_sub_ps (sda, dsa));
+}
+
+static force_inline __m128
+blend_exclusion (__m128 sa, __m128 s, __m128 da, __m128 d)
+{
+    return _mm_sub_ps (_mm_add_ps (_mm_mul_ps (s, da), _mm_mul_ps (d, sa)),
+		       _mm_mul_ps (_mm_mul_ps (_mm_set1_ps (2.0f), d), s));
+}
+
+MAKE_SEPARABLE_PDF_COMBINERS (multiply)
+MAKE_SEPARABLE_PDF_COMBINERS (screen)
+MAKE_SEPARABLE_PDF_COMBINERS (overlay)
+MAKE_SEPARABLE_PDF_COMBINERS (darken)
+MAKE_SEPARABLE_PDF_COMBINERS (lighten)
+MAKE_SEPARABLE_PDF_COMBINERS (color_dodge)
+MAKE_SEPARABLE_PDF_COMBINERS (color_burn)
+MAKE_SEPARABLE_PDF_COMBINERS (hard_light)
+MAKE_SEPARABLE_PDF_COMBINERS (soft_light)
+MAKE_SEPARABLE_PDF_COMBINERS (difference)
+MAKE_SEPARABLE_PDF_COMBINERS (exclusion)
+
+/*
+ * Wide iterators
+ *
+ * Four pixels are unpacked into one register per channel, converted,
+ * and transposed into four argb_t, or the other way around.  The
+ * conversions are those of unorm_to_float() and float_to_unorm() in
+ * pixman-utils.c.
+ */
+typedef enum
+{
+    FORMAT_8888,
+    FORMAT_2101010
+} wide_format_t;
+
+static force_inline __m128
+unorm_to_float (__m128i u, int n_bits)
+{
+    return _mm_mul_ps (_mm_cvtepi32_ps (u),
+		       _mm_set1_ps (1.f / (float)((1 << n_bits) - 1)));
+}
+
+static force_inline __m128i
+float_to_unorm (__m128 f, int n_bits)
+{
+    __m128i u;
+
+    /* NaN becomes 0, as it does for the scalar conversion */
+    f = _mm_min_ps (_mm_max_ps (f, _mm_setzero_ps ()), _mm_set1_ps (1.0f));
+
+    u = _mm_cvttps_epi32 (_mm_mul_ps (f, _mm_set1_ps ((float)(1 << n_bits))));
+
+    return _mm_sub_epi32 (u, _mm_srli_epi32 (u, n_bits));
+}
+
+static force_inline void
+expand_4 (argb_t *dst, __m128i p, wide_format_t format, pixman_bool_t has_alpha)
+{
+    __m128 a, r, g, b;
+
+    if (format == FORMAT_8888)
+    {
+	__m128i m = _mm_set1_epi32 (0xff);
+
+	a = unorm_to_float (_mm_srli_epi32 (p, 24), 8);
+	r = unorm_to_float (_mm_and_si128 (_mm_srli_epi32 (p, 16), m), 8);
+	g = unorm_to_float (_mm_and_si128 (_mm_srli_epi32 (p, 8), m), 8);
+	b = unorm_to_float (_mm_and_si128 (p, m), 8);
+    }
+    else
+    {
+	__m128i m = _mm_set1_epi32 (0x3ff);
+
+	a = unorm_to_float (_mm_srli_epi32 (p, 30), 2);
+	r = unorm_to_float (_mm_and_si128 (_mm_srli_epi32 (p, 20), m), 10);
+	g = unorm_to_float (_mm_and_si128 (_mm_srli_epi32 (p, 10), m), 10);
+	b = unorm_to_float (_mm_and_si128 (p, m), 10);
+    }
+
+    if (!has_alpha)
+	a = _mm_set1_ps (1.0f);
+
+    _MM_TRANSPOSE4_PS (a, r, g, b);
+
+    _mm_storeu_ps ((float *)(dst + 0), a);
+    _mm_storeu_ps ((float *)(dst + 1), r);
+    _mm_storeu_ps ((float *)(dst + 2), g);
+    _mm_storeu_ps ((float *)(dst + 3), b);
+}
+
+static force_inline __m128i
+contract_4 (const argb_t *src, wide_format_t format, pixman_bool_t has_alpha)
+{
+    __m128 a = _mm_loadu_ps ((const float *)(src + 0));
+    __m128 r = _mm_loadu_ps ((const float *)(src + 1));
+    __m128 g = _mm_loadu_ps ((const float *)(src + 2));
+    __m128 b = _mm_loadu_ps ((const float *)(src + 3));
+    __m128i p;
+
+    _MM_TRANSPOSE4_PS (a, r, g, b);
+
+    if (format == FORMAT_8888)
+    {
+	p = _mm_or_si128 (_mm_slli_epi32 (float_to_unorm (r, 8), 16),
+			  _mm_or_si128 (_mm_slli_epi32 (float_to_unorm (g, 8), 8),
+					float_to_unorm (b, 8)));
+	if (has_alpha)
+	    p = _mm_or_si128 (p, _mm_slli_epi32 (float_to_unorm (a, 8), 24));
+    }
+    else
+    {
+	p = _mm_or_si128 (_mm_slli_epi32 (float_to_unorm (r, 10), 20),
+			  _mm_or_si128 (_mm_slli_epi32 (float_to_unorm (g, 10), 10),
+					float_to_unorm (b, 10)));
+	if (has_alpha)
+	    p = _mm_or_si128 (p, _mm_slli_epi32 (float_to_unorm (a, 2), 30));
+    }
+
+    return p;
+}
+
+static force_inline void
+fetch_wide (argb_t *dst, const uint32_t *src, int w,
+	    wide_format_t format, pixman_bool_t has_alpha)
+{
+    while (w >= 4)
+    {
+	expand_4 (dst, _mm_loadu_si128 ((const __m128i *)src), format, has_alpha);
+
+	dst += 4;
+	src += 4;
+	w -= 4;
+    }
+
+    if (w)
+    {
+	uint32_t in[4] = { 0 };
+	argb_t out[4];
+
+	memcpy (in, src, w * sizeof (uint32_t));
+	expand_4 (out, _mm_loadu_si128 ((const __m128i *)in), format, has_alpha);
+	memcpy (dst, out, w * sizeof (argb_t));
+    }
+}
+
+static force_inline void
+store_wide (uint32_t *dst, const argb_t *src, int w,
+	    wide_format_t format, pixman_bool_t has_alpha)
+{
+    while (w >= 4)
+    {
+	_mm_storeu_si128 ((__m128i *)dst, contract_4 (src, format, has_alpha));
+
+	dst += 4;
+	src += 4;
+	w -= 4;
+    }
+
+    if (w)
+    {
+	argb_t in[4];
+	uint32_t out[4];
+
+	memset (in, 0, sizeof (in));
+	memcpy (in, src, w * sizeof (argb_t));
+	_mm_storeu_si128 ((__m128i *)out, contract_4 (in, format, has_alpha));
+	memcpy (dst, out, w * sizeof (uint32_t));
+    }
+}
+
+/* Source iterators advance in get_scanline, destination iterators in
+ * write_back, after the scanline has been stored back to the same row.
+ */
+#define MAKE_WIDE_ITERS(name, format, has_alpha)			\
+    static uint32_t *							\
+    sse2_fetch_ ## name ## _float (pixman_iter_t *iter,		\
+				   const uint32_t *mask)		\
+    {									\
+	fetch_wide ((argb_t *)iter->buffer, (uint32_t *)iter->bits,	\
+		    iter->width, format, has_alpha);			\
+									\
+	iter->bits += iter->stride;					\
+									\
+	return iter->buffer;						\
+    }									\
+									\
+    static uint32_t *							\
+    sse2_fetch_dest_ ## name ## _float (pixman_iter_t *iter,		\
+					const uint32_t *mask)		\
+    {									\
+	fetch_wide ((argb_t *)iter->buffer, (uint32_t *)iter->bits,	\
+		    iter->width, format, has_alpha);			\
+									\
+	return iter->buffer;						\
+    }									\
+									\
+    static void								\
+    sse2_write_back_ ## name ## _float (pixman_iter_t *iter)		\
+    {									\
+	store_wide ((uint32_t *)iter->bits, (argb_t *)iter->buffer,	\
+		    iter->width, format, has_alpha);			\
+									\
+	iter->bits += iter->stride;					\
+    }
+
+MAKE_WIDE_ITERS (a8r8g8b8, FORMAT_8888, TRUE)
+MAKE_WIDE_ITERS (x8r8g8b8, FORMAT_8888, FALSE)
+MAKE_WIDE_ITERS (a2r10g10b10, FORMAT_2101010, TRUE)
+MAKE_WIDE_ITERS (x2r10g10b10, FORMAT_2101010, FALSE)
+
+#define SRC_FLAGS							\
+    (FAST_PATH_NO_ACCESSORS | FAST_PATH_NO_ALPHA_MAP |			\
+     FAST_PATH_ID_TRANSFORM | FAST_PATH_BITS_IMAGE |			\
+     FAST_PATH_SAMPLES_COVER_CLIP_NEAREST)
+
+#define DEST_FLAGS							\
+    (FAST_PATH_NO_ACCESSORS | FAST_PATH_NO_ALPHA_MAP)
+
+#define WIDE_ITERS(name)						\
+    { PIXMAN_ ## name, SRC_FLAGS, ITER_SRC | ITER_WIDE,		\
+      _pixman_iter_init_bits_stride,					\
+      sse2_fetch_ ## name ## _float, NULL				\
+    },									\
+    { PIXMAN_ ## name, DEST_FLAGS, ITER_DEST | ITER_WIDE,		\
+      _pixman_iter_init_bits_stride,					\
+      sse2_fetch_dest_ ## name ## _float,				\
+      sse2_write_back_ ## name ## _float				\
+    }
+
+static const pixman_iter_info_t sse2_float_iters[] =
+{
+    WIDE_ITERS (a8r8g8b8),
+    WIDE_ITERS (x8r8g8b8),
+    WIDE_ITERS (a2r10g10b10),
+    WIDE_ITERS (x2r10g10b10),
+    { PIXMAN_null },
+};
+
+static const pixman_fast_path_t sse2_float_fast_paths[] =
+{
+    { PIXMAN_OP_NONE },
+};
+
+#if defined(__GNUC__) && !defined(__x86_64__) && !defined(__amd64__)
+__attribute__((__force_align_arg_pointer__))
+#endif
+pixman_implementation_t *
+_pixman_implementation_create_sse2_float (pixman_implementation_t *fallback)
+{
+    pixman_implementation_t *imp =
+	_pixman_implementation_create (fallback, sse2_float_fast_paths);
+
+    /* Unified alpha */
+    imp->combine_float[PIXMAN_OP_CLEAR] = sse2_combine_clear_u_float;
+    imp->combine_float[PIXMAN_OP_SRC] = sse2_combine_src_u_float;
+    imp->combine_float[PIXMAN_OP_DST] = sse2_combine_dst_u_float;
+    imp->combine_float[PIXMAN_OP_OVER] = sse2_combine_over_u_float;
+    imp->combine_float[PIXMAN_OP_OVER_REVERSE] = sse2_combine_over_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_IN] = sse2_combine_in_u_float;
+    imp->combine_float[PIXMAN_OP_IN_REVERSE] = sse2_combine_in_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_OUT] = sse2_combine_out_u_float;
+    imp->combine_float[PIXMAN_OP_OUT_REVERSE] = sse2_combine_out_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_ATOP] = sse2_combine_atop_u_float;
+    imp->combine_float[PIXMAN_OP_ATOP_REVERSE] = sse2_combine_atop_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_XOR] = sse2_combine_xor_u_float;
+    imp->combine_float[PIXMAN_OP_ADD] = sse2_combine_add_u_float;
+    imp->combine_float[PIXMAN_OP_SATURATE] = sse2_combine_saturate_u_float;
+
+    /* Disjoint, unified */
+    imp->combine_float[PIXMAN_OP_DISJOINT_CLEAR] = sse2_combine_disjoint_clear_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_SRC] = sse2_combine_disjoint_src_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_DST] = sse2_combine_disjoint_dst_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_OVER] = sse2_combine_disjoint_over_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_OVER_REVERSE] = sse2_combine_disjoint_over_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_IN] = sse2_combine_disjoint_in_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_IN_REVERSE] = sse2_combine_disjoint_in_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_OUT] = sse2_combine_disjoint_out_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_OUT_REVERSE] = sse2_combine_disjoint_out_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_ATOP] = sse2_combine_disjoint_atop_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_ATOP_REVERSE] = sse2_combine_disjoint_atop_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_DISJOINT_XOR] = sse2_combine_disjoint_xor_u_float;
+
+    /* Conjoint, unified */
+    imp->combine_float[PIXMAN_OP_CONJOINT_CLEAR] = sse2_combine_conjoint_clear_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_SRC] = sse2_combine_conjoint_src_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_DST] = sse2_combine_conjoint_dst_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_OVER] = sse2_combine_conjoint_over_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_OVER_REVERSE] = sse2_combine_conjoint_over_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_IN] = sse2_combine_conjoint_in_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_IN_REVERSE] = sse2_combine_conjoint_in_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_OUT] = sse2_combine_conjoint_out_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_OUT_REVERSE] = sse2_combine_conjoint_out_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_ATOP] = sse2_combine_conjoint_atop_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_ATOP_REVERSE] = sse2_combine_conjoint_atop_reverse_u_float;
+    imp->combine_float[PIXMAN_OP_CONJOINT_XOR] = sse2_combine_conjoint_xor_u_float;
+
+    /* PDF operators, unified */
+    imp->combine_float[PIXMAN_OP_MULTIPLY] = sse2_combine_multiply_u_float;
+    imp->combine_float[PIXMAN_OP_SCREEN] = sse2_combine_screen_u_float;
+    imp->combine_float[PIXMAN_OP_OVERLAY] = sse2_combine_overlay_u_float;
+    imp->combine_float[PIXMAN_OP_DARKEN] = sse2_combine_darken_u_float;
+    imp->combine_float[PIXMAN_OP_LIGHTEN] = sse2_combine_lighten_u_float;
+    imp->combine_float[PIXMAN_OP_COLOR_DODGE] = sse2_combine_color_dodge_u_float;
+    imp->combine_float[PIXMAN_OP_COLOR_BURN] = sse2_combine_color_burn_u_float;
+    imp->combine_float[PIXMAN_OP_HARD_LIGHT] = sse2_combine_hard_light_u_float;
+    imp->combine_float[PIXMAN_OP_SOFT_LIGHT] = sse2_combine_soft_light_u_float;
+    imp->combine_float[PIXMAN_OP_DIFFERENCE] = sse2_combine_difference_u_float;
+    imp->combine_float[PIXMAN_OP_EXCLUSION] = sse2_combine_exclusion_u_float;
+
+    /* Component alpha combiners */
+    imp->combine_float_ca[PIXMAN_OP_CLEAR] = sse2_combine_clear_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_SRC] = sse2_combine_src_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DST] = sse2_combine_dst_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_OVER] = sse2_combine_over_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_OVER_REVERSE] = sse2_combine_over_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_IN] = sse2_combine_in_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_IN_REVERSE] = sse2_combine_in_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_OUT] = sse2_combine_out_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_OUT_REVERSE] = sse2_combine_out_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_ATOP] = sse2_combine_atop_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_ATOP_REVERSE] = sse2_combine_atop_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_XOR] = sse2_combine_xor_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_ADD] = sse2_combine_add_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_SATURATE] = sse2_combine_saturate_ca_float;
+
+    /* Disjoint CA */
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_CLEAR] = sse2_combine_disjoint_clear_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_SRC] = sse2_combine_disjoint_src_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_DST] = sse2_combine_disjoint_dst_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_OVER] = sse2_combine_disjoint_over_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_OVER_REVERSE] = sse2_combine_disjoint_over_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_IN] = sse2_combine_disjoint_in_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_IN_REVERSE] = sse2_combine_disjoint_in_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_OUT] = sse2_combine_disjoint_out_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_OUT_REVERSE] = sse2_combine_disjoint_out_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_ATOP] = sse2_combine_disjoint_atop_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_ATOP_REVERSE] = sse2_combine_disjoint_atop_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DISJOINT_XOR] = sse2_combine_disjoint_xor_ca_float;
+
+    /* Conjoint CA */
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_CLEAR] = sse2_combine_conjoint_clear_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_SRC] = sse2_combine_conjoint_src_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_DST] = sse2_combine_conjoint_dst_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_OVER] = sse2_combine_conjoint_over_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_OVER_REVERSE] = sse2_combine_conjoint_over_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_IN] = sse2_combine_conjoint_in_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_IN_REVERSE] = sse2_combine_conjoint_in_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_OUT] = sse2_combine_conjoint_out_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_OUT_REVERSE] = sse2_combine_conjoint_out_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_ATOP] = sse2_combine_conjoint_atop_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_ATOP_REVERSE] = sse2_combine_conjoint_atop_reverse_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_CONJOINT_XOR] = sse2_combine_conjoint_xor_ca_float;
+
+    /* PDF operators CA */
+    imp->combine_float_ca[PIXMAN_OP_MULTIPLY] = sse2_combine_multiply_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_SCREEN] = sse2_combine_screen_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_OVERLAY] = sse2_combine_overlay_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DARKEN] = sse2_combine_darken_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_LIGHTEN] = sse2_combine_lighten_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_COLOR_DODGE] = sse2_combine_color_dodge_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_COLOR_BURN] = sse2_combine_color_burn_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_HARD_LIGHT] = sse2_combine_hard_light_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_SOFT_LIGHT] = sse2_combine_soft_light_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_DIFFERENCE] = sse2_combine_difference_ca_float;
+    imp->combine_float_ca[PIXMAN_OP_EXCLUSION] = sse2_combine_exclusion_ca_float;
+
+    imp->iter_info = sse2_float_iters;
+
+    return imp;
+}
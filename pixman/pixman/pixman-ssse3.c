@@ -319,6 +319,306 @@ fail:
     iter->fini = NULL;
 }
 
+typedef uint32_t (* convert_pixel_t) (const uint8_t *row, int x);
+
+static force_inline uint32_t
+convert_a8r8g8b8 (const uint8_t *row, int x)
+{
+    return *(((uint32_t *)row) + x);
+}
+
+static force_inline uint32_t
+convert_x8r8g8b8 (const uint8_t *row, int x)
+{
+    return *(((uint32_t *)row) + x);
+}
+
+static force_inline uint32_t
+convert_r5g6b5 (const uint8_t *row, int x)
+{
+    return convert_0565_to_0888 (*((uint16_t *)row + x));
+}
+
+static force_inline __m128i
+pixel_pair (uint32_t left, uint32_t right)
+{
+    return _mm_unpacklo_epi32 (_mm_cvtsi32_si128 (left),
+			       _mm_cvtsi32_si128 (right));
+}
+
+/* Fetches the four pixels around (x, y) the same way as
+ * bits_image_fetch_bilinear_affine() in pixman-fast-path.c, as a
+ * (left, right) pair for the top and for the bottom row, and returns
+ * the bilinear weights. Returns FALSE, without setting the pairs, when
+ * all four pixels are outside an image with PIXMAN_REPEAT_NONE.
+ */
+static force_inline pixman_bool_t
+bilinear_affine_corners (bits_image_t        *bits,
+			 pixman_fixed_t       x,
+			 pixman_fixed_t       y,
+			 __m128i             *top,
+			 __m128i             *bottom,
+			 int                 *distx,
+			 int                 *disty,
+			 convert_pixel_t      convert_pixel,
+			 pixman_format_code_t format,
+			 pixman_repeat_t      repeat_mode)
+{
+    uint32_t amask = PIXMAN_FORMAT_A (format)? 0 : 0xff000000;
+    int width = bits->width;
+    int height = bits->height;
+    const uint8_t *row1, *row2;
+    int x1, y1, x2, y2;
+
+    x1 = x - pixman_fixed_1 / 2;
+    y1 = y - pixman_fixed_1 / 2;
+
+    *distx = pixman_fixed_to_bilinear_weight (x1);
+    *disty = pixman_fixed_to_bilinear_weight (y1);
+
+    y1 = pixman_fixed_to_int (y1);
+    y2 = y1 + 1;
+    x1 = pixman_fixed_to_int (x1);
+    x2 = x1 + 1;
+
+    /* All repeat modes agree inside the image */
+    if (x1 >= 0 && x2 < width && y1 >= 0 && y2 < height)
+    {
+	row1 = (uint8_t *)bits->bits + bits->rowstride * 4 * y1;
+	row2 = (uint8_t *)bits->bits + bits->rowstride * 4 * y2;
+
+	if (PIXMAN_FORMAT_BPP (format) == 32)
+	{
+	    __m128i vamask = _mm_set1_epi32 (amask);
+
+	    *top = _mm_or_si128 (
+		_mm_loadl_epi64 ((__m128i *)((uint32_t *)row1 + x1)), vamask);
+	    *bottom = _mm_or_si128 (
+		_mm_loadl_epi64 ((__m128i *)((uint32_t *)row2 + x1)), vamask);
+	}
+	else
+	{
+	    *top = pixel_pair (convert_pixel (row1, x1) | amask,
+			       convert_pixel (row1, x2) | amask);
+	    *bottom = pixel_pair (convert_pixel (row2, x1) | amask,
+				  convert_pixel (row2, x2) | amask);
+	}
+    }
+    else if (repeat_mode != PIXMAN_REPEAT_NONE)
+    {
+	repeat (repeat_mode, &x1, width);
+	repeat (repeat_mode, &y1, height);
+	repeat (repeat_mode, &x2, width);
+	repeat (repeat_mode, &y2, height);
+
+	row1 = (uint8_t *)bits->bits + bits->rowstride * 4 * y1;
+	row2 = (uint8_t *)bits->bits + bits->rowstride * 4 * y2;
+
+	*top = pixel_pair (convert_pixel (row1, x1) | amask,
+			   convert_pixel (row1, x2) | amask);
+	*bottom = pixel_pair (convert_pixel (row2, x1) | amask,
+			      convert_pixel (row2, x2) | amask);
+    }
+    else if (x1 >= width || x2 < 0 || y1 >= height || y2 < 0)
+    {
+	return FALSE;
+    }
+    else
+    {
+	/* Pixels outside the image are transparent black */
+	pixman_bool_t x1_in = x1 >= 0 && x1 < width;
+	pixman_bool_t x2_in = x2 >= 0 && x2 < width;
+	uint32_t tl = 0, tr = 0, bl = 0, br = 0;
+
+	if (y1 >= 0 && y1 < height)
+	{
+	    row1 = (uint8_t *)bits->bits + bits->rowstride * 4 * y1;
+
+	    if (x1_in)
+		tl = convert_pixel (row1, x1) | amask;
+	    if (x2_in)
+		tr = convert_pixel (row1, x2) | amask;
+	}
+
+	if (y2 >= 0 && y2 < height)
+	{
+	    row2 = (uint8_t *)bits->bits + bits->rowstride * 4 * y2;
+
+	    if (x1_in)
+		bl = convert_pixel (row2, x1) | amask;
+	    if (x2_in)
+		br = convert_pixel (row2, x2) | amask;
+	}
+
+	*top = pixel_pair (tl, tr);
+	*bottom = pixel_pair (bl, br);
+    }
+
+    return TRUE;
+}
+
+/* Interpolates two pixels given the (left, right) pairs of their top
+ * and bottom rows.
+ *
+ * bilinear_interpolation() weights the corners with 8 bit distances
+ * that are the 7 bit ones shifted left by one, so its result is the
+ * weighted sum with 7 bit distances shifted right by 14 instead of 16.
+ * That is computed exactly here in two passes: maddubsw interpolates
+ * horizontally into 16 bits, and pmaddwd vertically into 32 bits.
+ */
+static force_inline __m128i
+ssse3_bilinear_interpolate_two (__m128i top0, __m128i bottom0,
+				__m128i top1, __m128i bottom1,
+				int distx0, int disty0,
+				int distx1, int disty1)
+{
+    __m128i wx, wy0, wy1, t, b, r0, r1;
+
+    wx = _mm_packus_epi16 (
+	_mm_set1_epi32 ((distx0 << 16) | (BILINEAR_INTERPOLATION_RANGE - distx0)),
+	_mm_set1_epi32 ((distx1 << 16) | (BILINEAR_INTERPOLATION_RANGE - distx1)));
+    wy0 = _mm_set1_epi32 ((disty0 << 16) | (BILINEAR_INTERPOLATION_RANGE - disty0));
+    wy1 = _mm_set1_epi32 ((disty1 << 16) | (BILINEAR_INTERPOLATION_RANGE - disty1));
+
+    /* t, b: L0 L1 R0 R1 */
+    t = _mm_unpacklo_epi32 (top0, top1);
+    b = _mm_unpacklo_epi32 (bottom0, bottom1);
+
+    /* t, b: l0 r0 for each byte of pixel 0, then the same for pixel 1 */
+    t = _mm_unpacklo_epi8 (t, _mm_srli_si128 (t, 8));
+    b = _mm_unpacklo_epi8 (b, _mm_srli_si128 (b, 8));
+
+    /* A weight of 128 ends up as -128 in a signed byte; see
+     * ssse3_fetch_horizontal() for why the absolute value fixes that.
+     */
+    t = _mm_abs_epi16 (_mm_maddubs_epi16 (t, wx));
+    b = _mm_abs_epi16 (_mm_maddubs_epi16 (b, wx));
+    /* t, b: B0 G0 R0 A0 B1 G1 R1 A1 */
+
+    r0 = _mm_madd_epi16 (_mm_unpacklo_epi16 (t, b), wy0);
+    r1 = _mm_madd_epi16 (_mm_unpackhi_epi16 (t, b), wy1);
+
+    r0 = _mm_srli_epi32 (r0, 2 * BILINEAR_INTERPOLATION_BITS);
+    r1 = _mm_srli_epi32 (r1, 2 * BILINEAR_INTERPOLATION_BITS);
+
+    r0 = _mm_packs_epi32 (r0, r1);
+
+    return _mm_packus_epi16 (r0, r0);
+}
+
+static force_inline void
+ssse3_fetch_bilinear_affine (pixman_iter_t        *iter,
+			     convert_pixel_t       convert_pixel,
+			     pixman_format_code_t  format,
+			     pixman_repeat_t       repeat_mode)
+{
+    pixman_image_t *image = iter->image;
+    bits_image_t *bits = &image->bits;
+    uint32_t *buffer = iter->buffer;
+    int width = iter->width;
+    pixman_fixed_t x, y, ux, uy;
+    pixman_vector_t v;
+    int i;
+
+    /* reference point is the center of the pixel */
+    v.vector[0] = pixman_int_to_fixed (iter->x) + pixman_fixed_1 / 2;
+    v.vector[1] = pixman_int_to_fixed (iter->y) + pixman_fixed_1 / 2;
+    v.vector[2] = pixman_fixed_1;
+
+    if (!pixman_transform_point_3d (image->common.transform, &v))
+	return;
+
+    ux = image->common.transform->matrix[0][0];
+    uy = image->common.transform->matrix[1][0];
+
+    x = v.vector[0];
+    y = v.vector[1];
+
+    for (i = 0; i + 1 < width; i += 2)
+    {
+	__m128i top0, bottom0, top1, bottom1;
+	int distx0, disty0, distx1, disty1;
+	pixman_bool_t in0, in1;
+
+	in0 = bilinear_affine_corners (bits, x, y, &top0, &bottom0,
+				       &distx0, &disty0,
+				       convert_pixel, format, repeat_mode);
+	in1 = bilinear_affine_corners (bits, x + ux, y + uy, &top1, &bottom1,
+				       &distx1, &disty1,
+				       convert_pixel, format, repeat_mode);
+
+	if (in0 || in1)
+	{
+	    if (!in0)
+	    {
+		top0 = bottom0 = _mm_setzero_si128 ();
+		distx0 = disty0 = 0;
+	    }
+	    else if (!in1)
+	    {
+		top1 = bottom1 = _mm_setzero_si128 ();
+		distx1 = disty1 = 0;
+	    }
+
+	    _mm_storel_epi64 ((__m128i *)(buffer + i),
+			      ssse3_bilinear_interpolate_two (
+				  top0, bottom0, top1, bottom1,
+				  distx0, disty0, distx1, disty1));
+	}
+	else
+	{
+	    buffer[i] = buffer[i + 1] = 0;
+	}
+
+	x += 2 * ux;
+	y += 2 * uy;
+    }
+
+    if (i < width)
+    {
+	__m128i top, bottom;
+	int distx, disty;
+
+	if (bilinear_affine_corners (bits, x, y, &top, &bottom, &distx, &disty,
+				     convert_pixel, format, repeat_mode))
+	{
+	    buffer[i] = _mm_cvtsi128_si32 (
+		ssse3_bilinear_interpolate_two (
+		    top, bottom, top, bottom, distx, disty, distx, disty));
+	}
+	else
+	{
+	    buffer[i] = 0;
+	}
+    }
+}
+
+#define MAKE_BILINEAR_FETCHER(name, format, repeat_mode)		\
+    static uint32_t *							\
+    ssse3_fetch_bilinear_affine_ ## name (pixman_iter_t   *iter,	\
+					  const uint32_t * mask)	\
+    {									\
+	ssse3_fetch_bilinear_affine (iter,				\
+				     convert_ ## format,		\
+				     PIXMAN_ ## format,			\
+				     repeat_mode);			\
+	iter->y++;							\
+	return iter->buffer;						\
+    }
+
+MAKE_BILINEAR_FETCHER (pad_a8r8g8b8,     a8r8g8b8, PIXMAN_REPEAT_PAD)
+MAKE_BILINEAR_FETCHER (none_a8r8g8b8,    a8r8g8b8, PIXMAN_REPEAT_NONE)
+MAKE_BILINEAR_FETCHER (reflect_a8r8g8b8, a8r8g8b8, PIXMAN_REPEAT_REFLECT)
+MAKE_BILINEAR_FETCHER (normal_a8r8g8b8,  a8r8g8b8, PIXMAN_REPEAT_NORMAL)
+MAKE_BILINEAR_FETCHER (pad_x8r8g8b8,     x8r8g8b8, PIXMAN_REPEAT_PAD)
+MAKE_BILINEAR_FETCHER (none_x8r8g8b8,    x8r8g8b8, PIXMAN_REPEAT_NONE)
+MAKE_BILINEAR_FETCHER (reflect_x8r8g8b8, x8r8g8b8, PIXMAN_REPEAT_REFLECT)
+MAKE_BILINEAR_FETCHER (normal_x8r8g8b8,  x8r8g8b8, PIXMAN_REPEAT_NORMAL)
+MAKE_BILINEAR_FETCHER (pad_r5g6b5,       r5g6b5,   PIXMAN_REPEAT_PAD)
+MAKE_BILINEAR_FETCHER (none_r5g6b5,      r5g6b5,   PIXMAN_REPEAT_NONE)
+MAKE_BILINEAR_FETCHER (reflect_r5g6b5,   r5g6b5,   PIXMAN_REPEAT_REFLECT)
+MAKE_BILINEAR_FETCHER (normal_r5g6b5,    r5g6b5,   PIXMAN_REPEAT_NORMAL)
+
 static const pixman_iter_info_t ssse3_iters[] = 
 {
     { PIXMAN_a8r8g8b8,
@@ -331,6 +631,33 @@ static const pixman_iter_info_t ssse3_iters[] =
       NULL, NULL
     },
 
+#define BILINEAR_AFFINE_FLAGS						\
+    (FAST_PATH_NO_ALPHA_MAP		|				\
+     FAST_PATH_NO_ACCESSORS		|				\
+     FAST_PATH_HAS_TRANSFORM		|				\
+     FAST_PATH_AFFINE_TRANSFORM		|				\
+     FAST_PATH_BILINEAR_FILTER)
+
+#define BILINEAR_AFFINE_ITER(name, format, repeat)			\
+    { PIXMAN_ ## format,						\
+      BILINEAR_AFFINE_FLAGS | FAST_PATH_ ## repeat ## _REPEAT,		\
+      ITER_NARROW | ITER_SRC,						\
+      NULL, ssse3_fetch_bilinear_affine_ ## name, NULL			\
+    },
+
+    BILINEAR_AFFINE_ITER (pad_a8r8g8b8, a8r8g8b8, PAD)
+    BILINEAR_AFFINE_ITER (none_a8r8g8b8, a8r8g8b8, NONE)
+    BILINEAR_AFFINE_ITER (reflect_a8r8g8b8, a8r8g8b8, REFLECT)
+    BILINEAR_AFFINE_ITER (normal_a8r8g8b8, a8r8g8b8, NORMAL)
+    BILINEAR_AFFINE_ITER (pad_x8r8g8b8, x8r8g8b8, PAD)
+    BILINEAR_AFFINE_ITER (none_x8r8g8b8, x8r8g8b8, NONE)
+    BILINEAR_AFFINE_ITER (reflect_x8r8g8b8, x8r8g8b8, REFLECT)
+    BILINEAR_AFFINE_ITER (normal_x8r8g8b8, x8r8g8b8, NORMAL)
+    BILINEAR_AFFINE_ITER (pad_r5g6b5, r5g6b5, PAD)
+    BILINEAR_AFFINE_ITER (none_r5g6b5, r5g6b5, NONE)
+    BILINEAR_AFFINE_ITER (reflect_r5g6b5, r5g6b5, REFLECT)
+    BILINEAR_AFFINE_ITER (normal_r5g6b5, r5g6b5, NORMAL)
+
     { PIXMAN_null },
 };
 
@@ -0,0 +1,467 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Threaded compositing
+ *
+ * Large composites are cut into bands of whole rows, each about as big
+ * as the L1/L2 cache can hold, and the bands are handed out to a pool of
+ * worker threads that lives as long as the process.  The thread that
+ * called pixman_image_composite32() works on the bands as well and
+ * returns once all of them are done.
+ *
+ * Every composite function computes its source positions from the
+ * destination position of the box it is given, so compositing a box in
+ * bands gives exactly the same pixels as compositing it in one go.
+ *
+ * Threading is off by default.  It is turned on with
+ * pixman_set_composite_threads(), or by setting PIXMAN_THREADS to the
+ * number of threads to use.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include "pixman-private.h"
+
+/* Pixels per band, 64KB worth of a8r8g8b8 */
+#define TILE_PIXELS		16384
+
+/* Composites smaller than this aren't worth waking the workers for */
+#define PARALLEL_MIN_PIXELS	(4 * TILE_PIXELS)
+
+#define MAX_THREADS		64
+
+#if defined(_WIN32)
+
+/* SRW locks and condition variables are Vista and later */
+#   if !defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600
+#   undef _WIN32_WINNT
+#   define _WIN32_WINNT 0x0600
+#   endif
+#   define _NO_W32_PSEUDO_MODIFIERS
+#   include <windows.h>
+#ifdef IN
+#undef IN
+#endif
+
+typedef SRWLOCK pixman_mutex_t;
+typedef CONDITION_VARIABLE pixman_cond_t;
+
+#   define PIXMAN_MUTEX_INITIALIZER	SRWLOCK_INIT
+#   define PIXMAN_COND_INITIALIZER	CONDITION_VARIABLE_INIT
+#   define mutex_lock(m)		AcquireSRWLockExclusive (m)
+#   define mutex_unlock(m)		ReleaseSRWLockExclusive (m)
+#   define cond_wait(c, m)		SleepConditionVariableSRW (c, m, INFINITE, 0)
+#   define cond_signal(c)		WakeConditionVariable (c)
+#   define cond_broadcast(c)		WakeAllConditionVariable (c)
+
+#   define HAVE_COMPOSITE_THREADS
+
+#elif defined(HAVE_PTHREADS)
+
+#   include <pthread.h>
+
+typedef pthread_mutex_t pixman_mutex_t;
+typedef pthread_cond_t pixman_cond_t;
+
+#   define PIXMAN_MUTEX_INITIALIZER	PTHREAD_MUTEX_INITIALIZER
+#   define PIXMAN_COND_INITIALIZER	PTHREAD_COND_INITIALIZER
+#   define mutex_lock(m)		pthread_mutex_lock (m)
+#   define mutex_unlock(m)		pthread_mutex_unlock (m)
+#   define cond_wait(c, m)		pthread_cond_wait (c, m)
+#   define cond_signal(c)		pthread_cond_signal (c)
+#   define cond_broadcast(c)		pthread_cond_broadcast (c)
+
+#   define HAVE_COMPOSITE_THREADS
+
+#endif
+
+#ifdef HAVE_COMPOSITE_THREADS
+
+typedef struct
+{
+    pixman_implementation_t *	imp;
+    pixman_composite_func_t	func;
+    const pixman_composite_info_t *info;
+    const pixman_box32_t *	boxes;
+    int				n_boxes;
+    int32_t			src_dx, src_dy;
+    int32_t			mask_dx, mask_dy;
+
+    /* The next band to hand out */
+    int				box;
+    int32_t			y;
+} job_t;
+
+typedef struct
+{
+    pixman_mutex_t	lock;
+    pixman_cond_t	work;		/* a new job was posted */
+    pixman_cond_t	done;		/* the last worker left a job */
+
+    int			n_threads;	/* -1 until PIXMAN_THREADS was read */
+    int			n_workers;	/* worker threads started */
+    job_t *		job;
+    unsigned int	serial;		/* bumped for every job */
+    int			active;		/* workers inside the job */
+} pool_t;
+
+static pool_t pool =
+{
+    PIXMAN_MUTEX_INITIALIZER,
+    PIXMAN_COND_INITIALIZER,
+    PIXMAN_COND_INITIALIZER,
+    -1
+};
+
+/* Takes the next band of the job, with the pool locked. */
+static pixman_bool_t
+next_band (job_t *job, pixman_box32_t *band)
+{
+    const pixman_box32_t *box;
+    int32_t height;
+
+    if (job->box == job->n_boxes)
+	return FALSE;
+
+    box = &job->boxes[job->box];
+
+    height = TILE_PIXELS / (box->x2 - box->x1);
+    if (height < 1)
+	height = 1;
+    if (height > box->y2 - job->y)
+	height = box->y2 - job->y;
+
+    band->x1 = box->x1;
+    band->x2 = box->x2;
+    band->y1 = job->y;
+    band->y2 = job->y + height;
+
+    job->y += height;
+    if (job->y == box->y2 && ++job->box < job->n_boxes)
+	job->y = job->boxes[job->box].y1;
+
+    return TRUE;
+}
+
+static void
+composite_band (job_t *job, const pixman_box32_t *band)
+{
+    pixman_composite_info_t info = *job->info;
+
+    info.src_x = band->x1 + job->src_dx;
+    info.src_y = band->y1 + job->src_dy;
+    info.mask_x = band->x1 + job->mask_dx;
+    info.mask_y = band->y1 + job->mask_dy;
+    info.dest_x = band->x1;
+    info.dest_y = band->y1;
+    info.width = band->x2 - band->x1;
+    info.height = band->y2 - band->y1;
+
+    job->func (job->imp, &info);
+}
+
+/* Runs bands until there are none left, with the pool locked. */
+static void
+run_job (job_t *job)
+{
+    pixman_box32_t band;
+
+    while (next_band (job, &band))
+    {
+	mutex_unlock (&pool.lock);
+	composite_band (job, &band);
+	mutex_lock (&pool.lock);
+    }
+}
+
+static void
+worker_main (int index)
+{
+    unsigned int serial = 0;
+
+    mutex_lock (&pool.lock);
+
+    for (;;)
+    {
+	while (pool.serial == serial)
+	    cond_wait (&pool.work, &pool.lock);
+
+	serial = pool.serial;
+
+	/* Workers beyond the thread count stay out, and a job may
+	 * already be finished by the time a worker wakes up.
+	 */
+	if (!pool.job || index >= pool.n_threads - 1)
+	    continue;
+
+	pool.active++;
+	run_job (pool.job);
+	if (--pool.active == 0)
+	    cond_signal (&pool.done);
+    }
+}
+
+#if defined(_WIN32)
+
+static DWORD WINAPI
+worker_thread (LPVOID data)
+{
+    worker_main ((int)(intptr_t)data);
+    return 0;
+}
+
+static pixman_bool_t
+start_worker (int index)
+{
+    HANDLE thread = CreateThread (
+	NULL, 0, worker_thread, (LPVOID)(intptr_t)index, 0, NULL);
+
+    if (!thread)
+	return FALSE;
+
+    CloseHandle (thread);
+    return TRUE;
+}
+
+#else
+
+static void *
+worker_thread (void *data)
+{
+    worker_main ((int)(intptr_t)data);
+    return NULL;
+}
+
+static pixman_bool_t
+start_worker (int index)
+{
+    pthread_t thread;
+
+    if (pthread_create (&thread, NULL, worker_thread, (void *)(intptr_t)index))
+	return FALSE;
+
+    pthread_detach (thread);
+    return TRUE;
+}
+
+#endif
+
+/* With the pool locked */
+static int
+get_n_threads (void)
+{
+    if (pool.n_threads < 0)
+    {
+	const char *env = getenv ("PIXMAN_THREADS");
+
+	pool.n_threads = env ? atoi (env) : 0;
+	if (pool.n_threads < 0)
+	    pool.n_threads = 0;
+	if (pool.n_threads > MAX_THREADS)
+	    pool.n_threads = MAX_THREADS;
+    }
+
+    return pool.n_threads;
+}
+
+static void
+get_bits_range (pixman_image_t *image, uint32_t **start, uint32_t **end)
+{
+    bits_image_t *bits = &image->bits;
+
+    if (bits->rowstride >= 0)
+    {
+	*start = bits->bits;
+	*end = bits->bits + bits->rowstride * bits->height;
+    }
+    else
+    {
+	*start = bits->bits + bits->rowstride * (bits->height - 1);
+	*end = bits->bits - bits->rowstride;
+    }
+}
+
+/* Whether writing to dest could change what is read from image */
+static pixman_bool_t
+overlaps_dest (pixman_image_t *image, pixman_image_t *dest)
+{
+    uint32_t *start, *end, *dest_start, *dest_end;
+
+    if (!image || image->type != BITS)
+	return FALSE;
+
+    if (image->common.alpha_map &&
+	overlaps_dest ((pixman_image_t *)image->common.alpha_map, dest))
+    {
+	return TRUE;
+    }
+
+    get_bits_range (image, &start, &end);
+    get_bits_range (dest, &dest_start, &dest_end);
+
+    return start < dest_end && dest_start < end;
+}
+
+pixman_bool_t
+_pixman_composite_parallel (pixman_implementation_t *      imp,
+			    pixman_composite_func_t        func,
+			    const pixman_composite_info_t *info,
+			    const pixman_box32_t *         boxes,
+			    int                            n_boxes,
+			    int32_t                        src_dx,
+			    int32_t                        src_dy,
+			    int32_t                        mask_dx,
+			    int32_t                        mask_dy)
+{
+    job_t job;
+    int64_t pixels;
+    int n_threads;
+    int i;
+
+    /* Read without the lock; an out of date value only means that one
+     * composite runs the old way.
+     */
+    if (pool.n_threads >= 0 && pool.n_threads < 2)
+	return FALSE;
+
+    pixels = 0;
+    for (i = 0; i < n_boxes; i++)
+    {
+	pixels += (int64_t)(boxes[i].x2 - boxes[i].x1) *
+	    (boxes[i].y2 - boxes[i].y1);
+    }
+
+    if (pixels < PARALLEL_MIN_PIXELS)
+	return FALSE;
+
+    /* Accessors are application code that may not expect to be
+     * called from several threads at once.
+     */
+    if (!(info->src_image->common.flags & FAST_PATH_NO_ACCESSORS)	||
+	(info->mask_image &&
+	 !(info->mask_image->common.flags & FAST_PATH_NO_ACCESSORS))	||
+	!(info->dest_image->common.flags & FAST_PATH_NO_ACCESSORS)	||
+	info->dest_image->common.alpha_map)
+    {
+	return FALSE;
+    }
+
+    if (overlaps_dest (info->src_image, info->dest_image) ||
+	overlaps_dest (info->mask_image, info->dest_image))
+    {
+	return FALSE;
+    }
+
+    mutex_lock (&pool.lock);
+
+    n_threads = get_n_threads ();
+
+    /* Only one threaded composite at a time; anyone else, including a
+     * composite function that composites, does its own work.
+     */
+    if (n_threads < 2 || pool.job)
+    {
+	mutex_unlock (&pool.lock);
+	return FALSE;
+    }
+
+    while (pool.n_workers < n_threads - 1)
+    {
+	if (!start_worker (pool.n_workers))
+	    break;
+	pool.n_workers++;
+    }
+
+    if (pool.n_workers == 0)
+    {
+	mutex_unlock (&pool.lock);
+	return FALSE;
+    }
+
+    job.imp = imp;
+    job.func = func;
+    job.info = info;
+    job.boxes = boxes;
+    job.n_boxes = n_boxes;
+    job.src_dx = src_dx;
+    job.src_dy = src_dy;
+    job.mask_dx = mask_dx;
+    job.mask_dy = mask_dy;
+    job.box = 0;
+    job.y = boxes[0].y1;
+
+    pool.job = &job;
+    pool.serial++;
+    cond_broadcast (&pool.work);
+
+    run_job (&job);
+
+    while (pool.active)
+	cond_wait (&pool.done, &pool.lock);
+
+    pool.job = NULL;
+
+    mutex_unlock (&pool.lock);
+
+    return TRUE;
+}
+
+PIXMAN_EXPORT void
+pixman_set_composite_threads (int n_threads)
+{
+    if (n_threads < 0)
+	n_threads = 0;
+    if (n_threads > MAX_THREADS)
+	n_threads = MAX_THREADS;
+
+    mutex_lock (&pool.lock);
+    pool.n_threads = n_threads;
+    mutex_unlock (&pool.lock);
+}
+
+#else /* !HAVE_COMPOSITE_THREADS */
+
+pixman_bool_t
+_pixman_composite_parallel (pixman_implementation_t *      imp,
+			    pixman_composite_func_t        func,
+			    const pixman_composite_info_t *info,
+			    const pixman_box32_t *         boxes,
+			    int                            n_boxes,
+			    int32_t                        src_dx,
+			    int32_t                        src_dy,
+			    int32_t                        mask_dx,
+			    int32_t                        mask_dy)
+{
+    return FALSE;
+}
+
+PIXMAN_EXPORT void
+pixman_set_composite_threads (int n_threads)
+{
+}
+
+#endif
@@ -27,8 +27,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pixman-private.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRAP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 /*
  * Compute the smallest value greater than or equal to y which is on a
  * grid row.
@@ -286,6 +293,530 @@ pixman_add_traps (pixman_image_t *     image,
     }
 }
 
+/*
+ * One pass rasterization of a list of trapezoids into an a8 image.
+ *
+ * pixman_rasterize_trapezoid() walks the sample grid of one trapezoid
+ * and adds the coverage of each sample row straight into the image.
+ * Here all the trapezoids are walked together, one pixel row at a time,
+ * and each sample row span is recorded as four entries in a row of
+ * cells:
+ *
+ *     cells[lxi]     += N_X_FRAC - lxs
+ *     cells[lxi + 1] += lxs
+ *     cells[rxi]     -= N_X_FRAC - rxs
+ *     cells[rxi + 1] -= rxs
+ *
+ * so that the running sum of the cells is the coverage the span adds to
+ * each pixel.  When all the trapezoids have been stepped across the
+ * row, the running sum is clamped and added to the image in one go.
+ *
+ * Coverage only ever increases and is clamped at 255, so adding it up
+ * first gives exactly the same pixels as adding it one span at a time.
+ *
+ * The edges of the trapezoids that cross the current row are kept in
+ * columns, so that with SSE2 four trapezoids are stepped at once.
+ */
+#define N_FIELDS 18
+
+typedef struct
+{
+    int32_t *	x;
+    int32_t *	e;
+    int32_t *	stepx_small;
+    int32_t *	dx_small;
+    int32_t *	stepx_big;
+    int32_t *	dx_big;
+    int32_t *	dy;
+    int32_t *	signdx;
+} edge_columns_t;
+
+typedef struct
+{
+    edge_columns_t	l, r;
+    /* Next sample row, and last sample row, of each trapezoid */
+    int32_t *		y;
+    int32_t *		b;
+    int			n;
+} active_traps_t;
+
+/* Marks a trapezoid as finished */
+#define Y_DONE INT32_MAX
+
+typedef struct
+{
+    pixman_edge_t	l, r;
+    pixman_fixed_t	t, b;
+} trap_edges_t;
+
+static int
+compare_trap_edges (const void *a, const void *b)
+{
+    pixman_fixed_t ta = ((const trap_edges_t *)a)->t;
+    pixman_fixed_t tb = ((const trap_edges_t *)b)->t;
+
+    return (ta > tb) - (ta < tb);
+}
+
+static void
+set_edge (edge_columns_t *c, int i, const pixman_edge_t *e)
+{
+    c->x[i] = e->x;
+    c->e[i] = e->e;
+    c->stepx_small[i] = e->stepx_small;
+    c->dx_small[i] = e->dx_small;
+    c->stepx_big[i] = e->stepx_big;
+    c->dx_big[i] = e->dx_big;
+    c->dy[i] = e->dy;
+    c->signdx[i] = e->signdx;
+}
+
+static void
+move_edge (edge_columns_t *c, int to, int from)
+{
+    c->x[to] = c->x[from];
+    c->e[to] = c->e[from];
+    c->stepx_small[to] = c->stepx_small[from];
+    c->dx_small[to] = c->dx_small[from];
+    c->stepx_big[to] = c->stepx_big[from];
+    c->dx_big[to] = c->dx_big[from];
+    c->dy[to] = c->dy[from];
+    c->signdx[to] = c->signdx[from];
+}
+
+static force_inline void
+add_span (int32_t *cells, int lxi, int lxs, int rxi, int rxs,
+	  int *x_min, int *x_max)
+{
+    cells[lxi] += N_X_FRAC (8) - lxs;
+    cells[lxi + 1] += lxs;
+    cells[rxi] -= N_X_FRAC (8) - rxs;
+    cells[rxi + 1] -= rxs;
+
+    if (lxi < *x_min)
+	*x_min = lxi;
+    if (rxi > *x_max)
+	*x_max = rxi;
+}
+
+#ifdef TRAP_USE_SSE2
+
+static force_inline __m128i
+select_epi32 (__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128 (_mm_and_si128 (mask, a), _mm_andnot_si128 (mask, b));
+}
+
+/* RENDER_SAMPLES_X (x, 8).  The quotient is below 18 and the division is
+ * correctly rounded, so truncating the float quotient is exact.
+ */
+static force_inline __m128i
+samples_x_8 (__m128i x)
+{
+    __m128i f = _mm_add_epi32 (_mm_and_si128 (x, _mm_set1_epi32 (0xffff)),
+			       _mm_set1_epi32 (X_FRAC_FIRST (8)));
+
+    return _mm_cvttps_epi32 (_mm_div_ps (_mm_cvtepi32_ps (f),
+					 _mm_set1_ps (STEP_X_SMALL (8))));
+}
+
+static force_inline void
+step_edges (__m128i *x, __m128i *e, __m128i stepx, __m128i dx, __m128i dy,
+	    __m128i signdx, __m128i live)
+{
+    __m128i carry;
+
+    *x = _mm_add_epi32 (*x, _mm_and_si128 (live, stepx));
+    *e = _mm_add_epi32 (*e, _mm_and_si128 (live, dx));
+
+    carry = _mm_and_si128 (live, _mm_cmpgt_epi32 (*e, _mm_setzero_si128 ()));
+    *e = _mm_sub_epi32 (*e, _mm_and_si128 (carry, dy));
+    *x = _mm_add_epi32 (*x, _mm_and_si128 (carry, signdx));
+}
+
+#define LOAD(p) _mm_loadu_si128 ((const __m128i *)(p))
+
+static void
+walk_row (active_traps_t *active, int32_t *cells, pixman_fixed_t row,
+	  int width, int *x_min, int *x_max)
+{
+    edge_columns_t *l = &active->l;
+    edge_columns_t *r = &active->r;
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i max_rx = _mm_set1_epi32 (pixman_int_to_fixed (width) - 1);
+    const __m128i last_pixel = _mm_set1_epi32 (width - 1);
+    int i, j, k;
+
+    for (i = 0; i < active->n; i += 4)
+    {
+	__m128i lane = _mm_add_epi32 (_mm_set1_epi32 (i),
+				      _mm_setr_epi32 (0, 1, 2, 3));
+	__m128i valid = _mm_cmplt_epi32 (lane, _mm_set1_epi32 (active->n));
+	__m128i lx = LOAD (l->x + i), le = LOAD (l->e + i);
+	__m128i rx = LOAD (r->x + i), re = LOAD (r->e + i);
+	__m128i y = LOAD (active->y + i), b = LOAD (active->b + i);
+	__m128i l_dy = LOAD (l->dy + i), l_signdx = LOAD (l->signdx + i);
+	__m128i r_dy = LOAD (r->dy + i), r_signdx = LOAD (r->signdx + i);
+	pixman_fixed_t sample_y = row + Y_FRAC_FIRST (8);
+
+	for (j = 0; j < N_Y_FRAC (8); ++j, sample_y += STEP_Y_SMALL (8))
+	{
+	    __m128i live, done, span, cx1, cx2, lxi, lxs, rxi, rxs;
+	    int32_t a_lxi[4], a_lxs[4], a_rxi[4], a_rxs[4];
+	    int bits;
+
+	    live = _mm_and_si128 (
+		valid, _mm_cmpeq_epi32 (y, _mm_set1_epi32 (sample_y)));
+	    if (!_mm_movemask_epi8 (live))
+		continue;
+
+	    /* clip X, the same way as rasterize_edges_8() */
+	    cx1 = select_epi32 (_mm_cmplt_epi32 (lx, zero), zero, lx);
+	    cx2 = select_epi32 (
+		_mm_cmpgt_epi32 (_mm_srai_epi32 (rx, 16), last_pixel),
+		max_rx, rx);
+
+	    span = _mm_and_si128 (live, _mm_cmpgt_epi32 (cx2, cx1));
+	    bits = _mm_movemask_ps (_mm_castsi128_ps (span));
+
+	    if (bits)
+	    {
+		lxi = _mm_srai_epi32 (cx1, 16);
+		rxi = _mm_srai_epi32 (cx2, 16);
+		lxs = samples_x_8 (cx1);
+		rxs = samples_x_8 (cx2);
+
+		_mm_storeu_si128 ((__m128i *)a_lxi, lxi);
+		_mm_storeu_si128 ((__m128i *)a_lxs, lxs);
+		_mm_storeu_si128 ((__m128i *)a_rxi, rxi);
+		_mm_storeu_si128 ((__m128i *)a_rxs, rxs);
+
+		for (k = 0; k < 4; ++k)
+		{
+		    if (bits & (1 << k))
+		    {
+			add_span (cells, a_lxi[k], a_lxs[k], a_rxi[k], a_rxs[k],
+				  x_min, x_max);
+		    }
+		}
+	    }
+
+	    done = _mm_and_si128 (live, _mm_cmpeq_epi32 (y, b));
+	    live = _mm_andnot_si128 (done, live);
+
+	    if (j < N_Y_FRAC (8) - 1)
+	    {
+		step_edges (&lx, &le, LOAD (l->stepx_small + i),
+			    LOAD (l->dx_small + i), l_dy, l_signdx, live);
+		step_edges (&rx, &re, LOAD (r->stepx_small + i),
+			    LOAD (r->dx_small + i), r_dy, r_signdx, live);
+		y = _mm_add_epi32 (
+		    y, _mm_and_si128 (live, _mm_set1_epi32 (STEP_Y_SMALL (8))));
+	    }
+	    else
+	    {
+		step_edges (&lx, &le, LOAD (l->stepx_big + i),
+			    LOAD (l->dx_big + i), l_dy, l_signdx, live);
+		step_edges (&rx, &re, LOAD (r->stepx_big + i),
+			    LOAD (r->dx_big + i), r_dy, r_signdx, live);
+		y = _mm_add_epi32 (
+		    y, _mm_and_si128 (live, _mm_set1_epi32 (STEP_Y_BIG (8))));
+	    }
+
+	    y = select_epi32 (done, _mm_set1_epi32 (Y_DONE), y);
+	}
+
+	_mm_storeu_si128 ((__m128i *)(l->x + i), lx);
+	_mm_storeu_si128 ((__m128i *)(l->e + i), le);
+	_mm_storeu_si128 ((__m128i *)(r->x + i), rx);
+	_mm_storeu_si128 ((__m128i *)(r->e + i), re);
+	_mm_storeu_si128 ((__m128i *)(active->y + i), y);
+    }
+}
+
+#undef LOAD
+
+#else
+
+#define STEP_EDGE(c, i, size)						\
+    {									\
+	c->x[i] += c->stepx_ ## size[i];				\
+	c->e[i] += c->dx_ ## size[i];					\
+	if (c->e[i] > 0)						\
+	{								\
+	    c->e[i] -= c->dy[i];					\
+	    c->x[i] += c->signdx[i];					\
+	}								\
+    }
+
+static void
+walk_row (active_traps_t *active, int32_t *cells, pixman_fixed_t row,
+	  int width, int *x_min, int *x_max)
+{
+    edge_columns_t *l = &active->l;
+    edge_columns_t *r = &active->r;
+    int i;
+
+    for (i = 0; i < active->n; ++i)
+    {
+	while (pixman_fixed_to_int (active->y[i]) == pixman_fixed_to_int (row))
+	{
+	    pixman_fixed_t lx = l->x[i];
+	    pixman_fixed_t rx = r->x[i];
+
+	    /* clip X, the same way as rasterize_edges_8() */
+	    if (lx < 0)
+		lx = 0;
+	    if (pixman_fixed_to_int (rx) >= width)
+		rx = pixman_int_to_fixed (width) - 1;
+
+	    if (rx > lx)
+	    {
+		add_span (cells,
+			  pixman_fixed_to_int (lx), RENDER_SAMPLES_X (lx, 8),
+			  pixman_fixed_to_int (rx), RENDER_SAMPLES_X (rx, 8),
+			  x_min, x_max);
+	    }
+
+	    if (active->y[i] == active->b[i])
+	    {
+		active->y[i] = Y_DONE;
+	    }
+	    else if (pixman_fixed_frac (active->y[i]) != Y_FRAC_LAST (8))
+	    {
+		STEP_EDGE (l, i, small);
+		STEP_EDGE (r, i, small);
+		active->y[i] += STEP_Y_SMALL (8);
+	    }
+	    else
+	    {
+		STEP_EDGE (l, i, big);
+		STEP_EDGE (r, i, big);
+		active->y[i] += STEP_Y_BIG (8);
+	    }
+	}
+    }
+}
+
+#undef STEP_EDGE
+
+#endif
+
+/* Adds the running sum of cells[x1, x2) to line[x1, x2), and clears
+ * the cells.
+ */
+static void
+resolve_row (uint8_t *line, int32_t *cells, int x1, int x2)
+{
+    int32_t sum = 0;
+    int x = x1;
+
+#ifdef TRAP_USE_SSE2
+    __m128i carry = _mm_setzero_si128 ();
+
+    while (x + 4 <= x2)
+    {
+	__m128i c = _mm_loadu_si128 ((__m128i *)(cells + x));
+	__m128i p;
+	uint32_t pixels;
+
+	c = _mm_add_epi32 (c, _mm_slli_si128 (c, 4));
+	c = _mm_add_epi32 (c, _mm_slli_si128 (c, 8));
+	c = _mm_add_epi32 (c, carry);
+	carry = _mm_shuffle_epi32 (c, _MM_SHUFFLE (3, 3, 3, 3));
+
+	p = _mm_packs_epi32 (c, c);
+	p = _mm_packus_epi16 (p, p);
+	memcpy (&pixels, line + x, 4);
+	p = _mm_adds_epu8 (p, _mm_cvtsi32_si128 (pixels));
+	pixels = _mm_cvtsi128_si32 (p);
+	memcpy (line + x, &pixels, 4);
+
+	_mm_storeu_si128 ((__m128i *)(cells + x), _mm_setzero_si128 ());
+	x += 4;
+    }
+
+    sum = _mm_cvtsi128_si32 (carry);
+#endif
+
+    while (x < x2)
+    {
+	int v;
+
+	sum += cells[x];
+	cells[x] = 0;
+
+	v = line[x] + sum;
+	line[x] = v > 255 ? 255 : v;
+	x++;
+    }
+}
+
+/*
+ * Rasterizes the valid trapezoids in traps into image, which must be
+ * an a8 image without accessors.  Returns FALSE if it could not, in
+ * which case nothing has been drawn.
+ */
+static pixman_bool_t
+rasterize_trapezoids_a8 (pixman_image_t *          image,
+			 const pixman_trapezoid_t *traps,
+			 int                       n_traps,
+			 int                       x_off,
+			 int                       y_off)
+{
+    int width = image->bits.width;
+    int height = image->bits.height;
+    pixman_fixed_t y_off_fixed = pixman_int_to_fixed (y_off);
+    active_traps_t active;
+    trap_edges_t *edges;
+    int32_t *columns;
+    int32_t *cells;
+    int n_edges, next, stride;
+    int i, y;
+
+    if (image->bits.format != PIXMAN_a8		||
+	image->bits.read_func || image->bits.write_func)
+    {
+	return FALSE;
+    }
+
+    /* Columns are padded so that the last group of four can be loaded */
+    stride = (n_traps + 3) & ~3;
+
+    edges = pixman_malloc_ab (n_traps, sizeof (trap_edges_t));
+    columns = pixman_malloc_abc (N_FIELDS, stride, sizeof (int32_t));
+    /* One cell past the last pixel, for rxi + 1 */
+    cells = pixman_malloc_ab (width + 1, sizeof (int32_t));
+
+    if (!edges || !columns || !cells)
+    {
+	free (edges);
+	free (columns);
+	free (cells);
+	return FALSE;
+    }
+
+    memset (columns, 0, N_FIELDS * stride * sizeof (int32_t));
+    memset (cells, 0, (width + 1) * sizeof (int32_t));
+
+#define COLUMN(n) (columns + (n) * stride)
+    active.l.x = COLUMN (0);
+    active.l.e = COLUMN (1);
+    active.l.stepx_small = COLUMN (2);
+    active.l.dx_small = COLUMN (3);
+    active.l.stepx_big = COLUMN (4);
+    active.l.dx_big = COLUMN (5);
+    active.l.dy = COLUMN (6);
+    active.l.signdx = COLUMN (7);
+    active.r.x = COLUMN (8);
+    active.r.e = COLUMN (9);
+    active.r.stepx_small = COLUMN (10);
+    active.r.dx_small = COLUMN (11);
+    active.r.stepx_big = COLUMN (12);
+    active.r.dx_big = COLUMN (13);
+    active.r.dy = COLUMN (14);
+    active.r.signdx = COLUMN (15);
+    active.y = COLUMN (16);
+    active.b = COLUMN (17);
+    active.n = 0;
+#undef COLUMN
+
+    /* Same setup as pixman_rasterize_trapezoid() */
+    n_edges = 0;
+    for (i = 0; i < n_traps; ++i)
+    {
+	const pixman_trapezoid_t *trap = &traps[i];
+	trap_edges_t *e = &edges[n_edges];
+	pixman_fixed_t t, b;
+
+	if (!pixman_trapezoid_valid (trap))
+	    continue;
+
+	t = trap->top + y_off_fixed;
+	if (t < 0)
+	    t = 0;
+	t = pixman_sample_ceil_y (t, 8);
+
+	b = trap->bottom + y_off_fixed;
+	if (pixman_fixed_to_int (b) >= height)
+	    b = pixman_int_to_fixed (height) - 1;
+	b = pixman_sample_floor_y (b, 8);
+
+	if (b < t)
+	    continue;
+
+	pixman_line_fixed_edge_init (&e->l, 8, t, &trap->left, x_off, y_off);
+	pixman_line_fixed_edge_init (&e->r, 8, t, &trap->right, x_off, y_off);
+	e->t = t;
+	e->b = b;
+
+	n_edges++;
+    }
+
+    qsort (edges, n_edges, sizeof (trap_edges_t), compare_trap_edges);
+
+    next = 0;
+    y = n_edges ? pixman_fixed_to_int (edges[0].t) : height;
+
+    while (y < height && (active.n || next < n_edges))
+    {
+	uint8_t *line;
+	int x_min = width, x_max = -1;
+
+	if (!active.n && pixman_fixed_to_int (edges[next].t) > y)
+	    y = pixman_fixed_to_int (edges[next].t);
+
+	line = (uint8_t *)(image->bits.bits + y * image->bits.rowstride);
+
+	while (next < n_edges && pixman_fixed_to_int (edges[next].t) == y)
+	{
+	    set_edge (&active.l, active.n, &edges[next].l);
+	    set_edge (&active.r, active.n, &edges[next].r);
+	    active.y[active.n] = edges[next].t;
+	    active.b[active.n] = edges[next].b;
+	    active.n++;
+	    next++;
+	}
+
+	walk_row (&active, cells, pixman_int_to_fixed (y), width,
+		  &x_min, &x_max);
+
+	if (x_min <= x_max)
+	    resolve_row (line, cells, x_min, x_max + 1);
+
+	/* The running sum is zero again at x_max + 1 */
+	cells[x_max + 1] = 0;
+
+	/* Drop the trapezoids that are finished */
+	for (i = 0; i < active.n; )
+	{
+	    if (active.y[i] == Y_DONE)
+	    {
+		active.n--;
+		move_edge (&active.l, i, active.n);
+		move_edge (&active.r, i, active.n);
+		active.y[i] = active.y[active.n];
+		active.b[i] = active.b[active.n];
+	    }
+	    else
+	    {
+		i++;
+	    }
+	}
+
+	y++;
+    }
+
+    free (edges);
+    free (columns);
+    free (cells);
+
+    return TRUE;
+}
+
+#undef Y_DONE
+#undef N_FIELDS
+
 #if 0
 static void
 dump_image (pixman_image_t *image,
@@ -327,6 +858,16 @@ pixman_add_trapezoids (pixman_image_t *          image,
     dump_image (image, "before");
 #endif
 
+    return_if_fail (image->type == BITS);
+
+    _pixman_image_validate (image);
+
+    if (ntraps <= 0 ||
+	rasterize_trapezoids_a8 (image, traps, ntraps, x_off, y_off))
+    {
+	return;
+    }
+
     for (i = 0; i < ntraps; ++i)
     {
 	const pixman_trapezoid_t *trap = &(traps[i]);
@@ -504,6 +1045,9 @@ pixman_composite_trapezoids (pixman_op_t		op,
 	(mask_format == dst->common.extended_format_code)	&&
 	!(dst->common.have_clip_region))
     {
+	if (rasterize_trapezoids_a8 (dst, traps, n_traps, x_dst, y_dst))
+	    return;
+
 	for (i = 0; i < n_traps; ++i)
 	{
 	    const pixman_trapezoid_t *trap = &(traps[i]);
@@ -527,14 +1071,17 @@ pixman_composite_trapezoids (pixman_op_t		op,
 		  mask_format, box.x2 - box.x1, box.y2 - box.y1, NULL, -1)))
 	    return;
 	
-	for (i = 0; i < n_traps; ++i)
+	if (!rasterize_trapezoids_a8 (tmp, traps, n_traps, - box.x1, - box.y1))
 	{
-	    const pixman_trapezoid_t *trap = &(traps[i]);
-	    
-	    if (!pixman_trapezoid_valid (trap))
-		continue;
-	    
-	    pixman_rasterize_trapezoid (tmp, trap, - box.x1, - box.y1);
+	    for (i = 0; i < n_traps; ++i)
+	    {
+		const pixman_trapezoid_t *trap = &(traps[i]);
+
+		if (!pixman_trapezoid_valid (trap))
+		    continue;
+
+		pixman_rasterize_trapezoid (tmp, trap, - box.x1, - box.y1);
+	    }
 	}
 	
 	pixman_image_composite (op, src, tmp, dst,
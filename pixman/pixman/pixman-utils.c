@@ -30,6 +30,16 @@
 
 #include "pixman-private.h"
 
+#if defined(_WIN32)
+#   define _NO_W32_PSEUDO_MODIFIERS
+#   include <windows.h>
+#ifdef IN
+#undef IN
+#endif
+#elif defined(HAVE_PTHREADS)
+#   include <pthread.h>
+#endif
+
 pixman_bool_t
 _pixman_multiply_overflows_size (size_t a, size_t b)
 {
@@ -57,6 +67,124 @@ pixman_malloc_ab_plus_c (unsigned int a, unsigned int b, unsigned int c)
     return malloc (a * b + c);
 }
 
+/*
+ * Scanline buffers that are too big for the stack are kept around, one
+ * per thread, so that wide composites, such as full screen ones on
+ * large displays, don't go through malloc() every time.  Sizes are
+ * rounded up to a power of two so that composites of about the same
+ * width share a buffer.
+ */
+#define MIN_POOLED_SCANLINE_BUFFER	(1 << 15)
+#define MAX_POOLED_SCANLINE_BUFFER	(1 << 21)
+
+typedef struct
+{
+    uint8_t *		buffer;
+    size_t		size;
+    pixman_bool_t	in_use;
+} scanline_pool_t;
+
+PIXMAN_DEFINE_THREAD_LOCAL (scanline_pool_t, scanline_pool);
+
+/* Arranges for the pooled buffer to be freed when its thread exits */
+#if defined(_WIN32)
+
+static void WINAPI
+free_pooled_buffer (void *buffer)
+{
+    free (buffer);
+}
+
+static void
+set_pooled_buffer (uint8_t *buffer)
+{
+    static volatile LONG index = FLS_OUT_OF_INDEXES;
+
+    if (index == FLS_OUT_OF_INDEXES)
+    {
+	DWORD i = FlsAlloc (free_pooled_buffer);
+
+	if (i != FLS_OUT_OF_INDEXES &&
+	    InterlockedCompareExchange (&index, i, FLS_OUT_OF_INDEXES) !=
+	    FLS_OUT_OF_INDEXES)
+	{
+	    FlsFree (i);
+	}
+    }
+
+    if (index != FLS_OUT_OF_INDEXES)
+	FlsSetValue (index, buffer);
+}
+
+#elif defined(HAVE_PTHREADS)
+
+static pthread_once_t pooled_buffer_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pooled_buffer_key;
+
+static void
+make_pooled_buffer_key (void)
+{
+    pthread_key_create (&pooled_buffer_key, free);
+}
+
+static void
+set_pooled_buffer (uint8_t *buffer)
+{
+    if (pthread_once (&pooled_buffer_once, make_pooled_buffer_key) == 0)
+	pthread_setspecific (pooled_buffer_key, buffer);
+}
+
+#else
+
+static void
+set_pooled_buffer (uint8_t *buffer)
+{
+}
+
+#endif
+
+uint8_t *
+_pixman_scanline_buffer_get (size_t size)
+{
+    scanline_pool_t *pool = PIXMAN_GET_THREAD_LOCAL (scanline_pool);
+    uint8_t *buffer;
+    size_t pool_size;
+
+    if (!pool || pool->in_use || size > MAX_POOLED_SCANLINE_BUFFER)
+	return malloc (size);
+
+    if (size > pool->size)
+    {
+	pool_size = MIN_POOLED_SCANLINE_BUFFER;
+	while (pool_size < size)
+	    pool_size *= 2;
+
+	if (!(buffer = malloc (pool_size)))
+	    return NULL;
+
+	free (pool->buffer);
+	pool->buffer = buffer;
+	pool->size = pool_size;
+
+	set_pooled_buffer (buffer);
+    }
+
+    pool->in_use = TRUE;
+
+    return pool->buffer;
+}
+
+void
+_pixman_scanline_buffer_put (uint8_t *buffer)
+{
+    scanline_pool_t *pool = PIXMAN_GET_THREAD_LOCAL (scanline_pool);
+
+    if (pool && buffer == pool->buffer)
+	pool->in_use = FALSE;
+    else
+	free (buffer);
+}
+
 void *
 pixman_malloc_ab (unsigned int a,
                   unsigned int b)
@@ -25,7 +25,12 @@
 
 #include "pixman-private.h"
 
-#if defined(USE_X86_MMX) || defined (USE_SSE2) || defined (USE_SSSE3)
+#if defined (_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(USE_X86_MMX) || defined (USE_SSE2) || defined (USE_SSSE3) || \
+    defined (USE_AVX2)
 
 /* The CPU detection code needs to be in a file not compiled with
  * "-mmmx -msse", as gcc would generate CMOV instructions otherwise
@@ -40,7 +45,8 @@ typedef enum
     X86_SSE			= (1 << 2) | X86_MMX_EXTENSIONS,
     X86_SSE2			= (1 << 3),
     X86_CMOV			= (1 << 4),
-    X86_SSSE3			= (1 << 5)
+    X86_SSSE3			= (1 << 5),
+    X86_AVX2			= (1 << 6)
 } cpu_features_t;
 
 #ifdef HAVE_GETISAX
@@ -67,6 +73,10 @@ detect_cpu_features (void)
 	    features |= X86_SSE2;
 	if (result & AV_386_SSSE3)
 	    features |= X86_SSSE3;
+#ifdef AV_386_AVX2
+	if (result & AV_386_AVX2)
+	    features |= X86_AVX2;
+#endif
     }
 
     return features;
@@ -119,7 +129,7 @@ pixman_cpuid (uint32_t feature,
     __asm__ volatile (
         "cpuid"				"\n\t"
 	: "=a" (*a), "=b" (*b), "=c" (*c), "=d" (*d)
-	: "a" (feature));
+	: "a" (feature), "c" (0));
 #else
     /* On x86-32 we need to be careful about the handling of %ebx
      * and %esp. We can't declare either one as clobbered
@@ -134,13 +144,13 @@ pixman_cpuid (uint32_t feature,
 	"cpuid"				"\n\t"
 	"xchg %%ebx, %1"		"\n\t"
 	: "=a" (*a), "=r" (*b), "=c" (*c), "=d" (*d)
-	: "a" (feature));
+	: "a" (feature), "c" (0));
 #endif
 
 #elif defined (_MSC_VER)
     int info[4];
 
-    __cpuid (info, feature);
+    __cpuidex (info, feature, 0);
 
     *a = info[0];
     *b = info[1];
@@ -151,6 +161,26 @@ pixman_cpuid (uint32_t feature,
 #endif
 }
 
+static uint32_t
+xgetbv (void)
+{
+#if defined (__GNUC__)
+    uint32_t a, d;
+
+    /* xgetbv, spelled out for assemblers that don't know it */
+    __asm__ volatile (
+	".byte 0x0f, 0x01, 0xd0"	"\n\t"
+	: "=a" (a), "=d" (d)
+	: "c" (0));
+
+    return a;
+#elif defined (_MSC_VER)
+    return (uint32_t) _xgetbv (0);
+#else
+#error Unknown compiler
+#endif
+}
+
 static cpu_features_t
 detect_cpu_features (void)
 {
@@ -173,6 +203,20 @@ detect_cpu_features (void)
     if (c & (1 << 9))
 	features |= X86_SSSE3;
 
+    /* AVX2 also needs the OS to save the upper halves of the
+     * registers, which it says through XCR0 once OSXSAVE is set.
+     */
+    if ((c & (1 << 27)) && (c & (1 << 28)) && (xgetbv () & 6) == 6)
+    {
+	pixman_cpuid (0x00, &a, &b, &c, &d);
+	if (a >= 7)
+	{
+	    pixman_cpuid (0x07, &a, &b, &c, &d);
+	    if (b & (1 << 5))
+		features |= X86_AVX2;
+	}
+    }
+
     /* Check for AMD specific features */
     if ((features & X86_MMX) && !(features & X86_SSE))
     {
@@ -228,6 +272,7 @@ _pixman_x86_get_implementations (pixman_implementation_t *imp)
 #define MMX_BITS  (X86_MMX | X86_MMX_EXTENSIONS)
 #define SSE2_BITS (X86_MMX | X86_MMX_EXTENSIONS | X86_SSE | X86_SSE2)
 #define SSSE3_BITS (X86_SSE | X86_SSE2 | X86_SSSE3)
+#define AVX2_BITS (X86_SSE | X86_SSE2 | X86_SSSE3 | X86_AVX2)
 
 #ifdef USE_X86_MMX
     if (!_pixman_disabled ("mmx") && have_feature (MMX_BITS))
@@ -237,6 +282,9 @@ _pixman_x86_get_implementations (pixman_implementation_t *imp)
 #ifdef USE_SSE2
     if (!_pixman_disabled ("sse2") && have_feature (SSE2_BITS))
 	imp = _pixman_implementation_create_sse2 (imp);
+
+    if (!_pixman_disabled ("sse2-float") && have_feature (SSE2_BITS))
+	imp = _pixman_implementation_create_sse2_float (imp);
 #endif
 
 #ifdef USE_SSSE3
@@ -244,5 +292,10 @@ _pixman_x86_get_implementations (pixman_implementation_t *imp)
 	imp = _pixman_implementation_create_ssse3 (imp);
 #endif
 
+#ifdef USE_AVX2
+    if (!_pixman_disabled ("avx2") && have_feature (AVX2_BITS))
+	imp = _pixman_implementation_create_avx2 (imp);
+#endif
+
     return imp;
 }
@@ -580,6 +580,8 @@ pixman_image_composite32 (pixman_op_t      op,
     pixman_composite_func_t func;
     pixman_composite_info_t info;
     const pixman_box32_t *pbox;
+    pixman_bool_t profiling;
+    uint64_t start = 0;
     int n;
 
     _pixman_image_validate (src);
@@ -686,6 +688,17 @@ pixman_image_composite32 (pixman_op_t      op,
 
     pbox = pixman_region32_rectangles (&region, &n);
 
+    profiling = _pixman_profiling ();
+    if (profiling)
+	start = _pixman_profile_stamp ();
+
+    if (_pixman_composite_parallel (imp, func, &info, pbox, n,
+				    src_x - dest_x, src_y - dest_y,
+				    mask_x - dest_x, mask_y - dest_y))
+    {
+	n = 0;
+    }
+
     while (n--)
     {
 	info.src_x = pbox->x1 + src_x - dest_x;
@@ -702,6 +715,13 @@ pixman_image_composite32 (pixman_op_t      op,
 	pbox++;
     }
 
+    if (profiling)
+    {
+	_pixman_profile_record (imp, func, &info,
+				src_format, mask_format, dest_format,
+				&region, _pixman_profile_stamp () - start);
+    }
+
 out:
     pixman_region32_fini (&region);
 }
@@ -285,6 +285,10 @@ typedef enum
     PIXMAN_REPEAT_REFLECT
 } pixman_repeat_t;
 
+/* Gradients are drawn from a table of colors computed in advance with
+ * every filter but PIXMAN_FILTER_BEST, which evaluates the stops at each
+ * pixel.
+ */
 typedef enum
 {
     PIXMAN_FILTER_FAST,
@@ -926,6 +930,26 @@ void          pixman_image_composite32        (pixman_op_t        op,
 					       int32_t            width,
 					       int32_t            height);
 
+/* Large composites are split up and run on this many threads, including
+ * the calling one.  The default is taken from the PIXMAN_THREADS
+ * environment variable; without it, or with fewer than two threads,
+ * everything runs on the calling thread.
+ */
+void          pixman_set_composite_threads    (int                n_threads);
+
+/* With PIXMAN_PROFILE set in the environment, composite operations are
+ * counted per operator, formats, flags and composite function, noting
+ * those that found no fast path.  This passes the report, one line at
+ * a time, to print; with a NULL print it goes to stderr.  Unless it has
+ * been asked for this way, the report is written to stderr at exit.
+ * Nothing happens when profiling is off.
+ */
+typedef void (* pixman_profile_print_func_t) (const char *line,
+					      void       *closure);
+
+void          pixman_profile_report           (pixman_profile_print_func_t print,
+					       void                       *closure);
+
 /* Executive Summary: This function is a no-op that only exists
  * for historical reasons.
  *
@@ -0,0 +1,169 @@
+/*
+ * Test program for the fetchers of affine transformed images with the
+ * bilinear and separable convolution filters.  Random a8r8g8b8,
+ * x8r8g8b8, r5g6b5 and a8 images are composited with random rotated,
+ * scaled and translated transforms, in all the repeat modes.
+ *
+ * The checksum is the one of the generic C fetchers, so it can be
+ * verified against them with PIXMAN_DISABLE.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "utils.h"
+
+#define MAX_SRC_WIDTH  48
+#define MAX_SRC_HEIGHT 48
+#define MAX_DST_WIDTH  48
+#define MAX_DST_HEIGHT 48
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8,
+    PIXMAN_x8r8g8b8,
+    PIXMAN_r5g6b5,
+    PIXMAN_a8,
+};
+
+static const pixman_repeat_t repeats[] =
+{
+    PIXMAN_REPEAT_NONE,
+    PIXMAN_REPEAT_NORMAL,
+    PIXMAN_REPEAT_PAD,
+    PIXMAN_REPEAT_REFLECT,
+};
+
+static const pixman_kernel_t kernels[] =
+{
+    PIXMAN_KERNEL_BOX,
+    PIXMAN_KERNEL_LINEAR,
+    PIXMAN_KERNEL_CUBIC,
+    PIXMAN_KERNEL_GAUSSIAN,
+    PIXMAN_KERNEL_LANCZOS2,
+    PIXMAN_KERNEL_LANCZOS3,
+    PIXMAN_KERNEL_LANCZOS3_STRETCHED,
+};
+
+static void
+set_random_filter (pixman_image_t *image)
+{
+    pixman_fixed_t *params;
+    int n_params;
+
+    if (prng_rand_n (3) == 0)
+    {
+	pixman_image_set_filter (image, PIXMAN_FILTER_BILINEAR, NULL, 0);
+	return;
+    }
+
+    params = pixman_filter_create_separable_convolution (
+	&n_params,
+	pixman_double_to_fixed ((prng_rand_n (300) + 50) / 100.0),
+	pixman_double_to_fixed ((prng_rand_n (300) + 50) / 100.0),
+	kernels[prng_rand_n (ARRAY_LENGTH (kernels))],
+	kernels[prng_rand_n (ARRAY_LENGTH (kernels))],
+	kernels[prng_rand_n (ARRAY_LENGTH (kernels))],
+	kernels[prng_rand_n (ARRAY_LENGTH (kernels))],
+	prng_rand_n (5), prng_rand_n (5));
+
+    pixman_image_set_filter (image, PIXMAN_FILTER_SEPARABLE_CONVOLUTION,
+			     params, n_params);
+    free (params);
+}
+
+static void
+set_random_transform (pixman_image_t *image, int width, int height)
+{
+    pixman_transform_t transform;
+    double angle = prng_rand_n (360) * M_PI / 180;
+
+    pixman_transform_init_rotate (&transform,
+				  pixman_double_to_fixed (cos (angle)),
+				  pixman_double_to_fixed (sin (angle)));
+    pixman_transform_scale (&transform, NULL,
+			    pixman_double_to_fixed ((prng_rand_n (300) + 20) / 100.0),
+			    pixman_double_to_fixed ((prng_rand_n (300) + 20) / 100.0));
+    pixman_transform_translate (&transform, NULL,
+				prng_rand_n (pixman_int_to_fixed (2 * width)) -
+				pixman_int_to_fixed (width / 2),
+				prng_rand_n (pixman_int_to_fixed (2 * height)) -
+				pixman_int_to_fixed (height / 2));
+
+    pixman_image_set_transform (image, &transform);
+}
+
+static uint32_t
+test_composite (int testnum, int verbose)
+{
+    pixman_image_t *src_img, *dst_img;
+    pixman_format_code_t src_fmt;
+    int src_width, src_height, dst_width, dst_height;
+    int src_stride;
+    pixman_op_t op;
+    uint32_t *srcbuf;
+    uint32_t crc32;
+
+    prng_srand (testnum);
+
+    src_fmt = formats[prng_rand_n (ARRAY_LENGTH (formats))];
+    op = prng_rand_n (2) ? PIXMAN_OP_SRC : PIXMAN_OP_OVER;
+
+    src_width = prng_rand_n (MAX_SRC_WIDTH) + 1;
+    src_height = prng_rand_n (MAX_SRC_HEIGHT) + 1;
+    dst_width = prng_rand_n (MAX_DST_WIDTH) + 1;
+    dst_height = prng_rand_n (MAX_DST_HEIGHT) + 1;
+
+    src_stride = (src_width * PIXMAN_FORMAT_BPP (src_fmt) / 8 + 3) & ~3;
+    srcbuf = (uint32_t *)malloc (src_stride * src_height);
+    prng_randmemset (srcbuf, src_stride * src_height, 0);
+
+    src_img = pixman_image_create_bits (
+	src_fmt, src_width, src_height, srcbuf, src_stride);
+    dst_img = pixman_image_create_bits (
+	PIXMAN_a8r8g8b8, dst_width, dst_height, NULL, 0);
+    prng_randmemset (pixman_image_get_data (dst_img),
+		     pixman_image_get_stride (dst_img) * dst_height, 0);
+
+    image_endian_swap (src_img);
+    image_endian_swap (dst_img);
+
+    pixman_image_set_repeat (src_img, repeats[prng_rand_n (ARRAY_LENGTH (repeats))]);
+    set_random_filter (src_img);
+    set_random_transform (src_img, src_width, src_height);
+
+    if (verbose)
+    {
+	printf ("src_fmt=%s, op=%s, src %dx%d, dst %dx%d\n",
+		format_name (src_fmt), operator_name (op),
+		src_width, src_height, dst_width, dst_height);
+    }
+
+    pixman_image_composite32 (op, src_img, NULL, dst_img,
+			      0, 0, 0, 0, 0, 0, dst_width, dst_height);
+
+    crc32 = compute_crc32_for_image (0, dst_img);
+
+    if (verbose)
+	print_image (dst_img);
+
+    pixman_image_unref (src_img);
+    pixman_image_unref (dst_img);
+    free (srcbuf);
+
+    return crc32;
+}
+
+#if BILINEAR_INTERPOLATION_BITS == 7
+#define CHECKSUM 0x3D2F593E
+#else
+#define CHECKSUM 0x00000000
+#endif
+
+int
+main (int argc, const char *argv[])
+{
+    pixman_disable_out_of_bounds_workaround ();
+
+    return fuzzer_test_main ("affine-fetch", 20000, CHECKSUM,
+			     test_composite, argc, argv);
+}
@@ -0,0 +1,218 @@
+/*
+ * Checks that compositing on several threads gives exactly the same
+ * pixels as compositing on one.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+#define WIDTH	397
+#define HEIGHT	311
+#define N_ROUNDS 120
+
+static const pixman_op_t operators[] =
+{
+    PIXMAN_OP_SRC,
+    PIXMAN_OP_OVER,
+    PIXMAN_OP_ADD,
+    PIXMAN_OP_IN,
+    PIXMAN_OP_OUT_REVERSE,
+    PIXMAN_OP_MULTIPLY,
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8,
+    PIXMAN_x8r8g8b8,
+    PIXMAN_r5g6b5,
+    PIXMAN_a8,
+};
+
+static const pixman_filter_t filters[] =
+{
+    PIXMAN_FILTER_NEAREST,
+    PIXMAN_FILTER_BILINEAR,
+    PIXMAN_FILTER_SEPARABLE_CONVOLUTION,
+};
+
+static const pixman_repeat_t repeats[] =
+{
+    PIXMAN_REPEAT_NONE,
+    PIXMAN_REPEAT_NORMAL,
+    PIXMAN_REPEAT_PAD,
+    PIXMAN_REPEAT_REFLECT,
+};
+
+#define RANDOM_ELT(arr)	(arr[prng_rand_n (ARRAY_LENGTH (arr))])
+
+static void
+on_destroy (pixman_image_t *image, void *data)
+{
+    fence_free (data);
+}
+
+static pixman_image_t *
+create_bits (pixman_format_code_t format, int width, int height)
+{
+    int stride = ((width * PIXMAN_FORMAT_BPP (format) + 31) / 32) * 4;
+    uint32_t *bits = (uint32_t *)make_random_bytes (stride * height);
+    pixman_image_t *image;
+
+    image = pixman_image_create_bits (format, width, height, bits, stride);
+    pixman_image_set_destroy_function (image, on_destroy, bits);
+
+    return image;
+}
+
+static pixman_image_t *
+create_source (void)
+{
+    static const pixman_gradient_stop_t stops[] =
+    {
+	{ pixman_int_to_fixed (0), { 0xffff, 0x0000, 0x0000, 0xffff } },
+	{ pixman_double_to_fixed (0.4), { 0x0000, 0x8000, 0xffff, 0x8000 } },
+	{ pixman_int_to_fixed (1), { 0x0000, 0x0000, 0x0000, 0x4000 } },
+    };
+    pixman_image_t *image;
+    pixman_transform_t transform;
+    pixman_point_fixed_t p1, p2;
+    pixman_fixed_t *params;
+    int n_params;
+    double scale;
+
+    switch (prng_rand_n (4))
+    {
+    case 0:
+	p1.x = pixman_int_to_fixed (prng_rand_n (WIDTH));
+	p1.y = pixman_int_to_fixed (prng_rand_n (HEIGHT));
+	p2.x = pixman_int_to_fixed (prng_rand_n (WIDTH));
+	p2.y = pixman_int_to_fixed (prng_rand_n (HEIGHT) + 1);
+	image = pixman_image_create_linear_gradient (
+	    &p1, &p2, stops, ARRAY_LENGTH (stops));
+	break;
+
+    case 1:
+	p1.x = pixman_int_to_fixed (WIDTH / 2);
+	p1.y = pixman_int_to_fixed (HEIGHT / 2);
+	image = pixman_image_create_radial_gradient (
+	    &p1, &p1, 0, pixman_int_to_fixed (WIDTH / 3),
+	    stops, ARRAY_LENGTH (stops));
+	break;
+
+    default:
+	image = create_bits (RANDOM_ELT (formats),
+			     prng_rand_n (WIDTH) + 1, prng_rand_n (HEIGHT) + 1);
+
+	scale = 0.3 + prng_rand_n (400) / 100.0;
+	pixman_transform_init_scale (
+	    &transform, pixman_double_to_fixed (scale),
+	    pixman_double_to_fixed (scale * (0.5 + prng_rand_n (100) / 100.0)));
+	if (prng_rand_n (2))
+	{
+	    pixman_transform_rotate (&transform, NULL,
+				     pixman_double_to_fixed (0.8),
+				     pixman_double_to_fixed (0.6));
+	}
+	if (prng_rand_n (3))
+	    pixman_image_set_transform (image, &transform);
+
+	pixman_image_set_repeat (image, RANDOM_ELT (repeats));
+
+	switch (RANDOM_ELT (filters))
+	{
+	case PIXMAN_FILTER_SEPARABLE_CONVOLUTION:
+	    params = pixman_filter_create_separable_convolution (
+		&n_params,
+		pixman_double_to_fixed (scale), pixman_double_to_fixed (scale),
+		PIXMAN_KERNEL_LINEAR, PIXMAN_KERNEL_BOX,
+		PIXMAN_KERNEL_LINEAR, PIXMAN_KERNEL_BOX, 2, 2);
+	    pixman_image_set_filter (image, PIXMAN_FILTER_SEPARABLE_CONVOLUTION,
+				     params, n_params);
+	    free (params);
+	    break;
+
+	case PIXMAN_FILTER_BILINEAR:
+	    pixman_image_set_filter (image, PIXMAN_FILTER_BILINEAR, NULL, 0);
+	    break;
+
+	default:
+	    break;
+	}
+	break;
+    }
+
+    return image;
+}
+
+static uint32_t
+test_composite (int testnum, int n_threads)
+{
+    pixman_image_t *src, *mask = NULL, *dest;
+    pixman_region32_t clip;
+    pixman_op_t op;
+    uint32_t crc32;
+    int i, n_rects;
+
+    prng_srand (testnum);
+
+    src = create_source ();
+    if (prng_rand_n (3) == 0)
+	mask = create_bits (PIXMAN_a8, WIDTH, HEIGHT);
+    dest = create_bits (RANDOM_ELT (formats), WIDTH, HEIGHT);
+    op = RANDOM_ELT (operators);
+
+    /* Several boxes of different widths, so that bands end in the
+     * middle of boxes and boxes end in the middle of bands.
+     */
+    pixman_region32_init (&clip);
+    n_rects = prng_rand_n (4);
+    for (i = 0; i < n_rects; i++)
+    {
+	pixman_region32_union_rect (&clip, &clip,
+				    prng_rand_n (WIDTH / 2),
+				    prng_rand_n (HEIGHT / 2),
+				    WIDTH / 4 + prng_rand_n (WIDTH),
+				    HEIGHT / 4 + prng_rand_n (HEIGHT));
+    }
+    if (n_rects)
+	pixman_image_set_clip_region32 (dest, &clip);
+    pixman_region32_fini (&clip);
+
+    pixman_set_composite_threads (n_threads);
+
+    pixman_image_composite32 (op, src, mask, dest,
+			      prng_rand_n (50), prng_rand_n (50),
+			      0, 0, 0, 0, WIDTH, HEIGHT);
+
+    crc32 = compute_crc32_for_image (0, dest);
+
+    pixman_image_unref (src);
+    if (mask)
+	pixman_image_unref (mask);
+    pixman_image_unref (dest);
+
+    return crc32;
+}
+
+int
+main (int argc, const char *argv[])
+{
+    int i, n_fails = 0;
+
+    for (i = 0; i < N_ROUNDS; i++)
+    {
+	uint32_t single = test_composite (i, 1);
+	uint32_t threaded = test_composite (i, 4);
+
+	if (single != threaded)
+	{
+	    printf ("test %d: single threaded %08x, threaded %08x\n",
+		    i, single, threaded);
+	    n_fails++;
+	}
+    }
+
+    pixman_set_composite_threads (0);
+
+    return n_fails != 0;
+}
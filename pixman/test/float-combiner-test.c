@@ -0,0 +1,196 @@
+/*
+ * Checks that the float combiners of the selected implementation give
+ * bit for bit the same results as the generic ones.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+#include <sys/types.h>
+#include "pixman-private.h"
+
+#define WIDTH		67
+#define N_ROUNDS	200
+
+static const pixman_op_t op_list[] =
+{
+    PIXMAN_OP_CLEAR,
+    PIXMAN_OP_SRC,
+    PIXMAN_OP_DST,
+    PIXMAN_OP_OVER,
+    PIXMAN_OP_OVER_REVERSE,
+    PIXMAN_OP_IN,
+    PIXMAN_OP_IN_REVERSE,
+    PIXMAN_OP_OUT,
+    PIXMAN_OP_OUT_REVERSE,
+    PIXMAN_OP_ATOP,
+    PIXMAN_OP_ATOP_REVERSE,
+    PIXMAN_OP_XOR,
+    PIXMAN_OP_ADD,
+    PIXMAN_OP_SATURATE,
+    PIXMAN_OP_DISJOINT_CLEAR,
+    PIXMAN_OP_DISJOINT_SRC,
+    PIXMAN_OP_DISJOINT_DST,
+    PIXMAN_OP_DISJOINT_OVER,
+    PIXMAN_OP_DISJOINT_OVER_REVERSE,
+    PIXMAN_OP_DISJOINT_IN,
+    PIXMAN_OP_DISJOINT_IN_REVERSE,
+    PIXMAN_OP_DISJOINT_OUT,
+    PIXMAN_OP_DISJOINT_OUT_REVERSE,
+    PIXMAN_OP_DISJOINT_ATOP,
+    PIXMAN_OP_DISJOINT_ATOP_REVERSE,
+    PIXMAN_OP_DISJOINT_XOR,
+    PIXMAN_OP_CONJOINT_CLEAR,
+    PIXMAN_OP_CONJOINT_SRC,
+    PIXMAN_OP_CONJOINT_DST,
+    PIXMAN_OP_CONJOINT_OVER,
+    PIXMAN_OP_CONJOINT_OVER_REVERSE,
+    PIXMAN_OP_CONJOINT_IN,
+    PIXMAN_OP_CONJOINT_IN_REVERSE,
+    PIXMAN_OP_CONJOINT_OUT,
+    PIXMAN_OP_CONJOINT_OUT_REVERSE,
+    PIXMAN_OP_CONJOINT_ATOP,
+    PIXMAN_OP_CONJOINT_ATOP_REVERSE,
+    PIXMAN_OP_CONJOINT_XOR,
+    PIXMAN_OP_MULTIPLY,
+    PIXMAN_OP_SCREEN,
+    PIXMAN_OP_OVERLAY,
+    PIXMAN_OP_DARKEN,
+    PIXMAN_OP_LIGHTEN,
+    PIXMAN_OP_COLOR_DODGE,
+    PIXMAN_OP_COLOR_BURN,
+    PIXMAN_OP_HARD_LIGHT,
+    PIXMAN_OP_DIFFERENCE,
+    PIXMAN_OP_EXCLUSION,
+    PIXMAN_OP_SOFT_LIGHT,
+    PIXMAN_OP_HSL_HUE,
+    PIXMAN_OP_HSL_SATURATION,
+    PIXMAN_OP_HSL_COLOR,
+    PIXMAN_OP_HSL_LUMINOSITY,
+};
+
+/* Mostly values in and slightly outside [0, 1], with the edge cases
+ * of the scalar code mixed in.
+ */
+static float
+random_channel (void)
+{
+    static const float special[] =
+    {
+	0.0f, -0.0f, 1.0f, 0.5f, 0.25f, 1e-39f, -1e-39f, 1.5f, -0.5f,
+    };
+
+    switch (prng_rand_n (4))
+    {
+    case 0:
+	return special[prng_rand_n (ARRAY_LENGTH (special))];
+    case 1:
+	return prng_rand_n (256) / 255.0f;
+    default:
+	return prng_rand_n (1200) / 1000.0f - 0.1f;
+    }
+}
+
+static void
+random_pixels (argb_t *argb, int width)
+{
+    int i;
+
+    for (i = 0; i < width; ++i)
+    {
+	argb[i].a = random_channel ();
+	argb[i].r = random_channel ();
+	argb[i].g = random_channel ();
+	argb[i].b = random_channel ();
+    }
+}
+
+static pixman_combine_float_func_t
+lookup_combiner (pixman_implementation_t *imp, pixman_op_t op,
+		 pixman_bool_t component_alpha)
+{
+    pixman_combine_float_func_t f;
+
+    do
+    {
+	if (component_alpha)
+	    f = imp->combine_float_ca[op];
+	else
+	    f = imp->combine_float[op];
+
+	imp = imp->fallback;
+    }
+    while (!f);
+
+    return f;
+}
+
+static pixman_bool_t
+same_float (float a, float b)
+{
+    if (a != a && b != b)
+	return TRUE;
+
+    return memcmp (&a, &b, sizeof (float)) == 0;
+}
+
+int
+main ()
+{
+    pixman_implementation_t *impl, *general;
+    argb_t src[WIDTH], mask[WIDTH], dest[WIDTH];
+    argb_t expected[WIDTH], actual[WIDTH];
+    int i, j, k, n_fails = 0;
+
+    enable_divbyzero_exceptions ();
+
+    impl = _pixman_internal_only_get_implementation ();
+    for (general = impl; general->fallback; general = general->fallback)
+	;
+
+    prng_srand (0);
+
+    for (i = 0; i < N_ROUNDS; ++i)
+    {
+	for (j = 0; j < ARRAY_LENGTH (op_list); ++j)
+	{
+	    pixman_op_t op = op_list[j];
+	    int m = prng_rand_n (3);
+	    int ca = m == 2;
+	    const float *mask_bits = m ? (float *)mask : NULL;
+
+	    random_pixels (src, WIDTH);
+	    random_pixels (mask, WIDTH);
+	    random_pixels (dest, WIDTH);
+
+	    memcpy (expected, dest, sizeof (dest));
+	    memcpy (actual, dest, sizeof (dest));
+
+	    lookup_combiner (general, op, ca) (
+		general, op, (float *)expected, (float *)src, mask_bits, WIDTH);
+	    lookup_combiner (impl, op, ca) (
+		impl, op, (float *)actual, (float *)src, mask_bits, WIDTH);
+
+	    for (k = 0; k < WIDTH; ++k)
+	    {
+		if (!same_float (expected[k].a, actual[k].a) ||
+		    !same_float (expected[k].r, actual[k].r) ||
+		    !same_float (expected[k].g, actual[k].g) ||
+		    !same_float (expected[k].b, actual[k].b))
+		{
+		    printf ("op %d, %s, pixel %d: "
+			    "expected (%a %a %a %a), got (%a %a %a %a)\n",
+			    op, ca ? "ca" : m ? "mask" : "no mask", k,
+			    expected[k].a, expected[k].r,
+			    expected[k].g, expected[k].b,
+			    actual[k].a, actual[k].r,
+			    actual[k].g, actual[k].b);
+		    n_fails++;
+		    break;
+		}
+	    }
+	}
+    }
+
+    return n_fails != 0;
+}
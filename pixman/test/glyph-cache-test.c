@@ -0,0 +1,111 @@
+/*
+ * Checks that a glyph cache grows past its initial table, that thawing
+ * it drops the least recently used glyphs once it is above its budget,
+ * and that glyphs in use during a freeze are never dropped.
+ */
+#include <stdlib.h>
+#include "utils.h"
+
+#define N_GLYPHS	20000
+#define GLYPH_SIZE	32
+/* What a cache holds on to, in bytes; N_GLYPHS glyphs are well above it */
+#define BUDGET		(8 * 1024 * 1024)
+
+static uint8_t keys[N_GLYPHS];
+
+static const void *
+insert (pixman_glyph_cache_t *cache, int i)
+{
+    pixman_image_t *image;
+    const void *glyph;
+
+    image = pixman_image_create_bits (
+	PIXMAN_a8, GLYPH_SIZE, GLYPH_SIZE, NULL, 0);
+    glyph = pixman_glyph_cache_insert (cache, NULL, &keys[i], 0, 0, image);
+    pixman_image_unref (image);
+
+    return glyph;
+}
+
+int
+main ()
+{
+    pixman_glyph_cache_t *cache;
+    int i, n_cached, n_fails = 0;
+
+    cache = pixman_glyph_cache_create ();
+
+    /* All glyphs inserted during a freeze stay, whatever the budget */
+    pixman_glyph_cache_freeze (cache);
+    for (i = 0; i < N_GLYPHS; ++i)
+    {
+	if (!insert (cache, i))
+	{
+	    printf ("insert of glyph %d failed\n", i);
+	    n_fails++;
+	}
+    }
+    for (i = 0; i < N_GLYPHS; ++i)
+    {
+	if (!pixman_glyph_cache_lookup (cache, NULL, &keys[i]))
+	{
+	    printf ("glyph %d missing during the freeze\n", i);
+	    n_fails++;
+	    break;
+	}
+    }
+
+    /* Touch a few old glyphs so that they become the most recent ones */
+    for (i = 0; i < 10; ++i)
+	pixman_glyph_cache_lookup (cache, NULL, &keys[i]);
+    pixman_glyph_cache_thaw (cache);
+
+    pixman_glyph_cache_freeze (cache);
+
+    n_cached = 0;
+    for (i = 0; i < N_GLYPHS; ++i)
+    {
+	if (pixman_glyph_cache_lookup (cache, NULL, &keys[i]))
+	    n_cached++;
+    }
+
+    if (n_cached == 0 || n_cached * GLYPH_SIZE * GLYPH_SIZE > BUDGET)
+    {
+	printf ("%d glyphs cached after the thaw\n", n_cached);
+	n_fails++;
+    }
+
+    for (i = 0; i < 10; ++i)
+    {
+	if (!pixman_glyph_cache_lookup (cache, NULL, &keys[i]))
+	{
+	    printf ("recently used glyph %d was dropped\n", i);
+	    n_fails++;
+	}
+    }
+
+    if (pixman_glyph_cache_lookup (cache, NULL, &keys[10]))
+    {
+	printf ("least recently used glyph was kept\n");
+	n_fails++;
+    }
+
+    pixman_glyph_cache_remove (cache, NULL, &keys[0]);
+    if (pixman_glyph_cache_lookup (cache, NULL, &keys[0]))
+    {
+	printf ("removed glyph is still there\n");
+	n_fails++;
+    }
+
+    /* Glyphs can be inserted again after the table shrank */
+    if (!insert (cache, 0) || !pixman_glyph_cache_lookup (cache, NULL, &keys[0]))
+    {
+	printf ("reinserting glyph 0 failed\n");
+	n_fails++;
+    }
+
+    pixman_glyph_cache_thaw (cache);
+    pixman_glyph_cache_destroy (cache);
+
+    return n_fails != 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Checks that gradients rendered from their color ramp, as they are with
+ * every filter but PIXMAN_FILTER_BEST, stay close to the exact
+ * evaluation used with PIXMAN_FILTER_BEST.
+ */
+#include <stdlib.h>
+#include "utils.h"
+
+#define N_ROUNDS 400
+#define WIDTH 67
+#define HEIGHT 23
+#define TOLERANCE 3
+
+static const pixman_repeat_t repeats[] =
+{
+    PIXMAN_REPEAT_NONE,
+    PIXMAN_REPEAT_NORMAL,
+    PIXMAN_REPEAT_PAD,
+    PIXMAN_REPEAT_REFLECT,
+};
+
+static pixman_fixed_t
+random_coord (int size)
+{
+    return prng_rand_n (pixman_int_to_fixed (3 * size)) - pixman_int_to_fixed (size);
+}
+
+static void
+random_color (pixman_color_t *color)
+{
+    color->alpha = prng_rand_n (0x10000);
+    color->red = prng_rand_n (0x10000);
+    color->green = prng_rand_n (0x10000);
+    color->blue = prng_rand_n (0x10000);
+}
+
+static const pixman_filter_t ramp_filters[] =
+{
+    PIXMAN_FILTER_FAST,
+    PIXMAN_FILTER_GOOD,
+    PIXMAN_FILTER_NEAREST,
+    PIXMAN_FILTER_BILINEAR,
+};
+
+static pixman_image_t *
+create_random_gradient (void)
+{
+    pixman_gradient_stop_t stops[5];
+    pixman_point_fixed_t p1, p2;
+    pixman_fixed_t r1, r2, spacing, start;
+    int i, n_stops = prng_rand_n (ARRAY_LENGTH (stops)) + 1;
+
+    /* Stops at least 1/8 apart, so the color changes slowly enough for
+     * the ramp to follow it within the tolerance.
+     */
+    spacing = pixman_fixed_1 / 8 + prng_rand_n (pixman_fixed_1 / 8 + 1);
+    start = prng_rand_n (pixman_fixed_1 - (n_stops - 1) * spacing + 1);
+
+    for (i = 0; i < n_stops; ++i)
+    {
+	stops[i].x = start + i * spacing;
+	random_color (&stops[i].color);
+    }
+
+    p1.x = random_coord (WIDTH);
+    p1.y = random_coord (HEIGHT);
+    p2.x = random_coord (WIDTH);
+    p2.y = random_coord (HEIGHT);
+
+    switch (prng_rand_n (3))
+    {
+    case 0:
+	return pixman_image_create_linear_gradient (&p1, &p2, stops, n_stops);
+
+    case 1:
+	r1 = prng_rand_n (pixman_int_to_fixed (WIDTH));
+	r2 = prng_rand_n (pixman_int_to_fixed (WIDTH));
+	return pixman_image_create_radial_gradient (
+	    &p1, &p2, r1, r2, stops, n_stops);
+
+    default:
+	return pixman_image_create_conical_gradient (
+	    &p1, prng_rand_n (pixman_int_to_fixed (360)), stops, n_stops);
+    }
+}
+
+static pixman_bool_t
+close_enough (uint32_t a, uint32_t b)
+{
+    int i;
+
+    for (i = 0; i < 32; i += 8)
+    {
+	if (abs ((int)((a >> i) & 0xff) - (int)((b >> i) & 0xff)) > TOLERANCE)
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+int
+main ()
+{
+    int i, j, n_fails = 0;
+
+    prng_srand (0);
+
+    for (i = 0; i < N_ROUNDS; ++i)
+    {
+	pixman_image_t *gradient, *exact, *fast;
+	pixman_repeat_t repeat = repeats[prng_rand_n (ARRAY_LENGTH (repeats))];
+	pixman_transform_t transform;
+	uint32_t *e, *f;
+
+	gradient = create_random_gradient ();
+	pixman_image_set_repeat (gradient, repeat);
+
+	if (prng_rand_n (2))
+	{
+	    pixman_transform_init_rotate (&transform,
+					  pixman_double_to_fixed (0.6),
+					  pixman_double_to_fixed (0.8));
+	    pixman_transform_scale (&transform, NULL,
+				    pixman_double_to_fixed (1.5),
+				    pixman_double_to_fixed (0.7));
+	    pixman_image_set_transform (gradient, &transform);
+	}
+
+	exact = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+	fast = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+
+	pixman_image_set_filter (gradient, PIXMAN_FILTER_BEST, NULL, 0);
+	pixman_image_composite32 (PIXMAN_OP_SRC, gradient, NULL, exact,
+				  0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+	pixman_image_set_filter (
+	    gradient, ramp_filters[prng_rand_n (ARRAY_LENGTH (ramp_filters))],
+	    NULL, 0);
+	pixman_image_composite32 (PIXMAN_OP_SRC, gradient, NULL, fast,
+				  0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+
+	/* Only the continuous repeat modes can be compared pixel by pixel;
+	 * with the others a position right at a discontinuity may land on
+	 * either side of it.
+	 */
+	if (repeat == PIXMAN_REPEAT_PAD || repeat == PIXMAN_REPEAT_REFLECT)
+	{
+	    e = pixman_image_get_data (exact);
+	    f = pixman_image_get_data (fast);
+
+	    for (j = 0; j < WIDTH * HEIGHT; ++j)
+	    {
+		if (!close_enough (e[j], f[j]))
+		{
+		    printf ("round %d, pixel %d: exact %08x, ramp %08x\n",
+			    i, j, e[j], f[j]);
+		    n_fails++;
+		    break;
+		}
+	    }
+	}
+
+	pixman_image_unref (gradient);
+	pixman_image_unref (exact);
+	pixman_image_unref (fast);
+    }
+
+    return n_fails != 0;
+}
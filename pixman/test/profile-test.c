@@ -0,0 +1,115 @@
+/*
+ * Checks the report of the composite profiler: composites that found a
+ * fast path and ones that fell back to the general path are counted
+ * apart, per operator and formats.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+#define WIDTH 40
+#define HEIGHT 30
+
+typedef struct
+{
+    int n_lines;
+    int n_fast;
+    int n_general;
+    char summary[256];
+} report_t;
+
+static void
+collect_line (const char *line, void *closure)
+{
+    report_t *report = closure;
+    char op[32], src[64], mask[64], dest[64], func[64];
+    unsigned long long hits, pixels, ticks;
+
+    if (report->n_lines++ == 0)
+    {
+	snprintf (report->summary, sizeof (report->summary), "%s", line);
+	return;
+    }
+
+    if (sscanf (line, "%llu %llu %llu %31s %63s %63s %63s %63s",
+		&hits, &pixels, &ticks, op, src, mask, dest, func) != 8)
+    {
+	return;
+    }
+
+    if (strcmp (op, "src") == 0				&&
+	strncmp (src, "a8r8g8b8/", 9) == 0			&&
+	strncmp (mask, "null/", 5) == 0				&&
+	strncmp (dest, "x8r8g8b8/", 9) == 0)
+    {
+	if (hits != 3 || pixels != 3 * WIDTH * HEIGHT ||
+	    strcmp (func, "general") == 0)
+	{
+	    printf ("unexpected line: %s\n", line);
+	    exit (1);
+	}
+	report->n_fast++;
+    }
+
+    if (strcmp (op, "hsl_hue") == 0				&&
+	strncmp (src, "r5g6b5/", 7) == 0			&&
+	strncmp (mask, "a8/", 3) == 0				&&
+	strncmp (dest, "a8r8g8b8/", 9) == 0)
+    {
+	if (hits != 2 || pixels != 2 * (WIDTH / 2) * HEIGHT ||
+	    strcmp (func, "general") != 0)
+	{
+	    printf ("unexpected line: %s\n", line);
+	    exit (1);
+	}
+	report->n_general++;
+    }
+}
+
+int
+main ()
+{
+    pixman_image_t *a8r8g8b8, *x8r8g8b8, *r5g6b5, *a8;
+    report_t report;
+    int i;
+
+    /* Read the first time anything is composited */
+    putenv ((char *)"PIXMAN_PROFILE=1");
+
+    a8r8g8b8 = pixman_image_create_bits (PIXMAN_a8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+    x8r8g8b8 = pixman_image_create_bits (PIXMAN_x8r8g8b8, WIDTH, HEIGHT, NULL, 0);
+    r5g6b5 = pixman_image_create_bits (PIXMAN_r5g6b5, WIDTH, HEIGHT, NULL, 0);
+    a8 = pixman_image_create_bits (PIXMAN_a8, WIDTH, HEIGHT, NULL, 0);
+
+    for (i = 0; i < 3; ++i)
+    {
+	pixman_image_composite32 (PIXMAN_OP_SRC, a8r8g8b8, NULL, x8r8g8b8,
+				  0, 0, 0, 0, 0, 0, WIDTH, HEIGHT);
+    }
+
+    for (i = 0; i < 2; ++i)
+    {
+	pixman_image_composite32 (PIXMAN_OP_HSL_HUE, r5g6b5, a8, a8r8g8b8,
+				  0, 0, 0, 0, 0, 0, WIDTH / 2, HEIGHT);
+    }
+
+    memset (&report, 0, sizeof (report));
+    pixman_profile_report (collect_line, &report);
+
+    printf ("%s\n", report.summary);
+
+    if (strncmp (report.summary, "pixman: 5 composites, 2 ", 24) != 0 ||
+	report.n_fast != 1 || report.n_general != 1)
+    {
+	printf ("%d lines, %d fast path lines, %d general lines\n",
+		report.n_lines, report.n_fast, report.n_general);
+	return 1;
+    }
+
+    pixman_image_unref (a8r8g8b8);
+    pixman_image_unref (x8r8g8b8);
+    pixman_image_unref (r5g6b5);
+    pixman_image_unref (a8);
+
+    return 0;
+}
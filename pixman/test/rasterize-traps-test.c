@@ -0,0 +1,95 @@
+/*
+ * Checks that rasterizing a list of trapezoids in one pass with
+ * pixman_add_trapezoids() gives exactly the same a8 mask as
+ * rasterizing them one at a time with pixman_rasterize_trapezoid().
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+#define N_ROUNDS 3000
+#define MAX_TRAPS 40
+
+static pixman_fixed_t
+random_coord (int size)
+{
+    return prng_rand_n (pixman_int_to_fixed (size + 20)) - pixman_int_to_fixed (10);
+}
+
+static void
+random_trap (pixman_trapezoid_t *trap, int width, int height)
+{
+    trap->top = random_coord (height);
+    trap->bottom = trap->top + prng_rand_n (pixman_int_to_fixed (height / 2 + 1));
+
+    trap->left.p1.x = random_coord (width);
+    trap->left.p1.y = random_coord (height);
+    trap->left.p2.x = random_coord (width);
+    trap->left.p2.y = random_coord (height);
+
+    /* Mostly proper trapezoids, but some with crossing edges */
+    trap->right = trap->left;
+    if (prng_rand_n (8))
+    {
+	trap->right.p1.x += prng_rand_n (pixman_int_to_fixed (width / 2 + 1));
+	trap->right.p2.x += prng_rand_n (pixman_int_to_fixed (width / 2 + 1));
+    }
+    else
+    {
+	trap->right.p1.x = random_coord (width);
+	trap->right.p2.x = random_coord (width);
+    }
+}
+
+int
+main ()
+{
+    pixman_trapezoid_t traps[MAX_TRAPS];
+    int i, j, n_fails = 0;
+
+    for (i = 0; i < N_ROUNDS; ++i)
+    {
+	pixman_image_t *one_pass, *per_trap;
+	int width, height, n_traps, x_off, y_off;
+
+	prng_srand (i);
+
+	width = prng_rand_n (100) + 1;
+	height = prng_rand_n (100) + 1;
+	n_traps = prng_rand_n (MAX_TRAPS) + 1;
+	x_off = prng_rand_n (21) - 10;
+	y_off = prng_rand_n (21) - 10;
+
+	for (j = 0; j < n_traps; ++j)
+	    random_trap (&traps[j], width, height);
+
+	one_pass = pixman_image_create_bits (PIXMAN_a8, width, height, NULL, 0);
+	per_trap = pixman_image_create_bits (PIXMAN_a8, width, height, NULL, 0);
+
+	/* Start from the same non-empty mask */
+	prng_randmemset (pixman_image_get_data (one_pass),
+			 pixman_image_get_stride (one_pass) * height,
+			 RANDMEMSET_MORE_00);
+	memcpy (pixman_image_get_data (per_trap),
+		pixman_image_get_data (one_pass),
+		pixman_image_get_stride (one_pass) * height);
+
+	pixman_add_trapezoids (one_pass, x_off, y_off, n_traps, traps);
+	for (j = 0; j < n_traps; ++j)
+	    pixman_rasterize_trapezoid (per_trap, &traps[j], x_off, y_off);
+
+	if (memcmp (pixman_image_get_data (one_pass),
+		    pixman_image_get_data (per_trap),
+		    pixman_image_get_stride (one_pass) * height) != 0)
+	{
+	    printf ("round %d: %d traps on %dx%d differ\n",
+		    i, n_traps, width, height);
+	    n_fails++;
+	}
+
+	pixman_image_unref (one_pass);
+	pixman_image_unref (per_trap);
+    }
+
+    return n_fails != 0;
+}
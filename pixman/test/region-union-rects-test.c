@@ -0,0 +1,249 @@
+/*
+ * Checks regions built from many boxes at once with init_rects() and a
+ * single union against unions of one box at a time, that the boxes of
+ * the result answer contains_point() and contains_rectangle() like a
+ * search of the boxes does, and that translating the resulting regions
+ * keeps them valid.
+ */
+#include <assert.h>
+#include <stdlib.h>
+#include "utils.h"
+
+#define N_ROUNDS 300
+#define MAX_BOXES 400
+
+static void
+random_boxes (pixman_box32_t *boxes, int n_boxes, int size)
+{
+    int i;
+
+    for (i = 0; i < n_boxes; i++)
+    {
+	/* Some empty and some inverted boxes, which are ignored */
+	boxes[i].x1 = prng_rand_n (size);
+	boxes[i].y1 = prng_rand_n (size);
+	boxes[i].x2 = boxes[i].x1 + prng_rand_n (size / 4) - 2;
+	boxes[i].y2 = boxes[i].y1 + prng_rand_n (size / 4) - 2;
+    }
+}
+
+static pixman_bool_t
+boxes_contain_point (const pixman_box32_t *boxes, int n_boxes, int x, int y)
+{
+    int i;
+
+    for (i = 0; i < n_boxes; i++)
+    {
+	if (boxes[i].x1 <= x && x < boxes[i].x2 &&
+	    boxes[i].y1 <= y && y < boxes[i].y2)
+	{
+	    return TRUE;
+	}
+    }
+
+    return FALSE;
+}
+
+static pixman_region_overlap_t
+boxes_contain_rectangle (const pixman_box32_t *boxes, int n_boxes,
+			 const pixman_box32_t *rect)
+{
+    int64_t covered = 0;
+    int i;
+
+    /* The boxes of a region don't overlap */
+    for (i = 0; i < n_boxes; i++)
+    {
+	int x1 = MAX (boxes[i].x1, rect->x1), x2 = MIN (boxes[i].x2, rect->x2);
+	int y1 = MAX (boxes[i].y1, rect->y1), y2 = MIN (boxes[i].y2, rect->y2);
+
+	if (x1 < x2 && y1 < y2)
+	    covered += (int64_t)(x2 - x1) * (y2 - y1);
+    }
+
+    if (covered == 0)
+	return PIXMAN_REGION_OUT;
+    if (covered == (int64_t)(rect->x2 - rect->x1) * (rect->y2 - rect->y1))
+	return PIXMAN_REGION_IN;
+    return PIXMAN_REGION_PART;
+}
+
+static void
+check_contains32 (pixman_region32_t *region, int size)
+{
+    const pixman_box32_t *rects;
+    pixman_box32_t box, rect;
+    int i, n_rects, x, y;
+
+    rects = pixman_region32_rectangles (region, &n_rects);
+
+    for (i = 0; i < 64; i++)
+    {
+	pixman_bool_t in;
+
+	x = prng_rand_n (size + 2) - 1;
+	y = prng_rand_n (size + 2) - 1;
+	in = boxes_contain_point (rects, n_rects, x, y);
+
+	assert (pixman_region32_contains_point (region, x, y, NULL) == in);
+	if (in)
+	{
+	    assert (pixman_region32_contains_point (region, x, y, &box));
+	    assert (box.x1 <= x && x < box.x2 && box.y1 <= y && y < box.y2);
+	}
+
+	rect.x1 = x;
+	rect.y1 = y;
+	rect.x2 = x + 1 + prng_rand_n (size / 4);
+	rect.y2 = y + 1 + prng_rand_n (size / 4);
+
+	assert (pixman_region32_contains_rectangle (region, &rect) ==
+		boxes_contain_rectangle (rects, n_rects, &rect));
+    }
+}
+
+static void
+check_contains16 (pixman_region16_t *region, int size)
+{
+    pixman_box32_t rects32[MAX_BOXES * 2];
+    const pixman_box16_t *rects;
+    pixman_box16_t rect;
+    pixman_box32_t rect32;
+    int i, n_rects, x, y;
+
+    rects = pixman_region_rectangles (region, &n_rects);
+    if (n_rects > MAX_BOXES * 2)
+	return;
+
+    for (i = 0; i < n_rects; i++)
+    {
+	rects32[i].x1 = rects[i].x1;
+	rects32[i].y1 = rects[i].y1;
+	rects32[i].x2 = rects[i].x2;
+	rects32[i].y2 = rects[i].y2;
+    }
+
+    for (i = 0; i < 64; i++)
+    {
+	x = prng_rand_n (size + 2) - 1;
+	y = prng_rand_n (size + 2) - 1;
+
+	assert (pixman_region_contains_point (region, x, y, NULL) ==
+		boxes_contain_point (rects32, n_rects, x, y));
+
+	rect32.x1 = rect.x1 = x;
+	rect32.y1 = rect.y1 = y;
+	rect32.x2 = rect.x2 = x + 1 + prng_rand_n (size / 4);
+	rect32.y2 = rect.y2 = y + 1 + prng_rand_n (size / 4);
+
+	assert (pixman_region_contains_rectangle (region, &rect) ==
+		boxes_contain_rectangle (rects32, n_rects, &rect32));
+    }
+}
+
+static void
+test_region32 (const pixman_box32_t *boxes, int n_boxes, int size)
+{
+    pixman_region32_t expected, actual, rects;
+    int i, dx, dy;
+
+    pixman_region32_init_rect (&expected, size / 2, 0, size / 8, size);
+    pixman_region32_init_rect (&actual, size / 2, 0, size / 8, size);
+
+    for (i = 0; i < n_boxes; i++)
+    {
+	if (boxes[i].x1 < boxes[i].x2 && boxes[i].y1 < boxes[i].y2)
+	{
+	    pixman_region32_union_rect (&expected, &expected,
+					boxes[i].x1, boxes[i].y1,
+					boxes[i].x2 - boxes[i].x1,
+					boxes[i].y2 - boxes[i].y1);
+	}
+    }
+
+    assert (pixman_region32_init_rects (&rects, boxes, n_boxes));
+    assert (pixman_region32_union (&actual, &actual, &rects));
+    assert (pixman_region32_selfcheck (&actual));
+    assert (pixman_region32_equal (&expected, &actual));
+    pixman_region32_fini (&rects);
+
+    check_contains32 (&actual, size);
+
+    dx = prng_rand_n (2 * size) - size;
+    dy = prng_rand_n (2 * size) - size;
+    pixman_region32_translate (&expected, dx, dy);
+    pixman_region32_translate (&actual, dx, dy);
+    assert (pixman_region32_selfcheck (&actual));
+    assert (pixman_region32_equal (&expected, &actual));
+
+    pixman_region32_fini (&expected);
+    pixman_region32_fini (&actual);
+}
+
+static void
+test_region16 (const pixman_box32_t *boxes32, int n_boxes, int size)
+{
+    pixman_box16_t boxes[MAX_BOXES];
+    pixman_region16_t expected, actual, rects;
+    int i;
+
+    for (i = 0; i < n_boxes; i++)
+    {
+	boxes[i].x1 = boxes32[i].x1;
+	boxes[i].y1 = boxes32[i].y1;
+	boxes[i].x2 = boxes32[i].x2;
+	boxes[i].y2 = boxes32[i].y2;
+    }
+
+    pixman_region_init (&expected);
+    pixman_region_init (&actual);
+
+    for (i = 0; i < n_boxes; i++)
+    {
+	if (boxes[i].x1 < boxes[i].x2 && boxes[i].y1 < boxes[i].y2)
+	{
+	    pixman_region_union_rect (&expected, &expected,
+				      boxes[i].x1, boxes[i].y1,
+				      boxes[i].x2 - boxes[i].x1,
+				      boxes[i].y2 - boxes[i].y1);
+	}
+    }
+
+    assert (pixman_region_init_rects (&rects, boxes, n_boxes));
+    assert (pixman_region_union (&actual, &actual, &rects));
+    assert (pixman_region_selfcheck (&actual));
+    assert (pixman_region_equal (&expected, &actual));
+    pixman_region_fini (&rects);
+
+    check_contains16 (&actual, size);
+
+    pixman_region_translate (&expected, -size / 3, size / 5);
+    pixman_region_translate (&actual, -size / 3, size / 5);
+    assert (pixman_region_selfcheck (&actual));
+    assert (pixman_region_equal (&expected, &actual));
+
+    pixman_region_fini (&expected);
+    pixman_region_fini (&actual);
+}
+
+int
+main ()
+{
+    pixman_box32_t boxes[MAX_BOXES];
+    int i;
+
+    prng_srand (0);
+
+    for (i = 0; i < N_ROUNDS; i++)
+    {
+	int n_boxes = prng_rand_n (MAX_BOXES + 1);
+	int size = 16 << prng_rand_n (8);
+
+	random_boxes (boxes, n_boxes, size);
+
+	test_region32 (boxes, n_boxes, size);
+	test_region16 (boxes, n_boxes, size);
+    }
+
+    return 0;
+}
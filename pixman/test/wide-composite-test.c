@@ -0,0 +1,95 @@
+/*
+ * Checks that composites on the general path that are too wide for its
+ * stack buffer, and so use the pooled scanline buffers, give the same
+ * results as the same composites done in narrow slices.  The widths go
+ * up and down so that the pooled buffer is both reused and replaced.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+#define N_ROUNDS 200
+#define MAX_WIDTH 9000
+#define HEIGHT 3
+#define SLICE 500
+
+static const pixman_op_t ops[] =
+{
+    PIXMAN_OP_DARKEN,
+    PIXMAN_OP_HSL_HUE,
+    PIXMAN_OP_CONJOINT_OVER,
+    PIXMAN_OP_SATURATE,
+};
+
+static const pixman_format_code_t formats[] =
+{
+    PIXMAN_a8r8g8b8,
+    PIXMAN_r5g6b5,
+    PIXMAN_a2r10g10b10,
+};
+
+static pixman_image_t *
+create_random_image (pixman_format_code_t format, int width)
+{
+    pixman_image_t *image =
+	pixman_image_create_bits (format, width, HEIGHT, NULL, 0);
+
+    prng_randmemset (pixman_image_get_data (image),
+		     pixman_image_get_stride (image) * HEIGHT, 0);
+
+    return image;
+}
+
+int
+main ()
+{
+    int i, x, n_fails = 0;
+
+    prng_srand (0);
+
+    for (i = 0; i < N_ROUNDS; ++i)
+    {
+	pixman_op_t op = ops[prng_rand_n (ARRAY_LENGTH (ops))];
+	pixman_format_code_t src_format =
+	    formats[prng_rand_n (ARRAY_LENGTH (formats))];
+	pixman_format_code_t dest_format =
+	    formats[prng_rand_n (ARRAY_LENGTH (formats))];
+	int width = prng_rand_n (MAX_WIDTH) + 1;
+	pixman_image_t *src, *mask, *whole, *sliced;
+
+	src = create_random_image (src_format, width);
+	mask = prng_rand_n (2) ? create_random_image (PIXMAN_a8, width) : NULL;
+	whole = create_random_image (dest_format, width);
+	sliced = pixman_image_create_bits (dest_format, width, HEIGHT, NULL, 0);
+	memcpy (pixman_image_get_data (sliced), pixman_image_get_data (whole),
+		pixman_image_get_stride (whole) * HEIGHT);
+
+	pixman_image_composite32 (op, src, mask, whole,
+				  0, 0, 0, 0, 0, 0, width, HEIGHT);
+
+	for (x = 0; x < width; x += SLICE)
+	{
+	    pixman_image_composite32 (op, src, mask, sliced, x, 0, x, 0, x, 0,
+				      width - x < SLICE ? width - x : SLICE,
+				      HEIGHT);
+	}
+
+	if (memcmp (pixman_image_get_data (whole),
+		    pixman_image_get_data (sliced),
+		    pixman_image_get_stride (whole) * HEIGHT) != 0)
+	{
+	    printf ("round %d: op %s, %s -> %s, width %d differs\n",
+		    i, operator_name (op), format_name (src_format),
+		    format_name (dest_format), width);
+	    n_fails++;
+	}
+
+	pixman_image_unref (src);
+	if (mask)
+	    pixman_image_unref (mask);
+	pixman_image_unref (whole);
+	pixman_image_unref (sliced);
+    }
+
+    return n_fails != 0;
+}
@@ -292,6 +292,36 @@ resourceTypeAtom(int i)
     return ret;
 }
 
+static void
+ResCountServerCounter(Atom name, unsigned long value, void *cdata)
+{
+    int *num_types = cdata;
+
+    (*num_types)++;
+}
+
+/*
+ * A server counter goes out as a resource type of its own, with the
+ * counter as the count.  Those counting events or bytes only ever grow,
+ * and wrap at 32 bits like any CARD32 counter, so clients should look at
+ * the difference between two queries rather than at the value.
+ */
+static void
+ResWriteServerCounter(Atom name, unsigned long value, void *cdata)
+{
+    ClientPtr client = cdata;
+    xXResType scratch;
+
+    scratch.resource_type = name;
+    scratch.count = (CARD32) value;
+
+    if (client->swapped) {
+        swapl(&scratch.resource_type);
+        swapl(&scratch.count);
+    }
+    WriteToClient(client, sz_xXResType, &scratch);
+}
+
 static int
 ProcXResQueryClientResources(ClientPtr client)
 {
@@ -320,6 +350,10 @@ ProcXResQueryClientResources(ClientPtr client)
             num_types++;
     }
 
+    /* the server's own counters come after its resources */
+    if (clientID == 0)
+        FindServerCounters(ResCountServerCounter, &num_types);
+
     rep = (xXResQueryClientResourcesReply) {
         .type = X_Reply,
         .sequenceNumber = client->sequence,
@@ -350,6 +384,8 @@ ProcXResQueryClientResources(ClientPtr client)
             }
             WriteToClient(client, sz_xXResType, &scratch);
         }
+        if (clientID == 0)
+            FindServerCounters(ResWriteServerCounter, client);
     }
 
     free(counts);
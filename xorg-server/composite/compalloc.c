@@ -182,6 +182,7 @@ compRedirectWindow(ClientPtr pClient, WindowPtr pWin, int update)
             free(cw);
             return BadAlloc;
         }
+        DamageSetBatched(cw->damage, TRUE);
 
         anyMarked = compMarkWindows(pWin, &pLayerWin);
 
@@ -300,6 +301,7 @@ compFreeClientWindow(WindowPtr pWin, XID id)
         DamageRegister(&pWin->drawable, cw->damage);
         cw->damageRegistered = TRUE;
         pWin->redirectDraw = RedirectDrawAutomatic;
+        MarkGeometryChanged(pWin);
         DamageDamageRegion(&pWin->drawable, &pWin->borderSize);
     }
 
@@ -610,6 +612,7 @@ compAllocPixmap(WindowPtr pWin)
         pWin->redirectDraw = RedirectDrawAutomatic;
     else
         pWin->redirectDraw = RedirectDrawManual;
+    MarkGeometryChanged(pWin);
 
     compSetPixmap(pWin, pPixmap, bw);
     cw->oldx = COMP_ORIGIN_INVALID;
@@ -650,6 +653,7 @@ compSetParentPixmap(WindowPtr pWin)
     RegionCopy(&pWin->borderClip, &cw->borderClip);
     pParentPixmap = (*pScreen->GetWindowPixmap) (pWin->parent);
     pWin->redirectDraw = RedirectDrawNone;
+    MarkGeometryChanged(pWin);
     compSetPixmap(pWin, pParentPixmap, pWin->borderWidth);
 }
 
@@ -179,6 +179,7 @@ compCheckRedirect(WindowPtr pWin)
             pWin->redirectDraw = RedirectDrawAutomatic;
         else
             pWin->redirectDraw = RedirectDrawManual;
+        MarkGeometryChanged(pWin);
     }
     return TRUE;
 }
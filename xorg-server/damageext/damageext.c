@@ -213,6 +213,7 @@ static void
 DamageExtRegister(DrawablePtr pDrawable, DamagePtr pDamage, Bool report)
 {
     DamageSetReportAfterOp(pDamage, TRUE);
+    DamageSetBatched(pDamage, TRUE);
     DamageRegister(pDrawable, pDamage);
 
     if (report) {
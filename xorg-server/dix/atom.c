@@ -56,106 +56,230 @@ SOFTWARE.
 #include "resource.h"
 #include "dix.h"
 
+/*
+ * Atoms are found by name through an open-addressed hash table, and by
+ * number through an array indexed by the atom.  Names of atoms made after
+ * the predefined ones are copied into large chunks that are only freed
+ * all at once.
+ *
+ * Only the main thread makes atoms, but the input thread may look them up
+ * at any time without a lock.  So nothing a reader can see is ever changed
+ * in place: a new entry is complete before the slot pointing at it is
+ * filled in, and a table that has to grow is replaced by a copy, the old
+ * one being kept until the atoms are freed.
+ */
 #define InitialTableSize 256
+#define InitialHashSize 512
+#define AtomChunkSize 16384
 
-typedef struct _Node {
-    struct _Node *left, *right;
-    Atom a;
-    unsigned int fingerPrint;
+#if INPUTTHREAD
+#define atomLoad(p)             __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define atomStore(p, v)         __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else
+#define atomLoad(p)             (*(p))
+#define atomStore(p, v)         (*(p) = (v))
+#endif
+
+typedef struct _AtomEntry {
     const char *string;
-} NodeRec, *NodePtr;
+    unsigned int len;
+    CARD32 hash;
+} AtomEntryRec, *AtomEntryPtr;
+
+/* Atom -> name, lastAtom + 1 entries used */
+typedef struct _AtomNames {
+    struct _AtomNames *prev;
+    unsigned long size;
+    AtomEntryRec entries[];
+} AtomNamesRec, *AtomNamesPtr;
+
+/* Name -> atom, kept at most half full, None in empty slots */
+typedef struct _AtomHash {
+    struct _AtomHash *prev;
+    unsigned long mask;
+    Atom slots[];
+} AtomHashRec, *AtomHashPtr;
+
+typedef struct _AtomChunk {
+    struct _AtomChunk *next;
+    size_t used, size;
+    char data[];
+} AtomChunkRec, *AtomChunkPtr;
 
 static Atom lastAtom = None;
-static NodePtr atomRoot = NULL;
-static unsigned long tableLength;
-static NodePtr *nodeTable;
+static AtomNamesPtr atomNames;
+static AtomHashPtr atomHash;
+static AtomChunkPtr atomChunks;
 
-Atom
-MakeAtom(const char *string, unsigned len, Bool makeit)
+/* Bob Jenkins' one-at-a-time hash, as in Xext/hashtable.c */
+static CARD32
+AtomHashString(const char *string, unsigned len)
 {
-    NodePtr *np;
+    CARD32 hash = 0;
     unsigned i;
-    int comp;
-    unsigned int fp = 0;
 
-    np = &atomRoot;
-    for (i = 0; i < (len + 1) / 2; i++) {
-        fp = fp * 27 + string[i];
-        fp = fp * 27 + string[len - 1 - i];
+    for (i = 0; i < len; i++) {
+        hash += (unsigned char) string[i];
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
     }
-    while (*np != NULL) {
-        if (fp < (*np)->fingerPrint)
-            np = &((*np)->left);
-        else if (fp > (*np)->fingerPrint)
-            np = &((*np)->right);
-        else {                  /* now start testing the strings */
-            comp = strncmp(string, (*np)->string, (int) len);
-            if ((comp < 0) || ((comp == 0) && (len < strlen((*np)->string))))
-                np = &((*np)->left);
-            else if (comp > 0)
-                np = &((*np)->right);
-            else
-                return (*np)->a;
-        }
-    }
-    if (makeit) {
-        NodePtr nd;
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+    return hash;
+}
 
-        nd = malloc(sizeof(NodeRec));
-        if (!nd)
-            return BAD_RESOURCE;
-        if (lastAtom < XA_LAST_PREDEFINED) {
-            nd->string = string;
+static const char *
+AtomCopyString(const char *string, unsigned len)
+{
+    AtomChunkPtr chunk = atomChunks;
+    char *copy;
+
+    if (!chunk || chunk->size - chunk->used < len + 1) {
+        size_t size = max(AtomChunkSize, len + 1);
+
+        chunk = malloc(sizeof(AtomChunkRec) + size);
+        if (!chunk)
+            return NULL;
+        chunk->used = 0;
+        chunk->size = size;
+        /* a long name gets a chunk of its own, behind the current one */
+        if (len + 1 > AtomChunkSize / 4 && atomChunks) {
+            chunk->next = atomChunks->next;
+            atomChunks->next = chunk;
         }
         else {
-            nd->string = strndup(string, len);
-            if (!nd->string) {
-                free(nd);
-                return BAD_RESOURCE;
-            }
+            chunk->next = atomChunks;
+            atomChunks = chunk;
         }
-        if ((lastAtom + 1) >= tableLength) {
-            NodePtr *table;
-
-            table = reallocarray(nodeTable, tableLength, 2 * sizeof(NodePtr));
-            if (!table) {
-                if (nd->string != string) {
-                    /* nd->string has been strdup'ed */
-                    free((char *) nd->string);
-                }
-                free(nd);
-                return BAD_RESOURCE;
-            }
-            tableLength <<= 1;
-            nodeTable = table;
-        }
-        *np = nd;
-        nd->left = nd->right = NULL;
-        nd->fingerPrint = fp;
-        nd->a = ++lastAtom;
-        nodeTable[lastAtom] = nd;
-        return nd->a;
     }
-    else
-        return None;
+    copy = chunk->data + chunk->used;
+    memcpy(copy, string, len);
+    copy[len] = '\0';
+    chunk->used += len + 1;
+    return copy;
+}
+
+static Atom
+AtomLookup(AtomHashPtr table, AtomNamesPtr names, CARD32 hash,
+           const char *string, unsigned len, unsigned long *slot)
+{
+    unsigned long i;
+    Atom a;
+
+    for (i = hash & table->mask; (a = atomLoad(&table->slots[i])) != None;
+         i = (i + 1) & table->mask) {
+        AtomEntryPtr entry;
+
+        /* the slot may be newer than the names we loaded */
+        if (a >= names->size)
+            names = atomLoad(&atomNames);
+        entry = &names->entries[a];
+        if (entry->hash == hash && entry->len == len &&
+            memcmp(entry->string, string, len) == 0)
+            return a;
+    }
+    if (slot)
+        *slot = i;
+    return None;
+}
+
+static Bool
+AtomGrowNames(void)
+{
+    AtomNamesPtr names;
+    unsigned long size = atomNames->size * 2;
+
+    names = malloc(sizeof(AtomNamesRec) + size * sizeof(AtomEntryRec));
+    if (!names)
+        return FALSE;
+    names->prev = atomNames;
+    names->size = size;
+    memcpy(names->entries, atomNames->entries,
+           (lastAtom + 1) * sizeof(AtomEntryRec));
+    atomStore(&atomNames, names);
+    return TRUE;
+}
+
+static Bool
+AtomGrowHash(void)
+{
+    AtomHashPtr table;
+    unsigned long size = (atomHash->mask + 1) * 2;
+    Atom a;
+
+    table = calloc(1, sizeof(AtomHashRec) + size * sizeof(Atom));
+    if (!table)
+        return FALSE;
+    table->prev = atomHash;
+    table->mask = size - 1;
+    for (a = None + 1; a <= lastAtom; a++) {
+        unsigned long i = atomNames->entries[a].hash & table->mask;
+
+        while (table->slots[i] != None)
+            i = (i + 1) & table->mask;
+        table->slots[i] = a;
+    }
+    atomStore(&atomHash, table);
+    return TRUE;
+}
+
+Atom
+MakeAtom(const char *string, unsigned len, Bool makeit)
+{
+    AtomHashPtr table = atomLoad(&atomHash);
+    AtomNamesPtr names = atomLoad(&atomNames);
+    AtomEntryPtr entry;
+    CARD32 hash;
+    unsigned long slot;
+    Atom a;
+
+    hash = AtomHashString(string, len);
+    a = AtomLookup(table, names, hash, string, len, &slot);
+    if (a != None || !makeit)
+        return a;
+
+    /* Only the main thread gets here, so the tables are the latest ones */
+    if ((lastAtom + 1) * 2 > table->mask) {
+        if (!AtomGrowHash())
+            return BAD_RESOURCE;
+        table = atomHash;
+        AtomLookup(table, atomNames, hash, string, len, &slot);
+    }
+    if (lastAtom + 1 >= atomNames->size && !AtomGrowNames())
+        return BAD_RESOURCE;
+
+    entry = &atomNames->entries[lastAtom + 1];
+    if (lastAtom < XA_LAST_PREDEFINED) {
+        entry->string = string;
+    }
+    else {
+        entry->string = AtomCopyString(string, len);
+        if (!entry->string)
+            return BAD_RESOURCE;
+    }
+    entry->len = len;
+    entry->hash = hash;
+    atomStore(&lastAtom, lastAtom + 1);
+    atomStore(&table->slots[slot], lastAtom);
+    return lastAtom;
 }
 
 Bool
 ValidAtom(Atom atom)
 {
-    return (atom != None) && (atom <= lastAtom);
+    return (atom != None) && (atom <= atomLoad(&lastAtom));
 }
 
 const char *
 NameForAtom(Atom atom)
 {
-    NodePtr node;
+    AtomNamesPtr names;
 
-    if (atom > lastAtom)
-        return 0;
-    if ((node = nodeTable[atom]) == NULL)
+    if (atom == None || atom > atomLoad(&lastAtom))
         return 0;
-    return node->string;
+    names = atomLoad(&atomNames);
+    return names->entries[atom].string;
 }
 
 void
@@ -164,32 +288,27 @@ AtomError(void)
     FatalError("initializing atoms");
 }
 
-static void
-FreeAtom(NodePtr patom)
-{
-    if (patom->left)
-        FreeAtom(patom->left);
-    if (patom->right)
-        FreeAtom(patom->right);
-    if (patom->a > XA_LAST_PREDEFINED) {
-        /*
-         * All strings above XA_LAST_PREDEFINED are strdup'ed, so it's safe to
-         * cast here
-         */
-        free((char *) patom->string);
-    }
-    free(patom);
-}
-
 void
 FreeAllAtoms(void)
 {
-    if (atomRoot == NULL)
-        return;
-    FreeAtom(atomRoot);
-    atomRoot = NULL;
-    free(nodeTable);
-    nodeTable = NULL;
+    while (atomHash) {
+        AtomHashPtr prev = atomHash->prev;
+
+        free(atomHash);
+        atomHash = prev;
+    }
+    while (atomNames) {
+        AtomNamesPtr prev = atomNames->prev;
+
+        free(atomNames);
+        atomNames = prev;
+    }
+    while (atomChunks) {
+        AtomChunkPtr next = atomChunks->next;
+
+        free(atomChunks);
+        atomChunks = next;
+    }
     lastAtom = None;
 }
 
@@ -197,11 +316,16 @@ void
 InitAtoms(void)
 {
     FreeAllAtoms();
-    tableLength = InitialTableSize;
-    nodeTable = xallocarray(InitialTableSize, sizeof(NodePtr));
-    if (!nodeTable)
+    atomNames = malloc(sizeof(AtomNamesRec) +
+                       InitialTableSize * sizeof(AtomEntryRec));
+    atomHash = calloc(1, sizeof(AtomHashRec) + InitialHashSize * sizeof(Atom));
+    if (!atomNames || !atomHash)
         AtomError();
-    nodeTable[None] = NULL;
+    atomNames->prev = NULL;
+    atomNames->size = InitialTableSize;
+    atomNames->entries[None].string = NULL;
+    atomHash->prev = NULL;
+    atomHash->mask = InitialHashSize - 1;
     MakePredeclaredAtoms();
     if (lastAtom != XA_LAST_PREDEFINED)
         AtomError();
@@ -798,7 +798,7 @@ FreeGC(void *value, XID gid)
     (*pGC->funcs->DestroyGC) (pGC);
     if (pGC->dash != DefaultDash)
         free(pGC->dash);
-    dixFreeObjectWithPrivates(pGC, PRIVATE_GC);
+    dixFreeScreenObjectWithPrivates(pGC->pScreen, pGC, PRIVATE_GC);
     return Success;
 }
 
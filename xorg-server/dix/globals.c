@@ -83,6 +83,7 @@ ClientPtr clients[MAXCLIENTS];
 ClientPtr serverClient;
 int currentMaxClients;          /* current size of clients array */
 long maxBigRequestSize = MAX_BIG_REQUEST_SIZE;
+long maxClientOutput = 0;
 
 unsigned long globalSerialNumber = 0;
 unsigned long serverGeneration = 0;
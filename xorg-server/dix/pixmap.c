@@ -116,7 +116,10 @@ AllocatePixmap(ScreenPtr pScreen, int pixDataSize)
     if (pScreen->totalPixmapSize > ((size_t) - 1) - pixDataSize)
         return NullPixmap;
 
-    pPixmap = malloc(pScreen->totalPixmapSize + pixDataSize);
+    /* headers alone, as fb allocates them, come out of the screen's cache */
+    pPixmap = dixAllocateScreenObject(pScreen,
+                                      pScreen->totalPixmapSize + pixDataSize,
+                                      PRIVATE_PIXMAP);
     if (!pPixmap)
         return NullPixmap;
 
@@ -128,8 +131,8 @@ AllocatePixmap(ScreenPtr pScreen, int pixDataSize)
 void
 FreePixmap(PixmapPtr pPixmap)
 {
-    dixFiniPrivates(pPixmap, PRIVATE_PIXMAP);
-    free(pPixmap);
+    dixFreeScreenObjectWithPrivates(pPixmap->drawable.pScreen, pPixmap,
+                                    PRIVATE_PIXMAP);
 }
 
 void PixmapUnshareSlavePixmap(PixmapPtr slave_pixmap)
@@ -135,6 +135,33 @@ static const Bool screen_specific_private[PRIVATE_LAST] = {
     /*[PRIVATE_SYNC_FENCE] =*/ FALSE
 };
 
+/* Objects recycled by dixAllocateScreenObject */
+static const Bool cached_private[PRIVATE_LAST] = {
+    /*[PRIVATE_XSELINUX] =*/ FALSE,
+    /*[PRIVATE_SCREEN] =*/ FALSE,
+    /*[PRIVATE_EXTENSION] =*/ FALSE,
+    /*[PRIVATE_COLORMAP] =*/ FALSE,
+    /*[PRIVATE_DEVICE] =*/ FALSE,
+    /*[PRIVATE_CLIENT] =*/ FALSE,
+    /*[PRIVATE_PROPERTY] =*/ FALSE,
+    /*[PRIVATE_SELECTION] =*/ FALSE,
+    /*[PRIVATE_WINDOW] =*/ TRUE,
+    /*[PRIVATE_PIXMAP] =*/ TRUE,
+    /*[PRIVATE_GC] =*/ TRUE,
+    /*[PRIVATE_CURSOR] =*/ FALSE,
+    /*[PRIVATE_CURSOR_BITS] =*/ FALSE,
+    /*[PRIVATE_GLYPH] =*/ FALSE,
+    /*[PRIVATE_GLYPHSET] =*/ FALSE,
+    /*[PRIVATE_PICTURE] =*/ FALSE,
+    /*[PRIVATE_SYNC_FENCE] =*/ FALSE
+};
+
+/* Freed objects kept per screen and type */
+#define MAX_CACHED_OBJECTS      128
+
+/* cachedSize of a set that no longer caches */
+#define CACHE_STOPPED           ((size_t) -1)
+
 typedef Bool (*FixupFunc) (PrivatePtr *privates, int offset, unsigned bytes);
 
 typedef enum { FixupMove, FixupRealloc } FixupType;
@@ -324,6 +351,23 @@ grow_private_set(DevPrivateSetPtr set, unsigned bytes)
     set->offset += bytes;
 }
 
+/*
+ * Free the cached objects of a set.  Nothing of the type exists when its
+ * privates grow, so this is all there is to make the cache follow.
+ */
+static void
+flush_object_cache(DevPrivateSetPtr set, size_t size)
+{
+    while (set->cached) {
+        void *next = *(void **) set->cached;
+
+        free(set->cached);
+        set->cached = next;
+    }
+    set->numCached = 0;
+    set->cachedSize = size;
+}
+
 static void
 grow_screen_specific_set(DevPrivateType type, unsigned bytes)
 {
@@ -334,11 +378,13 @@ grow_screen_specific_set(DevPrivateType type, unsigned bytes)
         ScreenPtr       pScreen = screenInfo.screens[s];
 
         grow_private_set(&pScreen->screenSpecificPrivates[type], bytes);
+        flush_object_cache(&pScreen->screenSpecificPrivates[type], 0);
     }
     for (s = 0; s < screenInfo.numGPUScreens; s++) {
         ScreenPtr       pScreen = screenInfo.gpuscreens[s];
 
         grow_private_set(&pScreen->screenSpecificPrivates[type], bytes);
+        flush_object_cache(&pScreen->screenSpecificPrivates[type], 0);
     }
 }
 
@@ -642,6 +688,7 @@ dixRegisterScreenSpecificPrivateKey(ScreenPtr pScreen, DevPrivateKey key,
     assert (!pScreen->screenSpecificPrivates[type].created);
     offset = pScreen->screenSpecificPrivates[type].offset;
     pScreen->screenSpecificPrivates[type].offset += bytes;
+    flush_object_cache(&pScreen->screenSpecificPrivates[type], 0);
 
     /* Setup this key */
     key->offset = offset;
@@ -667,6 +714,8 @@ dixFreeScreenSpecificPrivates(ScreenPtr pScreen)
         for (key = pScreen->screenSpecificPrivates[t].key; key; key = key->next) {
             key->initialized = FALSE;
         }
+        /* CloseScreen may still free objects, which mustn't be kept */
+        flush_object_cache(&pScreen->screenSpecificPrivates[t], CACHE_STOPPED);
     }
 }
 
@@ -726,7 +775,7 @@ _dixAllocateScreenObjectWithPrivates(ScreenPtr pScreen,
     /* round up so that pointer is aligned */
     baseSize = (baseSize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
     totalSize = baseSize + privates_size;
-    object = malloc(totalSize);
+    object = dixAllocateScreenObject(pScreen, totalSize, type);
     if (!object)
         return NULL;
 
@@ -739,6 +788,68 @@ _dixAllocateScreenObjectWithPrivates(ScreenPtr pScreen,
     return object;
 }
 
+void *
+dixAllocateScreenObject(ScreenPtr pScreen, size_t size, DevPrivateType type)
+{
+    DevPrivateSetPtr set;
+    void *object;
+
+    if (!pScreen || !cached_private[type])
+        return malloc(size);
+
+    set = &pScreen->screenSpecificPrivates[type];
+    if (set->cachedSize != size) {
+        /* the first object of the type sets the size */
+        if (set->cachedSize == 0)
+            set->cachedSize = size;
+        else
+            flush_object_cache(set, CACHE_STOPPED);
+        return malloc(size);
+    }
+
+    object = set->cached;
+    if (!object)
+        return malloc(size);
+    set->cached = *(void **) object;
+    set->numCached--;
+    return object;
+}
+
+void
+dixFreeScreenObject(ScreenPtr pScreen, void *object, DevPrivateType type)
+{
+    DevPrivateSetPtr set;
+
+    if (!pScreen || !cached_private[type] || !object) {
+        free(object);
+        return;
+    }
+
+    set = &pScreen->screenSpecificPrivates[type];
+    if (set->cachedSize == 0 || set->cachedSize == CACHE_STOPPED ||
+        set->numCached >= MAX_CACHED_OBJECTS) {
+        free(object);
+        return;
+    }
+    *(void **) object = set->cached;
+    set->cached = object;
+    set->numCached++;
+}
+
+/*
+ * Free an object allocated with dixAllocateScreenObjectWithPrivates
+ *
+ * This is expected to be invoked from the
+ * dixFreeScreenObjectWithPrivates macro
+ */
+void
+_dixFreeScreenObjectWithPrivates(ScreenPtr pScreen, void *object,
+                                 PrivatePtr privates, DevPrivateType type)
+{
+    _dixFiniPrivates(privates, type);
+    dixFreeScreenObject(pScreen, object, type);
+}
+
 int
 dixScreenSpecificPrivatesSize(ScreenPtr pScreen, DevPrivateType type)
 {
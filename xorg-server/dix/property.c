@@ -67,6 +67,153 @@ SOFTWARE.
  *
  *****************************************************************/
 
+/*
+ * Windows with many properties, the root window in particular, get a hash
+ * index from property name to the first property of that name in the
+ * list.  The list stays as it is: it gives the order properties are
+ * listed in, and is walked elsewhere.  There is only more than one
+ * property of a name when a security module polyinstantiates them.
+ */
+#define PROPERTY_INDEX_MIN      16
+
+typedef struct _PropertyIndex {
+    int bits;                   /* log2 of the number of slots */
+    int count;                  /* properties in the list */
+    int hidden;                 /* properties behind one of the same name */
+    PropertyPtr slots[];
+} PropertyIndexRec, *PropertyIndexPtr;
+
+static unsigned
+PropertyHash(Atom name, int bits)
+{
+    return ((CARD32) name * 2654435761U) >> (32 - bits);
+}
+
+static PropertyPtr *
+PropertyIndexSlot(PropertyIndexPtr index, Atom name)
+{
+    unsigned mask = (1U << index->bits) - 1;
+    unsigned i = PropertyHash(name, index->bits);
+
+    while (index->slots[i] && index->slots[i]->propertyName != name)
+        i = (i + 1) & mask;
+    return &index->slots[i];
+}
+
+/* Without memory for the index, the list is walked as it used to be */
+static void
+PropertyIndexBuild(WindowPtr pWin, int bits)
+{
+    PropertyIndexPtr index;
+    PropertyPtr pProp, *slot;
+
+    free(pWin->optional->propIndex);
+    index = calloc(1, sizeof(PropertyIndexRec) +
+                   (sizeof(PropertyPtr) << bits));
+    pWin->optional->propIndex = index;
+    if (!index)
+        return;
+
+    index->bits = bits;
+    for (pProp = pWin->optional->userProps; pProp; pProp = pProp->next) {
+        slot = PropertyIndexSlot(index, pProp->propertyName);
+        if (*slot)
+            index->hidden++;
+        else
+            *slot = pProp;
+        index->count++;
+    }
+}
+
+static void
+PropertyIndexRemove(PropertyIndexPtr index, PropertyPtr *slot)
+{
+    unsigned mask = (1U << index->bits) - 1;
+    unsigned hole = slot - index->slots, i = hole, home;
+
+    /* move back entries that probed past the hole */
+    for (i = (i + 1) & mask; index->slots[i]; i = (i + 1) & mask) {
+        home = PropertyHash(index->slots[i]->propertyName, index->bits);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            index->slots[hole] = index->slots[i];
+            hole = i;
+        }
+    }
+    index->slots[hole] = NULL;
+}
+
+static void
+LinkProperty(WindowPtr pWin, PropertyPtr pProp)
+{
+    WindowOptPtr optional = pWin->optional;
+    PropertyIndexPtr index = optional->propIndex;
+    PropertyPtr *slot, other;
+    int count;
+
+    pProp->prev = NULL;
+    pProp->next = optional->userProps;
+    if (pProp->next)
+        pProp->next->prev = pProp;
+    optional->userProps = pProp;
+
+    if (index) {
+        /* the new property comes first in the list */
+        slot = PropertyIndexSlot(index, pProp->propertyName);
+        if (*slot)
+            index->hidden++;
+        *slot = pProp;
+        if (2 * ++index->count > 1 << index->bits)
+            PropertyIndexBuild(pWin, index->bits + 1);
+    }
+    else {
+        count = 0;
+        for (other = pProp; other; other = other->next)
+            count++;
+        if (count >= PROPERTY_INDEX_MIN)
+            PropertyIndexBuild(pWin, 6);
+    }
+}
+
+static void
+UnlinkProperty(WindowPtr pWin, PropertyPtr pProp)
+{
+    WindowOptPtr optional = pWin->optional;
+    PropertyIndexPtr index = optional->propIndex;
+    PropertyPtr *slot, other = NULL;
+
+    if (index) {
+        slot = PropertyIndexSlot(index, pProp->propertyName);
+        if (*slot != pProp)
+            index->hidden--;
+        else {
+            if (index->hidden)
+                for (other = pProp->next; other; other = other->next)
+                    if (other->propertyName == pProp->propertyName)
+                        break;
+            if (other) {
+                *slot = other;
+                index->hidden--;
+            }
+            else
+                PropertyIndexRemove(index, slot);
+        }
+        if (--index->count == 0) {
+            free(index);
+            optional->propIndex = NULL;
+        }
+    }
+
+    if (pProp->prev)
+        pProp->prev->next = pProp->next;
+    else
+        optional->userProps = pProp->next;
+    if (pProp->next)
+        pProp->next->prev = pProp->prev;
+
+    if (!optional->userProps)
+        CheckWindowOptionalNeed(pWin);
+}
+
 #ifdef notdef
 static void
 PrintPropertys(WindowPtr pWin)
@@ -95,9 +242,12 @@ dixLookupProperty(PropertyPtr *result, WindowPtr pWin, Atom propertyName,
 
     client->errorValue = propertyName;
 
-    for (pProp = wUserProps(pWin); pProp; pProp = pProp->next)
-        if (pProp->propertyName == propertyName)
-            break;
+    if (pWin->optional && pWin->optional->propIndex)
+        pProp = *PropertyIndexSlot(pWin->optional->propIndex, propertyName);
+    else
+        for (pProp = wUserProps(pWin); pProp; pProp = pProp->next)
+            if (pProp->propertyName == propertyName)
+                break;
 
     if (pProp)
         rc = XaceHookPropertyAccess(client, pWin, &pProp, access_mode);
@@ -293,8 +443,7 @@ dixChangeWindowProperty(ClientPtr pClient, WindowPtr pWin, Atom property,
             pClient->errorValue = property;
             return rc;
         }
-        pProp->next = pWin->optional->userProps;
-        pWin->optional->userProps = pProp;
+        LinkProperty(pWin, pProp);
     }
     else if (rc == Success) {
         /* To append or prepend to a property the request format and type
@@ -368,7 +517,7 @@ dixChangeWindowProperty(ClientPtr pClient, WindowPtr pWin, Atom property,
 int
 DeleteProperty(ClientPtr client, WindowPtr pWin, Atom propName)
 {
-    PropertyPtr pProp, prevProp;
+    PropertyPtr pProp;
     int rc;
 
     rc = dixLookupProperty(&pProp, pWin, propName, client, DixDestroyAccess);
@@ -376,19 +525,7 @@ DeleteProperty(ClientPtr client, WindowPtr pWin, Atom propName)
         return Success;         /* Succeed if property does not exist */
 
     if (rc == Success) {
-        if (pWin->optional->userProps == pProp) {
-            /* Takes care of head */
-            if (!(pWin->optional->userProps = pProp->next))
-                CheckWindowOptionalNeed(pWin);
-        }
-        else {
-            /* Need to traverse to find the previous element */
-            prevProp = pWin->optional->userProps;
-            while (prevProp->next != pProp)
-                prevProp = prevProp->next;
-            prevProp->next = pProp->next;
-        }
-
+        UnlinkProperty(pWin, pProp);
         deliverPropertyNotifyEvent(pWin, PropertyDelete, pProp);
         free(pProp->data);
         dixFreeObjectWithPrivates(pProp, PRIVATE_PROPERTY);
@@ -410,8 +547,11 @@ DeleteAllWindowProperties(WindowPtr pWin)
         pProp = pNextProp;
     }
 
-    if (pWin->optional)
+    if (pWin->optional) {
         pWin->optional->userProps = NULL;
+        free(pWin->optional->propIndex);
+        pWin->optional->propIndex = NULL;
+    }
 }
 
 static int
@@ -442,7 +582,7 @@ NullPropertyReply(ClientPtr client, ATOM propertyType, int format)
 int
 ProcGetProperty(ClientPtr client)
 {
-    PropertyPtr pProp, prevProp;
+    PropertyPtr pProp;
     unsigned long n, len, ind;
     int rc;
     WindowPtr pWin;
@@ -543,19 +683,7 @@ ProcGetProperty(ClientPtr client)
 
     if (stuff->delete && (reply.bytesAfter == 0)) {
         /* Delete the Property */
-        if (pWin->optional->userProps == pProp) {
-            /* Takes care of head */
-            if (!(pWin->optional->userProps = pProp->next))
-                CheckWindowOptionalNeed(pWin);
-        }
-        else {
-            /* Need to traverse to find the previous element */
-            prevProp = pWin->optional->userProps;
-            while (prevProp->next != pProp)
-                prevProp = prevProp->next;
-            prevProp->next = pProp->next;
-        }
-
+        UnlinkProperty(pWin, pProp);
         free(pProp->data);
         dixFreeObjectWithPrivates(pProp, PRIVATE_PROPERTY);
     }
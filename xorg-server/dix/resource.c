@@ -142,6 +142,7 @@ Equipment Corporation.
 #include <assert.h>
 #include "registry.h"
 #include "gcstruct.h"
+#include "list.h"
 
 #ifdef XSERVER_DTRACE
 #include "probes.h"
@@ -149,31 +150,71 @@ Equipment Corporation.
 #define TypeNameString(t) LookupResourceName(t)
 #endif
 
-static void RebuildTable(int    /*client */
-    );
-
 #define SERVER_MINID 32
 
-#define INITBUCKETS 64
-#define INITHASHSIZE 6
-#define MAXHASHSIZE 16
+/*
+ * Each client's resources live in an open-addressed hash table keyed on
+ * the resource ID.  A slot holds the ID inline so a probe sequence only
+ * touches the slot array; all resources sharing one ID hang off the slot
+ * in a short chain, newest first.  Collisions are resolved by linear
+ * probing and deletions shift the following entries back (Knuth's
+ * algorithm R), so live tables never contain tombstones.  The slot also
+ * caches the type and value of the newest resource on its chain, so the
+ * common lookup touches nothing but the slot array.
+ *
+ * When the table grows, the old slot array is kept around and drained a
+ * few slots at a time by later insertions, so no single request pays for
+ * rehashing a client with a hundred thousand resources.  Lookups check
+ * the new table and then whatever remains in the old one, moving what
+ * they find there across.  Entries leave a tombstone behind in the old
+ * table, which is never inserted into and so never needs compacting.
+ *
+ * Independently of the hash, every resource is also linked into a
+ * per-client list of all resources and a per-client list for its type,
+ * both newest first, so that the walkers below never scan empty slots
+ * and type-restricted walks only visit resources of that type.
+ */
+
+#define INITSLOTS 64
+#define INITSLOTBITS 6
+#define MIGRATESLOTS 8          /* old slots drained per insertion */
 
 typedef struct _Resource {
-    struct _Resource *next;
+    struct _Resource *next;     /* next resource with the same id */
     XID id;
     RESTYPE type;
     void *value;
+    struct xorg_list all;       /* ClientResourceRec.all */
+    struct xorg_list byType;    /* ClientResourceRec.byType[type] */
 } ResourceRec, *ResourcePtr;
 
+typedef struct _ResourceSlot {
+    XID id;
+    RESTYPE type;               /* res->type */
+    void *value;                /* res->value */
+    ResourcePtr res;            /* NULL if empty */
+} ResourceSlot;
+
 typedef struct _ClientResource {
-    ResourcePtr *resources;
+    ResourceSlot *slots;        /* NULL if client not in use */
+    ResourceSlot *oldSlots;     /* table being drained, or NULL */
+    int bits;                   /* log(2) of the number of slots */
+    int used;                   /* occupied slots in slots */
+    int oldUsed;                /* occupied slots left in oldSlots */
+    int oldBits;
+    int migrate;                /* next oldSlots index to drain */
     int elements;
-    int buckets;
-    int hashsize;               /* log(2)(buckets) */
+    struct xorg_list all;
+    struct xorg_list **byType;  /* indexed by type & TypeMask */
+    int numTypes;
     XID fakeID;
     XID endFakeID;
 } ClientResourceRec;
 
+/* Marks a slot in oldSlots whose entry has been moved */
+static ResourceRec slotTombstone;
+#define SLOT_TOMBSTONE (&slotTombstone)
+
 RESTYPE lastResourceType;
 static RESTYPE lastResourceClass;
 RESTYPE TypeMask;
@@ -600,6 +641,13 @@ CreateNewResourceClass(void)
 
 static ClientResourceRec clientTable[MAXCLIENTS];
 
+static char resourceMarker;
+
+/* Walkers link a marker like this in behind the resource they are visiting */
+#define IS_MARKER(res) ((res)->value == (void *) &resourceMarker)
+
+#define RESOURCE_LINK(res, typed) ((typed) ? &(res)->byType : &(res)->all)
+
 static unsigned int
 ilog2(int val)
 {
@@ -620,7 +668,16 @@ ilog2(int val)
 unsigned int
 ResourceClientBits(void)
 {
-    return (ilog2(LimitClients));
+    /* CLIENT_ID() calls this for every lookup; LimitClients is only ever
+     * changed on the command line, so cache the answer */
+    static int limit;
+    static unsigned int bits;
+
+    if (limit != LimitClients) {
+        bits = ilog2(LimitClients);
+        limit = LimitClients;
+    }
+    return bits;
 }
 
 /*****************
@@ -632,7 +689,7 @@ ResourceClientBits(void)
 Bool
 InitClientResources(ClientPtr client)
 {
-    int i, j;
+    ClientResourceRec *rrec;
 
     if (client == serverClient) {
         lastResourceType = RT_LASTPREDEF;
@@ -644,24 +701,28 @@ InitClientResources(ClientPtr client)
             return FALSE;
         memcpy(resourceTypes, predefTypes, sizeof(predefTypes));
     }
-    clientTable[i = client->index].resources =
-        malloc(INITBUCKETS * sizeof(ResourcePtr));
-    if (!clientTable[i].resources)
+    rrec = &clientTable[client->index];
+    rrec->slots = calloc(INITSLOTS, sizeof(ResourceSlot));
+    if (!rrec->slots)
         return FALSE;
-    clientTable[i].buckets = INITBUCKETS;
-    clientTable[i].elements = 0;
-    clientTable[i].hashsize = INITHASHSIZE;
+    rrec->oldSlots = NULL;
+    rrec->bits = INITSLOTBITS;
+    rrec->used = 0;
+    rrec->oldUsed = 0;
+    rrec->oldBits = 0;
+    rrec->migrate = 0;
+    rrec->elements = 0;
+    xorg_list_init(&rrec->all);
+    rrec->byType = NULL;
+    rrec->numTypes = 0;
     /* Many IDs allocated from the server client are visible to clients,
      * so we don't use the SERVER_BIT for them, but we have to start
      * past the magic value constants used in the protocol.  For normal
      * clients, we can start from zero, with SERVER_BIT set.
      */
-    clientTable[i].fakeID = client->clientAsMask |
+    rrec->fakeID = client->clientAsMask |
         (client->index ? SERVER_BIT : SERVER_MINID);
-    clientTable[i].endFakeID = (clientTable[i].fakeID | RESOURCE_ID_MASK) + 1;
-    for (j = 0; j < INITBUCKETS; j++) {
-        clientTable[i].resources[j] = NULL;
-    }
+    rrec->endFakeID = (rrec->fakeID | RESOURCE_ID_MASK) + 1;
     return TRUE;
 }
 
@@ -678,18 +739,254 @@ HashResourceID(XID id, int numBits)
     return (id ^ (id >> numBits)) & ~((~0) << numBits);
 }
 
-static XID
-AvailableID(int client, XID id, XID maxid, XID goodid)
+/*
+ * Home slot of id in a table of 2^bits slots.  Multiplicative (Fibonacci)
+ * hashing takes the top bits of the product, which spreads both runs of
+ * consecutive IDs and IDs allocated with a fixed stride.
+ */
+static inline unsigned int
+SlotIndex(XID id, int bits)
+{
+    return ((uint32_t) id * 0x9E3779B1U) >> (32 - bits);
+}
+
+/* id must not be in the table yet */
+static ResourceSlot *
+InsertSlot(ClientResourceRec *rrec, XID id, ResourcePtr res)
+{
+    unsigned int i, mask;
+
+    mask = (1U << rrec->bits) - 1;
+    for (i = SlotIndex(id, rrec->bits); rrec->slots[i].res; i = (i + 1) & mask)
+        ;
+    rrec->slots[i].id = id;
+    rrec->slots[i].type = res->type;
+    rrec->slots[i].value = res->value;
+    rrec->slots[i].res = res;
+    rrec->used++;
+    return &rrec->slots[i];
+}
+
+static ResourceSlot *
+FindSlot(ClientResourceRec *rrec, XID id)
+{
+    ResourceSlot *slot;
+    unsigned int i, mask;
+
+    mask = (1U << rrec->bits) - 1;
+    for (i = SlotIndex(id, rrec->bits); (slot = &rrec->slots[i])->res;
+         i = (i + 1) & mask) {
+        if (slot->id == id)
+            return slot;
+    }
+    if (rrec->oldSlots) {
+        mask = (1U << rrec->oldBits) - 1;
+        for (i = SlotIndex(id, rrec->oldBits); (slot = &rrec->oldSlots[i])->res;
+             i = (i + 1) & mask) {
+            if (slot->id == id && slot->res != SLOT_TOMBSTONE) {
+                /* Move it across now, the next lookup is likely soon */
+                ResourcePtr res = slot->res;
+
+                slot->res = SLOT_TOMBSTONE;
+                if (!--rrec->oldUsed) {
+                    free(rrec->oldSlots);
+                    rrec->oldSlots = NULL;
+                }
+                return InsertSlot(rrec, id, res);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void
+RemoveSlot(ClientResourceRec *rrec, ResourceSlot *slot)
+{
+    ResourceSlot *slots = rrec->slots;
+    unsigned int i, j, home, mask;
+
+    /* Pull back every following entry whose home slot does not lie
+     * cyclically in (i, j], so that no probe sequence crosses the hole.
+     */
+    mask = (1U << rrec->bits) - 1;
+    i = slot - slots;
+    for (j = (i + 1) & mask; slots[j].res; j = (j + 1) & mask) {
+        home = SlotIndex(slots[j].id, rrec->bits);
+        if ((i < j) ? (home <= i || home > j) : (home <= i && home > j)) {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i].res = NULL;
+    rrec->used--;
+}
+
+/* Move up to count entries from the table being drained into the new one */
+static void
+MigrateSlots(ClientResourceRec *rrec, int count)
+{
+    ResourceSlot *slot;
+    int size;
+
+    if (!rrec->oldSlots)
+        return;
+    size = 1 << rrec->oldBits;
+    while (count-- > 0 && rrec->migrate < size) {
+        slot = &rrec->oldSlots[rrec->migrate++];
+        if (slot->res && slot->res != SLOT_TOMBSTONE) {
+            InsertSlot(rrec, slot->id, slot->res);
+            slot->res = SLOT_TOMBSTONE;
+            rrec->oldUsed--;
+        }
+    }
+    if (!rrec->oldUsed) {
+        free(rrec->oldSlots);
+        rrec->oldSlots = NULL;
+    }
+}
+
+static Bool
+GrowSlots(ClientResourceRec *rrec)
+{
+    ResourceSlot *slots;
+
+    /* The new table is twice the size of the old one, so the previous
+     * migration has normally finished long before we get here again.
+     */
+    if (rrec->oldSlots)
+        MigrateSlots(rrec, 1 << rrec->oldBits);
+
+    slots = calloc((size_t) 2 << rrec->bits, sizeof(ResourceSlot));
+    if (!slots)
+        return FALSE;
+    rrec->oldSlots = rrec->slots;
+    rrec->oldBits = rrec->bits;
+    rrec->oldUsed = rrec->used;
+    rrec->migrate = 0;
+    rrec->slots = slots;
+    rrec->bits++;
+    rrec->used = 0;
+    return TRUE;
+}
+
+static struct xorg_list *
+FindTypeList(ClientResourceRec *rrec, RESTYPE type)
+{
+    int index = type & TypeMask;
+
+    if (index >= rrec->numTypes)
+        return NULL;
+    return rrec->byType[index];
+}
+
+static struct xorg_list *
+GetTypeList(ClientResourceRec *rrec, RESTYPE type)
+{
+    int index = type & TypeMask;
+
+    if (index >= rrec->numTypes) {
+        struct xorg_list **byType;
+        int numTypes = max(index, lastResourceType) + 1;
+
+        byType = reallocarray(rrec->byType, numTypes, sizeof(*byType));
+        if (!byType)
+            return NULL;
+        memset(byType + rrec->numTypes, 0,
+               (numTypes - rrec->numTypes) * sizeof(*byType));
+        rrec->byType = byType;
+        rrec->numTypes = numTypes;
+    }
+    if (!rrec->byType[index]) {
+        rrec->byType[index] = malloc(sizeof(struct xorg_list));
+        if (!rrec->byType[index])
+            return NULL;
+        xorg_list_init(rrec->byType[index]);
+    }
+    return rrec->byType[index];
+}
+
+static ResourceSlot *
+LookupSlot(XID id)
+{
+    int cid = CLIENT_ID(id);
+
+    if ((cid >= LimitClients) || !clientTable[cid].slots)
+        return NULL;
+    return FindSlot(&clientTable[cid], id);
+}
+
+/*
+ * Find the newest resource registered under id whose type equals match,
+ * or, for classes, shares a bit with it.  Nearly every id has only one
+ * resource, and that one is answered from the slot itself.
+ */
+static Bool
+LookupTypeAndValue(XID id, RESTYPE match, Bool isClass,
+                   RESTYPE *type, void **value)
+{
+    ResourceSlot *slot;
+    ResourcePtr res;
+
+    if (!(slot = LookupSlot(id)))
+        return FALSE;
+    if (isClass ? (slot->type & match) : (slot->type == match)) {
+        *type = slot->type;
+        *value = slot->value;
+        return TRUE;
+    }
+    for (res = slot->res->next; res; res = res->next) {
+        if (isClass ? (res->type & match) : (res->type == match)) {
+            *type = res->type;
+            *value = res->value;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void
+UnlinkResource(ClientResourceRec *rrec, ResourceSlot *slot, ResourcePtr res)
+{
+    ResourcePtr *prev;
+
+    for (prev = &slot->res; *prev != res; prev = &(*prev)->next)
+        ;
+    *prev = res->next;
+    if (!slot->res)
+        RemoveSlot(rrec, slot);
+    else if (prev == &slot->res) {
+        slot->type = slot->res->type;
+        slot->value = slot->res->value;
+    }
+    xorg_list_del(&res->all);
+    xorg_list_del(&res->byType);
+    rrec->elements--;
+}
+
+/* The first resource at or after link in the given list, skipping markers */
+static ResourcePtr
+NextResource(struct xorg_list *head, struct xorg_list *link, Bool typed)
 {
     ResourcePtr res;
 
+    for (; link != head; link = link->next) {
+        if (typed)
+            res = xorg_list_entry(link, ResourceRec, byType);
+        else
+            res = xorg_list_entry(link, ResourceRec, all);
+        if (!IS_MARKER(res))
+            return res;
+    }
+    return NULL;
+}
+
+static XID
+AvailableID(int client, XID id, XID maxid, XID goodid)
+{
     if ((goodid >= id) && (goodid <= maxid))
         return goodid;
     for (; id <= maxid; id++) {
-        res = clientTable[client].resources[HashResourceID(id, clientTable[client].hashsize)];
-        while (res && (res->id != id))
-            res = res->next;
-        if (!res)
+        if (!FindSlot(&clientTable[client], id))
             return id;
     }
     return 0;
@@ -699,9 +996,7 @@ void
 GetXIDRange(int client, Bool server, XID *minp, XID *maxp)
 {
     XID id, maxid;
-    ResourcePtr *resp;
     ResourcePtr res;
-    int i;
     XID goodid;
 
     id = (Mask) client << CLIENTOFFSET;
@@ -709,18 +1004,17 @@ GetXIDRange(int client, Bool server, XID *minp, XID *maxp)
         id |= client ? SERVER_BIT : SERVER_MINID;
     maxid = id | RESOURCE_ID_MASK;
     goodid = 0;
-    for (resp = clientTable[client].resources, i = clientTable[client].buckets;
-         --i >= 0;) {
-        for (res = *resp++; res; res = res->next) {
-            if ((res->id < id) || (res->id > maxid))
-                continue;
-            if (((res->id - id) >= (maxid - res->id)) ?
-                (goodid = AvailableID(client, id, res->id - 1, goodid)) :
-                !(goodid = AvailableID(client, res->id + 1, maxid, goodid)))
-                maxid = res->id - 1;
-            else
-                id = res->id + 1;
-        }
+    xorg_list_for_each_entry(res, &clientTable[client].all, all) {
+        if (IS_MARKER(res))
+            continue;
+        if ((res->id < id) || (res->id > maxid))
+            continue;
+        if (((res->id - id) >= (maxid - res->id)) ?
+            (goodid = AvailableID(client, id, res->id - 1, goodid)) :
+            !(goodid = AvailableID(client, res->id + 1, maxid, goodid)))
+            maxid = res->id - 1;
+        else
+            id = res->id + 1;
     }
     if (id > maxid)
         id = maxid = 0;
@@ -798,77 +1092,58 @@ AddResource(XID id, RESTYPE type, void *value)
 {
     int client;
     ClientResourceRec *rrec;
-    ResourcePtr res, *head;
+    ResourceSlot *slot;
+    ResourcePtr res;
+    struct xorg_list *typeList;
 
 #ifdef XSERVER_DTRACE
     XSERVER_RESOURCE_ALLOC(id, type, value, TypeNameString(type));
 #endif
     client = CLIENT_ID(id);
     rrec = &clientTable[client];
-    if (!rrec->buckets) {
+    if (!rrec->slots) {
         ErrorF("[dix] AddResource(%lx, %x, %lx), client=%d \n",
                (unsigned long) id, type, (unsigned long)(uintptr_t) value, client);
         FatalError("client not in use\n");
     }
-    if ((rrec->elements >= 4 * rrec->buckets) && (rrec->hashsize < MAXHASHSIZE))
-        RebuildTable(client);
-    head = &rrec->resources[HashResourceID(id, clientTable[client].hashsize)];
     res = malloc(sizeof(ResourceRec));
-    if (!res) {
-        (*resourceTypes[type & TypeMask].deleteFunc) (value, id);
-        return FALSE;
-    }
-    res->next = *head;
+    typeList = GetTypeList(rrec, type);
+    if (!res || !typeList)
+        goto bail;
+
     res->id = id;
     res->type = type;
     res->value = value;
-    *head = res;
+
+    MigrateSlots(rrec, MIGRATESLOTS);
+    slot = FindSlot(rrec, id);
+    if (slot) {
+        res->next = slot->res;
+        slot->type = type;
+        slot->value = value;
+        slot->res = res;
+    }
+    else {
+        /* Keep the load under 3/4; a failed grow is only fatal if the
+         * table has no empty slot left to terminate probe sequences.
+         */
+        if ((rrec->used + rrec->oldUsed) * 4 >= 3 << rrec->bits &&
+            !GrowSlots(rrec) &&
+            rrec->used + rrec->oldUsed + 1 >= 1 << rrec->bits)
+            goto bail;
+        res->next = NULL;
+        InsertSlot(rrec, id, res);
+    }
+    xorg_list_add(&res->all, &rrec->all);
+    xorg_list_add(&res->byType, typeList);
     rrec->elements++;
     CallResourceStateCallback(ResourceStateAdding, res);
     return TRUE;
-}
 
-static void
-RebuildTable(int client)
-{
-    int j;
-    ResourcePtr res, next;
-    ResourcePtr **tails, *resources;
-    ResourcePtr **tptr, *rptr;
-
-    /*
-     * For now, preserve insertion order, since some ddx layers depend
-     * on resources being free in the opposite order they are added.
-     */
-
-    j = 2 * clientTable[client].buckets;
-    tails =  xallocarray(j, sizeof(ResourcePtr *));
-    if (!tails)
-        return;
-    resources =  xallocarray(j, sizeof(ResourcePtr));
-    if (!resources) {
-        free(tails);
-        return;
-    }
-    for (rptr = resources, tptr = tails; --j >= 0; rptr++, tptr++) {
-        *rptr = NULL;
-        *tptr = rptr;
-    }
-    clientTable[client].hashsize++;
-    for (j = clientTable[client].buckets,
-         rptr = clientTable[client].resources; --j >= 0; rptr++) {
-        for (res = *rptr; res; res = next) {
-            next = res->next;
-            res->next = NULL;
-            tptr = &tails[HashResourceID(res->id, clientTable[client].hashsize)];
-            **tptr = res;
-            *tptr = &res->next;
-        }
-    }
-    free(tails);
-    clientTable[client].buckets *= 2;
-    free(clientTable[client].resources);
-    clientTable[client].resources = resources;
+ bail:
+    free(res);
+    (*resourceTypes[type & TypeMask].deleteFunc) (value, id);
+    return FALSE;
 }
 
 static void
@@ -886,34 +1161,27 @@ void
 FreeResource(XID id, RESTYPE skipDeleteFuncType)
 {
     int cid;
+    ClientResourceRec *rrec;
+    ResourceSlot *slot;
     ResourcePtr res;
-    ResourcePtr *prev, *head;
-    int *eltptr;
-    int elements;
 
-    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].buckets) {
-        head = &clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-        eltptr = &clientTable[cid].elements;
+    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].slots) {
+        rrec = &clientTable[cid];
 
-        prev = head;
-        while ((res = *prev)) {
-            if (res->id == id) {
-                RESTYPE rtype = res->type;
+        /* Delete functions may free other resources and move slots
+         * around, so look the id up again every time.
+         */
+        while ((slot = FindSlot(rrec, id))) {
+            RESTYPE rtype;
 
+            res = slot->res;
+            rtype = res->type;
 #ifdef XSERVER_DTRACE
-                XSERVER_RESOURCE_FREE(res->id, res->type,
-                                      res->value, TypeNameString(res->type));
+            XSERVER_RESOURCE_FREE(res->id, res->type,
+                                  res->value, TypeNameString(res->type));
 #endif
-                *prev = res->next;
-                elements = --*eltptr;
-
-                doFreeResource(res, rtype == skipDeleteFuncType);
-
-                if (*eltptr != elements)
-                    prev = head;        /* prev may no longer be valid */
-            }
-            else
-                prev = &res->next;
+            UnlinkResource(rrec, slot, res);
+            doFreeResource(res, rtype == skipDeleteFuncType);
         }
     }
 }
@@ -922,28 +1190,22 @@ void
 FreeResourceByType(XID id, RESTYPE type, Bool skipFree)
 {
     int cid;
+    ResourceSlot *slot;
     ResourcePtr res;
-    ResourcePtr *prev, *head;
 
-    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].buckets) {
-        head = &clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
+    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].slots) {
+        slot = FindSlot(&clientTable[cid], id);
 
-        prev = head;
-        while ((res = *prev)) {
-            if (res->id == id && res->type == type) {
+        for (res = slot ? slot->res : NULL; res; res = res->next) {
+            if (res->type == type) {
 #ifdef XSERVER_DTRACE
                 XSERVER_RESOURCE_FREE(res->id, res->type,
                                       res->value, TypeNameString(res->type));
 #endif
-                *prev = res->next;
-                clientTable[cid].elements--;
-
+                UnlinkResource(&clientTable[cid], slot, res);
                 doFreeResource(res, skipFree);
-
                 break;
             }
-            else
-                prev = &res->next;
         }
     }
 }
@@ -957,51 +1219,57 @@ FreeResourceByType(XID id, RESTYPE type, Bool skipFree)
 Bool
 ChangeResourceValue(XID id, RESTYPE rtype, void *value)
 {
-    int cid;
+    ResourceSlot *slot;
     ResourcePtr res;
 
-    if (((cid = CLIENT_ID(id)) < LimitClients) && clientTable[cid].buckets) {
-        res = clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-
-        for (; res; res = res->next)
-            if ((res->id == id) && (res->type == rtype)) {
-                res->value = value;
-                return TRUE;
-            }
-    }
+    if (!(slot = LookupSlot(id)))
+        return FALSE;
+    for (res = slot->res; res; res = res->next)
+        if (res->type == rtype) {
+            res->value = value;
+            if (res == slot->res)
+                slot->value = value;
+            return TRUE;
+        }
     return FALSE;
 }
 
-/* Note: if func adds or deletes resources, then func can get called
- * more than once for some resources.  If func adds new resources,
- * func might or might not get called for them.  func cannot both
- * add and delete an equal number of resources!
+/* Note: func may add or delete resources, including the one it was
+ * called for.  Each resource that exists for the whole walk is visited
+ * exactly once; resources added by func are not visited.
  */
 
 void
 FindClientResourcesByType(ClientPtr client,
                           RESTYPE type, FindResType func, void *cdata)
 {
-    ResourcePtr *resources;
-    ResourcePtr this, next;
-    int i, elements;
-    int *eltptr;
+    struct xorg_list *head, *link;
+    ResourceRec marker;
+    ResourcePtr this;
+    Bool typed = type != RT_NONE;
 
     if (!client)
         client = serverClient;
 
-    resources = clientTable[client->index].resources;
-    eltptr = &clientTable[client->index].elements;
-    for (i = 0; i < clientTable[client->index].buckets; i++) {
-        for (this = resources[i]; this; this = next) {
-            next = this->next;
-            if (!type || this->type == type) {
-                elements = *eltptr;
-                (*func) (this->value, this->id, cdata);
-                if (*eltptr != elements)
-                    next = resources[i];        /* start over */
-            }
+    if (typed)
+        head = FindTypeList(&clientTable[client->index], type);
+    else
+        head = &clientTable[client->index].all;
+    if (!head)
+        return;
+
+    marker.value = &resourceMarker;
+    link = head->next;
+    while ((this = NextResource(head, link, typed))) {
+        /* The type list also holds types differing in the class bits */
+        if (this->type != type && typed) {
+            link = RESOURCE_LINK(this, typed)->next;
+            continue;
         }
+        xorg_list_add(RESOURCE_LINK(&marker, typed), RESOURCE_LINK(this, typed));
+        (*func) (this->value, this->id, cdata);
+        link = RESOURCE_LINK(&marker, typed)->next;
+        xorg_list_del(RESOURCE_LINK(&marker, typed));
     }
 }
 
@@ -1017,24 +1285,21 @@ void FindSubResources(void *resource,
 void
 FindAllClientResources(ClientPtr client, FindAllRes func, void *cdata)
 {
-    ResourcePtr *resources;
-    ResourcePtr this, next;
-    int i, elements;
-    int *eltptr;
+    struct xorg_list *head, *link;
+    ResourceRec marker;
+    ResourcePtr this;
 
     if (!client)
         client = serverClient;
 
-    resources = clientTable[client->index].resources;
-    eltptr = &clientTable[client->index].elements;
-    for (i = 0; i < clientTable[client->index].buckets; i++) {
-        for (this = resources[i]; this; this = next) {
-            next = this->next;
-            elements = *eltptr;
-            (*func) (this->value, this->id, this->type, cdata);
-            if (*eltptr != elements)
-                next = resources[i];    /* start over */
-        }
+    head = &clientTable[client->index].all;
+    marker.value = &resourceMarker;
+    link = head->next;
+    while ((this = NextResource(head, link, FALSE))) {
+        xorg_list_add(&marker.all, &this->all);
+        (*func) (this->value, this->id, this->type, cdata);
+        link = marker.all.next;
+        xorg_list_del(&marker.all);
     }
 }
 
@@ -1043,25 +1308,38 @@ LookupClientResourceComplex(ClientPtr client,
                             RESTYPE type,
                             FindComplexResType func, void *cdata)
 {
-    ResourcePtr *resources;
-    ResourcePtr this, next;
+    struct xorg_list *head, *link;
+    ResourceRec marker;
+    ResourcePtr this;
     void *value;
-    int i;
+    Bool typed = type != RT_NONE;
+    Bool found;
 
     if (!client)
         client = serverClient;
 
-    resources = clientTable[client->index].resources;
-    for (i = 0; i < clientTable[client->index].buckets; i++) {
-        for (this = resources[i]; this; this = next) {
-            next = this->next;
-            if (!type || this->type == type) {
-                /* workaround func freeing the type as DRI1 does */
-                value = this->value;
-                if ((*func) (value, this->id, cdata))
-                    return value;
-            }
+    if (typed)
+        head = FindTypeList(&clientTable[client->index], type);
+    else
+        head = &clientTable[client->index].all;
+    if (!head)
+        return NULL;
+
+    marker.value = &resourceMarker;
+    link = head->next;
+    while ((this = NextResource(head, link, typed))) {
+        if (this->type != type && typed) {
+            link = RESOURCE_LINK(this, typed)->next;
+            continue;
         }
+        /* workaround func freeing the type as DRI1 does */
+        value = this->value;
+        xorg_list_add(RESOURCE_LINK(&marker, typed), RESOURCE_LINK(this, typed));
+        found = (*func) (value, this->id, cdata);
+        link = RESOURCE_LINK(&marker, typed)->next;
+        xorg_list_del(RESOURCE_LINK(&marker, typed));
+        if (found)
+            return value;
     }
     return NULL;
 }
@@ -1069,48 +1347,40 @@ LookupClientResourceComplex(ClientPtr client,
 void
 FreeClientNeverRetainResources(ClientPtr client)
 {
-    ResourcePtr *resources;
+    ClientResourceRec *rrec;
+    struct xorg_list *link;
+    ResourceRec marker;
     ResourcePtr this;
-    ResourcePtr *prev;
-    int j, elements;
-    int *eltptr;
 
     if (!client)
         return;
 
-    resources = clientTable[client->index].resources;
-    eltptr = &clientTable[client->index].elements;
-    for (j = 0; j < clientTable[client->index].buckets; j++) {
-        prev = &resources[j];
-        while ((this = *prev)) {
-            RESTYPE rtype = this->type;
-
-            if (rtype & RC_NEVERRETAIN) {
+    rrec = &clientTable[client->index];
+    marker.value = &resourceMarker;
+    link = rrec->all.next;
+    while ((this = NextResource(&rrec->all, link, FALSE))) {
+        if (!(this->type & RC_NEVERRETAIN)) {
+            link = this->all.next;
+            continue;
+        }
 #ifdef XSERVER_DTRACE
-                XSERVER_RESOURCE_FREE(this->id, this->type,
-                                      this->value, TypeNameString(this->type));
+        XSERVER_RESOURCE_FREE(this->id, this->type,
+                              this->value, TypeNameString(this->type));
 #endif
-                *prev = this->next;
-                clientTable[client->index].elements--;
-                elements = *eltptr;
-
-                doFreeResource(this, FALSE);
-
-                if (*eltptr != elements)
-                    prev = &resources[j];       /* prev may no longer be valid */
-            }
-            else
-                prev = &this->next;
-        }
+        xorg_list_add(&marker.all, &this->all);
+        UnlinkResource(rrec, FindSlot(rrec, this->id), this);
+        doFreeResource(this, FALSE);
+        link = marker.all.next;
+        xorg_list_del(&marker.all);
     }
 }
 
 void
 FreeClientResources(ClientPtr client)
 {
-    ResourcePtr *resources;
+    ClientResourceRec *rrec;
     ResourcePtr this;
-    int j;
+    int i;
 
     /* This routine shouldn't be called with a null client, but just in
        case ... */
@@ -1120,35 +1390,31 @@ FreeClientResources(ClientPtr client)
 
     HandleSaveSet(client);
 
-    resources = clientTable[client->index].resources;
-    for (j = 0; j < clientTable[client->index].buckets; j++) {
-        /* It may seem silly to update the head of this resource list as
-           we delete the members, since the entire list will be deleted any way,
-           but there are some resource deletion functions "FreeClientPixels" for
-           one which do a LookupID on another resource id (a Colormap id in this
-           case), so the resource list must be kept valid up to the point that
-           it is deleted, so every time we delete a resource, we must update the
-           head, just like in FreeResource. I hope that this doesn't slow down
-           mass deletion appreciably. PRH */
+    rrec = &clientTable[client->index];
 
-        ResourcePtr *head;
+    /* Some resource deletion functions ("FreeClientPixels" for one) do a
+       lookup on another resource id, so the table must stay valid until
+       the very end: unlink each resource properly before freeing it.
+       Freeing from the front of the list releases resources in the
+       opposite order they were added, which some ddx layers depend on. */
 
-        head = &resources[j];
-
-        for (this = *head; this; this = *head) {
+    while ((this = NextResource(&rrec->all, rrec->all.next, FALSE))) {
 #ifdef XSERVER_DTRACE
-            XSERVER_RESOURCE_FREE(this->id, this->type,
-                                  this->value, TypeNameString(this->type));
+        XSERVER_RESOURCE_FREE(this->id, this->type,
+                              this->value, TypeNameString(this->type));
 #endif
-            *head = this->next;
-            clientTable[client->index].elements--;
-
-            doFreeResource(this, FALSE);
-        }
+        UnlinkResource(rrec, FindSlot(rrec, this->id), this);
+        doFreeResource(this, FALSE);
     }
-    free(clientTable[client->index].resources);
-    clientTable[client->index].resources = NULL;
-    clientTable[client->index].buckets = 0;
+    free(rrec->slots);
+    free(rrec->oldSlots);
+    for (i = 0; i < rrec->numTypes; i++)
+        free(rrec->byType[i]);
+    free(rrec->byType);
+    rrec->slots = NULL;
+    rrec->oldSlots = NULL;
+    rrec->byType = NULL;
+    rrec->numTypes = 0;
 }
 
 void
@@ -1157,7 +1423,7 @@ FreeAllResources(void)
     int i;
 
     for (i = currentMaxClients; --i >= 0;) {
-        if (clientTable[i].buckets)
+        if (clientTable[i].slots)
             FreeClientResources(clients[i]);
     }
 }
@@ -1191,36 +1457,30 @@ int
 dixLookupResourceByType(void **result, XID id, RESTYPE rtype,
                         ClientPtr client, Mask mode)
 {
-    int cid = CLIENT_ID(id);
-    ResourcePtr res = NULL;
+    int cid;
+    RESTYPE type;
+    void *value;
 
     *result = NULL;
     if ((rtype & TypeMask) > lastResourceType)
         return BadImplementation;
 
-    if ((cid < LimitClients) && clientTable[cid].buckets) {
-        res = clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-
-        for (; res; res = res->next)
-            if (res->id == id && res->type == rtype)
-                break;
-    }
     if (client) {
         client->errorValue = id;
     }
-    if (!res)
+    if (!LookupTypeAndValue(id, rtype, FALSE, &type, &value))
         return resourceTypes[rtype & TypeMask].errorValue;
 
     if (client) {
-        cid = XaceHook(XACE_RESOURCE_ACCESS, client, id, res->type,
-                       res->value, RT_NONE, NULL, mode);
+        cid = XaceHook(XACE_RESOURCE_ACCESS, client, id, type,
+                       value, RT_NONE, NULL, mode);
         if (cid == BadValue)
             return resourceTypes[rtype & TypeMask].errorValue;
         if (cid != Success)
             return cid;
     }
 
-    *result = res->value;
+    *result = value;
     return Success;
 }
 
@@ -1228,31 +1488,86 @@ int
 dixLookupResourceByClass(void **result, XID id, RESTYPE rclass,
                          ClientPtr client, Mask mode)
 {
-    int cid = CLIENT_ID(id);
-    ResourcePtr res = NULL;
+    int cid;
+    RESTYPE type;
+    void *value;
 
     *result = NULL;
 
-    if ((cid < LimitClients) && clientTable[cid].buckets) {
-        res = clientTable[cid].resources[HashResourceID(id, clientTable[cid].hashsize)];
-
-        for (; res; res = res->next)
-            if (res->id == id && (res->type & rclass))
-                break;
-    }
     if (client) {
         client->errorValue = id;
     }
-    if (!res)
+    if (!LookupTypeAndValue(id, rclass, TRUE, &type, &value))
         return BadValue;
 
     if (client) {
-        cid = XaceHook(XACE_RESOURCE_ACCESS, client, id, res->type,
-                       res->value, RT_NONE, NULL, mode);
+        cid = XaceHook(XACE_RESOURCE_ACCESS, client, id, type,
+                       value, RT_NONE, NULL, mode);
         if (cid != Success)
             return cid;
     }
 
-    *result = res->value;
+    *result = value;
     return Success;
 }
+
+/*
+ * Counters the server keeps about itself, which have no client resources
+ * to be found through.  Registered once per server generation and never
+ * removed; those not registered again after a reset are left out.
+ */
+#define MAX_SERVER_COUNTERS 32
+
+static struct {
+    Atom name;
+    const unsigned long *value;
+    unsigned long generation;
+} serverCounters[MAX_SERVER_COUNTERS];
+static int numServerCounters;
+
+Bool
+RegisterServerCounter(const char *name, const unsigned long *value)
+{
+    Atom atom = MakeAtom(name, strlen(name), TRUE);
+    int i;
+
+    if (atom == BAD_RESOURCE)
+        return FALSE;
+    for (i = 0; i < numServerCounters; i++)
+        if (serverCounters[i].value == value)
+            break;
+    if (i == MAX_SERVER_COUNTERS)
+        return FALSE;
+    if (i == numServerCounters)
+        numServerCounters++;
+    /* atoms don't survive a reset, so this is refreshed every time */
+    serverCounters[i].name = atom;
+    serverCounters[i].value = value;
+    serverCounters[i].generation = serverGeneration;
+    return TRUE;
+}
+
+void
+FindServerCounters(FindServerCounter func, void *cdata)
+{
+    int i, j;
+
+    for (i = 0; i < numServerCounters; i++) {
+        unsigned long value = 0;
+
+        if (serverCounters[i].generation != serverGeneration)
+            continue;
+        /* counters of the same name are reported once, added up */
+        for (j = 0; j < i; j++)
+            if (serverCounters[j].generation == serverGeneration &&
+                serverCounters[j].name == serverCounters[i].name)
+                break;
+        if (j < i)
+            continue;
+        for (j = i; j < numServerCounters; j++)
+            if (serverCounters[j].generation == serverGeneration &&
+                serverCounters[j].name == serverCounters[i].name)
+                value += *serverCounters[j].value;
+        func(serverCounters[i].name, value, cdata);
+    }
+}
@@ -597,6 +597,7 @@ CreateRootWindow(ScreenPtr pScreen)
     pWin->optional->otherClients = NULL;
     pWin->optional->passiveGrabs = NULL;
     pWin->optional->userProps = NULL;
+    pWin->optional->propIndex = NULL;
     pWin->optional->backingBitPlanes = ~0L;
     pWin->optional->backingPixel = 0;
     pWin->optional->boundingShape = NULL;
@@ -748,6 +749,203 @@ RealChildHead(WindowPtr pWin)
         return NullWindow;
 }
 
+/*
+ * Finding the window under the pointer searches the children of every
+ * window on the way down, which with thousands of top level or InputOnly
+ * windows makes every motion event expensive.  To avoid that, each screen
+ * is divided into cells that list the mapped windows whose border box
+ * intersects them, in the order a top-down walk of the tree meets them.
+ * A window whose parent is left out of a cell can't be found there, so it
+ * is left out as well.
+ *
+ * Cells are built when first needed.  A change to a window invalidates the
+ * cells its border box covers before and after the change; everything that
+ * can be found below it lies in those cells too.  Destroying windows
+ * invalidates all cells of the screen, so that none keeps a stale pointer.
+ */
+
+#define PICK_CELL_SHIFT 6
+
+typedef struct _PickCell {
+    WindowPtr *windows;
+    int count;
+    int size;
+    unsigned long serial;       /* grid serial when built, 0 if invalid */
+} PickCellRec, *PickCellPtr;
+
+typedef struct _PickGrid {
+    WindowPtr pRoot;
+    int width, height;
+    int columns, rows;
+    unsigned long serial;
+    PickCellRec cells[];
+} PickGridRec, *PickGridPtr;
+
+static PickGridPtr pickGrids[MAXSCREENS];
+
+static void
+FreePickGrid(ScreenPtr pScreen)
+{
+    PickGridPtr grid = pickGrids[pScreen->myNum];
+    int i;
+
+    if (!grid)
+        return;
+
+    for (i = 0; i < grid->columns * grid->rows; i++)
+        free(grid->cells[i].windows);
+    free(grid);
+    pickGrids[pScreen->myNum] = NULL;
+}
+
+static void
+InvalidatePickGrid(ScreenPtr pScreen)
+{
+    PickGridPtr grid = pickGrids[pScreen->myNum];
+    int i;
+
+    if (!grid)
+        return;
+
+    if (++grid->serial == 0) {
+        for (i = 0; i < grid->columns * grid->rows; i++)
+            grid->cells[i].serial = 0;
+        grid->serial = 1;
+    }
+}
+
+static void
+InvalidatePickCells(WindowPtr pWin)
+{
+    PickGridPtr grid = pickGrids[pWin->drawable.pScreen->myNum];
+    int bw = wBorderWidth(pWin);
+    int x1, y1, x2, y2, x, y;
+
+    if (!grid || !pWin->parent)
+        return;
+
+    x2 = min(pWin->drawable.x + (int) pWin->drawable.width + bw, grid->width);
+    y2 = min(pWin->drawable.y + (int) pWin->drawable.height + bw,
+             grid->height);
+    if (x2 <= 0 || y2 <= 0)
+        return;
+
+    x1 = max(pWin->drawable.x - bw, 0) >> PICK_CELL_SHIFT;
+    y1 = max(pWin->drawable.y - bw, 0) >> PICK_CELL_SHIFT;
+    x2 = (x2 - 1) >> PICK_CELL_SHIFT;
+    y2 = (y2 - 1) >> PICK_CELL_SHIFT;
+
+    for (y = y1; y <= y2; y++)
+        for (x = x1; x <= x2; x++)
+            grid->cells[y * grid->columns + x].serial = 0;
+}
+
+static Bool
+BuildPickCell(PickCellPtr cell, WindowPtr pRoot, BoxPtr box)
+{
+    WindowPtr pWin = pRoot->firstChild;
+
+    cell->count = 0;
+    while (pWin) {
+        int bw = wBorderWidth(pWin);
+
+        if (pWin->mapped &&
+            pWin->drawable.x - bw < box->x2 &&
+            pWin->drawable.x + (int) pWin->drawable.width + bw > box->x1 &&
+            pWin->drawable.y - bw < box->y2 &&
+            pWin->drawable.y + (int) pWin->drawable.height + bw > box->y1) {
+            if (cell->count == cell->size) {
+                int size = cell->size ? cell->size * 2 : 16;
+                WindowPtr *windows;
+
+                windows = reallocarray(cell->windows, size, sizeof(WindowPtr));
+                if (!windows)
+                    return FALSE;
+                cell->windows = windows;
+                cell->size = size;
+            }
+            cell->windows[cell->count++] = pWin;
+
+            if (pWin->firstChild) {
+                pWin = pWin->firstChild;
+                continue;
+            }
+        }
+        while (!pWin->nextSib && pWin->parent != pRoot)
+            pWin = pWin->parent;
+        pWin = pWin->nextSib;
+    }
+    return TRUE;
+}
+
+/*****
+ * PickWindowCandidates
+ *    Returns the windows that may contain the point x, y of pScreen, in
+ *    top to bottom stacking order with every window ahead of its children.
+ *    A window is only on the list if its parent is, but is not checked
+ *    against the point or its shape; the caller still has to do that.
+ *    Returns FALSE if the point is off the screen or memory runs out.
+ *****/
+
+Bool
+PickWindowCandidates(ScreenPtr pScreen, int x, int y,
+                     WindowPtr **windows, int *count)
+{
+    PickGridPtr grid = pickGrids[pScreen->myNum];
+    PickCellPtr cell;
+    int column, row;
+
+    if (!pScreen->root ||
+        x < 0 || y < 0 || x >= pScreen->width || y >= pScreen->height)
+        return FALSE;
+
+    if (grid && (grid->pRoot != pScreen->root ||
+                 grid->width != pScreen->width ||
+                 grid->height != pScreen->height)) {
+        FreePickGrid(pScreen);
+        grid = NULL;
+    }
+
+    if (!grid) {
+        int columns = (pScreen->width + (1 << PICK_CELL_SHIFT) - 1) >>
+            PICK_CELL_SHIFT;
+        int rows = (pScreen->height + (1 << PICK_CELL_SHIFT) - 1) >>
+            PICK_CELL_SHIFT;
+
+        grid = calloc(1, sizeof(PickGridRec) +
+                      columns * rows * sizeof(PickCellRec));
+        if (!grid)
+            return FALSE;
+        grid->pRoot = pScreen->root;
+        grid->width = pScreen->width;
+        grid->height = pScreen->height;
+        grid->columns = columns;
+        grid->rows = rows;
+        grid->serial = 1;
+        pickGrids[pScreen->myNum] = grid;
+    }
+
+    column = x >> PICK_CELL_SHIFT;
+    row = y >> PICK_CELL_SHIFT;
+    cell = &grid->cells[row * grid->columns + column];
+
+    if (cell->serial != grid->serial) {
+        BoxRec box;
+
+        box.x1 = column << PICK_CELL_SHIFT;
+        box.y1 = row << PICK_CELL_SHIFT;
+        box.x2 = box.x1 + (1 << PICK_CELL_SHIFT);
+        box.y2 = box.y1 + (1 << PICK_CELL_SHIFT);
+        if (!BuildPickCell(cell, pScreen->root, &box))
+            return FALSE;
+        cell->serial = grid->serial;
+    }
+
+    *windows = cell->windows;
+    *count = cell->count;
+    return TRUE;
+}
+
 /*****
  * CreateWindow
  *    Makes a window in response to client request
@@ -854,7 +1052,7 @@ CreateWindow(Window wid, WindowPtr pParent, int x, int y, unsigned w,
 
     if (visual != ancwopt->visual) {
         if (!MakeWindowOptional(pWin)) {
-            dixFreeObjectWithPrivates(pWin, PRIVATE_WINDOW);
+            dixFreeScreenObjectWithPrivates(pScreen, pWin, PRIVATE_WINDOW);
             *error = BadAlloc;
             return NullWindow;
         }
@@ -870,7 +1068,7 @@ CreateWindow(Window wid, WindowPtr pParent, int x, int y, unsigned w,
                       RT_WINDOW, pWin->parent,
                       DixCreateAccess | DixSetAttrAccess);
     if (*error != Success) {
-        dixFreeObjectWithPrivates(pWin, PRIVATE_WINDOW);
+        dixFreeScreenObjectWithPrivates(pScreen, pWin, PRIVATE_WINDOW);
         return NullWindow;
     }
 
@@ -1051,7 +1249,8 @@ CrushTree(WindowPtr pWin)
                 (*UnrealizeWindow) (pChild);
             }
             FreeWindowResources(pChild);
-            dixFreeObjectWithPrivates(pChild, PRIVATE_WINDOW);
+            dixFreeScreenObjectWithPrivates(pChild->drawable.pScreen, pChild,
+                                            PRIVATE_WINDOW);
             if ((pChild = pSib))
                 break;
             pChild = pParent;
@@ -1077,6 +1276,7 @@ DeleteWindow(void *value, XID wid)
 
     UnmapWindow(pWin, FALSE);
 
+    InvalidatePickGrid(pWin->drawable.pScreen);
     CrushTree(pWin);
 
     pParent = pWin->parent;
@@ -1099,9 +1299,12 @@ DeleteWindow(void *value, XID wid)
         if (pWin->prevSib)
             pWin->prevSib->nextSib = pWin->nextSib;
     }
-    else
+    else {
+        FreePickGrid(pWin->drawable.pScreen);
         pWin->drawable.pScreen->root = NULL;
-    dixFreeObjectWithPrivates(pWin, PRIVATE_WINDOW);
+    }
+    dixFreeScreenObjectWithPrivates(pWin->drawable.pScreen, pWin,
+                                    PRIVATE_WINDOW);
     return Success;
 }
 
@@ -1708,9 +1911,23 @@ MoveWindowInStack(WindowPtr pWin, WindowPtr pNextSib)
     return pFirstChange;
 }
 
+/*
+ * miComputeClips leaves a window alone when its visible area is the same
+ * as before, which is only right if nothing in it changed either.  Anything
+ * that changes how a window clips its parent without going through
+ * SetWinSize or SetBorderSize has to call this too.
+ */
+void
+MarkGeometryChanged(WindowPtr pWin)
+{
+    for (; pWin; pWin = pWin->parent)
+        pWin->geometryChanged = TRUE;
+}
+
 void
 SetWinSize(WindowPtr pWin)
 {
+    MarkGeometryChanged(pWin);
 #ifdef COMPOSITE
     if (pWin->redirectDraw != RedirectDrawNone) {
         BoxRec box;
@@ -1747,6 +1964,7 @@ SetBorderSize(WindowPtr pWin)
 {
     int bw;
 
+    MarkGeometryChanged(pWin);
     if (HasBorder(pWin)) {
         bw = wBorderWidth(pWin);
 #ifdef COMPOSITE
@@ -2160,6 +2378,7 @@ ReflectStackChange(WindowPtr pWin, WindowPtr pSib, VTKind kind)
         return;
 
     pFirstChange = MoveWindowInStack(pWin, pSib);
+    InvalidatePickCells(pWin);
 
     if (WasViewable) {
         anyMarked = (*pScreen->MarkOverlappedWindows) (pWin, pFirstChange,
@@ -2388,6 +2607,7 @@ ConfigureWindow(WindowPtr pWin, Mask mask, XID *vlist, ClientPtr client)
 #endif
         DeliverEvents(pWin, &event, 1, NullWindow);
     }
+    InvalidatePickCells(pWin);
     if (mask & CWBorderWidth) {
         if (action == RESTACK_WIN) {
             action = MOVE_WIN;
@@ -2410,6 +2630,7 @@ ConfigureWindow(WindowPtr pWin, Mask mask, XID *vlist, ClientPtr client)
         (*pWin->drawable.pScreen->ResizeWindow) (pWin, x, y, w, h, pSib);
     else if (mask & CWStackMode)
         ReflectStackChange(pWin, pSib, VTOther);
+    InvalidatePickCells(pWin);
 
     if (action != RESTACK_WIN)
         CheckCursorConfinement(pWin);
@@ -2673,6 +2894,7 @@ MapWindow(WindowPtr pWin, ClientPtr client)
                 return Success;
 
         pWin->mapped = TRUE;
+        InvalidatePickCells(pWin);
         if (SubStrSend(pWin, pParent))
             DeliverMapNotify(pWin);
 
@@ -2741,6 +2963,7 @@ MapSubwindows(WindowPtr pParent, ClientPtr client)
                     continue;
 
             pWin->mapped = TRUE;
+            InvalidatePickCells(pWin);
             if (parentNotify || StrSend(pWin))
                 DeliverMapNotify(pWin);
 
@@ -2857,6 +3080,7 @@ UnmapWindow(WindowPtr pWin, Bool fromConfigure)
         (*pScreen->MarkWindow) (pLayerWin->parent);
     }
     pWin->mapped = FALSE;
+    InvalidatePickCells(pWin);
     if (wasRealized)
         UnrealizeTree(pWin, fromConfigure);
     if (wasViewable) {
@@ -2908,6 +3132,7 @@ UnmapSubwindows(WindowPtr pWin)
                 anyMarked = TRUE;
             }
             pChild->mapped = FALSE;
+            InvalidatePickCells(pChild);
             if (pChild->realized)
                 UnrealizeTree(pChild, FALSE);
         }
@@ -3406,6 +3631,7 @@ MakeWindowOptional(WindowPtr pWin)
     optional->otherClients = NULL;
     optional->passiveGrabs = NULL;
     optional->userProps = NULL;
+    optional->propIndex = NULL;
     optional->backingBitPlanes = ~0L;
     optional->backingPixel = 0;
     optional->boundingShape = NULL;
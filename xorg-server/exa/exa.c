@@ -928,6 +928,7 @@ exaDriverInit(ScreenPtr pScreen, ExaDriverPtr pScreenInfo)
         wrap(pExaScr, ps, Composite, exaComposite);
         if (pScreenInfo->PrepareComposite) {
             wrap(pExaScr, ps, Glyphs, exaGlyphs);
+            GlyphAtlasDisable(pScreen);
         }
         else {
             wrap(pExaScr, ps, Glyphs, ExaCheckGlyphs);
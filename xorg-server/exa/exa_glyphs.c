@@ -365,6 +365,7 @@ exaGlyphCacheUploadGlyph(ScreenPtr pScreen,
                          ExaGlyphCachePtr cache, int x, int y, GlyphPtr pGlyph)
 {
     ExaScreenPriv(pScreen);
+    /* exaBufferGlyph has made sure the glyph has one */
     PicturePtr pGlyphPicture = GetGlyphPicture(pGlyph, pScreen);
     PixmapPtr pGlyphPixmap = (PixmapPtr) pGlyphPicture->pDrawable;
 
@@ -544,13 +545,19 @@ exaBufferGlyph(ScreenPtr pScreen,
                INT16 ySrc, INT16 xMask, INT16 yMask, INT16 xDst, INT16 yDst)
 {
     ExaScreenPriv(pScreen);
-    unsigned int format = (GetGlyphPicture(pGlyph, pScreen))->format;
+    PicturePtr pGlyphPicture = GetGlyphPicture(pGlyph, pScreen);
+    unsigned int format;
     int width = pGlyph->info.width;
     int height = pGlyph->info.height;
     ExaCompositeRectPtr rect;
     PicturePtr mask;
     int i;
 
+    /* A glyph without a picture has nothing to draw */
+    if (!pGlyphPicture)
+        return ExaGlyphSuccess;
+    format = pGlyphPicture->format;
+
     if (buffer->count == GLYPH_BUFFER_SIZE)
         return ExaGlyphNeedFlush;
 
@@ -586,7 +593,7 @@ exaBufferGlyph(ScreenPtr pScreen,
 
     /* Couldn't find the glyph in the cache, use the glyph picture directly */
 
-    mask = GetGlyphPicture(pGlyph, pScreen);
+    mask = pGlyphPicture;
     if (buffer->mask && buffer->mask != mask)
         return ExaGlyphNeedFlush;
 
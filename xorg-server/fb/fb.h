@@ -40,6 +40,7 @@
 #include "mi.h"
 #include "migc.h"
 #include "picturestr.h"
+#include "list.h"
 
 #ifdef FB_ACCESS_WRAPPER
 
@@ -402,6 +403,20 @@ typedef void (*FinishWrapProcPtr) (DrawablePtr pDraw);
 extern _X_EXPORT DevPrivateKey
 fbGetScreenPrivateKey(void);
 
+extern _X_EXPORT DevPrivateKey
+fbGetPixmapPrivateKey(void);
+
+/*
+ * Idle pixmap bits, by size class; see fbpixmap.c
+ */
+#define FB_POOL_CLASSES 48
+
+typedef struct {
+    struct xorg_list classes[FB_POOL_CLASSES];
+    struct xorg_list lru;       /* all idle blocks, most recently freed first */
+    size_t idle;                /* bytes in idle blocks */
+} FbPixmapPoolRec, *FbPixmapPoolPtr;
+
 /* private field of a screen */
 typedef struct {
 #ifdef FB_ACCESS_WRAPPER
@@ -410,6 +425,7 @@ typedef struct {
 #endif
     DevPrivateKeyRec    gcPrivateKeyRec;
     DevPrivateKeyRec    winPrivateKeyRec;
+    FbPixmapPoolPtr     pixmapPool;     /* NULL once closed */
 } FbScreenPrivRec, *FbScreenPrivPtr;
 
 #define fbGetScreenPrivate(pScreen) ((FbScreenPrivPtr) \
@@ -428,6 +444,15 @@ typedef struct {
 #define fbGetGCPrivate(pGC)	((FbGCPrivPtr)\
 				 dixLookupPrivate(&(pGC)->devPrivates, fbGetGCPrivateKey(pGC)))
 
+/* private field of a pixmap */
+typedef struct {
+    void *bits;                 /* allocated by fbCreatePixmap, if any */
+    size_t size;                /* of bits from the pool, 0 for others */
+} FbPixmapPrivRec, *FbPixmapPrivPtr;
+
+#define fbGetPixmapPrivate(pPixmap)	((FbPixmapPrivPtr)\
+				 dixLookupPrivate(&(pPixmap)->devPrivates, fbGetPixmapPrivateKey()))
+
 #define fbGetCompositeClip(pGC) ((pGC)->pCompositeClip)
 #define fbGetExpose(pGC)	((pGC)->fExpose)
 
@@ -952,9 +977,6 @@ extern _X_EXPORT void
 extern _X_EXPORT Bool
  fbPictureInit(ScreenPtr pScreen, PictFormatPtr formats, int nformats);
 
-extern _X_EXPORT void
-fbDestroyGlyphCache(void);
-
 /*
  * fbpixmap.c
  */
@@ -966,6 +988,12 @@ fbCreatePixmap(ScreenPtr pScreen, int width, int height, int depth,
 extern _X_EXPORT Bool
  fbDestroyPixmap(PixmapPtr pPixmap);
 
+extern _X_EXPORT Bool
+ fbInitPixmapPool(ScreenPtr pScreen);
+
+extern _X_EXPORT void
+ fbFiniPixmapPool(ScreenPtr pScreen);
+
 extern _X_EXPORT RegionPtr
  fbPixmapToRegion(PixmapPtr pPix);
 
@@ -1097,6 +1125,18 @@ fbSolid(FbBits * dst,
         FbStride dstStride,
         int dstX, int bpp, int width, int height, FbBits and, FbBits xor);
 
+/*
+ * fbthread.c
+ */
+
+typedef void (*FbBandProc) (void *closure, int y1, int y2);
+
+extern _X_EXPORT void
+fbSetThreads(int threads);
+
+extern _X_EXPORT void
+fbBands(int y1, int y2, int width, FbBandProc band, void *closure);
+
 /*
  * fbutil.c
  */
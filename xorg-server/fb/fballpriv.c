@@ -33,6 +33,17 @@ fbGetScreenPrivateKey(void)
     return &fbScreenPrivateKeyRec;
 }
 
+/*
+ * Not screen specific: the screen pixmap is destroyed from CloseScreen,
+ * after the screen specific keys have been released.
+ */
+static DevPrivateKeyRec fbPixmapPrivateKeyRec;
+DevPrivateKey
+fbGetPixmapPrivateKey(void)
+{
+    return &fbPixmapPrivateKeyRec;
+}
+
 Bool
 fbAllocatePrivates(ScreenPtr pScreen)
 {
@@ -48,6 +59,11 @@ fbAllocatePrivates(ScreenPtr pScreen)
         return FALSE;
     if (!dixRegisterScreenSpecificPrivateKey (pScreen, &pScrPriv->winPrivateKeyRec, PRIVATE_WINDOW, 0))
         return FALSE;
+    if (!dixRegisterPrivateKey
+        (&fbPixmapPrivateKeyRec, PRIVATE_PIXMAP, sizeof(FbPixmapPrivRec)))
+        return FALSE;
+    if (!fbInitPixmapPool(pScreen))
+        return FALSE;
 
     return TRUE;
 }
@@ -28,17 +28,7 @@
 
 #include "fb.h"
 
-void
-fbCopyNtoN(DrawablePtr pSrcDrawable,
-           DrawablePtr pDstDrawable,
-           GCPtr pGC,
-           BoxPtr pbox,
-           int nbox,
-           int dx,
-           int dy, Bool reverse, Bool upsidedown, Pixel bitplane, void *closure)
-{
-    CARD8 alu = pGC ? pGC->alu : GXcopy;
-    FbBits pm = pGC ? fbGetGCPrivate(pGC)->pm : FB_ALLONES;
+typedef struct {
     FbBits *src;
     FbStride srcStride;
     int srcBpp;
@@ -47,36 +37,87 @@ fbCopyNtoN(DrawablePtr pSrcDrawable,
     FbStride dstStride;
     int dstBpp;
     int dstXoff, dstYoff;
+    BoxPtr pbox;
+    int dx, dy;
+    CARD8 alu;
+    FbBits pm;
+    Bool reverse, upsidedown;
+} FbCopyNtoNRec;
 
-    fbGetDrawable(pSrcDrawable, src, srcStride, srcBpp, srcXoff, srcYoff);
-    fbGetDrawable(pDstDrawable, dst, dstStride, dstBpp, dstXoff, dstYoff);
+/* Copy rows y1 to y2 of the current box */
+static void
+fbCopyNtoNBand(void *closure, int y1, int y2)
+{
+    FbCopyNtoNRec *c = closure;
+    BoxPtr pbox = c->pbox;
 
-    while (nbox--) {
 #ifndef FB_ACCESS_WRAPPER       /* pixman_blt() doesn't support accessors yet */
-        if (pm == FB_ALLONES && alu == GXcopy && !reverse && !upsidedown) {
-            if (!pixman_blt
-                ((uint32_t *) src, (uint32_t *) dst, srcStride, dstStride,
-                 srcBpp, dstBpp, (pbox->x1 + dx + srcXoff),
-                 (pbox->y1 + dy + srcYoff), (pbox->x1 + dstXoff),
-                 (pbox->y1 + dstYoff), (pbox->x2 - pbox->x1),
-                 (pbox->y2 - pbox->y1)))
-                goto fallback;
-            else
-                goto next;
-        }
- fallback:
-#endif
-        fbBlt(src + (pbox->y1 + dy + srcYoff) * srcStride,
-              srcStride,
-              (pbox->x1 + dx + srcXoff) * srcBpp,
-              dst + (pbox->y1 + dstYoff) * dstStride,
-              dstStride,
-              (pbox->x1 + dstXoff) * dstBpp,
-              (pbox->x2 - pbox->x1) * dstBpp,
-              (pbox->y2 - pbox->y1), alu, pm, dstBpp, reverse, upsidedown);
-#ifndef FB_ACCESS_WRAPPER
- next:
+    if (c->pm == FB_ALLONES && c->alu == GXcopy &&
+        !c->reverse && !c->upsidedown &&
+        pixman_blt((uint32_t *) c->src, (uint32_t *) c->dst,
+                   c->srcStride, c->dstStride, c->srcBpp, c->dstBpp,
+                   (pbox->x1 + c->dx + c->srcXoff), (y1 + c->dy + c->srcYoff),
+                   (pbox->x1 + c->dstXoff), (y1 + c->dstYoff),
+                   (pbox->x2 - pbox->x1), (y2 - y1)))
+        return;
 #endif
+    fbBlt(c->src + (y1 + c->dy + c->srcYoff) * c->srcStride,
+          c->srcStride,
+          (pbox->x1 + c->dx + c->srcXoff) * c->srcBpp,
+          c->dst + (y1 + c->dstYoff) * c->dstStride,
+          c->dstStride,
+          (pbox->x1 + c->dstXoff) * c->dstBpp,
+          (pbox->x2 - pbox->x1) * c->dstBpp,
+          (y2 - y1), c->alu, c->pm, c->dstBpp, c->reverse, c->upsidedown);
+}
+
+/* Whether the source of the current box overlaps its destination, in
+ * which case the rows have to be copied in order.
+ */
+static Bool
+fbCopyNtoNOverlaps(FbCopyNtoNRec *c)
+{
+    BoxPtr pbox = c->pbox;
+    int sx = pbox->x1 + c->dx + c->srcXoff, dx = pbox->x1 + c->dstXoff;
+    int sy = pbox->y1 + c->dy + c->srcYoff, dy = pbox->y1 + c->dstYoff;
+
+    if (c->reverse || c->upsidedown)
+        return TRUE;
+    return c->src == c->dst &&
+        abs(sx - dx) < pbox->x2 - pbox->x1 &&
+        abs(sy - dy) < pbox->y2 - pbox->y1;
+}
+
+void
+fbCopyNtoN(DrawablePtr pSrcDrawable,
+           DrawablePtr pDstDrawable,
+           GCPtr pGC,
+           BoxPtr pbox,
+           int nbox,
+           int dx,
+           int dy, Bool reverse, Bool upsidedown, Pixel bitplane, void *closure)
+{
+    FbCopyNtoNRec c;
+
+    c.alu = pGC ? pGC->alu : GXcopy;
+    c.pm = pGC ? fbGetGCPrivate(pGC)->pm : FB_ALLONES;
+    c.dx = dx;
+    c.dy = dy;
+    c.reverse = reverse;
+    c.upsidedown = upsidedown;
+
+    fbGetDrawable(pSrcDrawable, c.src, c.srcStride, c.srcBpp,
+                  c.srcXoff, c.srcYoff);
+    fbGetDrawable(pDstDrawable, c.dst, c.dstStride, c.dstBpp,
+                  c.dstXoff, c.dstYoff);
+
+    while (nbox--) {
+        c.pbox = pbox;
+        if (fbCopyNtoNOverlaps(&c))
+            fbCopyNtoNBand(&c, pbox->y1, pbox->y2);
+        else
+            fbBands(pbox->y1, pbox->y2, pbox->x2 - pbox->x1,
+                    fbCopyNtoNBand, &c);
         pbox++;
     }
     fbFinishAccess(pDstDrawable);
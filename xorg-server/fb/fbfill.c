@@ -108,6 +108,31 @@ fbStipple(FbBits * dst, FbStride dstStride,
     }
 }
 
+typedef struct {
+    FbBits *dst;
+    FbStride dstStride;
+    int dstBpp;
+    int dstXoff, dstYoff;
+    int x, width;
+    FbBits and, xor;
+} FbSolidFillRec;
+
+static void
+fbSolidFillBand(void *closure, int y1, int y2)
+{
+    FbSolidFillRec *c = closure;
+
+#ifndef FB_ACCESS_WRAPPER
+    if (c->and || !pixman_fill((uint32_t *) c->dst, c->dstStride, c->dstBpp,
+                               c->x + c->dstXoff, y1 + c->dstYoff,
+                               c->width, y2 - y1, c->xor))
+#endif
+        fbSolid(c->dst + (y1 + c->dstYoff) * c->dstStride,
+                c->dstStride,
+                (c->x + c->dstXoff) * c->dstBpp,
+                c->dstBpp, c->width * c->dstBpp, y2 - y1, c->and, c->xor);
+}
+
 void
 fbFill(DrawablePtr pDrawable, GCPtr pGC, int x, int y, int width, int height)
 {
@@ -120,17 +145,15 @@ fbFill(DrawablePtr pDrawable, GCPtr pGC, int x, int y, int width, int height)
     fbGetDrawable(pDrawable, dst, dstStride, dstBpp, dstXoff, dstYoff);
 
     switch (pGC->fillStyle) {
-    case FillSolid:
-#ifndef FB_ACCESS_WRAPPER
-        if (pPriv->and || !pixman_fill((uint32_t *) dst, dstStride, dstBpp,
-                                       x + dstXoff, y + dstYoff,
-                                       width, height, pPriv->xor))
-#endif
-            fbSolid(dst + (y + dstYoff) * dstStride,
-                    dstStride,
-                    (x + dstXoff) * dstBpp,
-                    dstBpp, width * dstBpp, height, pPriv->and, pPriv->xor);
+    case FillSolid:{
+        FbSolidFillRec c = {
+            dst, dstStride, dstBpp, dstXoff, dstYoff,
+            x, width, pPriv->and, pPriv->xor
+        };
+
+        fbBands(y, y + height, width, fbSolidFillBand, &c);
         break;
+    }
     case FillStippled:
     case FillOpaqueStippled:{
         PixmapPtr pStip = pGC->stipple;
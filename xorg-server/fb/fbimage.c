@@ -74,6 +74,33 @@ fbPutImage(DrawablePtr pDrawable,
     }
 }
 
+typedef struct {
+    FbStip *src;
+    FbStride srcStride;
+    FbStip *dst;
+    FbStride dstStride;
+    int dstBpp;
+    int dstXoff, dstYoff;
+    int x, y;
+    int x1, x2;
+    int alu;
+    FbBits pm;
+} FbPutZImageRec;
+
+static void
+fbPutZImageBand(void *closure, int y1, int y2)
+{
+    FbPutZImageRec *c = closure;
+
+    fbBltStip(c->src + (y1 - c->y) * c->srcStride,
+              c->srcStride,
+              (c->x1 - c->x) * c->dstBpp,
+              c->dst + (y1 + c->dstYoff) * c->dstStride,
+              c->dstStride,
+              (c->x1 + c->dstXoff) * c->dstBpp,
+              (c->x2 - c->x1) * c->dstBpp, (y2 - y1), c->alu, c->pm, c->dstBpp);
+}
+
 void
 fbPutZImage(DrawablePtr pDrawable,
             RegionPtr pClip,
@@ -82,15 +109,19 @@ fbPutZImage(DrawablePtr pDrawable,
             int x,
             int y, int width, int height, FbStip * src, FbStride srcStride)
 {
-    FbStip *dst;
-    FbStride dstStride;
-    int dstBpp;
-    int dstXoff, dstYoff;
+    FbPutZImageRec c;
     int nbox;
     BoxPtr pbox;
     int x1, y1, x2, y2;
 
-    fbGetStipDrawable(pDrawable, dst, dstStride, dstBpp, dstXoff, dstYoff);
+    fbGetStipDrawable(pDrawable, c.dst, c.dstStride, c.dstBpp,
+                      c.dstXoff, c.dstYoff);
+    c.src = src;
+    c.srcStride = srcStride;
+    c.x = x;
+    c.y = y;
+    c.alu = alu;
+    c.pm = pm;
 
     for (nbox = RegionNumRects(pClip),
          pbox = RegionRects(pClip); nbox--; pbox++) {
@@ -108,13 +139,9 @@ fbPutZImage(DrawablePtr pDrawable,
             y2 = pbox->y2;
         if (x1 >= x2 || y1 >= y2)
             continue;
-        fbBltStip(src + (y1 - y) * srcStride,
-                  srcStride,
-                  (x1 - x) * dstBpp,
-                  dst + (y1 + dstYoff) * dstStride,
-                  dstStride,
-                  (x1 + dstXoff) * dstBpp,
-                  (x2 - x1) * dstBpp, (y2 - y1), alu, pm, dstBpp);
+        c.x1 = x1;
+        c.x2 = x2;
+        fbBands(y1, y2, x2 - x1, fbPutZImageBand, &c);
     }
 
     fbFinishAccess(pDrawable);
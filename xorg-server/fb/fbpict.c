@@ -35,6 +35,49 @@
 #include "mipict.h"
 #include "fbpict.h"
 
+typedef struct {
+    CARD8 op;
+    pixman_image_t *src, *mask, *dest;
+    int xSrc, ySrc;
+    int xMask, yMask;
+    int xDst, yDst;
+    int width;
+} FbCompositeRec;
+
+static void
+fbCompositeBand(void *closure, int y1, int y2)
+{
+    FbCompositeRec *c = closure;
+
+    pixman_image_composite(c->op, c->src, c->mask, c->dest,
+                           c->xSrc, c->ySrc + y1, c->xMask, c->yMask + y1,
+                           c->xDst, c->yDst + y1, c->width, y2 - y1);
+}
+
+static PixmapPtr
+fbCompositePixmap(DrawablePtr pDrawable)
+{
+    if (pDrawable->type != DRAWABLE_PIXMAP)
+        return fbGetWindowPixmap(pDrawable);
+    return (PixmapPtr) pDrawable;
+}
+
+/* Bands can only be composited independently when nothing is read from the
+ * pixmap that is being drawn to
+ */
+static Bool
+fbCompositeReadsDst(PicturePtr pPict, PicturePtr pDst)
+{
+    if (!pPict)
+        return FALSE;
+    if (pPict->alphaMap)
+        return TRUE;
+    if (!pPict->pDrawable)
+        return FALSE;
+    return fbCompositePixmap(pPict->pDrawable) ==
+        fbCompositePixmap(pDst->pDrawable);
+}
+
 void
 fbComposite(CARD8 op,
             PicturePtr pSrc,
@@ -59,10 +102,18 @@ fbComposite(CARD8 op,
     dest = image_from_pict(pDst, TRUE, &dst_xoff, &dst_yoff);
 
     if (src && dest && !(pMask && !mask)) {
-        pixman_image_composite(op, src, mask, dest,
-                               xSrc + src_xoff, ySrc + src_yoff,
-                               xMask + msk_xoff, yMask + msk_yoff,
-                               xDst + dst_xoff, yDst + dst_yoff, width, height);
+        FbCompositeRec c = {
+            op, src, mask, dest,
+            xSrc + src_xoff, ySrc + src_yoff,
+            xMask + msk_xoff, yMask + msk_yoff,
+            xDst + dst_xoff, yDst + dst_yoff, width
+        };
+
+        if (pDst->alphaMap || fbCompositeReadsDst(pSrc, pDst) ||
+            fbCompositeReadsDst(pMask, pDst))
+            fbCompositeBand(&c, 0, height);
+        else
+            fbBands(0, height, width, fbCompositeBand, &c);
     }
 
     free_pixman_pict(pSrc, src);
@@ -70,26 +121,6 @@ fbComposite(CARD8 op,
     free_pixman_pict(pDst, dest);
 }
 
-static pixman_glyph_cache_t *glyphCache;
-
-void
-fbDestroyGlyphCache(void)
-{
-    if (glyphCache)
-    {
-	pixman_glyph_cache_destroy (glyphCache);
-	glyphCache = NULL;
-    }
-}
-
-static void
-fbUnrealizeGlyph(ScreenPtr pScreen,
-		 GlyphPtr pGlyph)
-{
-    if (glyphCache)
-	pixman_glyph_cache_remove (glyphCache, pGlyph, NULL);
-}
-
 void
 fbGlyphs(CARD8 op,
 	 PicturePtr pSrc,
@@ -100,74 +131,85 @@ fbGlyphs(CARD8 op,
 	 GlyphListPtr list,
 	 GlyphPtr *glyphs)
 {
-#define N_STACK_GLYPHS 512
     ScreenPtr pScreen = pDst->pDrawable->pScreen;
-    pixman_glyph_t stack_glyphs[N_STACK_GLYPHS];
-    pixman_glyph_t *pglyphs = stack_glyphs;
-    pixman_image_t *srcImage, *dstImage;
+    pixman_image_t *srcImage, *dstImage, *maskImage = NULL;
+    pixman_image_t *glyphImage = NULL;
+    PicturePtr pGlyphPicture = NULL;
     int srcXoff, srcYoff, dstXoff, dstYoff;
+    int glyphXoff = 0, glyphYoff = 0;
+    BoxRec extents;
     GlyphPtr glyph;
-    int n_glyphs;
+    PicturePtr pPicture;
+    INT16 xGlyph, yGlyph;
     int x, y;
-    int i, n;
+    int n;
     int xDst = list->xOff, yDst = list->yOff;
 
     miCompositeSourceValidate(pSrc);
 
-    n_glyphs = 0;
-    for (i = 0; i < nlist; ++i)
-	n_glyphs += list[i].len;
+    if (!(srcImage = image_from_pict(pSrc, FALSE, &srcXoff, &srcYoff)))
+	return;
 
-    if (!glyphCache)
-	glyphCache = pixman_glyph_cache_create();
+    if (!(dstImage = image_from_pict(pDst, TRUE, &dstXoff, &dstYoff)))
+	goto out_free_src;
+
+    if (maskFormat) {
+	pixman_format_code_t format;
+
+	format = maskFormat->format | (maskFormat->depth << 24);
+
+	miGlyphExtents(nlist, list, glyphs, &extents);
+	if (extents.x2 <= extents.x1 || extents.y2 <= extents.y1)
+	    goto out_free_dst;
 
-    pixman_glyph_cache_freeze (glyphCache);
+	if (!(maskImage = pixman_image_create_bits(format,
+						   extents.x2 - extents.x1,
+						   extents.y2 - extents.y1,
+						   NULL, 0)))
+	    goto out_free_dst;
 
-    if (n_glyphs > N_STACK_GLYPHS) {
-	if (!(pglyphs = xallocarray(n_glyphs, sizeof(pixman_glyph_t))))
-	    goto out;
+	if (PIXMAN_FORMAT_A(format) != 0 && PIXMAN_FORMAT_RGB(format) != 0)
+	    pixman_image_set_component_alpha(maskImage, TRUE);
     }
 
-    i = 0;
+    /* Glyphs are drawn one at a time, straight from the glyph atlas */
     x = y = 0;
     while (nlist--) {
         x += list->xOff;
         y += list->yOff;
         n = list->len;
         while (n--) {
-	    const void *g;
-
             glyph = *glyphs++;
 
-	    if (!(g = pixman_glyph_cache_lookup (glyphCache, glyph, NULL))) {
-		pixman_image_t *glyphImage;
-		PicturePtr pPicture;
-		int xoff, yoff;
-
-		pPicture = GetGlyphPicture(glyph, pScreen);
-		if (!pPicture) {
-		    n_glyphs--;
-		    goto next;
-		}
+	    pPicture = GlyphAtlasPicture(glyph, pScreen, &xGlyph, &yGlyph);
+	    if (!pPicture)
+		goto next;
 
-		if (!(glyphImage = image_from_pict(pPicture, FALSE, &xoff, &yoff)))
-		    goto out;
-
-		g = pixman_glyph_cache_insert(glyphCache, glyph, NULL,
-					      glyph->info.x,
-					      glyph->info.y,
-					      glyphImage);
-
-		free_pixman_pict(pPicture, glyphImage);
-
-		if (!g)
+	    if (pPicture != pGlyphPicture) {
+		if (glyphImage)
+		    free_pixman_pict(pGlyphPicture, glyphImage);
+		pGlyphPicture = pPicture;
+		if (!(glyphImage = image_from_pict(pPicture, FALSE,
+						   &glyphXoff, &glyphYoff)))
 		    goto out;
 	    }
 
-	    pglyphs[i].x = x;
-	    pglyphs[i].y = y;
-	    pglyphs[i].glyph = g;
-	    i++;
+	    if (maskImage)
+		pixman_image_composite32(PIXMAN_OP_ADD, glyphImage, NULL,
+					 maskImage,
+					 xGlyph + glyphXoff, yGlyph + glyphYoff,
+					 0, 0,
+					 x - glyph->info.x - extents.x1,
+					 y - glyph->info.y - extents.y1,
+					 glyph->info.width, glyph->info.height);
+	    else
+		pixman_image_composite32(op, srcImage, glyphImage, dstImage,
+					 xSrc + srcXoff + x - glyph->info.x - xDst,
+					 ySrc + srcYoff + y - glyph->info.y - yDst,
+					 xGlyph + glyphXoff, yGlyph + glyphYoff,
+					 x - glyph->info.x + dstXoff,
+					 y - glyph->info.y + dstYoff,
+					 glyph->info.width, glyph->info.height);
 
 	next:
             x += glyph->info.xOff;
@@ -176,44 +218,26 @@ fbGlyphs(CARD8 op,
 	list++;
     }
 
-    if (!(srcImage = image_from_pict(pSrc, FALSE, &srcXoff, &srcYoff)))
-	goto out;
-
-    if (!(dstImage = image_from_pict(pDst, TRUE, &dstXoff, &dstYoff)))
-	goto out_free_src;
-
-    if (maskFormat) {
-	pixman_format_code_t format;
-	pixman_box32_t extents;
-
-	format = maskFormat->format | (maskFormat->depth << 24);
-
-	pixman_glyph_get_extents(glyphCache, n_glyphs, pglyphs, &extents);
+    if (maskImage)
+	pixman_image_composite32(op, srcImage, maskImage, dstImage,
+				 xSrc + srcXoff + extents.x1 - xDst,
+				 ySrc + srcYoff + extents.y1 - yDst,
+				 0, 0,
+				 extents.x1 + dstXoff, extents.y1 + dstYoff,
+				 extents.x2 - extents.x1,
+				 extents.y2 - extents.y1);
 
-	pixman_composite_glyphs(op, srcImage, dstImage, format,
-				xSrc + srcXoff + extents.x1 - xDst, ySrc + srcYoff + extents.y1 - yDst,
-				extents.x1, extents.y1,
-				extents.x1 + dstXoff, extents.y1 + dstYoff,
-				extents.x2 - extents.x1,
-				extents.y2 - extents.y1,
-				glyphCache, n_glyphs, pglyphs);
-    }
-    else {
-	pixman_composite_glyphs_no_mask(op, srcImage, dstImage,
-					xSrc + srcXoff - xDst, ySrc + srcYoff - yDst,
-					dstXoff, dstYoff,
-					glyphCache, n_glyphs, pglyphs);
-    }
+out:
+    if (glyphImage)
+	free_pixman_pict(pGlyphPicture, glyphImage);
+    if (maskImage)
+	pixman_image_unref(maskImage);
 
+out_free_dst:
     free_pixman_pict(pDst, dstImage);
 
 out_free_src:
     free_pixman_pict(pSrc, srcImage);
-
-out:
-    pixman_glyph_cache_thaw(glyphCache);
-    if (pglyphs != stack_glyphs)
-	free(pglyphs);
 }
 
 static pixman_image_t *
@@ -495,7 +519,6 @@ fbPictureInit(ScreenPtr pScreen, PictFormatPtr formats, int nformats)
     ps = GetPictureScreen(pScreen);
     ps->Composite = fbComposite;
     ps->Glyphs = fbGlyphs;
-    ps->UnrealizeGlyph = fbUnrealizeGlyph;
     ps->CompositeRects = miCompositeRects;
     ps->RasterizeTrapezoid = fbRasterizeTrapezoid;
     ps->Trapezoids = fbTrapezoids;
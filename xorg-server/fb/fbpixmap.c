@@ -28,32 +28,188 @@
 
 #include "fb.h"
 
+/*
+ * Pixmap bits come from a pool per screen, so that short-lived pixmaps
+ * don't make the server fault in and zero fresh pages over and over.
+ * Idle blocks are kept in size classes a quarter of a power of two apart,
+ * most recently freed first, and the oldest ones are given back once the
+ * pool holds more than FB_POOL_LIMIT bytes.  Smaller blocks than
+ * FB_POOL_MIN are left to malloc, as are those too big to keep.
+ *
+ * X leaves the contents of a new pixmap undefined, but a client mustn't
+ * get to read what another one drew.  So recycled bits are always cleared,
+ * just as fresh ones come from calloc.
+ *
+ * The pool is allocated apart from the screen private, which moves when
+ * other screen privates are registered after fb's.
+ */
+#define FB_POOL_MIN     4096
+#define FB_POOL_LIMIT   (32 << 20)
+#define FB_POOL_MAX     (FB_POOL_LIMIT / 4)
+
+typedef struct {
+    struct xorg_list entry;     /* in its size class */
+    struct xorg_list lru;       /* in the pool */
+    size_t size;
+} FbPoolBlockRec, *FbPoolBlockPtr;
+
+/* Counters of all screens, reported through X-Resource */
+static unsigned long fbPoolHits;
+static unsigned long fbPoolMisses;
+static unsigned long fbPoolIdleBytes;
+static unsigned long fbPoolClearedBytes;
+
+/* Index of the size class for size, and the size of its blocks */
+static int
+fbPoolClass(size_t size, size_t *class_size)
+{
+    size_t n = size - 1;
+    int h = 0, shift;
+
+    while (n >> (h + 1))
+        h++;
+    shift = h - 2;
+    *class_size = ((n >> shift) + 1) << shift;
+    return (h - 11) * 4 + (int) (n >> shift) - 4;
+}
+
+static void
+fbPoolUnlink(FbPixmapPoolPtr pool, FbPoolBlockPtr block)
+{
+    xorg_list_del(&block->entry);
+    xorg_list_del(&block->lru);
+    pool->idle -= block->size;
+    fbPoolIdleBytes -= block->size;
+}
+
+static void *
+fbPoolGet(FbPixmapPoolPtr pool, size_t datasize, size_t *size)
+{
+    FbPoolBlockPtr block;
+    int class;
+
+    if (datasize < FB_POOL_MIN || datasize > FB_POOL_MAX || !pool) {
+        *size = 0;
+        return calloc(1, datasize);
+    }
+
+    class = fbPoolClass(datasize, size);
+    if (xorg_list_is_empty(&pool->classes[class])) {
+        fbPoolMisses++;
+        /* fresh pages are zero anyway */
+        return calloc(1, *size);
+    }
+
+    fbPoolHits++;
+    block = xorg_list_first_entry(&pool->classes[class], FbPoolBlockRec,
+                                  entry);
+    fbPoolUnlink(pool, block);
+    memset(block, 0, datasize);
+    fbPoolClearedBytes += datasize;
+    return block;
+}
+
+static void
+fbPoolPut(FbPixmapPoolPtr pool, void *bits, size_t size)
+{
+    FbPoolBlockPtr block = bits;
+    size_t class_size;
+
+    if (!size || !pool) {
+        free(bits);
+        return;
+    }
+
+    block->size = size;
+    xorg_list_add(&block->entry,
+                  &pool->classes[fbPoolClass(size, &class_size)]);
+    xorg_list_add(&block->lru, &pool->lru);
+    pool->idle += size;
+    fbPoolIdleBytes += size;
+
+    while (pool->idle > FB_POOL_LIMIT) {
+        block = xorg_list_last_entry(&pool->lru, FbPoolBlockRec, lru);
+        fbPoolUnlink(pool, block);
+        free(block);
+    }
+}
+
+Bool
+fbInitPixmapPool(ScreenPtr pScreen)
+{
+    FbPixmapPoolPtr pool = malloc(sizeof(FbPixmapPoolRec));
+    int i;
+
+    if (!pool)
+        return FALSE;
+    for (i = 0; i < FB_POOL_CLASSES; i++)
+        xorg_list_init(&pool->classes[i]);
+    xorg_list_init(&pool->lru);
+    pool->idle = 0;
+    fbGetScreenPrivate(pScreen)->pixmapPool = pool;
+
+    RegisterServerCounter("FB_PIXMAP_POOL_HITS", &fbPoolHits);
+    RegisterServerCounter("FB_PIXMAP_POOL_MISSES", &fbPoolMisses);
+    RegisterServerCounter("FB_PIXMAP_POOL_IDLE_BYTES", &fbPoolIdleBytes);
+    RegisterServerCounter("FB_PIXMAP_POOL_CLEARED_BYTES", &fbPoolClearedBytes);
+    return TRUE;
+}
+
+void
+fbFiniPixmapPool(ScreenPtr pScreen)
+{
+    FbPixmapPoolPtr pool = fbGetScreenPrivate(pScreen)->pixmapPool;
+
+    if (!pool)
+        return;
+    while (!xorg_list_is_empty(&pool->lru)) {
+        FbPoolBlockPtr block =
+            xorg_list_first_entry(&pool->lru, FbPoolBlockRec, lru);
+
+        fbPoolUnlink(pool, block);
+        free(block);
+    }
+    free(pool);
+    /* pixmaps destroyed from here on give their bits straight back */
+    fbGetScreenPrivate(pScreen)->pixmapPool = NULL;
+}
+
 PixmapPtr
 fbCreatePixmap(ScreenPtr pScreen, int width, int height, int depth,
                unsigned usage_hint)
 {
+    FbPixmapPoolPtr pool = fbGetScreenPrivate(pScreen)->pixmapPool;
     PixmapPtr pPixmap;
+    FbPixmapPrivPtr pPixPriv;
     size_t datasize;
     size_t paddedWidth;
-    int adjust;
-    int base;
+    size_t size;
+    void *bits;
     int bpp = BitsPerPixel(depth);
 
     paddedWidth = ((width * bpp + FB_MASK) >> FB_SHIFT) * sizeof(FbBits);
     if (paddedWidth / 4 > 32767 || height > 32767)
         return NullPixmap;
     datasize = height * paddedWidth;
-    base = pScreen->totalPixmapSize;
-    adjust = 0;
-    if (base & 7)
-        adjust = 8 - (base & 7);
-    datasize += adjust;
 #ifdef FB_DEBUG
     datasize += 2 * paddedWidth;
 #endif
-    pPixmap = AllocatePixmap(pScreen, datasize);
-    if (!pPixmap)
+    /*
+     * The bits are kept apart from the header, so that all headers are
+     * the same size and can be recycled by AllocatePixmap.
+     */
+    bits = NULL;
+    size = 0;
+    if (datasize) {
+        bits = fbPoolGet(pool, datasize, &size);
+        if (!bits)
+            return NullPixmap;
+    }
+    pPixmap = AllocatePixmap(pScreen, 0);
+    if (!pPixmap) {
+        fbPoolPut(pool, bits, size);
         return NullPixmap;
+    }
     pPixmap->drawable.type = DRAWABLE_PIXMAP;
     pPixmap->drawable.class = 0;
     pPixmap->drawable.pScreen = pScreen;
@@ -67,8 +223,11 @@ fbCreatePixmap(ScreenPtr pScreen, int width, int height, int depth,
     pPixmap->drawable.height = height;
     pPixmap->devKind = paddedWidth;
     pPixmap->refcnt = 1;
-    pPixmap->devPrivate.ptr = (void *) ((char *) pPixmap + base + adjust);
+    pPixmap->devPrivate.ptr = bits;
     pPixmap->master_pixmap = NULL;
+    pPixPriv = fbGetPixmapPrivate(pPixmap);
+    pPixPriv->bits = bits;
+    pPixPriv->size = size;
 
 #ifdef FB_DEBUG
     pPixmap->devPrivate.ptr =
@@ -89,8 +248,13 @@ fbCreatePixmap(ScreenPtr pScreen, int width, int height, int depth,
 Bool
 fbDestroyPixmap(PixmapPtr pPixmap)
 {
+    FbPixmapPrivPtr pPixPriv;
+
     if (--pPixmap->refcnt)
         return TRUE;
+    pPixPriv = fbGetPixmapPrivate(pPixmap);
+    fbPoolPut(fbGetScreenPrivate(pPixmap->drawable.pScreen)->pixmapPool,
+              pPixPriv->bits, pPixPriv->size);
     FreePixmap(pPixmap);
     return TRUE;
 }
@@ -32,13 +32,13 @@ fbCloseScreen(ScreenPtr pScreen)
     int d;
     DepthPtr depths = pScreen->allowedDepths;
 
-    fbDestroyGlyphCache();
     for (d = 0; d < pScreen->numDepths; d++)
         free(depths[d].vids);
     free(depths);
     free(pScreen->visuals);
     if (pScreen->devPrivate)
         FreePixmap((PixmapPtr)pScreen->devPrivate);
+    fbFiniPixmapPool(pScreen);
     return TRUE;
 }
 
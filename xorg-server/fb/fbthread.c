@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include "fb.h"
+
+/*
+ * Large rendering operations are split into bands of rows which are
+ * drawn by a pool of worker threads, the calling thread taking its share.
+ * fbBands only returns once every band is done, so callers see no
+ * difference other than the time it takes.
+ *
+ * The first few rows are always drawn by the calling thread before any
+ * worker starts; pixman validates images lazily on first use, and this
+ * makes sure that happens before they are shared.
+ */
+
+#if INPUTTHREAD && !defined(FB_ACCESS_WRAPPER)
+
+#include <pthread.h>
+#include <signal.h>
+
+#define FB_BAND_MAX_THREADS     64
+#define FB_BAND_MIN_PIXELS      (256 * 1024)
+#define FB_BAND_MIN_ROWS        16
+
+static int fbNumThreads;
+static int fbStartedThreads;
+
+static pthread_mutex_t fbBandMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t fbBandWork = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t fbBandDone = PTHREAD_COND_INITIALIZER;
+
+static struct {
+    FbBandProc band;
+    void *closure;
+    int y;                      /* first row of band 0 */
+    int y2;                     /* end of the last band */
+    int rows;                   /* rows per band */
+    int count;                  /* bands in this job */
+    int next;                   /* next band to hand out */
+    int done;                   /* bands finished */
+} fbJob;
+
+/* Called with fbBandMutex held, which is dropped while the band runs */
+static void
+fbRunBand(void)
+{
+    int band = fbJob.next++;
+    int y1 = fbJob.y + band * fbJob.rows;
+    int y2 = min(y1 + fbJob.rows, fbJob.y2);
+
+    pthread_mutex_unlock(&fbBandMutex);
+    (*fbJob.band) (fbJob.closure, y1, y2);
+    pthread_mutex_lock(&fbBandMutex);
+    if (++fbJob.done == fbJob.count)
+        pthread_cond_signal(&fbBandDone);
+}
+
+static void *
+fbBandWorker(void *arg)
+{
+    sigset_t set;
+
+    /* Don't handle any signals on this thread */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_mutex_lock(&fbBandMutex);
+    for (;;) {
+        while (fbJob.next == fbJob.count)
+            pthread_cond_wait(&fbBandWork, &fbBandMutex);
+        fbRunBand();
+    }
+    return NULL;
+}
+
+static Bool
+fbStartThreads(void)
+{
+    pthread_t thread;
+
+    while (fbStartedThreads < fbNumThreads) {
+        if (pthread_create(&thread, NULL, fbBandWorker, NULL) != 0) {
+            ErrorF("fb: only %d of %d rendering threads started\n",
+                   fbStartedThreads, fbNumThreads);
+            fbNumThreads = fbStartedThreads;
+            break;
+        }
+        pthread_detach(thread);
+        fbStartedThreads++;
+    }
+    return fbNumThreads > 0;
+}
+
+void
+fbSetThreads(int threads)
+{
+    fbNumThreads = min(max(threads, 0), FB_BAND_MAX_THREADS);
+}
+
+void
+fbBands(int y1, int y2, int width, FbBandProc band, void *closure)
+{
+    int first = y1 + FB_BAND_MIN_ROWS;
+    int count;
+
+    if (!fbNumThreads ||
+        (int64_t) (y2 - y1) * width < FB_BAND_MIN_PIXELS ||
+        y2 - first < 2 * FB_BAND_MIN_ROWS ||
+        (fbStartedThreads < fbNumThreads && !fbStartThreads())) {
+        (*band) (closure, y1, y2);
+        return;
+    }
+
+    (*band) (closure, y1, first);
+
+    count = min(fbNumThreads + 1, (y2 - first) / FB_BAND_MIN_ROWS);
+
+    pthread_mutex_lock(&fbBandMutex);
+    fbJob.band = band;
+    fbJob.closure = closure;
+    fbJob.y = first;
+    fbJob.y2 = y2;
+    fbJob.rows = (y2 - first + count - 1) / count;
+    fbJob.count = count;
+    fbJob.next = 0;
+    fbJob.done = 0;
+    pthread_cond_broadcast(&fbBandWork);
+    while (fbJob.next < fbJob.count)
+        fbRunBand();
+    while (fbJob.done < fbJob.count)
+        pthread_cond_wait(&fbBandDone, &fbBandMutex);
+    pthread_mutex_unlock(&fbBandMutex);
+}
+
+#else                           /* INPUTTHREAD && !FB_ACCESS_WRAPPER */
+
+void
+fbSetThreads(int threads)
+{
+}
+
+void
+fbBands(int y1, int y2, int width, FbBandProc band, void *closure)
+{
+    (*band) (closure, y1, y2);
+}
+
+#endif
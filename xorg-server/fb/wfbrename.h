@@ -4,6 +4,7 @@
 #define fbArc16 wfbArc16
 #define fbArc32 wfbArc32
 #define fbArc8 wfbArc8
+#define fbBands wfbBands
 #define fbBlt wfbBlt
 #define fbBltOne wfbBltOne
 #define fbBltPlane wfbBltPlane
@@ -34,7 +35,6 @@
 #define fbCreateGC wfbCreateGC
 #define fbCreatePixmap wfbCreatePixmap
 #define fbCreateWindow wfbCreateWindow
-#define fbDestroyGlyphCache wfbDestroyGlyphCache
 #define fbDestroyPixmap wfbDestroyPixmap
 #define fbDestroyWindow wfbDestroyWindow
 #define fbDots wfbDots
@@ -45,11 +45,13 @@
 #define fbFill wfbFill
 #define fbFillRegionSolid wfbFillRegionSolid
 #define fbFillSpans wfbFillSpans
+#define fbFiniPixmapPool wfbFiniPixmapPool
 #define fbFixCoordModePrevious wfbFixCoordModePrevious
 #define fbGCFuncs wfbGCFuncs
 #define fbGCOps wfbGCOps
 #define fbGeneration wfbGeneration
 #define fbGetImage wfbGetImage
+#define fbGetPixmapPrivateKey wfbGetPixmapPrivateKey
 #define fbGetScreenPrivateKey wfbGetScreenPrivateKey
 #define fbGetSpans wfbGetSpans
 #define _fbGetWindowPixmap _wfbGetWindowPixmap
@@ -60,6 +62,7 @@
 #define fbImageGlyphBlt wfbImageGlyphBlt
 #define fbIn wfbIn
 #define fbInitializeColormap wfbInitializeColormap
+#define fbInitPixmapPool wfbInitPixmapPool
 #define fbInitVisuals wfbInitVisuals
 #define fbListInstalledColormaps wfbListInstalledColormaps
 #define FbMergeRopBits wFbMergeRopBits
@@ -108,6 +111,7 @@
 #define fbSegment wfbSegment
 #define fbSelectBres wfbSelectBres
 #define fbSetSpans wfbSetSpans
+#define fbSetThreads wfbSetThreads
 #define fbSetupScreen wfbSetupScreen
 #define fbSetVisualTypes wfbSetVisualTypes
 #define fbSetVisualTypesAndMasks wfbSetVisualTypesAndMasks
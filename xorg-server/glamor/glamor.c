@@ -711,6 +711,7 @@ glamor_init(ScreenPtr screen, unsigned int flags)
 
     glamor_priv->saved_procs.glyphs = ps->Glyphs;
     ps->Glyphs = glamor_composite_glyphs;
+    GlyphAtlasDisable(screen);
 
     glamor_init_vbo(screen);
     glamor_init_gradient_shader(screen);
@@ -362,7 +362,6 @@ glamor_composite_glyphs(CARD8 op,
     int glyph_atlas_dim = glamor_priv->glyph_atlas_dim;
     int glyph_max_dim = glamor_priv->glyph_max_dim;
     int nglyph = 0;
-    int screen_num = screen->myNum;
 
     for (n = 0; n < nlist; n++)
         nglyph += list[n].len;
@@ -378,11 +377,16 @@ glamor_composite_glyphs(CARD8 op,
         list++;
         while (n--) {
             GlyphPtr glyph = *glyphs++;
+            PicturePtr glyph_pict = NULL;
 
             /* Glyph not empty?
              */
-            if (glyph->info.width && glyph->info.height) {
-                PicturePtr glyph_pict = GlyphPicture(glyph)[screen_num];
+            if (glyph->info.width && glyph->info.height)
+                glyph_pict = GetGlyphPicture(glyph, screen);
+
+            /* Skip it if it has no picture
+             */
+            if (glyph_pict) {
                 DrawablePtr glyph_draw = glyph_pict->pDrawable;
 
                 /* Need to draw with slow path?
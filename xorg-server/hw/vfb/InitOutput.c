@@ -156,11 +156,20 @@ vfbBitsPerPixel(int depth)
         return 32;
 }
 
+static void
+vfbLogPixmanProfile(const char *line, void *closure)
+{
+    LogMessage(X_INFO, "%s\n", line);
+}
+
 void
 ddxGiveUp(enum ExitCode error)
 {
     int i;
 
+    /* Log where pixman found fast paths, when run with PIXMAN_PROFILE */
+    pixman_profile_report(vfbLogPixmanProfile, NULL);
+
     /* clean up the framebuffers */
 
     switch (fbmemtype) {
@@ -236,6 +245,7 @@ ddxUseMsg(void)
     ErrorF("-linebias n            adjust thin line pixelization\n");
     ErrorF("-blackpixel n          pixel value for black\n");
     ErrorF("-whitepixel n          pixel value for white\n");
+    ErrorF("-fbthreads n           render large operations with n extra threads\n");
 
 #ifdef HAVE_MMAP
     ErrorF
@@ -349,6 +359,12 @@ ddxProcessArgument(int argc, char *argv[], int i)
         return 2;
     }
 
+    if (strcmp(argv[i], "-fbthreads") == 0) {   /* -fbthreads n */
+        CHECK_FOR_REQUIRED_ARGUMENTS(1);
+        fbSetThreads(atoi(argv[++i]));
+        return 2;
+    }
+
 #ifdef HAVE_MMAP
     if (strcmp(argv[i], "-fbdir") == 0) {       /* -fbdir directory */
         CHECK_FOR_REQUIRED_ARGUMENTS(1);
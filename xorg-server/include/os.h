@@ -108,6 +108,10 @@ extern _X_EXPORT int ReadRequestFromClient(ClientPtr /*client */ );
 
 extern _X_EXPORT int ReadFdFromClient(ClientPtr client);
 
+extern _X_EXPORT void ClientInputStats(ClientPtr client,
+                                       unsigned long *copied,
+                                       unsigned long *reallocs);
+
 extern _X_EXPORT int WriteFdToClient(ClientPtr client, int fd, Bool do_close);
 
 extern _X_EXPORT Bool InsertFakeRequest(ClientPtr /*client */ ,
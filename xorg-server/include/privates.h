@@ -69,6 +69,10 @@ typedef struct _DevPrivateSetRec {
     unsigned offset;
     int created;
     int allocated;
+    /* freed objects kept for reuse, see dixAllocateScreenObject */
+    void *cached;
+    int numCached;
+    size_t cachedSize;
 } DevPrivateSetRec, *DevPrivateSetPtr;
 
 typedef struct _DevScreenPrivateKeyRec {
@@ -266,6 +270,24 @@ _dixAllocateScreenObjectWithPrivates(ScreenPtr pScreen,
 extern _X_EXPORT int
 dixScreenSpecificPrivatesSize(ScreenPtr pScreen, DevPrivateType type);
 
+/*
+ * Windows, GCs and pixmap headers are recycled through a per-screen cache
+ * of freed objects instead of going back to malloc every time.  All the
+ * objects of a type on a screen have to be the same size; asking for
+ * another size stops the caching of that type on that screen.
+ */
+extern _X_EXPORT void *
+dixAllocateScreenObject(ScreenPtr pScreen, size_t size, DevPrivateType type);
+
+extern _X_EXPORT void
+dixFreeScreenObject(ScreenPtr pScreen, void *object, DevPrivateType type);
+
+extern _X_EXPORT void
+_dixFreeScreenObjectWithPrivates(ScreenPtr pScreen, void *object,
+                                 PrivatePtr privates, DevPrivateType type);
+
+#define dixFreeScreenObjectWithPrivates(s, o, t) _dixFreeScreenObjectWithPrivates(s, o, (o)->devPrivates, t)
+
 extern _X_EXPORT void
 _dixInitScreenPrivates(ScreenPtr pScreen, PrivatePtr *privates, void *addr, DevPrivateType type);
 
@@ -61,6 +61,7 @@ typedef struct _Property {
     uint32_t size;              /* size of data in (format/8) bytes */
     void *data;                 /* private to client */
     PrivateRec *devPrivates;
+    struct _Property *prev;
 } PropertyRec;
 
 #endif                          /* PROPERTYSTRUCT_H */
@@ -222,6 +222,24 @@ extern _X_EXPORT void FindSubResources(void *resource,
                                        FindAllRes func,
                                        void *cdata);
 
+/** @brief Counters the server keeps about itself, such as the use of its
+    caches.  X-Resource reports them as extra resource types of the server
+    client, named by the counter, with the counter in the count field.
+    Counters registered under the same name are added up.
+
+    @note The name is interned when the counter is registered, so this has
+    to happen after the atoms are set up, once every server generation.
+    The value has to stay valid for as long as the server runs. */
+typedef void (*FindServerCounter)(Atom name,
+                                  unsigned long value,
+                                  void *cdata);
+
+extern _X_EXPORT Bool RegisterServerCounter(const char *name,
+                                            const unsigned long *value);
+
+extern _X_EXPORT void FindServerCounters(FindServerCounter func,
+                                         void *cdata);
+
 extern _X_EXPORT void FreeClientNeverRetainResources(ClientPtr /*client */ );
 
 extern _X_EXPORT void FreeClientResources(ClientPtr /*client */ );
@@ -193,6 +193,11 @@ extern _X_EXPORT Bool PointInWindowIsVisible(WindowPtr /*pWin */ ,
                                              int /*x */ ,
                                              int /*y */ );
 
+extern _X_EXPORT Bool PickWindowCandidates(ScreenPtr pScreen,
+                                           int x, int y,
+                                           WindowPtr **windows,
+                                           int *count);
+
 extern _X_EXPORT RegionPtr NotClippedByChildren(WindowPtr /*pWin */ );
 
 extern _X_EXPORT void SendVisibilityNotify(WindowPtr /*pWin */ );
@@ -210,6 +215,8 @@ extern _X_EXPORT Bool MakeWindowOptional(WindowPtr /*pWin */ );
 extern _X_EXPORT WindowPtr MoveWindowInStack(WindowPtr /*pWin */ ,
                                              WindowPtr /*pNextSib */ );
 
+extern _X_EXPORT void MarkGeometryChanged(WindowPtr /*pWin */ );
+
 extern _X_EXPORT void SetWinSize(WindowPtr /*pWin */ );
 
 extern _X_EXPORT void SetBorderSize(WindowPtr /*pWin */ );
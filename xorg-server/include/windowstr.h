@@ -93,6 +93,7 @@ typedef struct _WindowOpt {
     RegionPtr inputShape;       /* default: NULL */
     struct _OtherInputMasks *inputMasks;        /* default: NULL */
     DevCursorList deviceCursors;        /* default: NULL */
+    struct _PropertyIndex *propIndex;   /* default: NULL */
 } WindowOptRec, *WindowOptPtr;
 
 #define BackgroundPixel	    2L
@@ -162,6 +163,8 @@ typedef struct _Window {
     unsigned redirectDraw:2;    /* COMPOSITE rendering redirect */
     unsigned forcedBG:1;        /* must have an opaque background */
     unsigned unhittable:1;      /* doesn't hit-test, for rootless */
+    unsigned geometryChanged:1; /* it or an inferior moved or changed shape
+                                 * since its clips were last computed */
 #ifdef COMPOSITE
     unsigned damagedDescendants:1;      /* some descendants are damaged */
     unsigned inhibitBGPaint:1;  /* paint the background? */
@@ -59,20 +59,60 @@ in this Software without prior written authorization from The Open Group.
 #include <X11/extensions/dpmsconst.h>
 #endif
 
-/* Maximum size should be initial size multiplied by a power of 2 */
-#define QUEUE_INITIAL_SIZE                 1024
-#define QUEUE_RESERVED_SIZE                 64
-#define QUEUE_MAXIMUM_SIZE                4096
+/*
+ * The queue is a ring of preallocated events with a single consumer, the
+ * main thread, which takes events off without input_lock.  Everything
+ * adding events holds input_lock, so there is only ever one producer at
+ * a time, and it never allocates.
+ *
+ * The producer may fold a motion event into the last one it queued.  To
+ * keep that from racing with the consumer, each slot carries a state the
+ * two sides take over with compare-and-swap: the producer only rewrites a
+ * queued slot the consumer hasn't claimed yet.
+ */
+#define QUEUE_SIZE                        4096
 #define QUEUE_DROP_BACKTRACE_FREQUENCY     100
 #define QUEUE_DROP_BACKTRACE_MAX            10
 
 #define EnqueueScreen(dev) dev->spriteInfo->sprite->pEnqueueScreen
 #define DequeueScreen(dev) dev->spriteInfo->sprite->pDequeueScreen
 
+#if INPUTTHREAD
+#define mieqLoad(p)             __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define mieqStore(p, v)         __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define mieqSwap(p, old, new)   __atomic_compare_exchange_n(p, &(int){old}, new, \
+                                    FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define mieqExchange(p, v)      __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL)
+#define mieqIncrement(p)        __atomic_add_fetch(p, 1, __ATOMIC_ACQ_REL)
+#else
+#define mieqLoad(p)             (*(p))
+#define mieqStore(p, v)         (*(p) = (v))
+#define mieqSwap(p, old, new)   (*(p) == (old) ? (*(p) = (new), TRUE) : FALSE)
+#define mieqExchange(p, v)      mieqExchangeUnlocked(p, v)
+#define mieqIncrement(p)        (++*(p))
+
+static inline size_t
+mieqExchangeUnlocked(size_t *p, size_t v)
+{
+    size_t old = *p;
+
+    *p = v;
+    return old;
+}
+#endif
+
+enum {
+    EVENT_FREE,                 /* consumed, or never queued */
+    EVENT_QUEUED,               /* waiting for the consumer */
+    EVENT_CLAIMED,              /* being copied out by the consumer */
+    EVENT_WRITING,              /* being folded into by the producer */
+};
+
 typedef struct _Event {
     InternalEvent *events;
     ScreenPtr pScreen;
     DeviceIntPtr pDev;          /* device this event _originated_ from */
+    int state;
 } EventRec, *EventPtr;
 
 typedef struct _EventQueue {
@@ -80,6 +120,7 @@ typedef struct _EventQueue {
     CARD32 lastEventTime;       /* to avoid time running backwards */
     int lastMotion;             /* device ID if last event motion? */
     EventRec *events;           /* our queue as an array */
+    InternalEvent *pool;        /* the events in the queue */
     size_t nevents;             /* the number of buckets in our queue */
     size_t dropped;             /* counter for number of consecutive dropped events */
     mieqHandler handlers[128];  /* custom event handler */
@@ -87,86 +128,21 @@ typedef struct _EventQueue {
 
 static EventQueueRec miEventQueue;
 
-static size_t
-mieqNumEnqueued(EventQueuePtr eventQueue)
-{
-    size_t n_enqueued = 0;
-
-    if (eventQueue->nevents) {
-        /* % is not well-defined with negative numbers... sigh */
-        n_enqueued = eventQueue->tail - eventQueue->head + eventQueue->nevents;
-        if (n_enqueued >= eventQueue->nevents)
-            n_enqueued -= eventQueue->nevents;
-    }
-    return n_enqueued;
-}
-
-/* Pre-condition: Called with input_lock held */
-static Bool
-mieqGrowQueue(EventQueuePtr eventQueue, size_t new_nevents)
-{
-    size_t i, n_enqueued, first_hunk;
-    EventRec *new_events;
-
-    if (!eventQueue) {
-        ErrorF("[mi] mieqGrowQueue called with a NULL eventQueue\n");
-        return FALSE;
-    }
-
-    if (new_nevents <= eventQueue->nevents)
-        return FALSE;
-
-    new_events = calloc(new_nevents, sizeof(EventRec));
-    if (new_events == NULL) {
-        ErrorF("[mi] mieqGrowQueue memory allocation error.\n");
-        return FALSE;
-    }
-
-    n_enqueued = mieqNumEnqueued(eventQueue);
-
-    /* First copy the existing events */
-    first_hunk = eventQueue->nevents - eventQueue->head;
-    memcpy(new_events,
-           &eventQueue->events[eventQueue->head],
-           first_hunk * sizeof(EventRec));
-    memcpy(&new_events[first_hunk],
-           eventQueue->events, eventQueue->head * sizeof(EventRec));
-
-    /* Initialize the new portion */
-    for (i = eventQueue->nevents; i < new_nevents; i++) {
-        InternalEvent *evlist = InitEventList(1);
-
-        if (!evlist) {
-            size_t j;
-
-            for (j = 0; j < i; j++)
-                FreeEventList(new_events[j].events, 1);
-            free(new_events);
-            return FALSE;
-        }
-        new_events[i].events = evlist;
-    }
-
-    /* And update our record */
-    eventQueue->tail = n_enqueued;
-    eventQueue->head = 0;
-    eventQueue->nevents = new_nevents;
-    free(eventQueue->events);
-    eventQueue->events = new_events;
-
-    return TRUE;
-}
-
 Bool
 mieqInit(void)
 {
+    size_t i;
+
     memset(&miEventQueue, 0, sizeof(miEventQueue));
     miEventQueue.lastEventTime = GetTimeInMillis();
 
-    input_lock();
-    if (!mieqGrowQueue(&miEventQueue, QUEUE_INITIAL_SIZE))
+    miEventQueue.events = calloc(QUEUE_SIZE, sizeof(EventRec));
+    miEventQueue.pool = InitEventList(QUEUE_SIZE);
+    if (!miEventQueue.events || !miEventQueue.pool)
         FatalError("Could not allocate event queue.\n");
-    input_unlock();
+    for (i = 0; i < QUEUE_SIZE; i++)
+        miEventQueue.events[i].events = &miEventQueue.pool[i];
+    miEventQueue.nevents = QUEUE_SIZE;
 
     SetInputCheck(&miEventQueue.head, &miEventQueue.tail);
     return TRUE;
@@ -175,15 +151,10 @@ mieqInit(void)
 void
 mieqFini(void)
 {
-    int i;
-
-    for (i = 0; i < miEventQueue.nevents; i++) {
-        if (miEventQueue.events[i].events != NULL) {
-            FreeEventList(miEventQueue.events[i].events, 1);
-            miEventQueue.events[i].events = NULL;
-        }
-    }
+    FreeEventList(miEventQueue.pool, QUEUE_SIZE);
+    miEventQueue.pool = NULL;
     free(miEventQueue.events);
+    miEventQueue.events = NULL;
 }
 
 /*
@@ -195,31 +166,34 @@ void
 mieqEnqueue(DeviceIntPtr pDev, InternalEvent *e)
 {
     unsigned int oldtail = miEventQueue.tail;
+    unsigned int head = mieqLoad(&miEventQueue.head);
+    EventRec *slot = NULL;
+    Bool fold = FALSE;
     InternalEvent *evt;
     int isMotion = 0;
     int evlen;
     Time time;
-    size_t n_enqueued;
+    size_t dropped;
 
     verify_internal_event(e);
 
-    n_enqueued = mieqNumEnqueued(&miEventQueue);
-
     /* avoid merging events from different devices */
     if (e->any.type == ET_Motion)
         isMotion = pDev->id;
 
-    if (isMotion && isMotion == miEventQueue.lastMotion &&
-        oldtail != miEventQueue.head) {
-        oldtail = (oldtail - 1) % miEventQueue.nevents;
+    /* fold into the last motion event, unless the consumer has it already */
+    if (isMotion && isMotion == miEventQueue.lastMotion && oldtail != head) {
+        slot = &miEventQueue.events[(oldtail - 1) % miEventQueue.nevents];
+        fold = mieqSwap(&slot->state, EVENT_QUEUED, EVENT_WRITING);
     }
-    else if (n_enqueued + 1 == miEventQueue.nevents) {
-        if (!mieqGrowQueue(&miEventQueue, miEventQueue.nevents << 1)) {
+
+    if (!fold) {
+        if ((oldtail + 1) % miEventQueue.nevents == head) {
             /* Toss events which come in late.  Usually this means your server's
              * stuck in an infinite loop in the main thread.
              */
-            miEventQueue.dropped++;
-            if (miEventQueue.dropped == 1) {
+            dropped = mieqIncrement(&miEventQueue.dropped);
+            if (dropped == 1) {
                 ErrorFSigSafe("[mi] EQ overflowing.  Additional events will be "
                               "discarded until existing events are processed.\n");
                 xorg_backtrace();
@@ -227,12 +201,12 @@ mieqEnqueue(DeviceIntPtr pDev, InternalEvent *e)
                               "a culprit higher up the stack.\n");
                 ErrorFSigSafe("[mi] mieq is *NOT* the cause.  It is a victim.\n");
             }
-            else if (miEventQueue.dropped % QUEUE_DROP_BACKTRACE_FREQUENCY == 0 &&
-                     miEventQueue.dropped / QUEUE_DROP_BACKTRACE_FREQUENCY <=
+            else if (dropped % QUEUE_DROP_BACKTRACE_FREQUENCY == 0 &&
+                     dropped / QUEUE_DROP_BACKTRACE_FREQUENCY <=
                      QUEUE_DROP_BACKTRACE_MAX) {
                 ErrorFSigSafe("[mi] EQ overflow continuing.  %zu events have been "
-                              "dropped.\n", miEventQueue.dropped);
-                if (miEventQueue.dropped / QUEUE_DROP_BACKTRACE_FREQUENCY ==
+                              "dropped.\n", dropped);
+                if (dropped / QUEUE_DROP_BACKTRACE_FREQUENCY ==
                     QUEUE_DROP_BACKTRACE_MAX) {
                     ErrorFSigSafe("[mi] No further overflow reports will be "
                                   "reported until the clog is cleared.\n");
@@ -241,11 +215,11 @@ mieqEnqueue(DeviceIntPtr pDev, InternalEvent *e)
             }
             return;
         }
-        oldtail = miEventQueue.tail;
+        slot = &miEventQueue.events[oldtail];
     }
 
     evlen = e->any.length;
-    evt = miEventQueue.events[oldtail].events;
+    evt = slot->events;
     memcpy(evt, e, evlen);
 
     time = e->any.time;
@@ -256,11 +230,16 @@ mieqEnqueue(DeviceIntPtr pDev, InternalEvent *e)
         e->any.time = miEventQueue.lastEventTime;
 
     miEventQueue.lastEventTime = evt->any.time;
-    miEventQueue.events[oldtail].pScreen = pDev ? EnqueueScreen(pDev) : NULL;
-    miEventQueue.events[oldtail].pDev = pDev;
+    slot->pScreen = pDev ? EnqueueScreen(pDev) : NULL;
+    slot->pDev = pDev;
 
     miEventQueue.lastMotion = isMotion;
-    miEventQueue.tail = (oldtail + 1) % miEventQueue.nevents;
+    if (fold)
+        mieqStore(&slot->state, EVENT_QUEUED);
+    else {
+        slot->state = EVENT_QUEUED;
+        mieqStore(&miEventQueue.tail, (oldtail + 1) % miEventQueue.nevents);
+    }
 }
 
 /**
@@ -497,18 +476,44 @@ mieqProcessDeviceEvent(DeviceIntPtr dev, InternalEvent *event, ScreenPtr screen)
     }
 }
 
+/**
+ * Take the next event off the queue. Returns FALSE if it is empty as far
+ * as tail says.
+ */
+static Bool
+mieqDequeue(HWEventQueueType tail, InternalEvent *event,
+            DeviceIntPtr *dev, ScreenPtr *screen)
+{
+    HWEventQueueType head = miEventQueue.head;
+    EventRec *e = &miEventQueue.events[head];
+
+    if (head == tail)
+        return FALSE;
+
+    /* the producer only holds a slot for as long as a memcpy takes */
+    while (!mieqSwap(&e->state, EVENT_QUEUED, EVENT_CLAIMED))
+        ;
+
+    *event = *e->events;
+    *dev = e->pDev;
+    *screen = e->pScreen;
+
+    mieqStore(&e->state, EVENT_FREE);
+    mieqStore(&miEventQueue.head, (head + 1) % miEventQueue.nevents);
+    return TRUE;
+}
+
 /* Call this from ProcessInputEvents(). */
 void
 mieqProcessInputEvents(void)
 {
-    EventRec *e = NULL;
     ScreenPtr screen;
     InternalEvent event;
+    HWEventQueueType tail;
+    size_t dropped;
     DeviceIntPtr dev = NULL, master = NULL;
     static Bool inProcessInputEvents = FALSE;
 
-    input_lock();
-
     /*
      * report an error if mieqProcessInputEvents() is called recursively;
      * this can happen, e.g., if something in the mieqProcessDeviceEvent()
@@ -517,51 +522,40 @@ mieqProcessInputEvents(void)
     BUG_WARN_MSG(inProcessInputEvents, "[mi] mieqProcessInputEvents() called recursively.\n");
     inProcessInputEvents = TRUE;
 
-    if (miEventQueue.dropped) {
+    dropped = mieqExchange(&miEventQueue.dropped, 0);
+    if (dropped) {
         ErrorF("[mi] EQ processing has resumed after %lu dropped events.\n",
-               (unsigned long) miEventQueue.dropped);
+               (unsigned long) dropped);
         ErrorF
             ("[mi] This may be caused by a misbehaving driver monopolizing the server's resources.\n");
-        miEventQueue.dropped = 0;
     }
 
-    while (miEventQueue.head != miEventQueue.tail) {
-        e = &miEventQueue.events[miEventQueue.head];
-
-        event = *e->events;
-        dev = e->pDev;
-        screen = e->pScreen;
-
-        miEventQueue.head = (miEventQueue.head + 1) % miEventQueue.nevents;
-
-        input_unlock();
+    /* drain what is queued now, then check for more */
+    while ((tail = mieqLoad(&miEventQueue.tail)) != miEventQueue.head) {
+        while (mieqDequeue(tail, &event, &dev, &screen)) {
+            master = (dev) ? GetMaster(dev, MASTER_ATTACHED) : NULL;
 
-        master = (dev) ? GetMaster(dev, MASTER_ATTACHED) : NULL;
-
-        if (screenIsSaved == SCREEN_SAVER_ON)
-            dixSaveScreens(serverClient, SCREEN_SAVER_OFF, ScreenSaverReset);
+            if (screenIsSaved == SCREEN_SAVER_ON)
+                dixSaveScreens(serverClient, SCREEN_SAVER_OFF, ScreenSaverReset);
 #ifdef DPMSExtension
-        else if (DPMSPowerLevel != DPMSModeOn)
-            SetScreenSaverTimer();
+            else if (DPMSPowerLevel != DPMSModeOn)
+                SetScreenSaverTimer();
 
-        if (DPMSPowerLevel != DPMSModeOn)
-            DPMSSet(serverClient, DPMSModeOn);
+            if (DPMSPowerLevel != DPMSModeOn)
+                DPMSSet(serverClient, DPMSModeOn);
 #endif
 
-        mieqProcessDeviceEvent(dev, &event, screen);
-
-        /* Update the sprite now. Next event may be from different device. */
-        if (master &&
-            (event.any.type == ET_Motion ||
-             ((event.any.type == ET_TouchBegin ||
-               event.any.type == ET_TouchUpdate) &&
-              event.device_event.flags & TOUCH_POINTER_EMULATED)))
-            miPointerUpdateSprite(dev);
+            mieqProcessDeviceEvent(dev, &event, screen);
 
-        input_lock();
+            /* Update the sprite now. Next event may be from different device. */
+            if (master &&
+                (event.any.type == ET_Motion ||
+                 ((event.any.type == ET_TouchBegin ||
+                   event.any.type == ET_TouchUpdate) &&
+                  event.device_event.flags & TOUCH_POINTER_EMULATED)))
+                miPointerUpdateSprite(dev);
+        }
     }
 
     inProcessInputEvents = FALSE;
-
-    input_unlock();
 }
@@ -177,6 +177,34 @@ miShapedWindowIn(RegionPtr universe, RegionPtr bounding,
 				    HasBorder(w) && \
 				    (w)->backgroundState == ParentRelative)
 
+/*
+ * Clear the exposures of pParent and its marked inferiors, whose clips are
+ * left as they are.
+ */
+static void
+miClipsUnchanged(WindowPtr pParent)
+{
+    WindowPtr pChild;
+
+    pChild = pParent;
+    while (1) {
+        if (pChild->viewable && pChild->valdata &&
+            pChild->valdata != UnmapValData) {
+            RegionNull(&pChild->valdata->after.borderExposed);
+            RegionNull(&pChild->valdata->after.exposed);
+            if (pChild->firstChild) {
+                pChild = pChild->firstChild;
+                continue;
+            }
+        }
+        while (!pChild->nextSib && (pChild != pParent))
+            pChild = pChild->parent;
+        if (pChild == pParent)
+            break;
+        pChild = pChild->nextSib;
+    }
+}
+
 /*
  *-----------------------------------------------------------------------
  * miComputeClips --
@@ -281,6 +309,22 @@ miComputeClips(WindowPtr pParent,
     dx = pParent->drawable.x - pParent->valdata->before.oldAbsCorner.x;
     dy = pParent->drawable.y - pParent->valdata->before.oldAbsCorner.y;
 
+    /*
+     * A window that only got marked because a sibling changed often ends
+     * up with the same universe as before.  If nothing in it changed
+     * either, the clips of the whole subtree are still right; this saves
+     * revalidating every sibling below a window that is restacked.
+     */
+    if (!pParent->geometryChanged && kind != VTBroken &&
+        oldVis == newVis && oldVis != VisibilityNotViewable &&
+        !dx && !dy && pParent->redirectDraw == RedirectDrawNone &&
+        !pParent->valdata->before.borderVisible &&
+        !pParent->valdata->before.resized &&
+        RegionEqual(universe, &pParent->borderClip)) {
+        miClipsUnchanged(pParent);
+        return;
+    }
+
     /*
      * avoid computations when dealing with simple operations
      */
@@ -314,6 +358,7 @@ miComputeClips(WindowPtr pParent,
                         }
                         RegionNull(&pChild->valdata->after.exposed);
                     }
+                    pChild->geometryChanged = FALSE;
                     if (pChild->firstChild) {
                         pChild = pChild->firstChild;
                         continue;
@@ -476,6 +521,7 @@ miComputeClips(WindowPtr pParent,
 #endif
 
     pParent->drawable.serialNumber = NEXT_SERIAL_NUMBER;
+    pParent->geometryChanged = FALSE;
 
     if (pScreen->ClipNotify)
         (*pScreen->ClipNotify) (pParent, dx, dy);
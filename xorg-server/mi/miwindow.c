@@ -746,42 +746,73 @@ miMarkUnrealizedWindow(WindowPtr pChild, WindowPtr pWin, Bool fromConfigure)
     }
 }
 
+static Bool
+miSpriteHitWindow(WindowPtr pWin, int x, int y)
+{
+    BoxRec box;
+
+    return (pWin->mapped) &&
+        (x >= pWin->drawable.x - wBorderWidth(pWin)) &&
+        (x < pWin->drawable.x + (int) pWin->drawable.width +
+         wBorderWidth(pWin)) &&
+        (y >= pWin->drawable.y - wBorderWidth(pWin)) &&
+        (y < pWin->drawable.y + (int) pWin->drawable.height +
+         wBorderWidth(pWin))
+        /* When a window is shaped, a further check
+         * is made to see if the point is inside
+         * borderSize
+         */
+        && (!wBoundingShape(pWin) || PointInBorderSize(pWin, x, y))
+        && (!wInputShape(pWin) ||
+            RegionContainsPoint(wInputShape(pWin),
+                                x - pWin->drawable.x,
+                                y - pWin->drawable.y, &box))
+        /* In rootless mode windows may be offscreen, even when
+         * they're in X's stack. (E.g. if the native window system
+         * implements some form of virtual desktop system).
+         */
+        && !pWin->unhittable;
+}
+
+static void
+miSpriteTraceAppend(SpritePtr pSprite, WindowPtr pWin)
+{
+    if (pSprite->spriteTraceGood >= pSprite->spriteTraceSize) {
+        pSprite->spriteTraceSize += 10;
+        pSprite->spriteTrace = reallocarray(pSprite->spriteTrace,
+                                            pSprite->spriteTraceSize,
+                                            sizeof(WindowPtr));
+    }
+    pSprite->spriteTrace[pSprite->spriteTraceGood++] = pWin;
+}
+
 WindowPtr
 miSpriteTrace(SpritePtr pSprite, int x, int y)
 {
-    WindowPtr pWin;
-    BoxRec box;
+    WindowPtr pWin = DeepestSpriteWin(pSprite);
+    ScreenPtr pScreen = pWin->drawable.pScreen;
+    WindowPtr *candidates;
+    int i, count;
+
+    /* From the root, only the windows the screen lists for the point
+     * need to be looked at.  They come parents first, so a window is
+     * entered exactly when the walk below would have entered it.
+     */
+    if (pWin == pScreen->root &&
+        PickWindowCandidates(pScreen, x, y, &candidates, &count)) {
+        for (i = 0; i < count; i++) {
+            pWin = candidates[i];
+            if (pWin->parent == DeepestSpriteWin(pSprite) &&
+                miSpriteHitWindow(pWin, x, y))
+                miSpriteTraceAppend(pSprite, pWin);
+        }
+        return DeepestSpriteWin(pSprite);
+    }
 
-    pWin = DeepestSpriteWin(pSprite)->firstChild;
+    pWin = pWin->firstChild;
     while (pWin) {
-        if ((pWin->mapped) &&
-            (x >= pWin->drawable.x - wBorderWidth(pWin)) &&
-            (x < pWin->drawable.x + (int) pWin->drawable.width +
-             wBorderWidth(pWin)) &&
-            (y >= pWin->drawable.y - wBorderWidth(pWin)) &&
-            (y < pWin->drawable.y + (int) pWin->drawable.height +
-             wBorderWidth(pWin))
-            /* When a window is shaped, a further check
-             * is made to see if the point is inside
-             * borderSize
-             */
-            && (!wBoundingShape(pWin) || PointInBorderSize(pWin, x, y))
-            && (!wInputShape(pWin) ||
-                RegionContainsPoint(wInputShape(pWin),
-                                    x - pWin->drawable.x,
-                                    y - pWin->drawable.y, &box))
-            /* In rootless mode windows may be offscreen, even when
-             * they're in X's stack. (E.g. if the native window system
-             * implements some form of virtual desktop system).
-             */
-            && !pWin->unhittable) {
-            if (pSprite->spriteTraceGood >= pSprite->spriteTraceSize) {
-                pSprite->spriteTraceSize += 10;
-                pSprite->spriteTrace = reallocarray(pSprite->spriteTrace,
-                                                    pSprite->spriteTraceSize,
-                                                    sizeof(WindowPtr));
-            }
-            pSprite->spriteTrace[pSprite->spriteTraceGood++] = pWin;
+        if (miSpriteHitWindow(pWin, x, y)) {
+            miSpriteTraceAppend(pSprite, pWin);
             pWin = pWin->firstChild;
         }
         else
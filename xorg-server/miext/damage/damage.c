@@ -127,6 +127,107 @@ _damageRegionAppend(DrawablePtr pDrawable, RegionPtr pRegion, Bool clip,
                     int subWindowMode, const char *where)
 #define damageRegionAppend(d,r,c,m) _damageRegionAppend(d,r,c,m,__FUNCTION__)
 #else
+/*
+ * Batched damage doesn't union every drawing operation into the damage
+ * region.  The boxes are collected instead and added all at once when
+ * somebody looks at the region; past DAMAGE_BATCH_BOXES only their
+ * bounding box is kept.  Only levels which don't hand the region of each
+ * operation to the report function can be batched; NonEmpty still reports
+ * its first damage as it happens.
+ */
+#define DAMAGE_BATCH_BOXES 256
+
+static Bool
+damageBatching(DamagePtr pDamage)
+{
+    switch (pDamage->damageLevel) {
+    case DamageReportNone:
+        return pDamage->batched;
+    case DamageReportNonEmpty:
+        return pDamage->batched && (pDamage->nBoxes ||
+                                    RegionNotEmpty(&pDamage->damage));
+    default:
+        return FALSE;
+    }
+}
+
+/* Replace the collected boxes with their bounding box */
+static void
+damageBatchCollapse(DamagePtr pDamage)
+{
+    BoxPtr extents = &pDamage->boxes[0];
+    int i;
+
+    for (i = 1; i < pDamage->nBoxes; i++) {
+        BoxPtr b = &pDamage->boxes[i];
+
+        extents->x1 = min(extents->x1, b->x1);
+        extents->y1 = min(extents->y1, b->y1);
+        extents->x2 = max(extents->x2, b->x2);
+        extents->y2 = max(extents->y2, b->y2);
+    }
+    pDamage->nBoxes = 1;
+}
+
+static Bool
+damageBatchRegion(DamagePtr pDamage, RegionPtr pRegion)
+{
+    int nbox = RegionNumRects(pRegion);
+
+    if (!nbox)
+        return TRUE;
+
+    if (!pDamage->boxes) {
+        pDamage->boxes = xallocarray(DAMAGE_BATCH_BOXES, sizeof(BoxRec));
+        if (!pDamage->boxes)
+            return FALSE;
+    }
+
+    if (pDamage->nBoxes + nbox > DAMAGE_BATCH_BOXES) {
+        if (pDamage->nBoxes)
+            damageBatchCollapse(pDamage);
+        pDamage->boxes[pDamage->nBoxes++] = *RegionExtents(pRegion);
+        damageBatchCollapse(pDamage);
+        return TRUE;
+    }
+
+    memcpy(pDamage->boxes + pDamage->nBoxes, RegionRects(pRegion),
+           nbox * sizeof(BoxRec));
+    pDamage->nBoxes += nbox;
+    return TRUE;
+}
+
+static void
+damageBatchFlush(DamagePtr pDamage)
+{
+    RegionRec region;
+
+    if (!pDamage->nBoxes)
+        return;
+
+    if (!RegionInitBoxes(&region, pDamage->boxes, pDamage->nBoxes)) {
+        RegionUninit(&region);
+        damageBatchCollapse(pDamage);
+        RegionInit(&region, pDamage->boxes, 1);
+    }
+    pDamage->nBoxes = 0;
+    RegionUnion(&pDamage->damage, &pDamage->damage, &region);
+    RegionUninit(&region);
+}
+
+static void
+damageAccumulate(DamagePtr pDamage, RegionPtr pDamageRegion)
+{
+    if (damageBatching(pDamage) && damageBatchRegion(pDamage, pDamageRegion))
+        return;
+
+    /* It's possible that there is only interest in postRendering reporting. */
+    if (pDamage->damageReport)
+        DamageReportDamage(pDamage, pDamageRegion);
+    else
+        RegionUnion(&pDamage->damage, &pDamage->damage, pDamageRegion);
+}
+
 static void
 damageRegionAppend(DrawablePtr pDrawable, RegionPtr pRegion, Bool clip,
                    int subWindowMode)
@@ -261,12 +362,8 @@ damageRegionAppend(DrawablePtr pDrawable, RegionPtr pRegion, Bool clip,
                         &pDamage->pendingDamage, pDamageRegion);
 
         /* Report damage now, if desired. */
-        if (!pDamage->reportAfter) {
-            if (pDamage->damageReport)
-                DamageReportDamage(pDamage, pDamageRegion);
-            else
-                RegionUnion(&pDamage->damage, &pDamage->damage, pDamageRegion);
-        }
+        if (!pDamage->reportAfter)
+            damageAccumulate(pDamage, pDamageRegion);
 
         /*
          * translate original region back
@@ -288,14 +385,8 @@ damageRegionProcessPending(DrawablePtr pDrawable)
     drawableDamage(pDrawable);
 
     for (; pDamage != NULL; pDamage = pDamage->pNext) {
-        if (pDamage->reportAfter) {
-            /* It's possible that there is only interest in postRendering reporting. */
-            if (pDamage->damageReport)
-                DamageReportDamage(pDamage, &pDamage->pendingDamage);
-            else
-                RegionUnion(&pDamage->damage, &pDamage->damage,
-                            &pDamage->pendingDamage);
-        }
+        if (pDamage->reportAfter)
+            damageAccumulate(pDamage, &pDamage->pendingDamage);
 
         if (pDamage->reportAfter)
             RegionEmpty(&pDamage->pendingDamage);
@@ -1889,6 +1980,7 @@ DamageDestroy(DamagePtr pDamage)
     (*pScrPriv->funcs.Destroy) (pDamage);
     RegionUninit(&pDamage->damage);
     RegionUninit(&pDamage->pendingDamage);
+    free(pDamage->boxes);
     free(pDamage);
 }
 
@@ -1899,6 +1991,7 @@ DamageSubtract(DamagePtr pDamage, const RegionPtr pRegion)
     RegionRec pixmapClip;
     DrawablePtr pDrawable = pDamage->pDrawable;
 
+    damageBatchFlush(pDamage);
     RegionSubtract(&pDamage->damage, &pDamage->damage, pRegion);
     if (pDrawable) {
         if (pDrawable->type == DRAWABLE_WINDOW)
@@ -1925,12 +2018,14 @@ DamageSubtract(DamagePtr pDamage, const RegionPtr pRegion)
 void
 DamageEmpty(DamagePtr pDamage)
 {
+    pDamage->nBoxes = 0;
     RegionEmpty(&pDamage->damage);
 }
 
 RegionPtr
 DamageRegion(DamagePtr pDamage)
 {
+    damageBatchFlush(pDamage);
     return &pDamage->damage;
 }
 
@@ -1971,6 +2066,14 @@ DamageSetReportAfterOp(DamagePtr pDamage, Bool reportAfter)
     pDamage->reportAfter = reportAfter;
 }
 
+void
+DamageSetBatched(DamagePtr pDamage, Bool batched)
+{
+    if (!batched)
+        damageBatchFlush(pDamage);
+    pDamage->batched = batched;
+}
+
 DamageScreenFuncsPtr
 DamageGetScreenFuncs(ScreenPtr pScreen)
 {
@@ -1985,6 +2088,8 @@ DamageReportDamage(DamagePtr pDamage, RegionPtr pDamageRegion)
     RegionRec tmpRegion;
     Bool was_empty;
 
+    damageBatchFlush(pDamage);
+
     switch (pDamage->damageLevel) {
     case DamageReportRawRegion:
         RegionUnion(&pDamage->damage, &pDamage->damage, pDamageRegion);
@@ -110,6 +110,12 @@ extern _X_EXPORT void
 extern _X_EXPORT void
  DamageSetReportAfterOp(DamagePtr pDamage, Bool reportAfter);
 
+/* Collect damage as boxes and only merge them into the region when it is
+ * asked for.  Ignored unless the level is DamageReportNone or
+ * DamageReportNonEmpty. */
+extern _X_EXPORT void
+ DamageSetBatched(DamagePtr pDamage, Bool batched);
+
 extern _X_EXPORT DamageScreenFuncsPtr DamageGetScreenFuncs(ScreenPtr);
 
 #endif                          /* _DAMAGE_H_ */
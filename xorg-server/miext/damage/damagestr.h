@@ -49,6 +49,10 @@ typedef struct _damage {
     Bool reportAfter;
     RegionRec pendingDamage;    /* will be flushed post submission at the latest */
     ScreenPtr pScreen;
+
+    Bool batched;
+    BoxPtr boxes;               /* damage not yet added to the region */
+    int nBoxes;
 } DamageRec;
 
 typedef struct _damageScrPriv {
@@ -132,6 +132,7 @@ shadowSetup(ScreenPtr pScreen)
         free(pBuf);
         return FALSE;
     }
+    DamageSetBatched(pBuf->pDamage, TRUE);
 
     wrap(pBuf, pScreen, CloseScreen);
     wrap(pBuf, pScreen, GetImage);
@@ -95,9 +95,10 @@ SOFTWARE.
 #endif
 
 struct _OsTimerRec {
-    struct xorg_list list;
+    int index;                  /* position in timer_heap + 1, 0 if idle */
     CARD32 expires;
     CARD32 delta;
+    CARD32 serial;              /* orders timers expiring together */
     OsTimerCallback callback;
     void *arg;
 };
@@ -105,15 +106,95 @@ struct _OsTimerRec {
 static void DoTimer(OsTimerPtr timer, CARD32 now);
 static void DoTimers(CARD32 now);
 static void CheckAllTimers(void);
-static volatile struct xorg_list timers;
+
+/*
+ * Pending timers are kept in a binary min-heap ordered on expiry time,
+ * so that arming and cancelling a timer is O(log n) however many are
+ * pending.  Timers expiring at the same time run in the order they were
+ * set.  The heap always has room for every timer that has been
+ * allocated, so neither operation can fail.
+ */
+static OsTimerPtr *timer_heap;
+static int timer_count;         /* pending timers */
+static int timer_size;          /* slots in timer_heap */
+static int timers_allocated;
+static CARD32 timer_serial;
+
+static inline Bool
+timer_before(OsTimerPtr a, OsTimerPtr b)
+{
+    if (a->expires != b->expires)
+        return (int) (a->expires - b->expires) < 0;
+    return (int) (a->serial - b->serial) < 0;
+}
+
+static inline void
+timer_heap_place(OsTimerPtr timer, int i)
+{
+    timer_heap[i] = timer;
+    timer->index = i + 1;
+}
+
+static void
+timer_heap_up(OsTimerPtr timer, int i)
+{
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+
+        if (!timer_before(timer, timer_heap[parent]))
+            break;
+        timer_heap_place(timer_heap[parent], i);
+        i = parent;
+    }
+    timer_heap_place(timer, i);
+}
+
+static void
+timer_heap_down(OsTimerPtr timer, int i)
+{
+    for (;;) {
+        int child = 2 * i + 1;
+
+        if (child >= timer_count)
+            break;
+        if (child + 1 < timer_count &&
+            timer_before(timer_heap[child + 1], timer_heap[child]))
+            child++;
+        if (!timer_before(timer_heap[child], timer))
+            break;
+        timer_heap_place(timer_heap[child], i);
+        i = child;
+    }
+    timer_heap_place(timer, i);
+}
+
+static void
+timer_heap_insert(OsTimerPtr timer)
+{
+    timer_heap_up(timer, timer_count++);
+}
+
+static void
+timer_heap_remove(OsTimerPtr timer)
+{
+    int i = timer->index - 1;
+    OsTimerPtr last;
+
+    timer->index = 0;
+    last = timer_heap[--timer_count];
+    if (last == timer)
+        return;
+    /* Put the last timer in the hole, then let it find its place */
+    if (i > 0 && timer_before(last, timer_heap[(i - 1) / 2]))
+        timer_heap_up(last, i);
+    else
+        timer_heap_down(last, i);
+}
 
 static inline OsTimerPtr
 first_timer(void)
 {
-    /* inline xorg_list_is_empty which can't handle volatile */
-    if (timers.next == &timers)
-        return NULL;
-    return xorg_list_first_entry(&timers, struct _OsTimerRec, list);
+    return timer_count ? timer_heap[0] : NULL;
 }
 
 /*
@@ -124,16 +205,25 @@ static int
 check_timers(void)
 {
     OsTimerPtr timer;
+    CARD32 expires, delta;
 
-    if ((timer = first_timer()) != NULL) {
+    input_lock();
+    timer = first_timer();
+    if (timer) {
+        expires = timer->expires;
+        delta = timer->delta;
+    }
+    input_unlock();
+
+    if (timer) {
         CARD32 now = GetTimeInMillis();
-        int timeout = timer->expires - now;
+        int timeout = expires - now;
 
         if (timeout <= 0) {
             DoTimers(now);
         } else {
             /* Make sure the timeout is sane */
-            if (timeout < timer->delta + 250)
+            if (timeout < delta + 250)
                 return timeout;
 
             /* time has rewound.  reset the timers. */
@@ -328,22 +418,24 @@ AdjustWaitForDelay(void *waitTime, int newdelay)
 }
 
 static inline Bool timer_pending(OsTimerPtr timer) {
-    return !xorg_list_is_empty(&timer->list);
+    return timer->index != 0;
 }
 
 /* If time has rewound, re-run every affected timer.
- * Timers might drop out of the list, so we have to restart every time. */
+ * Timers might drop out of the heap, so we have to restart every time. */
 static void
 CheckAllTimers(void)
 {
     OsTimerPtr timer;
     CARD32 now;
+    int i;
 
     input_lock();
  start:
     now = GetTimeInMillis();
 
-    xorg_list_for_each_entry(timer, &timers, list) {
+    for (i = 0; i < timer_count; i++) {
+        timer = timer_heap[i];
         if (timer->expires - now > timer->delta + 250) {
             DoTimer(timer, now);
             goto start;
@@ -357,7 +449,7 @@ DoTimer(OsTimerPtr timer, CARD32 now)
 {
     CARD32 newTime;
 
-    xorg_list_del(&timer->list);
+    timer_heap_remove(timer);
     newTime = (*timer->callback) (timer, now, timer->arg);
     if (newTime)
         TimerSet(timer, 0, newTime, timer->callback, timer->arg);
@@ -381,19 +473,33 @@ OsTimerPtr
 TimerSet(OsTimerPtr timer, int flags, CARD32 millis,
          OsTimerCallback func, void *arg)
 {
-    OsTimerPtr existing;
     CARD32 now = GetTimeInMillis();
 
     if (!timer) {
         timer = calloc(1, sizeof(struct _OsTimerRec));
         if (!timer)
             return NULL;
-        xorg_list_init(&timer->list);
+        input_lock();
+        if (timers_allocated == timer_size) {
+            int size = timer_size ? timer_size * 2 : 32;
+            OsTimerPtr *heap;
+
+            heap = reallocarray(timer_heap, size, sizeof(OsTimerPtr));
+            if (!heap) {
+                input_unlock();
+                free(timer);
+                return NULL;
+            }
+            timer_heap = heap;
+            timer_size = size;
+        }
+        timers_allocated++;
+        input_unlock();
     }
     else {
         input_lock();
         if (timer_pending(timer)) {
-            xorg_list_del(&timer->list);
+            timer_heap_remove(timer);
             if (flags & TimerForceOld)
                 (void) (*timer->callback) (timer, now, timer->arg);
         }
@@ -413,12 +519,8 @@ TimerSet(OsTimerPtr timer, int flags, CARD32 millis,
     timer->arg = arg;
     input_lock();
 
-    /* Sort into list */
-    xorg_list_for_each_entry(existing, &timers, list)
-        if ((int) (existing->expires - millis) > 0)
-            break;
-    /* This even works at the end of the list -- existing->list will be timers */
-    xorg_list_append(&timer->list, &existing->list);
+    timer->serial = timer_serial++;
+    timer_heap_insert(timer);
 
     /* Check to see if the timer is ready to run now */
     if ((int) (millis - now) <= 0)
@@ -447,7 +549,8 @@ TimerCancel(OsTimerPtr timer)
     if (!timer)
         return;
     input_lock();
-    xorg_list_del(&timer->list);
+    if (timer_pending(timer))
+        timer_heap_remove(timer);
     input_unlock();
 }
 
@@ -456,7 +559,11 @@ TimerFree(OsTimerPtr timer)
 {
     if (!timer)
         return;
-    TimerCancel(timer);
+    input_lock();
+    if (timer_pending(timer))
+        timer_heap_remove(timer);
+    timers_allocated--;
+    input_unlock();
     free(timer);
 }
 
@@ -469,16 +576,10 @@ TimerCheck(void)
 void
 TimerInit(void)
 {
-    static Bool been_here;
-    OsTimerPtr timer, tmp;
-
-    if (!been_here) {
-        been_here = TRUE;
-        xorg_list_init((struct xorg_list*) &timers);
-    }
+    while (timer_count) {
+        OsTimerPtr timer = timer_heap[--timer_count];
 
-    xorg_list_for_each_entry_safe(timer, tmp, &timers, list) {
-        xorg_list_del(&timer->list);
+        timers_allocated--;
         free(timer);
     }
 }
@@ -648,6 +648,10 @@ AllocNewConnection(XtransConnInfo trans_conn, int fd, CARD32 conn_time)
     oc->auth_id = None;
     oc->conn_time = conn_time;
     oc->flags = 0;
+    oc->input_copied = 0;
+    oc->input_reallocs = 0;
+    oc->output_last = (ConnectionOutputPtr) NULL;
+    oc->output_queued = 0;
     if (!(client = NextAvailableClient((void *) oc))) {
         free(oc);
         return NullClient;
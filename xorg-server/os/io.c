@@ -83,6 +83,7 @@ CallbackListPtr FlushCallback;
 
 typedef struct _connectionInput {
     struct _connectionInput *next;
+    struct _connectionInput *more;  /* chunks read past the end of buffer */
     char *buffer;               /* contains current client input */
     char *bufptr;               /* pointer to current start of data */
     int bufcnt;                 /* count of bytes in buffer */
@@ -96,16 +97,21 @@ typedef struct _connectionOutput {
     unsigned char *buf;
     int size;
     int count;
+    int start;                  /* bytes of buf already written */
 } ConnectionOutput;
 
 static ConnectionInputPtr AllocateInputBuffer(void);
 static ConnectionOutputPtr AllocateOutputBuffer(void);
+static ConnectionOutputPtr GetOutputBuffer(void);
 
 static Bool CriticalOutputPending;
 static int timesThisConnection = 0;
 static ConnectionInputPtr FreeInputs = (ConnectionInputPtr) NULL;
 static ConnectionOutputPtr FreeOutputs = (ConnectionOutputPtr) NULL;
+static int NumFreeOutputs = 0;
 static OsCommPtr AvailableInput = (OsCommPtr) NULL;
+static char *LargeInput = NULL;
+static int LargeInputSize = 0;
 
 #define get_req_len(req,cli) ((cli)->swapped ? \
 			      bswap_16((req)->length) : (req)->length)
@@ -118,6 +124,8 @@ static OsCommPtr AvailableInput = (OsCommPtr) NULL;
 
 #define BUFSIZE 16384
 #define BUFWATERMARK 32768
+#define OUTPUTPOOLSIZE 64       /* free output segments kept around */
+#define OUTPUTIOVECS 16         /* output segments per writev */
 
 /*
  *   A lot of the code in this file manipulates a ConnectionInputPtr:
@@ -147,6 +155,14 @@ static OsCommPtr AvailableInput = (OsCommPtr) NULL;
  *  needed = the length of the request that we're trying to
  *  read.  Watch out: needed sometimes counts bytes and sometimes
  *  counts CARD32's.
+ *
+ *  Reads are scattered over the free space at the end of buffer and a
+ *  spare chunk from FreeInputs, so one read can pick up more than the
+ *  buffer holds.  Chunks that received data are queued on oci->more,
+ *  each with its own bufptr and bufcnt, and always hold input that
+ *  follows the buffer.  Once buffer is used up, the next chunk's buffer
+ *  is swapped in, so requests that fit in a chunk are never copied; only
+ *  a request that spans two chunks is gathered into buffer.
  */
 
 /*****************************************************************
@@ -197,6 +213,51 @@ YieldControlDeath(void)
     timesThisConnection = 0;
 }
 
+/* Keep the largest buffer let go after a big request, so that a stream of
+ * PutImage or AddGlyphs requests does not go back to realloc every time.
+ */
+static void
+StashLargeInput(char *buffer, int size)
+{
+    if (size > BUFWATERMARK && size > LargeInputSize) {
+        free(LargeInput);
+        LargeInput = buffer;
+        LargeInputSize = size;
+    }
+    else
+        free(buffer);
+}
+
+static ConnectionInputPtr
+GetInputBuffer(void)
+{
+    ConnectionInputPtr oci;
+
+    if ((oci = FreeInputs))
+        FreeInputs = oci->next;
+    else
+        oci = AllocateInputBuffer();
+    return oci;
+}
+
+static void
+ReleaseInputBuffer(ConnectionInputPtr oci)
+{
+    if (oci->size > BUFWATERMARK) {
+        StashLargeInput(oci->buffer, oci->size);
+        free(oci);
+    }
+    else {
+        oci->next = FreeInputs;
+        oci->more = NULL;
+        oci->bufptr = oci->buffer;
+        oci->bufcnt = 0;
+        oci->lenLastReq = 0;
+        oci->ignoreBytes = 0;
+        FreeInputs = oci;
+    }
+}
+
 /* If an input buffer was empty, either free it if it is too big or link it
  * into our list of free input buffers.  This means that different clients can
  * share the same input buffer (at different times).  This was done to save
@@ -207,22 +268,120 @@ NextAvailableInput(OsCommPtr oc)
 {
     if (AvailableInput) {
         if (AvailableInput != oc) {
-            ConnectionInputPtr aci = AvailableInput->input;
-
-            if (aci->size > BUFWATERMARK) {
-                free(aci->buffer);
-                free(aci);
-            }
-            else {
-                aci->next = FreeInputs;
-                FreeInputs = aci;
-            }
+            ReleaseInputBuffer(AvailableInput->input);
             AvailableInput->input = NULL;
         }
         AvailableInput = NULL;
     }
 }
 
+/* Swap in the buffer of the next chunk once the current one is used up */
+static void
+NextInputChunk(ConnectionInputPtr oci)
+{
+    ConnectionInputPtr chunk = oci->more;
+    char *buffer = oci->buffer;
+    int size = oci->size;
+
+    oci->more = chunk->more;
+    oci->buffer = chunk->buffer;
+    oci->bufptr = chunk->bufptr;
+    oci->bufcnt = chunk->bufcnt;
+    oci->size = chunk->size;
+    chunk->buffer = buffer;
+    chunk->size = size;
+    ReleaseInputBuffer(chunk);
+}
+
+/* Append up to count bytes from the queued chunks to the end of buffer,
+ * which must have room for them.  Returns the number of bytes moved.
+ */
+static int
+GatherInput(OsCommPtr oc, ConnectionInputPtr oci, int count)
+{
+    ConnectionInputPtr chunk;
+    int avail, moved = 0;
+
+    while (count > 0 && (chunk = oci->more)) {
+        avail = chunk->bufcnt + chunk->buffer - chunk->bufptr;
+        if (avail > count)
+            avail = count;
+        memcpy(oci->buffer + oci->bufcnt, chunk->bufptr, avail);
+        oci->bufcnt += avail;
+        chunk->bufptr += avail;
+        count -= avail;
+        moved += avail;
+        if (chunk->bufptr == chunk->buffer + chunk->bufcnt) {
+            oci->more = chunk->more;
+            ReleaseInputBuffer(chunk);
+        }
+    }
+    oc->input_copied += moved;
+    return moved;
+}
+
+/* Move the gotnow bytes of a request that does not fit in buffer to the
+ * start of a new one, big enough for all needed bytes of it.
+ */
+static Bool
+GrowInputBuffer(OsCommPtr oc, ConnectionInputPtr oci, int needed, int gotnow)
+{
+    char *ibuf;
+    int size;
+
+    if (LargeInputSize >= needed) {
+        ibuf = LargeInput;
+        size = LargeInputSize;
+        LargeInput = NULL;
+        LargeInputSize = 0;
+    }
+    else {
+        ibuf = (char *) malloc(needed);
+        if (!ibuf)
+            return FALSE;
+        size = needed;
+        oc->input_reallocs++;
+    }
+    memcpy(ibuf, oci->bufptr, gotnow);
+    oc->input_copied += gotnow;
+    StashLargeInput(oci->buffer, oci->size);
+    oci->buffer = ibuf;
+    oci->size = size;
+    return TRUE;
+}
+
+/* Read as much as the transport has for us: into the rest of buffer and,
+ * past that, into a spare chunk that is queued on oci->more.  Returns the
+ * number of bytes that went into buffer.
+ */
+static int
+ReadInput(OsCommPtr oc, ConnectionInputPtr oci)
+{
+    struct iovec iov[2];
+    ConnectionInputPtr chunk;
+    int room = oci->size - oci->bufcnt;
+    int result;
+
+    iov[0].iov_base = oci->buffer + oci->bufcnt;
+    iov[0].iov_len = room;
+    chunk = GetInputBuffer();
+    if (chunk) {
+        iov[1].iov_base = chunk->buffer;
+        iov[1].iov_len = chunk->size;
+    }
+    result = _XSERVTransReadv(oc->trans_conn, iov, chunk ? 2 : 1);
+    if (chunk) {
+        if (result > room) {
+            chunk->bufcnt = result - room;
+            oci->more = chunk;
+            result = room;
+        }
+        else
+            ReleaseInputBuffer(chunk);
+    }
+    return result;
+}
+
 int
 ReadRequestFromClient(ClientPtr client)
 {
@@ -239,10 +398,7 @@ ReadRequestFromClient(ClientPtr client)
     /* make sure we have an input buffer */
 
     if (!oci) {
-        if ((oci = FreeInputs)) {
-            FreeInputs = oci->next;
-        }
-        else if (!(oci = AllocateInputBuffer())) {
+        if (!(oci = GetInputBuffer())) {
             YieldControlDeath();
             return -1;
         }
@@ -260,9 +416,13 @@ ReadRequestFromClient(ClientPtr client)
     /* advance to start of next request */
 
     oci->bufptr += oci->lenLastReq;
+    oci->lenLastReq = 0;
 
+ again:
     need_header = FALSE;
     move_header = FALSE;
+    if (oci->more && oci->bufptr == oci->buffer + oci->bufcnt)
+        NextInputChunk(oci);
     gotnow = oci->bufcnt + oci->buffer - oci->bufptr;
 
     if (oci->ignoreBytes > 0) {
@@ -305,7 +465,6 @@ ReadRequestFromClient(ClientPtr client)
          * request (if need_header and move_header are both FALSE).
          */
 
-        oci->lenLastReq = 0;
         if (needed > maxBigRequestSize << 2) {
             /* request is too big for us to handle */
             /*
@@ -319,24 +478,26 @@ ReadRequestFromClient(ClientPtr client)
         if ((gotnow == 0) || ((oci->bufptr - oci->buffer + needed) > oci->size)) {
             /* no data, or the request is too big to fit in the buffer */
 
-            if ((gotnow > 0) && (oci->bufptr != oci->buffer))
-                /* save the data we've already read */
-                memmove(oci->buffer, oci->bufptr, gotnow);
             if (needed > oci->size) {
                 /* make buffer bigger to accomodate request */
-                char *ibuf;
-
-                ibuf = (char *) realloc(oci->buffer, needed);
-                if (!ibuf) {
+                if (!GrowInputBuffer(oc, oci, needed, gotnow)) {
                     YieldControlDeath();
                     return -1;
                 }
-                oci->size = needed;
-                oci->buffer = ibuf;
+            }
+            else if ((gotnow > 0) && (oci->bufptr != oci->buffer)) {
+                /* save the data we've already read */
+                memmove(oci->buffer, oci->bufptr, gotnow);
+                oc->input_copied += gotnow;
             }
             oci->bufptr = oci->buffer;
             oci->bufcnt = gotnow;
         }
+        if (oci->more) {
+            /* the rest of the request has been read already */
+            GatherInput(oc, oci, needed - gotnow);
+            goto again;
+        }
         /*  XXX this is a workaround.  This function is sometimes called
          *  after the trans_conn has been freed.  In this case trans_conn
          *  will be null.  Really ought to restructure things so that we
@@ -349,8 +510,7 @@ ReadRequestFromClient(ClientPtr client)
             YieldControlDeath();
             return -1;
         }
-        result = _XSERVTransRead(oc->trans_conn, oci->buffer + oci->bufcnt,
-                                 oci->size - oci->bufcnt);
+        result = ReadInput(oc, oci);
         if (result <= 0) {
             if ((result < 0) && ETEST(errno)) {
                 mark_client_not_ready(client);
@@ -370,13 +530,20 @@ ReadRequestFromClient(ClientPtr client)
         /* free up some space after huge requests */
         if ((oci->size > BUFWATERMARK) &&
             (oci->bufcnt < BUFSIZE) && (needed < BUFSIZE)) {
-            char *ibuf;
-
-            ibuf = (char *) realloc(oci->buffer, BUFSIZE);
-            if (ibuf) {
-                oci->size = BUFSIZE;
-                oci->buffer = ibuf;
-                oci->bufptr = ibuf + oci->bufcnt - gotnow;
+            ConnectionInputPtr chunk = GetInputBuffer();
+
+            if (chunk) {
+                char *ibuf = chunk->buffer;
+                int size = chunk->size;
+
+                memcpy(ibuf, oci->bufptr, gotnow);
+                oc->input_copied += gotnow;
+                chunk->buffer = oci->buffer;
+                chunk->size = oci->size;
+                ReleaseInputBuffer(chunk);
+                oci->buffer = oci->bufptr = ibuf;
+                oci->size = size;
+                oci->bufcnt = gotnow;
             }
         }
         if (need_header && gotnow >= needed) {
@@ -394,6 +561,9 @@ ReadRequestFromClient(ClientPtr client)
             needed <<= 2;
         }
         if (gotnow < needed) {
+            /* The rest may have been read into the next chunk */
+            if (oci->more)
+                goto again;
             /* Still don't have enough; punt. */
             YieldControlNoInput(client);
             return 0;
@@ -438,7 +608,7 @@ ReadRequestFromClient(ClientPtr client)
      */
 
     gotnow -= needed;
-    if (!gotnow)
+    if (!gotnow && !oci->more)
         AvailableInput = oc;
     if (move_header) {
         if (client->req_len < bytes_to_int32(sizeof(xBigReq) - sizeof(xReq))) {
@@ -464,6 +634,23 @@ ReadRequestFromClient(ClientPtr client)
     return needed;
 }
 
+/*****************************************************************
+ * ClientInputStats
+ *    Report how many request bytes had to be moved around or gathered
+ *    from several chunks, and how often the input buffer was resized,
+ *    since the client connected.
+ *****************************************************************/
+
+void
+ClientInputStats(ClientPtr client, unsigned long *copied,
+                 unsigned long *reallocs)
+{
+    OsCommPtr oc = (OsCommPtr) client->osPrivate;
+
+    *copied = oc->input_copied;
+    *reallocs = oc->input_reallocs;
+}
+
 int
 ReadFdFromClient(ClientPtr client)
 {
@@ -510,9 +697,7 @@ InsertFakeRequest(ClientPtr client, char *data, int count)
     NextAvailableInput(oc);
 
     if (!oci) {
-        if ((oci = FreeInputs))
-            FreeInputs = oci->next;
-        else if (!(oci = AllocateInputBuffer()))
+        if (!(oci = GetInputBuffer()))
             return FALSE;
         oc->input = oci;
     }
@@ -525,22 +710,25 @@ InsertFakeRequest(ClientPtr client, char *data, int count)
         ibuf = (char *) realloc(oci->buffer, gotnow + count);
         if (!ibuf)
             return FALSE;
+        oc->input_reallocs++;
         oci->size = gotnow + count;
         oci->buffer = ibuf;
         oci->bufptr = ibuf + oci->bufcnt - gotnow;
     }
     moveup = count - (oci->bufptr - oci->buffer);
     if (moveup > 0) {
-        if (gotnow > 0)
+        if (gotnow > 0) {
             memmove(oci->bufptr + moveup, oci->bufptr, gotnow);
+            oc->input_copied += gotnow;
+        }
         oci->bufptr += moveup;
         oci->bufcnt += moveup;
     }
     memmove(oci->bufptr - count, data, count);
     oci->bufptr -= count;
     gotnow += count;
-    if ((gotnow >= sizeof(xReq)) &&
-        (gotnow >= (int) (get_req_len((xReq *) oci->bufptr, client) << 2)))
+    if (oci->more || ((gotnow >= sizeof(xReq)) &&
+        (gotnow >= (int) (get_req_len((xReq *) oci->bufptr, client) << 2))))
         mark_client_ready(client);
     else
         YieldControlNoInput(client);
@@ -732,15 +920,12 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
 #endif
 
     if (!oco) {
-        if ((oco = FreeOutputs)) {
-            FreeOutputs = oco->next;
-        }
-        else if (!(oco = AllocateOutputBuffer())) {
+        if (!(oco = GetOutputBuffer())) {
             AbortClient(who);
             MarkClientException(who);
             return -1;
         }
-        oc->output = oco;
+        oc->output = oc->output_last = oco;
     }
 
     padBytes = padding_for_int32(count);
@@ -785,7 +970,8 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
         }
     }
 #endif
-    if (oco->count == 0 || oco->count + count + padBytes > oco->size) {
+    oco = oc->output_last;
+    if (oc->output_queued == 0 || oco->count + count + padBytes > oco->size) {
         output_pending_clear(who);
         if (!any_output_pending()) {
             CriticalOutputPending = FALSE;
@@ -803,16 +989,94 @@ WriteToClient(ClientPtr who, int count, const void *__buf)
         memset(oco->buf + oco->count, '\0', padBytes);
         oco->count += padBytes;
     }
+    oc->output_queued += count + padBytes;
     return count;
 }
 
+/* Output waiting for a client is kept in a list of BUFSIZE segments from
+ * FreeOutputs, from oc->output to oc->output_last.  Queueing more only fills
+ * the last segment or adds new ones, and a partial write only moves the
+ * start of the first, so data for a slow client is copied just once.
+ */
+
+static ConnectionOutputPtr
+GetOutputBuffer(void)
+{
+    ConnectionOutputPtr oco;
+
+    if ((oco = FreeOutputs)) {
+        FreeOutputs = oco->next;
+        NumFreeOutputs--;
+    }
+    else if (!(oco = AllocateOutputBuffer()))
+        return NULL;
+    oco->next = (ConnectionOutputPtr) NULL;
+    oco->count = 0;
+    oco->start = 0;
+    return oco;
+}
+
+static void
+ReleaseOutputBuffer(ConnectionOutputPtr oco)
+{
+    if (NumFreeOutputs >= OUTPUTPOOLSIZE) {
+        free(oco->buf);
+        free(oco);
+    }
+    else {
+        oco->next = FreeOutputs;
+        FreeOutputs = oco;
+        NumFreeOutputs++;
+    }
+}
+
+/* Let go of all output segments, written or not */
+static void
+ReleaseOutput(OsCommPtr oc)
+{
+    ConnectionOutputPtr oco;
+
+    while ((oco = oc->output)) {
+        oc->output = oco->next;
+        ReleaseOutputBuffer(oco);
+    }
+    oc->output_last = (ConnectionOutputPtr) NULL;
+    oc->output_queued = 0;
+}
+
+/* Append data to the output segments, adding segments as they fill up */
+static Bool
+QueueOutput(OsCommPtr oc, const char *data, long count)
+{
+    ConnectionOutputPtr oco = oc->output_last;
+    long len;
+
+    while (count > 0) {
+        if (oco->count == oco->size) {
+            if (!(oco->next = GetOutputBuffer()))
+                return FALSE;
+            oco = oc->output_last = oco->next;
+        }
+        len = oco->size - oco->count;
+        if (len > count)
+            len = count;
+        memcpy(oco->buf + oco->count, data, len);
+        oco->count += len;
+        oc->output_queued += len;
+        data += len;
+        count -= len;
+    }
+    return TRUE;
+}
+
  /********************
  * FlushClient()
  *    If the client isn't keeping up with us, then we try to continue
  *    buffering the data and set the apropriate bit in ClientsWritable
  *    (which is used by WaitFor in the select).  If the connection yields
- *    a permanent error, or we can't allocate any more space, we then
- *    close the connection.
+ *    a permanent error, we can't allocate any more space, or more than
+ *    maxClientOutput bytes are waiting for the client, we then close the
+ *    connection.
  *
  **********************/
 
@@ -821,7 +1085,7 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
 {
     ConnectionOutputPtr oco = oc->output;
     XtransConnInfo trans_conn = oc->trans_conn;
-    struct iovec iov[3];
+    struct iovec iov[OUTPUTIOVECS + 2];
     static char padBuffer[3];
     const char *extraBuf = __extraBuf;
     long written;
@@ -831,9 +1095,9 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
 
     if (!oco)
 	return 0;
-    written = 0;
+    written = 0;                /* of extraBuf and padBuffer */
     padsize = padding_for_int32(extraCount);
-    notWritten = oco->count + extraCount + padsize;
+    notWritten = oc->output_queued + extraCount + padsize;
     if (!notWritten)
         return 0;
 
@@ -842,47 +1106,65 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
 
     todo = notWritten;
     while (notWritten) {
-        long before = written;  /* amount of whole thing written */
         long remain = todo;     /* amount to try this time, <= notWritten */
         int i = 0;
         long len;
 
-        /* You could be very general here and have "in" and "out" iovecs
-         * and write a loop without using a macro, but what the heck.  This
-         * translates to:
-         *
-         *     how much of this piece is new?
-         *     if more new then we are trying this time, clamp
-         *     if nothing new
-         *         then bump down amount already written, for next piece
-         *         else put new stuff in iovec, will need all of next piece
-         *
-         * Note that todo had better be at least 1 or else we'll end up
-         * writing 0 iovecs.
+        /* Queued segments go first; extraBuf and its padding only follow
+         * once all of them made it into the iovec.  todo had better be
+         * at least 1 or else we'll end up writing 0 iovecs.
          */
-#define InsertIOV(pointer, length) \
-	len = (length) - before; \
-	if (len > remain) \
-	    len = remain; \
-	if (len <= 0) { \
-	    before = (-len); \
-	} else { \
-	    iov[i].iov_len = len; \
-	    iov[i].iov_base = (pointer) + before;	\
-	    i++; \
-	    remain -= len; \
-	    before = 0; \
-	}
-
-        InsertIOV((char *) oco->buf, oco->count)
-            InsertIOV((char *) extraBuf, extraCount)
-            InsertIOV(padBuffer, padsize)
-
-            errno = 0;
+        for (oco = oc->output; oco && remain > 0; oco = oco->next) {
+            if (i == OUTPUTIOVECS)
+                break;
+            len = oco->count - oco->start;
+            if (len > remain)
+                len = remain;
+            if (len > 0) {
+                iov[i].iov_base = (char *) oco->buf + oco->start;
+                iov[i].iov_len = len;
+                i++;
+                remain -= len;
+            }
+        }
+        if (!oco && remain > 0 && written < extraCount) {
+            len = extraCount - written;
+            if (len > remain)
+                len = remain;
+            iov[i].iov_base = (char *) extraBuf + written;
+            iov[i].iov_len = len;
+            i++;
+            remain -= len;
+        }
+        if (!oco && remain > 0 && written < extraCount + padsize) {
+            long padWritten = max(written - extraCount, 0);
+
+            len = padsize - padWritten;
+            if (len > remain)
+                len = remain;
+            iov[i].iov_base = padBuffer + padWritten;
+            iov[i].iov_len = len;
+            i++;
+        }
+
+        errno = 0;
         if (trans_conn && (len = _XSERVTransWritev(trans_conn, iov, i)) >= 0) {
-            written += len;
             notWritten -= len;
             todo = notWritten;
+            while (len > 0 && oc->output_queued > 0) {
+                long done;
+
+                oco = oc->output;
+                done = min(oco->count - oco->start, len);
+                oco->start += done;
+                oc->output_queued -= done;
+                len -= done;
+                if (oco->start == oco->count && oco->next) {
+                    oc->output = oco->next;
+                    ReleaseOutputBuffer(oco);
+                }
+            }
+            written += len;
         }
         else if (ETEST(errno)
 #ifdef SUNSYSV                  /* check for another brain-damaged OS bug */
@@ -897,42 +1179,26 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
                the rest. */
             output_pending_mark(who);
 
-            if (written < oco->count) {
-                if (written > 0) {
-                    oco->count -= written;
-                    memmove((char *) oco->buf,
-                            (char *) oco->buf + written, oco->count);
-                    written = 0;
-                }
-            }
-            else {
-                written -= oco->count;
-                oco->count = 0;
-            }
-
-            if (notWritten > oco->size) {
-                unsigned char *obuf = NULL;
-
-                if (notWritten + BUFSIZE <= INT_MAX) {
-                    obuf = realloc(oco->buf, notWritten + BUFSIZE);
-                }
-                if (!obuf) {
-                    AbortClient(who);
-                    MarkClientException(who);
-                    oco->count = 0;
-                    return -1;
-                }
-                oco->size = notWritten + BUFSIZE;
-                oco->buf = obuf;
-            }
-
             /* If the amount written extended into the padBuffer, then the
                difference "extraCount - written" may be less than 0 */
-            if ((len = extraCount - written) > 0)
-                memmove((char *) oco->buf + oco->count,
-                        extraBuf + written, len);
-
-            oco->count = notWritten;    /* this will include the pad */
+            if (((len = extraCount - written) > 0 &&
+                 !QueueOutput(oc, extraBuf + written, len)) ||
+                !QueueOutput(oc, padBuffer + max(written - extraCount, 0),
+                             padsize - max(written - extraCount, 0))) {
+                AbortClient(who);
+                MarkClientException(who);
+                ReleaseOutput(oc);
+                return -1;
+            }
+            if (maxClientOutput && oc->output_queued > maxClientOutput) {
+                LogMessage(X_WARNING, "Client %d has %ld bytes of output "
+                           "queued, disconnecting\n", who->index,
+                           oc->output_queued);
+                AbortClient(who);
+                MarkClientException(who);
+                ReleaseOutput(oc);
+                return -1;
+            }
             ospoll_listen(server_poll, oc->fd, X_NOTIFY_WRITE);
 
             /* return only the amount explicitly requested */
@@ -946,24 +1212,14 @@ FlushClient(ClientPtr who, OsCommPtr oc, const void *__extraBuf, int extraCount)
         else {
             AbortClient(who);
             MarkClientException(who);
-            oco->count = 0;
+            ReleaseOutput(oc);
             return -1;
         }
     }
 
     /* everything was flushed out */
-    oco->count = 0;
     output_pending_clear(who);
-
-    if (oco->size > BUFWATERMARK) {
-        free(oco->buf);
-        free(oco);
-    }
-    else {
-        oco->next = FreeOutputs;
-        FreeOutputs = oco;
-    }
-    oc->output = (ConnectionOutputPtr) NULL;
+    ReleaseOutput(oc);
     return extraCount;          /* return only the amount explicitly requested */
 }
 
@@ -981,6 +1237,7 @@ AllocateInputBuffer(void)
         return NULL;
     }
     oci->size = BUFSIZE;
+    oci->more = NULL;
     oci->bufptr = oci->buffer;
     oci->bufcnt = 0;
     oci->lenLastReq = 0;
@@ -1010,11 +1267,17 @@ void
 FreeOsBuffers(OsCommPtr oc)
 {
     ConnectionInputPtr oci;
-    ConnectionOutputPtr oco;
 
     if (AvailableInput == oc)
         AvailableInput = (OsCommPtr) NULL;
     if ((oci = oc->input)) {
+        ConnectionInputPtr chunk;
+
+        while ((chunk = oci->more)) {
+            oci->more = chunk->more;
+            free(chunk->buffer);
+            free(chunk);
+        }
         if (FreeInputs) {
             free(oci->buffer);
             free(oci);
@@ -1028,17 +1291,7 @@ FreeOsBuffers(OsCommPtr oc)
             oci->ignoreBytes = 0;
         }
     }
-    if ((oco = oc->output)) {
-        if (FreeOutputs) {
-            free(oco->buf);
-            free(oco);
-        }
-        else {
-            FreeOutputs = oco;
-            oco->next = (ConnectionOutputPtr) NULL;
-            oco->count = 0;
-        }
-    }
+    ReleaseOutput(oc);
 }
 
 void
@@ -1052,9 +1305,13 @@ ResetOsBuffers(void)
         free(oci->buffer);
         free(oci);
     }
+    free(LargeInput);
+    LargeInput = NULL;
+    LargeInputSize = 0;
     while ((oco = FreeOutputs)) {
         FreeOutputs = oco->next;
         free(oco->buf);
         free(oco);
     }
+    NumFreeOutputs = 0;
 }
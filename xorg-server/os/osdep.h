@@ -119,6 +119,10 @@ typedef struct _osComm {
     CARD32 conn_time;           /* timestamp if not established, else 0  */
     struct _XtransConnInfo *trans_conn; /* transport connection object */
     int flags;
+    unsigned long input_copied;   /* request bytes moved or gathered */
+    unsigned long input_reallocs; /* input buffer resizes */
+    ConnectionOutputPtr output_last;    /* last segment queued on output */
+    long output_queued;                 /* bytes queued but not written */
 } OsCommRec, *OsCommPtr;
 
 #define OS_COMM_GRAB_IMPERVIOUS 1
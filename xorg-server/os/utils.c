@@ -571,6 +571,7 @@ UseMsg(void)
     ErrorF("-nolock                disable the locking mechanism\n");
 #endif
     ErrorF("-maxclients n          set maximum number of clients (power of two)\n");
+    ErrorF("-maxclientoutput n     disconnect clients with n MB of output queued\n");
     ErrorF("-nolisten string       don't listen on protocol\n");
     ErrorF("-listen string         listen on protocol\n");
     ErrorF("-noreset               don't reset after last client exists\n");
@@ -975,6 +976,18 @@ ProcessCommandLine(int argc, char *argv[])
                     UseMsg();
             }
         }
+        else if (strcmp(argv[i], "-maxclientoutput") == 0) {
+            if (++i < argc) {
+                long outputSizeArg = atol(argv[i]);
+
+                if (outputSizeArg > 0L && outputSizeArg < 2048L)
+                    maxClientOutput = outputSizeArg * 1048576L;
+                else
+                    UseMsg();
+            }
+            else
+                UseMsg();
+        }
         else if (strcmp(argv[i], "-maxbigreqsize") == 0) {
             if (++i < argc) {
                 long reqSizeArg = atol(argv[i]);
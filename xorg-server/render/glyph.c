@@ -96,8 +96,8 @@ GlyphUninit(ScreenPtr pScreen)
         for (i = 0; i < globalGlyphs[fdepth].hashSet->size; i++) {
             glyph = globalGlyphs[fdepth].table[i].glyph;
             if (glyph && glyph != DeletedGlyph) {
-                if (GetGlyphPicture(glyph, pScreen)) {
-                    FreePicture((void *) GetGlyphPicture(glyph, pScreen), 0);
+                if (GlyphPicture(glyph)[pScreen->myNum]) {
+                    FreePicture((void *) GlyphPicture(glyph)[pScreen->myNum], 0);
                     SetGlyphPicture(glyph, pScreen, NULL);
                 }
                 (*ps->UnrealizeGlyph) (pScreen, glyph);
@@ -236,8 +236,9 @@ FreeGlyphPicture(GlyphPtr glyph)
     for (i = 0; i < screenInfo.numScreens; i++) {
         ScreenPtr pScreen = screenInfo.screens[i];
 
-        if (GetGlyphPicture(glyph, pScreen))
-            FreePicture((void *) GetGlyphPicture(glyph, pScreen), 0);
+        if (GlyphPicture(glyph)[i])
+            FreePicture((void *) GlyphPicture(glyph)[i], 0);
+        GlyphAtlasRemove(glyph, pScreen);
 
         ps = GetPictureScreenIfSet(pScreen);
         if (ps)
@@ -341,22 +342,27 @@ FindGlyph(GlyphSetPtr glyphSet, Glyph id)
 }
 
 GlyphPtr
-AllocateGlyph(xGlyphInfo * gi, int fdepth)
+AllocateGlyph(xGlyphInfo * gi, int fdepth, PictFormatPtr format, CARD8 *bits)
 {
     PictureScreenPtr ps;
     int size;
     GlyphPtr glyph;
     int i;
     int head_size;
+    int bits_size;
 
     head_size = sizeof(GlyphRec) + screenInfo.numScreens * sizeof(PicturePtr);
+    bits_size = gi->height * PixmapBytePad(gi->width, format->depth);
     size = (head_size + dixPrivatesSize(PRIVATE_GLYPH));
-    glyph = (GlyphPtr) malloc(size);
+    glyph = (GlyphPtr) malloc(size + bits_size);
     if (!glyph)
         return 0;
     glyph->refcnt = 0;
-    glyph->size = size + sizeof(xGlyphInfo);
+    glyph->size = size + bits_size + sizeof(xGlyphInfo);
     glyph->info = *gi;
+    glyph->format = format;
+    glyph->bits = (CARD8 *) glyph + size;
+    memcpy(glyph->bits, bits, bits_size);
     dixInitPrivates(glyph, (char *) glyph + head_size, PRIVATE_GLYPH);
 
     for (i = 0; i < screenInfo.numScreens; i++) {
@@ -494,8 +500,8 @@ FreeGlyphSet(void *value, XID gid)
     return Success;
 }
 
-static void
-GlyphExtents(int nlist, GlyphListPtr list, GlyphPtr * glyphs, BoxPtr extents)
+void
+miGlyphExtents(int nlist, GlyphListPtr list, GlyphPtr * glyphs, BoxPtr extents)
 {
     int x1, x2, y1, y2;
     int n;
@@ -590,12 +596,13 @@ miGlyphs(CARD8 op,
     int error;
     BoxRec extents = { 0, 0, 0, 0 };
     CARD32 component_alpha;
+    INT16 xGlyph, yGlyph;
 
     if (maskFormat) {
         GCPtr pGC;
         xRectangle rect;
 
-        GlyphExtents(nlist, list, glyphs, &extents);
+        miGlyphExtents(nlist, list, glyphs, &extents);
 
         if (extents.x2 <= extents.x1 || extents.y2 <= extents.y1)
             return;
@@ -636,7 +643,7 @@ miGlyphs(CARD8 op,
         n = list->len;
         while (n--) {
             glyph = *glyphs++;
-            pPicture = GetGlyphPicture(glyph, pScreen);
+            pPicture = GlyphAtlasPicture(glyph, pScreen, &xGlyph, &yGlyph);
 
             if (pPicture) {
                 if (maskFormat) {
@@ -644,7 +651,7 @@ miGlyphs(CARD8 op,
                                      pPicture,
                                      None,
                                      pMask,
-                                     0, 0,
+                                     xGlyph, yGlyph,
                                      0, 0,
                                      x - glyph->info.x,
                                      y - glyph->info.y,
@@ -657,7 +664,7 @@ miGlyphs(CARD8 op,
                                      pDst,
                                      xSrc + (x - glyph->info.x) - xDst,
                                      ySrc + (y - glyph->info.y) - yDst,
-                                     0, 0,
+                                     xGlyph, yGlyph,
                                      x - glyph->info.x,
                                      y - glyph->info.y,
                                      glyph->info.width, glyph->info.height);
@@ -683,6 +690,408 @@ miGlyphs(CARD8 op,
     }
 }
 
+/*
+ * Glyphs keep their own copy of their bits; what the screens draw from is
+ * made from those.  Normally that is an atlas: one per screen and glyph
+ * format, made of pages GLYPH_ATLAS_PAGE pixels square.  Pages are cut
+ * into slabs GLYPH_ATLAS_SLAB pixels square, and each slab into square
+ * cells of one power of two size; a glyph goes in the smallest cell it
+ * fits.  Once every page is in use, the least recently drawn glyph makes
+ * room: its cell if it is the size wanted, otherwise its whole slab.
+ *
+ * Glyphs too big for a cell, and screens whose driver draws each glyph
+ * from a picture of its own (see GlyphAtlasDisable), get that picture
+ * made when the glyph is added, by GlyphCreatePictures.
+ */
+
+#define GLYPH_ATLAS_PAGE        512
+#define GLYPH_ATLAS_SLAB        64
+#define GLYPH_ATLAS_MAX_PAGES   8
+#define GLYPH_ATLAS_CLASSES     4       /* cells of 8, 16, 32 and 64 */
+#define GLYPH_ATLAS_FREE        GLYPH_ATLAS_CLASSES
+
+#define GLYPH_ATLAS_ROW         (GLYPH_ATLAS_PAGE / GLYPH_ATLAS_SLAB)
+#define GLYPH_ATLAS_PAGE_SLABS  (GLYPH_ATLAS_ROW * GLYPH_ATLAS_ROW)
+
+#define GlyphAtlasCellSize(c)   (8 << (c))
+#define GlyphAtlasCellsPerRow(c) (GLYPH_ATLAS_SLAB / GlyphAtlasCellSize(c))
+
+typedef struct _GlyphAtlasSlab {
+    CARD8 sizeClass;            /* of its cells, GLYPH_ATLAS_FREE if none */
+    CARD64 free;                /* one bit per free cell */
+} GlyphAtlasSlabRec, *GlyphAtlasSlabPtr;
+
+typedef struct _GlyphAtlas {
+    struct xorg_list link;
+    PictFormatPtr format;
+    int npages;
+    CARD32 serial;              /* counts glyphs drawn */
+    PicturePtr pages[GLYPH_ATLAS_MAX_PAGES];
+    GlyphAtlasSlabRec slabs[GLYPH_ATLAS_MAX_PAGES * GLYPH_ATLAS_PAGE_SLABS];
+    struct xorg_list lru[GLYPH_ATLAS_CLASSES];  /* most recent first */
+} GlyphAtlasRec, *GlyphAtlasPtr;
+
+/* Kept in each glyph, one for each screen */
+typedef struct _GlyphAtlasEntry {
+    struct xorg_list lru;
+    GlyphAtlasPtr atlas;        /* NULL when not in the atlas */
+    CARD32 used;                /* atlas serial when last drawn */
+    CARD16 slab;
+    CARD8 cell;
+} GlyphAtlasEntryRec, *GlyphAtlasEntryPtr;
+
+typedef struct _GlyphAtlasScreen {
+    DevPrivateKeyRec entryKey;
+    struct xorg_list atlases;
+    Bool disabled;
+} GlyphAtlasScreenRec, *GlyphAtlasScreenPtr;
+
+static GlyphAtlasScreenRec glyphAtlasScreens[MAXSCREENS];
+
+static GlyphAtlasScreenPtr
+GlyphAtlasGetScreen(ScreenPtr pScreen)
+{
+    GlyphAtlasScreenPtr as;
+
+    if (pScreen->isGPU)
+        return NULL;
+    as = &glyphAtlasScreens[pScreen->myNum];
+    if (!dixPrivateKeyRegistered(&as->entryKey) || as->disabled)
+        return NULL;
+    return as;
+}
+
+static void
+GlyphPutBits(GlyphPtr glyph, DrawablePtr pDrawable, int x, int y)
+{
+    GCPtr pGC = GetScratchGC(pDrawable->depth, pDrawable->pScreen);
+
+    if (!pGC)
+        return;
+    ValidateGC(pDrawable, pGC);
+    (*pGC->ops->PutImage) (pDrawable, pGC, pDrawable->depth, x, y,
+                           glyph->info.width, glyph->info.height, 0,
+                           ZPixmap, (char *) glyph->bits);
+    FreeScratchGC(pGC);
+}
+
+static PicturePtr
+GlyphCreatePicture(ScreenPtr pScreen, PictFormatPtr format,
+                   int width, int height)
+{
+    CARD32 component_alpha = NeedsComponent(format->format);
+    PixmapPtr pPixmap;
+    PicturePtr pPicture;
+    int error;
+
+    pPixmap = (*pScreen->CreatePixmap) (pScreen, width, height, format->depth,
+                                        CREATE_PIXMAP_USAGE_GLYPH_PICTURE);
+    if (!pPixmap)
+        return NULL;
+    pPicture = CreatePicture(0, &pPixmap->drawable, format,
+                             CPComponentAlpha, &component_alpha,
+                             serverClient, &error);
+
+    /* The picture takes a reference to the pixmap, so we drop ours. */
+    (*pScreen->DestroyPixmap) (pPixmap);
+    return pPicture;
+}
+
+static int
+GlyphAtlasClass(GlyphPtr glyph)
+{
+    int size = max(glyph->info.width, glyph->info.height);
+    int c;
+
+    for (c = 0; c < GLYPH_ATLAS_CLASSES; c++)
+        if (size <= GlyphAtlasCellSize(c))
+            return c;
+    return -1;
+}
+
+static CARD64
+GlyphAtlasAllCells(int c)
+{
+    int cells = GlyphAtlasCellsPerRow(c) * GlyphAtlasCellsPerRow(c);
+
+    if (cells == 64)
+        return ~(CARD64) 0;
+    return ((CARD64) 1 << cells) - 1;
+}
+
+static PicturePtr
+GlyphAtlasOrigin(GlyphAtlasEntryPtr entry, INT16 *x, INT16 *y)
+{
+    int c = entry->atlas->slabs[entry->slab].sizeClass;
+    int slab = entry->slab % GLYPH_ATLAS_PAGE_SLABS;
+    int row = GlyphAtlasCellsPerRow(c);
+
+    *x = (slab % GLYPH_ATLAS_ROW) * GLYPH_ATLAS_SLAB +
+        (entry->cell % row) * GlyphAtlasCellSize(c);
+    *y = (slab / GLYPH_ATLAS_ROW) * GLYPH_ATLAS_SLAB +
+        (entry->cell / row) * GlyphAtlasCellSize(c);
+    return entry->atlas->pages[entry->slab / GLYPH_ATLAS_PAGE_SLABS];
+}
+
+static void
+GlyphAtlasFreeCell(GlyphAtlasEntryPtr entry)
+{
+    GlyphAtlasSlabPtr slab = &entry->atlas->slabs[entry->slab];
+
+    slab->free |= (CARD64) 1 << entry->cell;
+    if (slab->free == GlyphAtlasAllCells(slab->sizeClass))
+        slab->sizeClass = GLYPH_ATLAS_FREE;
+    xorg_list_del(&entry->lru);
+    entry->atlas = NULL;
+}
+
+static GlyphAtlasEntryPtr
+GlyphAtlasOldest(GlyphAtlasPtr atlas)
+{
+    GlyphAtlasEntryPtr entry, oldest = NULL;
+    int c;
+
+    for (c = 0; c < GLYPH_ATLAS_CLASSES; c++) {
+        if (xorg_list_is_empty(&atlas->lru[c]))
+            continue;
+        entry = xorg_list_last_entry(&atlas->lru[c], GlyphAtlasEntryRec, lru);
+        if (!oldest || (INT32) (entry->used - oldest->used) < 0)
+            oldest = entry;
+    }
+    return oldest;
+}
+
+static void
+GlyphAtlasReclaimSlab(GlyphAtlasPtr atlas, int slab)
+{
+    int c = atlas->slabs[slab].sizeClass;
+    GlyphAtlasEntryPtr entry, tmp;
+
+    xorg_list_for_each_entry_safe(entry, tmp, &atlas->lru[c], lru)
+        if (entry->slab == slab)
+            GlyphAtlasFreeCell(entry);
+}
+
+static Bool
+GlyphAtlasAlloc(GlyphAtlasPtr atlas, ScreenPtr pScreen, int c,
+                GlyphAtlasEntryPtr entry)
+{
+    int nslabs = atlas->npages * GLYPH_ATLAS_PAGE_SLABS;
+    int s, cell, free_slab = -1;
+    GlyphAtlasSlabPtr slab;
+
+    for (s = 0; s < nslabs; s++) {
+        if (atlas->slabs[s].sizeClass == c && atlas->slabs[s].free)
+            break;
+        if (free_slab < 0 && atlas->slabs[s].sizeClass == GLYPH_ATLAS_FREE)
+            free_slab = s;
+    }
+
+    if (s == nslabs) {
+        if (free_slab < 0 && atlas->npages < GLYPH_ATLAS_MAX_PAGES) {
+            PicturePtr pPicture = GlyphCreatePicture(pScreen, atlas->format,
+                                                     GLYPH_ATLAS_PAGE,
+                                                     GLYPH_ATLAS_PAGE);
+
+            if (pPicture) {
+                free_slab = nslabs;
+                atlas->pages[atlas->npages++] = pPicture;
+            }
+        }
+        if (free_slab >= 0)
+            s = free_slab;
+        else {
+            GlyphAtlasEntryPtr oldest = GlyphAtlasOldest(atlas);
+
+            if (!oldest)
+                return FALSE;
+            s = oldest->slab;
+            if (atlas->slabs[s].sizeClass == c)
+                GlyphAtlasFreeCell(oldest);
+            else
+                GlyphAtlasReclaimSlab(atlas, s);
+        }
+    }
+
+    slab = &atlas->slabs[s];
+    if (slab->sizeClass == GLYPH_ATLAS_FREE) {
+        slab->sizeClass = c;
+        slab->free = GlyphAtlasAllCells(c);
+    }
+    for (cell = 0; !(slab->free & ((CARD64) 1 << cell)); cell++)
+        ;
+    slab->free &= ~((CARD64) 1 << cell);
+
+    entry->atlas = atlas;
+    entry->used = ++atlas->serial;
+    entry->slab = s;
+    entry->cell = cell;
+    xorg_list_add(&entry->lru, &atlas->lru[c]);
+    return TRUE;
+}
+
+static GlyphAtlasPtr
+GlyphAtlasFind(GlyphAtlasScreenPtr as, PictFormatPtr format)
+{
+    GlyphAtlasPtr atlas;
+    int i;
+
+    xorg_list_for_each_entry(atlas, &as->atlases, link)
+        if (atlas->format == format)
+            return atlas;
+
+    atlas = calloc(1, sizeof(GlyphAtlasRec));
+    if (!atlas)
+        return NULL;
+    atlas->format = format;
+    for (i = 0; i < ARRAY_SIZE(atlas->slabs); i++)
+        atlas->slabs[i].sizeClass = GLYPH_ATLAS_FREE;
+    for (i = 0; i < GLYPH_ATLAS_CLASSES; i++)
+        xorg_list_init(&atlas->lru[i]);
+    xorg_list_add(&atlas->link, &as->atlases);
+    return atlas;
+}
+
+Bool
+GlyphAtlasInit(ScreenPtr pScreen)
+{
+    GlyphAtlasScreenPtr as;
+
+    if (pScreen->isGPU)
+        return TRUE;
+    as = &glyphAtlasScreens[pScreen->myNum];
+    xorg_list_init(&as->atlases);
+    as->disabled = FALSE;
+    return dixRegisterPrivateKey(&as->entryKey, PRIVATE_GLYPH,
+                                 sizeof(GlyphAtlasEntryRec));
+}
+
+void
+GlyphAtlasUninit(ScreenPtr pScreen)
+{
+    GlyphAtlasScreenPtr as = GlyphAtlasGetScreen(pScreen);
+    GlyphAtlasPtr atlas, next;
+    GlyphAtlasEntryPtr entry, tmp;
+    int i;
+
+    if (!as)
+        return;
+    xorg_list_for_each_entry_safe(atlas, next, &as->atlases, link) {
+        for (i = 0; i < GLYPH_ATLAS_CLASSES; i++)
+            xorg_list_for_each_entry_safe(entry, tmp, &atlas->lru[i], lru) {
+                xorg_list_del(&entry->lru);
+                entry->atlas = NULL;
+            }
+        for (i = 0; i < atlas->npages; i++)
+            FreePicture((void *) atlas->pages[i], 0);
+        xorg_list_del(&atlas->link);
+        free(atlas);
+    }
+}
+
+void
+GlyphAtlasDisable(ScreenPtr pScreen)
+{
+    GlyphAtlasScreenPtr as = GlyphAtlasGetScreen(pScreen);
+
+    if (as)
+        as->disabled = TRUE;
+}
+
+/*
+ * Make the picture of a glyph for a screen, with the glyph's bits in it.
+ */
+static PicturePtr
+GlyphMakePicture(GlyphPtr glyph, ScreenPtr pScreen)
+{
+    PicturePtr pPicture;
+
+    pPicture = GlyphCreatePicture(pScreen, glyph->format,
+                                  glyph->info.width, glyph->info.height);
+    if (pPicture) {
+        GlyphPutBits(glyph, pPicture->pDrawable, 0, 0);
+        SetGlyphPicture(glyph, pScreen, pPicture);
+    }
+    return pPicture;
+}
+
+Bool
+GlyphCreatePictures(GlyphPtr glyph)
+{
+    int i;
+
+    /* Skip work if it's invisibly small anyway */
+    if (!glyph->info.width || !glyph->info.height)
+        return TRUE;
+
+    for (i = 0; i < screenInfo.numScreens; i++) {
+        ScreenPtr pScreen = screenInfo.screens[i];
+
+        if (GlyphAtlasGetScreen(pScreen) && GlyphAtlasClass(glyph) >= 0)
+            continue;
+        if (!GlyphMakePicture(glyph, pScreen)) {
+            while (i--) {
+                if (GlyphPicture(glyph)[i]) {
+                    FreePicture((void *) GlyphPicture(glyph)[i], 0);
+                    SetGlyphPicture(glyph, screenInfo.screens[i], NULL);
+                }
+            }
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+PicturePtr
+GlyphAtlasPicture(GlyphPtr glyph, ScreenPtr pScreen, INT16 *x, INT16 *y)
+{
+    GlyphAtlasScreenPtr as = GlyphAtlasGetScreen(pScreen);
+    GlyphAtlasEntryPtr entry;
+    GlyphAtlasPtr atlas;
+    PicturePtr pPicture;
+    int c = GlyphAtlasClass(glyph);
+
+    *x = 0;
+    *y = 0;
+    if (!glyph->info.width || !glyph->info.height)
+        return NULL;
+    if (!as || c < 0)
+        return GetGlyphPicture(glyph, pScreen);
+
+    entry = dixLookupPrivate(&glyph->devPrivates, &as->entryKey);
+    if (entry->atlas) {
+        entry->used = ++entry->atlas->serial;
+        xorg_list_del(&entry->lru);
+        xorg_list_add(&entry->lru, &entry->atlas->lru[c]);
+        return GlyphAtlasOrigin(entry, x, y);
+    }
+
+    /* with no room in the atlas at all, fall back to a picture of its own */
+    atlas = GlyphAtlasFind(as, glyph->format);
+    if (!atlas || !GlyphAtlasAlloc(atlas, pScreen, c, entry)) {
+        pPicture = GetGlyphPicture(glyph, pScreen);
+        if (!pPicture)
+            pPicture = GlyphMakePicture(glyph, pScreen);
+        return pPicture;
+    }
+    pPicture = GlyphAtlasOrigin(entry, x, y);
+    GlyphPutBits(glyph, pPicture->pDrawable, *x, *y);
+    return pPicture;
+}
+
+void
+GlyphAtlasRemove(GlyphPtr glyph, ScreenPtr pScreen)
+{
+    GlyphAtlasScreenPtr as = GlyphAtlasGetScreen(pScreen);
+    GlyphAtlasEntryPtr entry;
+
+    if (!as)
+        return;
+    entry = dixLookupPrivate(&glyph->devPrivates, &as->entryKey);
+    if (entry->atlas)
+        GlyphAtlasFreeCell(entry);
+}
+
 PicturePtr GetGlyphPicture(GlyphPtr glyph, ScreenPtr pScreen)
 {
     if (pScreen->isGPU)
@@ -45,6 +45,8 @@ typedef struct _Glyph {
     unsigned char sha1[20];
     CARD32 size;                /* info + bitmap */
     xGlyphInfo info;
+    PictFormatPtr format;       /* of the glyphset it was added to */
+    CARD8 *bits;                /* padded like a pixmap of that format */
     /* per-screen pixmaps follow */
 } GlyphRec, *GlyphPtr;
 
@@ -107,7 +109,8 @@ extern Bool
 
 extern GlyphPtr FindGlyph(GlyphSetPtr glyphSet, Glyph id);
 
-extern GlyphPtr AllocateGlyph(xGlyphInfo * gi, int format);
+extern GlyphPtr AllocateGlyph(xGlyphInfo * gi, int fdepth,
+                              PictFormatPtr format, CARD8 *bits);
 
 extern Bool
  ResizeGlyphSet(GlyphSetPtr glyphSet, CARD32 change);
@@ -117,6 +120,38 @@ extern GlyphSetPtr AllocateGlyphSet(int fdepth, PictFormatPtr format);
 extern int
  FreeGlyphSet(void *value, XID gid);
 
+extern Bool
+ GlyphAtlasInit(ScreenPtr pScreen);
+
+extern void
+ GlyphAtlasUninit(ScreenPtr pScreen);
+
+/*
+ * Returns the picture to draw a glyph from, with the glyph's top left
+ * corner at *x, *y in it; usually one of the screen's glyph atlases.  It
+ * is only good until the next glyph is looked up.
+ */
+extern _X_EXPORT PicturePtr
+ GlyphAtlasPicture(GlyphPtr glyph, ScreenPtr pScreen, INT16 *x, INT16 *y);
+
+extern void
+ GlyphAtlasRemove(GlyphPtr glyph, ScreenPtr pScreen);
+
+/*
+ * For drivers which draw every glyph from a picture of its own, got with
+ * GetGlyphPicture, rather than from the screen's glyph atlases.  Must be
+ * called before any glyph is added, usually right after wrapping Glyphs.
+ */
+extern _X_EXPORT void
+ GlyphAtlasDisable(ScreenPtr pScreen);
+
+/*
+ * Makes the pictures of a new glyph for the screens which don't draw it
+ * from an atlas, so GetGlyphPicture never has to.
+ */
+extern Bool
+ GlyphCreatePictures(GlyphPtr glyph);
+
 #define GLYPH_HAS_GLYPH_PICTURE_ACCESSOR 1 /* used for api compat */
 extern _X_EXPORT PicturePtr
  GetGlyphPicture(GlyphPtr glyph, ScreenPtr pScreen);
@@ -86,6 +86,10 @@ miGlyphs(CARD8 op,
          INT16 xSrc,
          INT16 ySrc, int nlist, GlyphListPtr list, GlyphPtr * glyphs);
 
+extern _X_EXPORT void
+ miGlyphExtents(int nlist, GlyphListPtr list, GlyphPtr * glyphs,
+                BoxPtr extents);
+
 extern _X_EXPORT void
  miRenderColorToPixel(PictFormatPtr pPict, xRenderColor * color, CARD32 *pixel);
 
@@ -89,6 +89,7 @@ PictureCloseScreen(ScreenPtr pScreen)
     Bool ret;
     int n;
 
+    GlyphAtlasUninit(pScreen);
     pScreen->CloseScreen = ps->CloseScreen;
     ret = (*pScreen->CloseScreen) (pScreen);
     PictureResetFilters(pScreen);
@@ -633,6 +634,9 @@ PictureInit(ScreenPtr pScreen, PictFormatPtr formats, int nformats)
     if (!dixRegisterPrivateKey(&PictureWindowPrivateKeyRec, PRIVATE_WINDOW, 0))
         return FALSE;
 
+    if (!GlyphAtlasInit(pScreen))
+        return FALSE;
+
     if (!formats) {
         formats = PictureCreateDefaultFormats(pScreen, &nformats);
         if (!formats)
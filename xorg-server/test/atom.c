@@ -0,0 +1,127 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <X11/X.h>
+#include <X11/Xatom.h>
+#include "misc.h"
+#include "dix.h"
+
+#include "tests-common.h"
+
+/* Enough unique atoms to make the tables grow several times */
+#define NUM_ATOMS 100000
+
+static Atom
+make_atom(const char *name, Bool makeit)
+{
+    return MakeAtom(name, strlen(name), makeit);
+}
+
+static void
+atom_predefined(void)
+{
+    InitAtoms();
+
+    assert(make_atom("PRIMARY", FALSE) == XA_PRIMARY);
+    assert(make_atom("WM_TRANSIENT_FOR", FALSE) == XA_WM_TRANSIENT_FOR);
+    assert(strcmp(NameForAtom(XA_STRING), "STRING") == 0);
+    assert(ValidAtom(XA_LAST_PREDEFINED));
+    assert(!ValidAtom(XA_LAST_PREDEFINED + 1));
+    assert(!ValidAtom(None));
+    assert(NameForAtom(None) == NULL);
+    assert(NameForAtom(XA_LAST_PREDEFINED + 1) == NULL);
+}
+
+static void
+atom_make(void)
+{
+    char name[64], *long_name;
+    Atom a, b;
+    int i;
+
+    InitAtoms();
+
+    assert(make_atom("_TEST_NOT_THERE", FALSE) == None);
+    a = make_atom("_TEST_ATOM", TRUE);
+    assert(a == XA_LAST_PREDEFINED + 1);
+    assert(make_atom("_TEST_ATOM", TRUE) == a);
+    assert(make_atom("_TEST_ATOM", FALSE) == a);
+    assert(strcmp(NameForAtom(a), "_TEST_ATOM") == 0);
+
+    /* names are counted, not terminated */
+    b = MakeAtom("_TEST_ATOM_LONGER", strlen("_TEST_ATOM"), TRUE);
+    assert(b == a);
+    b = MakeAtom("_TEST_AT", 7, TRUE);
+    assert(b != a);
+    assert(strcmp(NameForAtom(b), "_TEST_A") == 0);
+    assert(MakeAtom("", 0, TRUE) != None);
+
+    /* bigger than a chunk of names */
+    long_name = malloc(100000);
+    assert(long_name);
+    memset(long_name, 'x', 99999);
+    long_name[99999] = '\0';
+    a = make_atom(long_name, TRUE);
+    assert(strcmp(NameForAtom(a), long_name) == 0);
+    assert(make_atom(long_name, FALSE) == a);
+    free(long_name);
+
+    for (i = 0; i < NUM_ATOMS; i++) {
+        sprintf(name, "_TEST_ATOM_%d", i);
+        b = make_atom(name, TRUE);
+        assert(b == a + 1 + i);
+    }
+    for (i = 0; i < NUM_ATOMS; i++) {
+        sprintf(name, "_TEST_ATOM_%d", i);
+        assert(make_atom(name, FALSE) == a + 1 + i);
+        assert(strcmp(NameForAtom(a + 1 + i), name) == 0);
+    }
+    assert(ValidAtom(a + NUM_ATOMS));
+    assert(!ValidAtom(a + NUM_ATOMS + 1));
+    assert(make_atom("PRIMARY", FALSE) == XA_PRIMARY);
+
+    /* starting over forgets everything but the predefined atoms */
+    InitAtoms();
+    assert(make_atom("_TEST_ATOM_1", FALSE) == None);
+    assert(!ValidAtom(XA_LAST_PREDEFINED + 1));
+    assert(make_atom("_TEST_ATOM_1", TRUE) == XA_LAST_PREDEFINED + 1);
+}
+
+int
+atom_test(void)
+{
+    atom_predefined();
+    atom_make();
+    FreeAllAtoms();
+
+    return 0;
+}
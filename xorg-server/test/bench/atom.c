@@ -0,0 +1,81 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <X11/X.h>
+#include <X11/Xatom.h>
+#include "misc.h"
+#include "dix.h"
+
+#include "tests-common.h"
+
+#define NUM_ATOMS 100000
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int
+atom_benchmark(void)
+{
+    char name[64];
+    double start, make_ns, lookup_ns;
+    int i;
+
+    InitAtoms();
+
+    start = now();
+    for (i = 0; i < NUM_ATOMS; i++) {
+        sprintf(name, "_BENCH_ATOM_%d", i);
+        MakeAtom(name, strlen(name), TRUE);
+    }
+    make_ns = (now() - start) * 1e9 / NUM_ATOMS;
+
+    start = now();
+    for (i = 0; i < NUM_ATOMS; i++) {
+        sprintf(name, "_BENCH_ATOM_%d", (i * 7919) % NUM_ATOMS);
+        MakeAtom(name, strlen(name), FALSE);
+    }
+    lookup_ns = (now() - start) * 1e9 / NUM_ATOMS;
+
+    printf("%d atoms: %.1f ns to make one, %.1f ns to look one up\n",
+           NUM_ATOMS, make_ns, lookup_ns);
+
+    FreeAllAtoms();
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file
+ *
+ * Damage-heavy benchmark: lots of small scattered fills, one request
+ * each, on a pixmap with and without a damage object watching it.
+ * test/damage/batch.c checks the damage these fills produce.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <xcb/damage.h>
+
+#define WIDTH 1024
+#define HEIGHT 1024
+#define NUM_RECTS 100000
+
+static xcb_connection_t *c;
+static xcb_pixmap_t pixmap;
+static xcb_gc_t gc;
+static xcb_rectangle_t rects[NUM_RECTS];
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+sync_server(void)
+{
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+}
+
+static void
+run(const char *name, int level)
+{
+    xcb_damage_damage_t damage = 0;
+    xcb_generic_event_t *ev;
+    double start;
+
+    if (level >= 0) {
+        damage = xcb_generate_id(c);
+        xcb_damage_create(c, damage, pixmap, level);
+    }
+
+    sync_server();
+    start = now();
+    for (int i = 0; i < NUM_RECTS; i++)
+        xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rects[i]);
+    sync_server();
+    printf("%-16s %10.0f fills/s\n", name, NUM_RECTS / (now() - start));
+
+    if (damage)
+        xcb_damage_destroy(c, damage);
+    sync_server();
+    while ((ev = xcb_poll_for_event(c)))
+        free(ev);
+}
+
+int main(int argc, char **argv)
+{
+    xcb_screen_t *screen;
+
+    c = xcb_connect(NULL, NULL);
+    if (!xcb_get_extension_data(c, &xcb_damage_id)->present) {
+        printf("No XDamage present\n");
+        exit(77);
+    }
+    free(xcb_damage_query_version_reply(c, xcb_damage_query_version(c, 1, 1),
+                                        NULL));
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    pixmap = xcb_generate_id(c);
+    xcb_create_pixmap(c, screen->root_depth, pixmap, screen->root,
+                      WIDTH, HEIGHT);
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, pixmap, XCB_GC_FOREGROUND,
+                  (uint32_t[]) { 0xffffff });
+
+    srand(0);
+    for (int i = 0; i < NUM_RECTS; i++) {
+        rects[i].x = rand() % (WIDTH - 8);
+        rects[i].y = rand() % (HEIGHT - 8);
+        rects[i].width = 1 + rand() % 8;
+        rects[i].height = 1 + rand() % 8;
+    }
+
+    run("no damage", -1);
+    run("non-empty", XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+    run("bounding-box", XCB_DAMAGE_REPORT_LEVEL_BOUNDING_BOX);
+
+    xcb_free_gc(c, gc);
+    xcb_free_pixmap(c, pixmap);
+    xcb_disconnect(c);
+    exit(0);
+}
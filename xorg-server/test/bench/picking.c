@@ -0,0 +1,178 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "misc.h"
+#include "dix.h"
+#include "windowstr.h"
+#include "scrnintstr.h"
+#include "inputstr.h"
+#include "mi.h"
+
+#include "tests-common.h"
+
+/* Lots of top level windows, with toolkit trees below some of them */
+#define NUM_WINDOWS 3000
+#define NUM_POINTS 2000
+#define SCREEN_WIDTH 1920
+#define SCREEN_HEIGHT 1080
+
+static ScreenRec screen;
+static WindowRec root;
+static WindowPtr windows[NUM_WINDOWS];
+static SpriteRec sprite;
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+add_window(WindowPtr pWin, WindowPtr pParent)
+{
+    pWin->drawable.pScreen = &screen;
+    pWin->parent = pParent;
+    pWin->nextSib = pParent->firstChild;
+    if (pParent->firstChild)
+        pParent->firstChild->prevSib = pWin;
+    else
+        pParent->lastChild = pWin;
+    pParent->firstChild = pWin;
+}
+
+static void
+picking_init(void)
+{
+    int i;
+
+    memset(&screen, 0, sizeof(screen));
+    screen.width = SCREEN_WIDTH;
+    screen.height = SCREEN_HEIGHT;
+    screen.root = &root;
+
+    memset(&root, 0, sizeof(root));
+    root.drawable.pScreen = &screen;
+    root.drawable.width = SCREEN_WIDTH;
+    root.drawable.height = SCREEN_HEIGHT;
+    root.mapped = TRUE;
+
+    srand(0);
+    for (i = 0; i < NUM_WINDOWS; i++) {
+        WindowPtr pWin = calloc(1, sizeof(WindowRec));
+        WindowPtr pParent = &root;
+
+        assert(pWin);
+        /* half of them top level, the others below an earlier window */
+        if (i > 0 && rand() % 2)
+            pParent = windows[rand() % i];
+
+        pWin->borderWidth = rand() % 3;
+        pWin->drawable.x = pParent->drawable.x + rand() % 400 - 100 +
+            pWin->borderWidth;
+        pWin->drawable.y = pParent->drawable.y + rand() % 300 - 100 +
+            pWin->borderWidth;
+        pWin->drawable.width = rand() % 300 + 1;
+        pWin->drawable.height = rand() % 200 + 1;
+        if (pParent == &root) {
+            pWin->drawable.x += rand() % SCREEN_WIDTH;
+            pWin->drawable.y += rand() % SCREEN_HEIGHT;
+        }
+        pWin->mapped = rand() % 8 != 0;
+        add_window(pWin, pParent);
+        windows[i] = pWin;
+    }
+
+    sprite.spriteTraceSize = 1;
+    sprite.spriteTrace = calloc(1, sizeof(WindowPtr));
+    assert(sprite.spriteTrace);
+    sprite.spriteTrace[0] = &root;
+}
+
+/* The search through the children at every level XYToWindow used to do */
+static int
+linear_trace(int x, int y, WindowPtr *trace)
+{
+    WindowPtr pWin = root.firstChild;
+    int n = 0;
+
+    while (pWin) {
+        int bw = wBorderWidth(pWin);
+
+        if (pWin->mapped &&
+            x >= pWin->drawable.x - bw &&
+            x < pWin->drawable.x + (int) pWin->drawable.width + bw &&
+            y >= pWin->drawable.y - bw &&
+            y < pWin->drawable.y + (int) pWin->drawable.height + bw) {
+            trace[n++] = pWin;
+            pWin = pWin->firstChild;
+        }
+        else
+            pWin = pWin->nextSib;
+    }
+    return n;
+}
+
+int
+picking_benchmark(void)
+{
+    WindowPtr trace[NUM_WINDOWS];
+    double start, new_ms, old_ms;
+    int i, x, y;
+    const int rounds = 20;
+
+    picking_init();
+
+    start = now();
+    for (i = 0; i < rounds * NUM_POINTS; i++) {
+        x = (i * 7) % SCREEN_WIDTH;
+        y = (i * 13) % SCREEN_HEIGHT;
+        linear_trace(x, y, trace);
+    }
+    old_ms = (now() - start) * 1e3;
+
+    start = now();
+    for (i = 0; i < rounds * NUM_POINTS; i++) {
+        x = (i * 7) % SCREEN_WIDTH;
+        y = (i * 13) % SCREEN_HEIGHT;
+        miXYToWindow(&screen, &sprite, x, y);
+    }
+    new_ms = (now() - start) * 1e3;
+
+    printf("XYToWindow among %d windows: %.1f ns (child search %.1f ns)\n",
+           NUM_WINDOWS, new_ms * 1e6 / (rounds * NUM_POINTS),
+           old_ms * 1e6 / (rounds * NUM_POINTS));
+
+    return 0;
+}
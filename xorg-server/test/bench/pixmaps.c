@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file
+ *
+ * Pixmap benchmark: creating and freeing pixmaps of mixed sizes, whose
+ * bits fb recycles through its pixmap pool, and what the pool's counters
+ * made of it.  test/fb/pixmaps.c checks the recycled pixmaps.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xcb/res.h>
+
+#define ROUNDS 10000
+#define LIVE 16
+
+static xcb_connection_t *c;
+static xcb_screen_t *screen;
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+sync_server(void)
+{
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+}
+
+static void
+print_counters(void)
+{
+    /* the root window is one of the server's own resources */
+    xcb_res_query_client_resources_reply_t *reply =
+        xcb_res_query_client_resources_reply(c,
+            xcb_res_query_client_resources(c, screen->root), NULL);
+    xcb_res_type_iterator_t i;
+
+    if (!reply)
+        return;
+    for (i = xcb_res_query_client_resources_types_iterator(reply);
+         i.rem; xcb_res_type_next(&i)) {
+        xcb_get_atom_name_reply_t *name =
+            xcb_get_atom_name_reply(c,
+                                    xcb_get_atom_name(c, i.data->resource_type),
+                                    NULL);
+
+        if (name && xcb_get_atom_name_name_length(name) > 15 &&
+            !memcmp(xcb_get_atom_name_name(name), "FB_PIXMAP_POOL_", 15))
+            printf("%-30.*s %10u\n", xcb_get_atom_name_name_length(name),
+                   xcb_get_atom_name_name(name), i.data->count);
+        free(name);
+    }
+    free(reply);
+}
+
+int main(int argc, char **argv)
+{
+    xcb_pixmap_t live[LIVE] = { 0 };
+    xcb_gcontext_t gc;
+    double start;
+
+    c = xcb_connect(NULL, NULL);
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, screen->root, XCB_GC_FOREGROUND,
+                  (uint32_t[]) { 0xffffff });
+
+    srand(0);
+    sync_server();
+    start = now();
+    for (int i = 0; i < ROUNDS; i++) {
+        int k = rand() % LIVE;
+        xcb_rectangle_t rect = { 0, 0, 1, 1 };
+
+        if (live[k])
+            xcb_free_pixmap(c, live[k]);
+        live[k] = xcb_generate_id(c);
+        xcb_create_pixmap(c, screen->root_depth, live[k], screen->root,
+                          rand() % 512 + 64, rand() % 256 + 32);
+        xcb_poly_fill_rectangle(c, live[k], gc, 1, &rect);
+    }
+    sync_server();
+    printf("%-30s %10.2f us\n", "CreatePixmap/FreePixmap",
+           (now() - start) * 1e6 / ROUNDS);
+
+    for (int k = 0; k < LIVE; k++)
+        xcb_free_pixmap(c, live[k]);
+    xcb_free_gc(c, gc);
+    sync_server();
+    print_counters();
+
+    xcb_disconnect(c);
+    exit(0);
+}
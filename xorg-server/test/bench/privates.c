@@ -0,0 +1,111 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "misc.h"
+#include "dix.h"
+#include "gcstruct.h"
+#include "scrnintstr.h"
+#include "privates.h"
+
+#include "tests-common.h"
+
+#define NUM_ROUNDS 100000
+
+static ScreenRec screen;
+static DevPrivateKeyRec key;
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static GCPtr
+alloc_gc(ScreenPtr pScreen)
+{
+    GCPtr pGC = dixAllocateScreenObjectWithPrivates(pScreen, GC, PRIVATE_GC);
+
+    assert(pGC);
+    pGC->pScreen = pScreen;
+    return pGC;
+}
+
+static void
+free_gc(GCPtr pGC)
+{
+    dixFreeScreenObjectWithPrivates(pGC->pScreen, pGC, PRIVATE_GC);
+}
+
+int
+privates_benchmark(void)
+{
+    GCPtr gcs[16];
+    double start, cached_ns, malloc_ns;
+    int i, j;
+
+    screenInfo.screens[0] = &screen;
+    screenInfo.numScreens = 1;
+    dixInitScreenSpecificPrivates(&screen);
+    assert(dixRegisterScreenSpecificPrivateKey(&screen, &key, PRIVATE_GC, 64));
+
+    start = now();
+    for (i = 0; i < NUM_ROUNDS; i++) {
+        for (j = 0; j < 16; j++)
+            gcs[j] = alloc_gc(&screen);
+        for (j = 0; j < 16; j++)
+            free_gc(gcs[j]);
+    }
+    cached_ns = (now() - start) * 1e9 / (NUM_ROUNDS * 16);
+
+    /* objects of no screen are never cached */
+    start = now();
+    for (i = 0; i < NUM_ROUNDS; i++) {
+        for (j = 0; j < 16; j++)
+            gcs[j] = alloc_gc(NULL);
+        for (j = 0; j < 16; j++)
+            free_gc(gcs[j]);
+    }
+    malloc_ns = (now() - start) * 1e9 / (NUM_ROUNDS * 16);
+
+    printf("GC allocation: %.1f ns (malloc %.1f ns)\n", cached_ns, malloc_ns);
+
+    dixFreeScreenSpecificPrivates(&screen);
+    dixResetPrivates();
+    screenInfo.numScreens = 0;
+    screenInfo.screens[0] = NULL;
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <X11/Xatom.h>
+#include "misc.h"
+#include "dix.h"
+#include "dixstruct.h"
+#include "windowstr.h"
+#include "scrnintstr.h"
+#include "propertyst.h"
+
+#include "tests-common.h"
+
+#define NUM_PROPERTIES 1000
+
+static ScreenRec screen;
+static WindowRec root;
+static ClientRec client;
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int
+property_benchmark(void)
+{
+    PropertyPtr prop;
+    Atom *order;
+    double start, new_ms, old_ms;
+    int i, round;
+    const int rounds = 100;
+
+    dixResetPrivates();
+    root.drawable.pScreen = &screen;
+    root.optional = calloc(1, sizeof(WindowOptRec));
+    assert(root.optional);
+    client.index = 1;
+
+    for (i = 0; i < NUM_PROPERTIES; i++) {
+        CARD32 value = i + 1;
+
+        assert(dixChangeWindowProperty(&client, &root, i + 1, XA_INTEGER, 32,
+                                       PropModeReplace, 1, &value,
+                                       TRUE) == Success);
+    }
+
+    /* look properties up in random order, as clients ask for them */
+    order = malloc(NUM_PROPERTIES * sizeof(Atom));
+    assert(order);
+    srand(0);
+    for (i = 0; i < NUM_PROPERTIES; i++)
+        order[i] = rand() % NUM_PROPERTIES + 1;
+
+    /* the list walk GetProperty used to do */
+    start = now();
+    for (round = 0; round < rounds; round++)
+        for (i = 0; i < NUM_PROPERTIES; i++) {
+            for (prop = wUserProps(&root); prop; prop = prop->next)
+                if (prop->propertyName == order[i])
+                    break;
+            assert(prop);
+        }
+    old_ms = (now() - start) * 1e3;
+
+    start = now();
+    for (round = 0; round < rounds; round++)
+        for (i = 0; i < NUM_PROPERTIES; i++) {
+            assert(dixLookupProperty(&prop, &root, order[i], &client,
+                                     DixReadAccess) == Success);
+        }
+    new_ms = (now() - start) * 1e3;
+
+    printf("GetProperty lookup on %d properties: %.1f ns (list walk %.1f ns)\n",
+           NUM_PROPERTIES, new_ms * 1e6 / (rounds * NUM_PROPERTIES),
+           old_ms * 1e6 / (rounds * NUM_PROPERTIES));
+
+    start = now();
+    for (i = 0; i < NUM_PROPERTIES; i++)
+        DeleteProperty(&client, &root, order[i]);
+    DeleteAllWindowProperties(&root);
+    printf("delete %d properties: %.2f ms\n", NUM_PROPERTIES,
+           (now() - start) * 1e3);
+    free(order);
+
+    return 0;
+}
@@ -0,0 +1,267 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "misc.h"
+#include "dix.h"
+#include "dixstruct.h"
+#include "resource.h"
+
+#include "tests-common.h"
+
+#define NUM_RESOURCES 100000
+
+static ClientRec server_client;
+static ClientRec client;
+static RESTYPE type_a, type_b;
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+no_delete(void *value, XID id)
+{
+    return Success;
+}
+
+static XID
+client_id(int i)
+{
+    return client.clientAsMask | (i + 1);
+}
+
+static void
+count_walk(void *value, XID id, void *cdata)
+{
+    (*(int *) cdata)++;
+}
+
+/*
+ * The chained hash table the resource code used to have, kept here to
+ * compare lookup and insertion cost against.
+ */
+typedef struct _ChainedResource {
+    struct _ChainedResource *next;
+    XID id;
+    RESTYPE type;
+    void *value;
+} ChainedResourceRec, *ChainedResourcePtr;
+
+typedef struct {
+    ChainedResourcePtr *resources;
+    int elements;
+    int buckets;
+    int hashsize;
+} ChainedTable;
+
+static void
+chained_rebuild(ChainedTable *t)
+{
+    ChainedResourcePtr *resources, res, next;
+    int i;
+
+    resources = calloc(2 * t->buckets, sizeof(ChainedResourcePtr));
+    assert(resources);
+    t->hashsize++;
+    for (i = 0; i < t->buckets; i++) {
+        for (res = t->resources[i]; res; res = next) {
+            int h = HashResourceID(res->id, t->hashsize);
+
+            next = res->next;
+            res->next = resources[h];
+            resources[h] = res;
+        }
+    }
+    free(t->resources);
+    t->resources = resources;
+    t->buckets *= 2;
+}
+
+static void
+chained_add(ChainedTable *t, XID id, RESTYPE type, void *value)
+{
+    ChainedResourcePtr res, *head;
+
+    if (t->elements >= 4 * t->buckets && t->hashsize < 16)
+        chained_rebuild(t);
+    head = &t->resources[HashResourceID(id, t->hashsize)];
+    res = malloc(sizeof(ChainedResourceRec));
+    assert(res);
+    res->next = *head;
+    res->id = id;
+    res->type = type;
+    res->value = value;
+    *head = res;
+    t->elements++;
+}
+
+static void *
+chained_lookup(ChainedTable *t, XID id, RESTYPE type)
+{
+    ChainedResourcePtr res;
+
+    for (res = t->resources[HashResourceID(id, t->hashsize)]; res; res = res->next)
+        if (res->id == id && res->type == type)
+            return res->value;
+    return NULL;
+}
+
+static void
+chained_free(ChainedTable *t)
+{
+    ChainedResourcePtr res, next;
+    int i;
+
+    for (i = 0; i < t->buckets; i++)
+        for (res = t->resources[i]; res; res = next) {
+            next = res->next;
+            free(res);
+        }
+    free(t->resources);
+}
+
+static int
+chained_count_type(ChainedTable *t, RESTYPE type)
+{
+    ChainedResourcePtr res;
+    int i, count = 0;
+
+    for (i = 0; i < t->buckets; i++)
+        for (res = t->resources[i]; res; res = res->next)
+            if (res->type == type)
+                count++;
+    return count;
+}
+
+int
+resource_benchmark(void)
+{
+    ChainedTable chained;
+    double start, new_ms, old_ms;
+    void *value;
+    int *order;
+    int i, round, count;
+    const int rounds = 10;
+    const int rare = 100;
+
+    dixResetPrivates();
+    serverClient = &server_client;
+    InitClient(serverClient, 0, (void *) NULL);
+    assert(InitClientResources(serverClient));
+    type_a = CreateNewResourceType(no_delete, "BenchA");
+    type_b = CreateNewResourceType(no_delete, "BenchB");
+    assert(type_a && type_b);
+    InitClient(&client, 1, (void *) NULL);
+    assert(InitClientResources(&client));
+
+    chained.buckets = 64;
+    chained.hashsize = 6;
+    chained.elements = 0;
+    chained.resources = calloc(chained.buckets, sizeof(ChainedResourcePtr));
+    assert(chained.resources);
+
+    /* lookups in random order, as dispatch sees them */
+    order = malloc(NUM_RESOURCES * sizeof(int));
+    assert(order);
+    for (i = 0; i < NUM_RESOURCES; i++)
+        order[i] = i;
+    srand(0);
+    for (i = NUM_RESOURCES - 1; i > 0; i--) {
+        int j = rand() % (i + 1), tmp = order[i];
+
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    /* a few resources of a second type spread among the others */
+    start = now();
+    for (i = 0; i < NUM_RESOURCES; i++)
+        chained_add(&chained, client_id(i),
+                    (i % (NUM_RESOURCES / rare)) ? type_a : type_b,
+                    (void *) (intptr_t) (i + 1));
+    old_ms = (now() - start) * 1e3;
+    start = now();
+    for (i = 0; i < NUM_RESOURCES; i++)
+        AddResource(client_id(i),
+                    (i % (NUM_RESOURCES / rare)) ? type_a : type_b,
+                    (void *) (intptr_t) (i + 1));
+    new_ms = (now() - start) * 1e3;
+    printf("add %d: %.2f ms (chained %.2f ms)\n", NUM_RESOURCES, new_ms, old_ms);
+
+    start = now();
+    for (round = 0; round < rounds; round++)
+        for (i = 0; i < NUM_RESOURCES; i++) {
+            value = chained_lookup(&chained, client_id(order[i]),
+                                   (order[i] % (NUM_RESOURCES / rare)) ?
+                                   type_a : type_b);
+            assert(value);
+        }
+    old_ms = (now() - start) * 1e3;
+    start = now();
+    for (round = 0; round < rounds; round++)
+        for (i = 0; i < NUM_RESOURCES; i++) {
+            dixLookupResourceByType(&value, client_id(order[i]),
+                                    (order[i] % (NUM_RESOURCES / rare)) ?
+                                    type_a : type_b, NULL, DixReadAccess);
+            assert(value);
+        }
+    new_ms = (now() - start) * 1e3;
+    printf("lookup %d: %.2f ms (chained %.2f ms)\n",
+           rounds * NUM_RESOURCES, new_ms, old_ms);
+
+    start = now();
+    for (round = 0; round < rounds; round++)
+        assert(chained_count_type(&chained, type_b) == rare);
+    old_ms = (now() - start) * 1e3;
+    start = now();
+    for (round = 0; round < rounds; round++) {
+        count = 0;
+        FindClientResourcesByType(&client, type_b, count_walk, &count);
+        assert(count == rare);
+    }
+    new_ms = (now() - start) * 1e3;
+    printf("find %d of %d by type: %.3f ms (chained %.3f ms)\n",
+           rare, NUM_RESOURCES, new_ms, old_ms);
+
+    chained_free(&chained);
+    start = now();
+    FreeClientResources(&client);
+    printf("free %d: %.2f ms\n", NUM_RESOURCES, (now() - start) * 1e3);
+    free(order);
+
+    return 0;
+}
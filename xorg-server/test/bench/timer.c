@@ -0,0 +1,90 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "misc.h"
+#include "os.h"
+
+#include "tests-common.h"
+
+#define NUM_TIMERS 10000
+
+static OsTimerPtr timers[NUM_TIMERS];
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static CARD32
+never_fires(OsTimerPtr timer, CARD32 time, void *arg)
+{
+    return 0;
+}
+
+int
+timer_benchmark(void)
+{
+    double start, arm, cancel;
+    int i, round;
+    const int rounds = 10;
+
+    TimerInit();
+    for (i = 0; i < NUM_TIMERS; i++)
+        timers[i] = TimerSet(NULL, 0, 0, never_fires, NULL);
+
+    arm = cancel = 0;
+    for (round = 0; round < rounds; round++) {
+        start = now();
+        for (i = 0; i < NUM_TIMERS; i++)
+            TimerSet(timers[i], 0, 100000 + rand() % 100000,
+                     never_fires, (void *) (intptr_t) i);
+        arm += now() - start;
+
+        start = now();
+        for (i = 0; i < NUM_TIMERS; i++)
+            TimerCancel(timers[(i * 7919) % NUM_TIMERS]);
+        cancel += now() - start;
+    }
+
+    printf("%d timers: arm %.1f ns, cancel %.1f ns\n", NUM_TIMERS,
+           arm * 1e9 / (rounds * NUM_TIMERS),
+           cancel * 1e9 / (rounds * NUM_TIMERS));
+
+    for (i = 0; i < NUM_TIMERS; i++)
+        TimerFree(timers[i]);
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file
+ *
+ * Lots of small scattered fills, one request each, on a pixmap a damage
+ * object watches.  Checks that the damage the server collected covers
+ * everything that was drawn, and that a new notify follows a subtract.
+ * test/bench/damage.c times the same fills.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/damage.h>
+#include <xcb/xfixes.h>
+
+#define WIDTH 1024
+#define HEIGHT 1024
+#define NUM_RECTS 100000
+
+static xcb_connection_t *c;
+static xcb_screen_t *screen;
+static xcb_pixmap_t pixmap;
+static xcb_gc_t gc;
+static xcb_rectangle_t rects[NUM_RECTS];
+static uint8_t damage_event;
+
+static void
+sync_server(void)
+{
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+}
+
+static int
+count_damage_notify(void)
+{
+    xcb_generic_event_t *ev;
+    int count = 0;
+
+    while ((ev = xcb_poll_for_event(c))) {
+        if ((ev->response_type & 0x7f) ==
+            damage_event + XCB_DAMAGE_NOTIFY)
+            count++;
+        free(ev);
+    }
+    return count;
+}
+
+static void
+draw_rects(void)
+{
+    for (int i = 0; i < NUM_RECTS; i++)
+        xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rects[i]);
+    sync_server();
+}
+
+/* Every drawn pixel has to be inside the damage the server returns. */
+static bool
+check_parts(xcb_xfixes_region_t parts)
+{
+    xcb_xfixes_fetch_region_reply_t *reply =
+        xcb_xfixes_fetch_region_reply(c, xcb_xfixes_fetch_region(c, parts),
+                                      NULL);
+    xcb_rectangle_t *boxes = xcb_xfixes_fetch_region_rectangles(reply);
+    int nboxes = xcb_xfixes_fetch_region_rectangles_length(reply);
+    uint8_t *covered = calloc(WIDTH, HEIGHT);
+    bool pass = true;
+
+    assert(covered);
+    for (int i = 0; i < nboxes; i++)
+        for (int y = boxes[i].y; y < boxes[i].y + boxes[i].height; y++)
+            memset(covered + y * WIDTH + boxes[i].x, 1, boxes[i].width);
+
+    for (int i = 0; i < NUM_RECTS && pass; i++)
+        for (int y = rects[i].y; y < rects[i].y + rects[i].height; y++)
+            for (int x = rects[i].x; x < rects[i].x + rects[i].width; x++)
+                if (!covered[y * WIDTH + x]) {
+                    fprintf(stderr, "  fail: damage missed %d, %d\n", x, y);
+                    pass = false;
+                    break;
+                }
+
+    printf("  damage came back as %d rectangles\n", nboxes);
+    free(covered);
+    free(reply);
+    return pass;
+}
+
+static bool
+run(void)
+{
+    xcb_damage_damage_t damage = xcb_generate_id(c);
+    xcb_xfixes_region_t parts = xcb_generate_id(c);
+    bool pass = true;
+
+    xcb_damage_create(c, damage, pixmap, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+    draw_rects();
+
+    if (count_damage_notify() != 1) {
+        fprintf(stderr, "  fail: expected one notify\n");
+        pass = false;
+    }
+
+    xcb_xfixes_create_region(c, parts, 0, NULL);
+    xcb_damage_subtract(c, damage, XCB_NONE, parts);
+    pass = check_parts(parts) && pass;
+    xcb_xfixes_destroy_region(c, parts);
+
+    /* Emptied again, so the next fill has to be reported */
+    xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rects[0]);
+    sync_server();
+    if (count_damage_notify() != 1) {
+        fprintf(stderr, "  fail: no notify after subtract\n");
+        pass = false;
+    }
+
+    xcb_damage_destroy(c, damage);
+    sync_server();
+    count_damage_notify();
+    return pass;
+}
+
+int main(int argc, char **argv)
+{
+    const xcb_query_extension_reply_t *ext;
+    bool pass;
+
+    c = xcb_connect(NULL, NULL);
+    ext = xcb_get_extension_data(c, &xcb_damage_id);
+    if (!ext->present) {
+        printf("No XDamage present\n");
+        exit(77);
+    }
+    damage_event = ext->first_event;
+    if (!xcb_get_extension_data(c, &xcb_xfixes_id)->present) {
+        printf("No XFixes present\n");
+        exit(77);
+    }
+
+    free(xcb_damage_query_version_reply(c, xcb_damage_query_version(c, 1, 1),
+                                        NULL));
+    free(xcb_xfixes_query_version_reply(c, xcb_xfixes_query_version(c, 2, 0),
+                                        NULL));
+
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    pixmap = xcb_generate_id(c);
+    xcb_create_pixmap(c, screen->root_depth, pixmap, screen->root,
+                      WIDTH, HEIGHT);
+    gc = xcb_generate_id(c);
+    xcb_create_gc(c, gc, pixmap, XCB_GC_FOREGROUND,
+                  (uint32_t[]) { 0xffffff });
+
+    srand(0);
+    for (int i = 0; i < NUM_RECTS; i++) {
+        rects[i].x = rand() % (WIDTH - 8);
+        rects[i].y = rand() % (HEIGHT - 8);
+        rects[i].width = 1 + rand() % 8;
+        rects[i].height = 1 + rand() % 8;
+    }
+
+    pass = run();
+
+    xcb_free_gc(c, gc);
+    xcb_free_pixmap(c, pixmap);
+    xcb_disconnect(c);
+    exit(pass ? 0 : 1);
+}
@@ -0,0 +1,318 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file
+ *
+ * Benchmark of CopyArea, PutImage and Render Composite on 4K pixmaps,
+ * which is where fb splits the work into bands when the server runs with
+ * -fbthreads.  Every operation is also done again in single rows, which
+ * are always drawn on the main thread, and the results are compared.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xcb/render.h>
+
+#define WIDTH 3840
+#define HEIGHT 2160
+#define STRIP 128               /* rows per PutImage/GetImage request */
+#define ROUNDS 10
+
+struct bench {
+    xcb_connection_t *c;
+    xcb_screen_t *screen;
+    xcb_gcontext_t gc32, gc24;
+    xcb_render_pictformat_t argb32, rgb24;
+};
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** Waits until the server has executed everything sent so far. */
+static void
+sync_server(struct bench *b)
+{
+    free(xcb_get_input_focus_reply(b->c, xcb_get_input_focus(b->c), NULL));
+}
+
+static uint32_t
+pattern(int x, int y, int seed)
+{
+    uint32_t v = (x * 2654435761u) ^ (y * 40503u) ^ (seed * 97u);
+
+    return v ^ (v >> 13);
+}
+
+static xcb_pixmap_t
+create_pixmap(struct bench *b, int depth, int seed)
+{
+    xcb_pixmap_t p = xcb_generate_id(b->c);
+    uint32_t *rows = malloc(WIDTH * STRIP * 4);
+
+    xcb_create_pixmap(b->c, depth, p, b->screen->root, WIDTH, HEIGHT);
+    for (int y = 0; y < HEIGHT; y += STRIP) {
+        for (int i = 0; i < WIDTH * STRIP; i++)
+            rows[i] = pattern(i % WIDTH, y + i / WIDTH, seed);
+        xcb_put_image(b->c, XCB_IMAGE_FORMAT_Z_PIXMAP, p,
+                      depth == 32 ? b->gc32 : b->gc24, WIDTH, STRIP, 0, y,
+                      0, depth, WIDTH * STRIP * 4, (uint8_t *) rows);
+    }
+    free(rows);
+    return p;
+}
+
+static uint32_t *
+get_image(struct bench *b, xcb_drawable_t d)
+{
+    uint32_t *pixels = malloc(WIDTH * HEIGHT * 4);
+
+    for (int y = 0; y < HEIGHT; y += STRIP) {
+        xcb_get_image_reply_t *reply =
+            xcb_get_image_reply(b->c,
+                                xcb_get_image(b->c, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                                              d, 0, y, WIDTH, STRIP, ~0),
+                                NULL);
+
+        assert(reply);
+        assert(xcb_get_image_data_length(reply) == WIDTH * STRIP * 4);
+        memcpy(pixels + y * WIDTH, xcb_get_image_data(reply),
+               WIDTH * STRIP * 4);
+        free(reply);
+    }
+    return pixels;
+}
+
+static bool
+same_contents(struct bench *b, xcb_drawable_t d1, xcb_drawable_t d2,
+              uint32_t mask, const char *what)
+{
+    uint32_t *p1 = get_image(b, d1);
+    uint32_t *p2 = get_image(b, d2);
+    bool same = true;
+
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        if ((p1[i] ^ p2[i]) & mask) {
+            printf("%s: pixel %d,%d is 0x%08x, expected 0x%08x\n", what,
+                   i % WIDTH, i / WIDTH, p1[i], p2[i]);
+            same = false;
+            break;
+        }
+    }
+    free(p1);
+    free(p2);
+    return same;
+}
+
+static xcb_render_picture_t
+create_picture(struct bench *b, xcb_pixmap_t p, xcb_render_pictformat_t format)
+{
+    xcb_render_picture_t pict = xcb_generate_id(b->c);
+
+    xcb_render_create_picture(b->c, pict, p, format, 0, NULL);
+    return pict;
+}
+
+static void
+find_formats(struct bench *b)
+{
+    xcb_render_query_pict_formats_reply_t *reply =
+        xcb_render_query_pict_formats_reply(b->c,
+                                            xcb_render_query_pict_formats(b->c),
+                                            NULL);
+    xcb_render_pictforminfo_iterator_t i;
+
+    assert(reply);
+    for (i = xcb_render_query_pict_formats_formats_iterator(reply);
+         i.rem; xcb_render_pictforminfo_next(&i)) {
+        xcb_render_directformat_t *d = &i.data->direct;
+
+        if (i.data->type != XCB_RENDER_PICT_TYPE_DIRECT ||
+            d->red_shift != 16 || d->green_shift != 8 || d->blue_shift != 0)
+            continue;
+        if (i.data->depth == 32 && d->alpha_mask == 0xff &&
+            d->alpha_shift == 24)
+            b->argb32 = i.data->id;
+        if (i.data->depth == 24 && d->alpha_mask == 0)
+            b->rgb24 = i.data->id;
+    }
+    free(reply);
+}
+
+static bool
+bench_copy_area(struct bench *b)
+{
+    xcb_pixmap_t src = create_pixmap(b, 24, 1);
+    xcb_pixmap_t dst = create_pixmap(b, 24, 2);
+    xcb_pixmap_t ref = create_pixmap(b, 24, 2);
+    double start, elapsed;
+    bool pass;
+
+    sync_server(b);
+    start = now();
+    for (int i = 0; i < ROUNDS; i++)
+        xcb_copy_area(b->c, src, dst, b->gc24, i, 0, 0, i,
+                      WIDTH - i, HEIGHT - i);
+    sync_server(b);
+    elapsed = now() - start;
+    printf("CopyArea %dx%d: %.2f ms\n", WIDTH, HEIGHT, elapsed * 1e3 / ROUNDS);
+
+    for (int i = 0; i < ROUNDS; i++)
+        for (int y = 0; y < HEIGHT - i; y++)
+            xcb_copy_area(b->c, src, ref, b->gc24, i, y, 0, i + y,
+                          WIDTH - i, 1);
+    pass = same_contents(b, dst, ref, 0xffffff, "CopyArea");
+
+    xcb_free_pixmap(b->c, src);
+    xcb_free_pixmap(b->c, dst);
+    xcb_free_pixmap(b->c, ref);
+    return pass;
+}
+
+static bool
+bench_composite(struct bench *b, uint8_t op, const char *name)
+{
+    xcb_pixmap_t src = create_pixmap(b, 32, 3);
+    xcb_pixmap_t dst = create_pixmap(b, 24, 4);
+    xcb_pixmap_t ref = create_pixmap(b, 24, 4);
+    xcb_render_picture_t src_pict = create_picture(b, src, b->argb32);
+    xcb_render_picture_t dst_pict = create_picture(b, dst, b->rgb24);
+    xcb_render_picture_t ref_pict = create_picture(b, ref, b->rgb24);
+    double start, elapsed;
+    bool pass;
+
+    sync_server(b);
+    start = now();
+    for (int i = 0; i < ROUNDS; i++)
+        xcb_render_composite(b->c, op, src_pict, XCB_NONE, dst_pict,
+                             i, 0, 0, 0, 0, i, WIDTH - i, HEIGHT - i);
+    sync_server(b);
+    elapsed = now() - start;
+    printf("Composite %s %dx%d: %.2f ms\n", name, WIDTH, HEIGHT,
+           elapsed * 1e3 / ROUNDS);
+
+    for (int i = 0; i < ROUNDS; i++)
+        for (int y = 0; y < HEIGHT - i; y++)
+            xcb_render_composite(b->c, op, src_pict, XCB_NONE, ref_pict,
+                                 i, y, 0, 0, 0, i + y, WIDTH - i, 1);
+    pass = same_contents(b, dst, ref, 0xffffff, name);
+
+    xcb_render_free_picture(b->c, src_pict);
+    xcb_render_free_picture(b->c, dst_pict);
+    xcb_render_free_picture(b->c, ref_pict);
+    xcb_free_pixmap(b->c, src);
+    xcb_free_pixmap(b->c, dst);
+    xcb_free_pixmap(b->c, ref);
+    return pass;
+}
+
+static bool
+bench_put_image(struct bench *b)
+{
+    xcb_pixmap_t dst, ref;
+    uint32_t *rows = malloc(WIDTH * 4 * 4);
+    double start, elapsed;
+    bool pass;
+
+    /* a request only holds so much, so this covers the pixmap in strips */
+    sync_server(b);
+    start = now();
+    for (int i = 0; i < ROUNDS; i++)
+        xcb_free_pixmap(b->c, create_pixmap(b, 24, 5));
+    sync_server(b);
+    elapsed = now() - start;
+    printf("PutImage %dx%d: %.2f ms\n", WIDTH, HEIGHT, elapsed * 1e3 / ROUNDS);
+
+    /* the reference is drawn four rows at a time */
+    dst = create_pixmap(b, 24, 5);
+    ref = xcb_generate_id(b->c);
+    xcb_create_pixmap(b->c, 24, ref, b->screen->root, WIDTH, HEIGHT);
+    for (int y = 0; y < HEIGHT; y += 4) {
+        for (int i = 0; i < WIDTH * 4; i++)
+            rows[i] = pattern(i % WIDTH, y + i / WIDTH, 5);
+        xcb_put_image(b->c, XCB_IMAGE_FORMAT_Z_PIXMAP, ref, b->gc24,
+                      WIDTH, 4, 0, y, 0, 24, WIDTH * 4 * 4,
+                      (uint8_t *) rows);
+    }
+    pass = same_contents(b, dst, ref, 0xffffff, "PutImage");
+
+    free(rows);
+    xcb_free_pixmap(b->c, dst);
+    xcb_free_pixmap(b->c, ref);
+    return pass;
+}
+
+int main(int argc, char **argv)
+{
+    int screen;
+    xcb_connection_t *c = xcb_connect(NULL, &screen);
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data(c, &xcb_render_id);
+    struct bench b = { .c = c };
+    xcb_pixmap_t p;
+    bool pass = true;
+
+    if (!ext->present) {
+        printf("No RENDER present\n");
+        exit(77);
+    }
+    xcb_render_query_version_reply_t *version =
+        xcb_render_query_version_reply(c, xcb_render_query_version(c, 0, 11),
+                                       NULL);
+    free(version);
+
+    b.screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    find_formats(&b);
+    if (!b.argb32 || !b.rgb24) {
+        printf("No a8r8g8b8/x8r8g8b8 picture formats\n");
+        exit(77);
+    }
+
+    /* GCs for depth 24 and 32 pixmaps */
+    b.gc24 = xcb_generate_id(c);
+    b.gc32 = xcb_generate_id(c);
+    p = xcb_generate_id(c);
+    xcb_create_pixmap(c, 24, p, b.screen->root, 1, 1);
+    xcb_create_gc(c, b.gc24, p, 0, NULL);
+    xcb_free_pixmap(c, p);
+    xcb_create_pixmap(c, 32, p, b.screen->root, 1, 1);
+    xcb_create_gc(c, b.gc32, p, 0, NULL);
+    xcb_free_pixmap(c, p);
+
+    pass = bench_copy_area(&b) && pass;
+    pass = bench_put_image(&b) && pass;
+    pass = bench_composite(&b, XCB_RENDER_PICT_OP_SRC, "Src") && pass;
+    pass = bench_composite(&b, XCB_RENDER_PICT_OP_OVER, "Over") && pass;
+
+    xcb_disconnect(c);
+    exit(pass ? 0 : 1);
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file
+ *
+ * Pixmaps a client gets from fb's pixmap pool must not show what was
+ * drawn in the ones freed before them, and the pool's counters, read back
+ * through X-Resource, must show the recycling.  test/bench/pixmaps.c
+ * times the pool.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/res.h>
+
+#define SIZE 256
+
+struct counters {
+    uint32_t hits;
+    uint32_t cleared_bytes;
+};
+
+static bool
+check_cleared(xcb_connection_t *c, xcb_screen_t *screen, xcb_gcontext_t gc)
+{
+    xcb_rectangle_t rect = { 0, 0, SIZE, SIZE };
+    bool pass = true;
+
+    for (int i = 0; i < 4 && pass; i++) {
+        xcb_pixmap_t p = xcb_generate_id(c);
+        xcb_get_image_reply_t *reply;
+        uint8_t *data;
+        int len;
+
+        xcb_create_pixmap(c, screen->root_depth, p, screen->root, SIZE, SIZE);
+        reply = xcb_get_image_reply(c,
+                                    xcb_get_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                                                  p, 0, 0, SIZE, SIZE, ~0),
+                                    NULL);
+        assert(reply);
+        data = xcb_get_image_data(reply);
+        len = xcb_get_image_data_length(reply);
+        for (int j = 0; j < len; j++) {
+            if (data[j]) {
+                printf("new pixmap has byte %d set to 0x%02x\n", j, data[j]);
+                pass = false;
+                break;
+            }
+        }
+        free(reply);
+
+        /* leave something behind for the next one */
+        xcb_poly_fill_rectangle(c, p, gc, 1, &rect);
+        xcb_free_pixmap(c, p);
+    }
+    return pass;
+}
+
+static bool
+get_counters(xcb_connection_t *c, xcb_screen_t *screen,
+             struct counters *counters)
+{
+    /* the root window is one of the server's own resources */
+    xcb_res_query_client_resources_reply_t *reply =
+        xcb_res_query_client_resources_reply(c,
+            xcb_res_query_client_resources(c, screen->root), NULL);
+    xcb_res_type_iterator_t i;
+    int found = 0;
+
+    if (!reply)
+        return false;
+    for (i = xcb_res_query_client_resources_types_iterator(reply);
+         i.rem; xcb_res_type_next(&i)) {
+        xcb_get_atom_name_reply_t *name =
+            xcb_get_atom_name_reply(c,
+                                    xcb_get_atom_name(c, i.data->resource_type),
+                                    NULL);
+        int len = name ? xcb_get_atom_name_name_length(name) : 0;
+        const char *s = name ? xcb_get_atom_name_name(name) : NULL;
+
+        if (len == strlen("FB_PIXMAP_POOL_HITS") &&
+            !memcmp(s, "FB_PIXMAP_POOL_HITS", len)) {
+            counters->hits = i.data->count;
+            found++;
+        }
+        else if (len == strlen("FB_PIXMAP_POOL_CLEARED_BYTES") &&
+                 !memcmp(s, "FB_PIXMAP_POOL_CLEARED_BYTES", len)) {
+            counters->cleared_bytes = i.data->count;
+            found++;
+        }
+        free(name);
+    }
+    free(reply);
+    return found == 2;
+}
+
+int main(int argc, char **argv)
+{
+    int screen_num;
+    xcb_connection_t *c = xcb_connect(NULL, &screen_num);
+    xcb_screen_t *screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    xcb_gcontext_t gc = xcb_generate_id(c);
+    uint32_t fg = ~0;
+    struct counters before, after;
+    bool pass;
+
+    if (!xcb_get_extension_data(c, &xcb_res_id)->present) {
+        printf("No X-Resource present\n");
+        exit(77);
+    }
+
+    xcb_create_gc(c, gc, screen->root, XCB_GC_FOREGROUND, &fg);
+
+    if (!get_counters(c, screen, &before)) {
+        printf("pixmap pool counters not reported\n");
+        exit(1);
+    }
+    pass = check_cleared(c, screen, gc);
+    if (!get_counters(c, screen, &after)) {
+        printf("pixmap pool counters not reported\n");
+        exit(1);
+    }
+
+    /* the counters wrap, so only their differences mean anything */
+    if ((uint32_t) (after.hits - before.hits) < 3) {
+        printf("%u pool hits for 4 pixmaps of the same size\n",
+               after.hits - before.hits);
+        pass = false;
+    }
+    /* at least a byte per pixel */
+    if ((uint32_t) (after.cleared_bytes - before.cleared_bytes) <
+        3 * SIZE * SIZE) {
+        printf("%u bytes cleared for the recycled pixmaps\n",
+               after.cleared_bytes - before.cleared_bytes);
+        pass = false;
+    }
+
+    xcb_disconnect(c);
+    exit(pass ? 0 : 1);
+}
@@ -1814,27 +1814,21 @@ mieq_test(void)
     mieqInit();
     mieqSetHandler(ET_RawMotion, mieq_test_event_handler);
 
-    /* Enough to fit the buffer but trigger a grow */
+    /* The queue is allocated once and never grows */
     mieq_test_generate_events(180);
-
-    /* We should resize to 512 now */
     mieqProcessInputEvents();
 
-    /* Some should now get dropped */
     mieq_test_generate_events(500);
-
-    /* Tell us how many got dropped, 1024 now */
     mieqProcessInputEvents();
 
-    /* Now make it 2048 */
     mieq_test_generate_events(900);
     mieqProcessInputEvents();
 
-    /* Now make it 4096 (max) */
-    mieq_test_generate_events(1950);
+    /* Fill it right up to the last slot */
+    mieq_test_generate_events(4095);
     mieqProcessInputEvents();
 
-    /* Now overflow one last time with the maximal queue and reach the verbosity limit */
+    /* Now overflow and reach the verbosity limit */
     mieq_test_generate_events(10000);
     mieqProcessInputEvents();
 
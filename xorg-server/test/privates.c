@@ -0,0 +1,143 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "misc.h"
+#include "dix.h"
+#include "gcstruct.h"
+#include "scrnintstr.h"
+#include "privates.h"
+
+#include "tests-common.h"
+
+#define NUM_GCS 1000
+
+static ScreenRec screen;
+static DevPrivateKeyRec key1, key2;
+
+static GCPtr
+alloc_gc(ScreenPtr pScreen)
+{
+    GCPtr pGC = dixAllocateScreenObjectWithPrivates(pScreen, GC, PRIVATE_GC);
+
+    assert(pGC);
+    pGC->pScreen = pScreen;
+    return pGC;
+}
+
+static void
+free_gc(GCPtr pGC)
+{
+    dixFreeScreenObjectWithPrivates(pGC->pScreen, pGC, PRIVATE_GC);
+}
+
+static void
+privates_init(void)
+{
+    screenInfo.screens[0] = &screen;
+    screenInfo.numScreens = 1;
+    dixInitScreenSpecificPrivates(&screen);
+
+    assert(dixRegisterScreenSpecificPrivateKey(&screen, &key1, PRIVATE_GC,
+                                               64));
+}
+
+static void
+privates_recycle(void)
+{
+    GCPtr pGC, pOld;
+    char *data;
+
+    /* a freed GC comes back, with its privates cleared */
+    pGC = alloc_gc(&screen);
+    data = dixLookupPrivate(&pGC->devPrivates, &key1);
+    memset(data, 0xff, 64);
+    free_gc(pGC);
+
+    pOld = pGC;
+    pGC = alloc_gc(&screen);
+    assert(pGC == pOld);
+    data = dixLookupPrivate(&pGC->devPrivates, &key1);
+    assert(data[0] == 0 && data[63] == 0);
+    free_gc(pGC);
+
+    /*
+     * A key registered while no GC exists makes room in the GCs allocated
+     * from then on; none of the cached ones may be handed out anymore
+     */
+    assert(dixRegisterPrivateKey(&key2, PRIVATE_GC, 4096));
+    pGC = alloc_gc(&screen);
+    data = dixLookupPrivate(&pGC->devPrivates, &key2);
+    memset(data, 0xff, 4096);
+    free_gc(pGC);
+}
+
+static void
+privates_many(void)
+{
+    GCPtr gcs[NUM_GCS];
+    int i;
+
+    /* more than are kept, so that some go back to malloc */
+    for (i = 0; i < NUM_GCS; i++)
+        gcs[i] = alloc_gc(&screen);
+    for (i = 0; i < NUM_GCS; i++)
+        free_gc(gcs[i]);
+    for (i = 0; i < NUM_GCS; i++)
+        gcs[i] = alloc_gc(&screen);
+    for (i = 0; i < NUM_GCS; i++)
+        free_gc(gcs[i]);
+}
+
+static void
+privates_fini(void)
+{
+    GCPtr pGC = alloc_gc(&screen);
+
+    /* what the screen still frees while closing isn't kept */
+    dixFreeScreenSpecificPrivates(&screen);
+    free_gc(pGC);
+    assert(screen.screenSpecificPrivates[PRIVATE_GC].cached == NULL);
+
+    dixResetPrivates();
+    screenInfo.numScreens = 0;
+    screenInfo.screens[0] = NULL;
+}
+
+int
+privates_test(void)
+{
+    privates_init();
+    privates_recycle();
+    privates_many();
+    privates_fini();
+
+    return 0;
+}
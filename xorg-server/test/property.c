@@ -0,0 +1,188 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <X11/Xatom.h>
+#include "misc.h"
+#include "dix.h"
+#include "dixstruct.h"
+#include "windowstr.h"
+#include "scrnintstr.h"
+#include "propertyst.h"
+#include "xace.h"
+#include "xacestr.h"
+
+#include "tests-common.h"
+
+/* As many properties as a busy root window collects */
+#define NUM_PROPERTIES 1000
+
+static ScreenRec screen;
+static WindowRec root;
+static ClientRec client;
+
+#ifdef XACE
+static Bool hide_properties;
+
+/* Stands in for a security module that polyinstantiates properties: while
+ * hide_properties is set, existing properties can't be seen, so changing
+ * one creates another of the same name. */
+static void
+hide_existing(CallbackListPtr *list, void *closure, void *data)
+{
+    XacePropertyAccessRec *rec = data;
+
+    if (hide_properties && !(rec->access_mode & DixCreateAccess))
+        rec->status = BadMatch;
+}
+#endif
+
+static void
+property_init(void)
+{
+    dixResetPrivates();
+    memset(&root, 0, sizeof(root));
+    root.drawable.pScreen = &screen;
+    root.optional = calloc(1, sizeof(WindowOptRec));
+    assert(root.optional);
+    client.index = 1;
+#ifdef XACE
+    assert(XaceRegisterCallback(XACE_PROPERTY_ACCESS, hide_existing, NULL));
+#endif
+}
+
+static Atom
+property_name(int i)
+{
+    return i + 1;
+}
+
+static void
+add_property(Atom name, CARD32 value, int mode)
+{
+    assert(dixChangeWindowProperty(&client, &root, name, XA_INTEGER, 32,
+                                   mode, 1, &value, TRUE) == Success);
+}
+
+static CARD32
+lookup_property(Atom name)
+{
+    PropertyPtr prop;
+
+    if (dixLookupProperty(&prop, &root, name, &client,
+                          DixReadAccess) != Success)
+        return 0;
+    assert(prop->propertyName == name);
+    return ((CARD32 *) prop->data)[prop->size - 1];
+}
+
+static int
+count_properties(void)
+{
+    PropertyPtr prop;
+    int count = 0;
+
+    for (prop = wUserProps(&root); prop; prop = prop->next) {
+        assert(!prop->next || prop->next->prev == prop);
+        count++;
+    }
+    return count;
+}
+
+static void
+property_add_lookup_delete(void)
+{
+    PropertyPtr prop;
+    int i;
+
+    for (i = 0; i < NUM_PROPERTIES; i++) {
+        add_property(property_name(i), i + 1, PropModeReplace);
+        /* the first ones are also looked up before the index exists */
+        if (i < 20)
+            assert(lookup_property(property_name(i)) == i + 1);
+    }
+    for (i = 0; i < NUM_PROPERTIES; i++)
+        assert(lookup_property(property_name(i)) == i + 1);
+    assert(lookup_property(property_name(NUM_PROPERTIES)) == 0);
+
+    /* properties are listed newest first, as they always were */
+    i = NUM_PROPERTIES;
+    for (prop = wUserProps(&root); prop; prop = prop->next)
+        assert(prop->propertyName == property_name(--i));
+    assert(i == 0);
+
+    /* changing a property keeps its place */
+    add_property(property_name(10), 5000, PropModeAppend);
+    assert(lookup_property(property_name(10)) == 5000);
+    assert(count_properties() == NUM_PROPERTIES);
+
+    for (i = 0; i < NUM_PROPERTIES; i += 3)
+        assert(DeleteProperty(&client, &root, property_name(i)) == Success);
+    /* deleting a property that doesn't exist succeeds */
+    assert(DeleteProperty(&client, &root, property_name(0)) == Success);
+    for (i = 1; i < NUM_PROPERTIES; i++)
+        assert((lookup_property(property_name(i)) != 0) == (i % 3 != 0));
+    assert(count_properties() == NUM_PROPERTIES - (NUM_PROPERTIES + 2) / 3);
+
+#ifdef XACE
+    /* hidden properties of the same name come back in list order */
+    hide_properties = TRUE;
+    add_property(property_name(1), 7001, PropModeReplace);
+    add_property(property_name(1), 7002, PropModeReplace);
+    hide_properties = FALSE;
+    assert(lookup_property(property_name(1)) == 7002);
+    assert(DeleteProperty(&client, &root, property_name(1)) == Success);
+    assert(lookup_property(property_name(1)) == 7001);
+    assert(DeleteProperty(&client, &root, property_name(1)) == Success);
+    assert(lookup_property(property_name(1)) == 2);
+    assert(DeleteProperty(&client, &root, property_name(1)) == Success);
+    assert(lookup_property(property_name(1)) == 0);
+#endif
+
+    /* the index goes away with the last property */
+    for (i = 0; i < NUM_PROPERTIES; i++)
+        assert(DeleteProperty(&client, &root, property_name(i)) == Success);
+    assert(wUserProps(&root) == NULL);
+    assert(root.optional->propIndex == NULL);
+
+    for (i = 0; i < NUM_PROPERTIES; i++)
+        add_property(property_name(i), i + 1, PropModeReplace);
+    DeleteAllWindowProperties(&root);
+    assert(wUserProps(&root) == NULL);
+    assert(root.optional->propIndex == NULL);
+}
+
+int
+property_test(void)
+{
+    property_init();
+    property_add_lookup_delete();
+
+    return 0;
+}
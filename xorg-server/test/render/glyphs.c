@@ -0,0 +1,342 @@
+/*
+ * Copyright © 2026 The X.Org Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file
+ *
+ * Benchmark of AddGlyphs and CompositeGlyphs with as many glyphs as a
+ * long running session collects, reporting glyphs per second and how much
+ * the server's resident set grew.  Text is drawn from a small set of
+ * glyphs, which stay in the server's glyph atlas, and from all of them,
+ * which keeps the atlas evicting.  The results are checked against the
+ * same text put together here.
+ */
+
+#define _GNU_SOURCE 1
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+#include <xcb/render.h>
+
+#define NUM_GLYPHS 100000
+#define HOT_GLYPHS 2000
+#define GLYPH_WIDTH 8
+#define GLYPH_HEIGHT 16
+#define ADD_BATCH 1000          /* glyphs per AddGlyphs request */
+#define LINE 200                /* glyphs per CompositeGlyphs request */
+#define LINES 30
+#define WIDTH (LINE * GLYPH_WIDTH)
+#define HEIGHT (LINES * GLYPH_HEIGHT)
+#define ROUNDS 50
+
+struct bench {
+    xcb_connection_t *c;
+    xcb_screen_t *screen;
+    xcb_render_pictformat_t a8;
+    xcb_render_glyphset_t glyphset;
+    xcb_pixmap_t pixmap;
+    xcb_render_picture_t dst, white;
+};
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** Waits until the server has executed everything sent so far. */
+static void
+sync_server(struct bench *b)
+{
+    free(xcb_get_input_focus_reply(b->c, xcb_get_input_focus(b->c), NULL));
+}
+
+/** The server's resident set in kB, or -1 if it can't be found. */
+static long
+server_rss(struct bench *b)
+{
+    long rss = -1;
+#ifdef __linux__
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    char path[64], line[256];
+    FILE *f;
+
+    if (getsockopt(xcb_get_file_descriptor(b->c), SOL_SOCKET, SO_PEERCRED,
+                   &cred, &len) != 0 || cred.pid <= 0)
+        return -1;
+    snprintf(path, sizeof(path), "/proc/%d/status", (int) cred.pid);
+    f = fopen(path, "r");
+    if (!f)
+        return -1;
+    while (fgets(line, sizeof(line), f))
+        if (sscanf(line, "VmRSS: %ld", &rss) == 1)
+            break;
+    fclose(f);
+#endif
+    return rss;
+}
+
+/** The alpha of pixel x, y of glyph id; every glyph is different. */
+static uint8_t
+glyph_pixel(uint32_t id, int x, int y)
+{
+    uint32_t v = (id * 2654435761u) ^ ((x + y * GLYPH_WIDTH) * 40503u);
+
+    if (y == 0 && x < 4)
+        return id >> (x * 8);
+    return (v ^ (v >> 13)) >> 24;
+}
+
+static void
+find_formats(struct bench *b)
+{
+    xcb_render_query_pict_formats_reply_t *reply =
+        xcb_render_query_pict_formats_reply(b->c,
+                                            xcb_render_query_pict_formats(b->c),
+                                            NULL);
+    xcb_render_pictforminfo_iterator_t i;
+
+    assert(reply);
+    for (i = xcb_render_query_pict_formats_formats_iterator(reply);
+         i.rem; xcb_render_pictforminfo_next(&i)) {
+        xcb_render_directformat_t *d = &i.data->direct;
+
+        if (i.data->type == XCB_RENDER_PICT_TYPE_DIRECT &&
+            i.data->depth == 8 && d->alpha_mask == 0xff &&
+            d->red_mask == 0 && d->green_mask == 0 && d->blue_mask == 0)
+            b->a8 = i.data->id;
+    }
+    free(reply);
+}
+
+static void
+add_glyphs(struct bench *b)
+{
+    uint32_t ids[ADD_BATCH];
+    xcb_render_glyphinfo_t info[ADD_BATCH];
+    uint8_t *bits = malloc(ADD_BATCH * GLYPH_WIDTH * GLYPH_HEIGHT);
+    long rss_before = server_rss(b), rss_after;
+    double start, elapsed;
+
+    b->glyphset = xcb_generate_id(b->c);
+    xcb_render_create_glyph_set(b->c, b->glyphset, b->a8);
+    sync_server(b);
+
+    start = now();
+    for (int first = 0; first < NUM_GLYPHS; first += ADD_BATCH) {
+        for (int i = 0; i < ADD_BATCH; i++) {
+            ids[i] = first + i;
+            info[i] = (xcb_render_glyphinfo_t) {
+                .width = GLYPH_WIDTH, .height = GLYPH_HEIGHT,
+                .x = 0, .y = GLYPH_HEIGHT - 4,
+                .x_off = GLYPH_WIDTH, .y_off = 0,
+            };
+            for (int y = 0; y < GLYPH_HEIGHT; y++)
+                for (int x = 0; x < GLYPH_WIDTH; x++)
+                    bits[(i * GLYPH_HEIGHT + y) * GLYPH_WIDTH + x] =
+                        glyph_pixel(ids[i], x, y);
+        }
+        xcb_render_add_glyphs(b->c, b->glyphset, ADD_BATCH, ids, info,
+                              ADD_BATCH * GLYPH_WIDTH * GLYPH_HEIGHT, bits);
+    }
+    sync_server(b);
+    elapsed = now() - start;
+
+    rss_after = server_rss(b);
+    printf("AddGlyphs %d glyphs: %.0f glyphs/s", NUM_GLYPHS,
+           NUM_GLYPHS / elapsed);
+    if (rss_before >= 0 && rss_after >= 0)
+        printf(", server RSS grew %ld kB (%.0f bytes/glyph)",
+               rss_after - rss_before,
+               (rss_after - rss_before) * 1024.0 / NUM_GLYPHS);
+    printf("\n");
+    free(bits);
+}
+
+/** Draws one line of glyphs with its baseline at y. */
+static void
+draw_line(struct bench *b, uint8_t op, xcb_render_pictformat_t mask,
+          const uint32_t *ids, int y)
+{
+    uint8_t cmds[8 + LINE * 4];
+    int16_t delta[2] = { 0, y };
+
+    /* a single glyph element */
+    cmds[0] = LINE;
+    cmds[1] = cmds[2] = cmds[3] = 0;
+    memcpy(cmds + 4, delta, sizeof(delta));
+    memcpy(cmds + 8, ids, LINE * 4);
+    xcb_render_composite_glyphs_32(b->c, op, b->white, b->dst, mask,
+                                   b->glyphset, 0, 0, sizeof(cmds), cmds);
+}
+
+static void
+clear(struct bench *b)
+{
+    xcb_render_color_t transparent = { 0, 0, 0, 0 };
+    xcb_rectangle_t rect = { 0, 0, WIDTH, HEIGHT };
+
+    xcb_render_fill_rectangles(b->c, XCB_RENDER_PICT_OP_SRC, b->dst,
+                               transparent, 1, &rect);
+}
+
+static void
+bench_composite(struct bench *b, int range, const char *name)
+{
+    uint32_t ids[LINE];
+    double start, elapsed;
+
+    srand(range);
+    clear(b);
+    sync_server(b);
+    start = now();
+    for (int round = 0; round < ROUNDS; round++)
+        for (int line = 0; line < LINES; line++) {
+            for (int i = 0; i < LINE; i++)
+                ids[i] = rand() % range;
+            draw_line(b, XCB_RENDER_PICT_OP_OVER, XCB_NONE, ids,
+                      line * GLYPH_HEIGHT + GLYPH_HEIGHT - 4);
+        }
+    sync_server(b);
+    elapsed = now() - start;
+    printf("CompositeGlyphs from %d glyphs (%s): %.0f glyphs/s\n",
+           range, name, ROUNDS * LINES * LINE / elapsed);
+}
+
+/**
+ * Draws random glyphs with ADD, so overlapping glyphs add up, and checks
+ * every pixel.
+ */
+static bool
+check_composite(struct bench *b, xcb_render_pictformat_t mask,
+                const char *name)
+{
+    uint32_t ids[LINES][LINE];
+    uint8_t *expect = calloc(WIDTH, HEIGHT);
+    xcb_get_image_reply_t *reply;
+    const uint8_t *pixels;
+    bool pass = true;
+
+    clear(b);
+    for (int line = 0; line < LINES; line++) {
+        for (int i = 0; i < LINE; i++)
+            ids[line][i] = rand() % NUM_GLYPHS;
+        /* every other line is drawn again half a line lower */
+        for (int again = 0; again <= (line & 1); again++) {
+            int baseline = line * GLYPH_HEIGHT + GLYPH_HEIGHT - 4 +
+                again * GLYPH_HEIGHT / 2;
+
+            draw_line(b, XCB_RENDER_PICT_OP_ADD, mask, ids[line], baseline);
+            for (int i = 0; i < LINE; i++)
+                for (int y = 0; y < GLYPH_HEIGHT; y++) {
+                    int py = baseline - (GLYPH_HEIGHT - 4) + y;
+
+                    if (py >= HEIGHT)
+                        continue;
+                    for (int x = 0; x < GLYPH_WIDTH; x++) {
+                        uint8_t *p = &expect[py * WIDTH + i * GLYPH_WIDTH + x];
+                        int sum = *p + glyph_pixel(ids[line][i], x, y);
+
+                        *p = sum > 255 ? 255 : sum;
+                    }
+                }
+        }
+    }
+
+    reply = xcb_get_image_reply(b->c,
+                                xcb_get_image(b->c, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                                              b->pixmap, 0, 0, WIDTH, HEIGHT,
+                                              ~0),
+                                NULL);
+    assert(reply);
+    assert(xcb_get_image_data_length(reply) == WIDTH * HEIGHT);
+    pixels = xcb_get_image_data(reply);
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        if (pixels[i] != expect[i]) {
+            printf("%s: pixel %d,%d is 0x%02x, expected 0x%02x\n", name,
+                   i % WIDTH, i / WIDTH, pixels[i], expect[i]);
+            pass = false;
+            break;
+        }
+    }
+    free(reply);
+    free(expect);
+    return pass;
+}
+
+int main(int argc, char **argv)
+{
+    int screen;
+    xcb_connection_t *c = xcb_connect(NULL, &screen);
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data(c, &xcb_render_id);
+    struct bench b = { .c = c };
+    xcb_render_color_t white = { 0xffff, 0xffff, 0xffff, 0xffff };
+    bool pass = true;
+
+    if (!ext->present) {
+        printf("No RENDER present\n");
+        exit(77);
+    }
+    xcb_render_query_version_reply_t *version =
+        xcb_render_query_version_reply(c, xcb_render_query_version(c, 0, 11),
+                                       NULL);
+    free(version);
+
+    b.screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    find_formats(&b);
+    if (!b.a8) {
+        printf("No a8 picture format\n");
+        exit(77);
+    }
+
+    b.pixmap = xcb_generate_id(c);
+    xcb_create_pixmap(c, 8, b.pixmap, b.screen->root, WIDTH, HEIGHT);
+    b.dst = xcb_generate_id(c);
+    xcb_render_create_picture(c, b.dst, b.pixmap, b.a8, 0, NULL);
+    b.white = xcb_generate_id(c);
+    xcb_render_create_solid_fill(c, b.white, white);
+
+    add_glyphs(&b);
+    bench_composite(&b, HOT_GLYPHS, "in the atlas");
+    bench_composite(&b, NUM_GLYPHS, "evicting");
+    pass = check_composite(&b, XCB_NONE, "no mask") && pass;
+    pass = check_composite(&b, b.a8, "a8 mask") && pass;
+
+    xcb_render_free_glyph_set(c, b.glyphset);
+    xcb_render_free_picture(c, b.white);
+    xcb_render_free_picture(c, b.dst);
+    xcb_free_pixmap(c, b.pixmap);
+    xcb_disconnect(c);
+    exit(pass ? 0 : 1);
+}
@@ -0,0 +1,179 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "misc.h"
+#include "dix.h"
+#include "dixstruct.h"
+#include "resource.h"
+
+#include "tests-common.h"
+
+/* Enough resources to push the table through several incremental grows */
+#define NUM_RESOURCES 100000
+
+static int freed;
+
+static int
+count_delete(void *value, XID id)
+{
+    freed++;
+    return Success;
+}
+
+static ClientRec server_client;
+static ClientRec client;
+static RESTYPE type_a, type_b;
+
+static void
+resource_init(void)
+{
+    dixResetPrivates();
+    serverClient = &server_client;
+    InitClient(serverClient, 0, (void *) NULL);
+    assert(InitClientResources(serverClient));
+
+    type_a = CreateNewResourceType(count_delete, "TestA");
+    type_b = CreateNewResourceType(count_delete, "TestB");
+    assert(type_a && type_b);
+
+    InitClient(&client, 1, (void *) NULL);
+    assert(InitClientResources(&client));
+}
+
+static XID
+client_id(int i)
+{
+    return client.clientAsMask | (i + 1);
+}
+
+static void
+count_walk(void *value, XID id, void *cdata)
+{
+    (*(int *) cdata)++;
+}
+
+static void
+free_walk(void *value, XID id, void *cdata)
+{
+    void *found;
+
+    /* we must never be handed a resource that has already been freed */
+    assert(dixLookupResourceByType(&found, id, type_b, NULL,
+                                   DixReadAccess) == Success);
+    (*(int *) cdata)++;
+    /* free ourselves and the next resource of this type in the walk */
+    FreeResource(id, RT_NONE);
+    FreeResource(id - 2, RT_NONE);
+}
+
+static void
+resource_add_lookup_free(void)
+{
+    void *value;
+    int i, count;
+
+    for (i = 0; i < NUM_RESOURCES; i++)
+        assert(AddResource(client_id(i), (i & 1) ? type_b : type_a,
+                           (void *) (intptr_t) (i + 1)));
+
+    /* a second resource on an existing id shares the slot */
+    assert(AddResource(client_id(0), type_b, (void *) 0x1234));
+
+    for (i = 0; i < NUM_RESOURCES; i++) {
+        assert(dixLookupResourceByType(&value, client_id(i),
+                                       (i & 1) ? type_b : type_a,
+                                       NULL, DixReadAccess) == Success);
+        assert(value == (void *) (intptr_t) (i + 1));
+        assert(dixLookupResourceByType(&value, client_id(i),
+                                       (i & 1) ? type_a : type_b,
+                                       NULL, DixReadAccess) != Success ||
+               i == 0);
+    }
+    assert(dixLookupResourceByType(&value, client_id(0), type_b, NULL,
+                                   DixReadAccess) == Success);
+    assert(value == (void *) 0x1234);
+    assert(dixLookupResourceByClass(&value, client_id(NUM_RESOURCES),
+                                    RC_ANY, NULL, DixReadAccess) == BadValue);
+    assert(!LegalNewID(client_id(5), &client));
+    assert(LegalNewID(client_id(NUM_RESOURCES), &client));
+
+    count = 0;
+    FindClientResourcesByType(&client, type_a, count_walk, &count);
+    assert(count == NUM_RESOURCES / 2);
+    count = 0;
+    FindClientResourcesByType(&client, type_b, count_walk, &count);
+    assert(count == NUM_RESOURCES / 2 + 1);
+    count = 0;
+    FindClientResourcesByType(&client, RT_NONE, count_walk, &count);
+    assert(count == NUM_RESOURCES + 1);
+
+    /* freeing by id drops both resources on client_id(0) */
+    freed = 0;
+    FreeResource(client_id(0), RT_NONE);
+    assert(freed == 2);
+    assert(dixLookupResourceByClass(&value, client_id(0), RC_ANY, NULL,
+                                    DixReadAccess) == BadValue);
+
+    FreeResourceByType(client_id(1), type_a, FALSE);
+    assert(freed == 2);
+    FreeResourceByType(client_id(1), type_b, TRUE);
+    assert(freed == 2);
+    assert(dixLookupResourceByClass(&value, client_id(1), RC_ANY, NULL,
+                                    DixReadAccess) == BadValue);
+
+    /* every other id is gone, the rest must still be found */
+    for (i = 2; i < NUM_RESOURCES; i += 2)
+        FreeResource(client_id(i), RT_NONE);
+    for (i = 3; i < NUM_RESOURCES; i++)
+        assert((dixLookupResourceByClass(&value, client_id(i), RC_ANY, NULL,
+                                         DixReadAccess) == Success) == (i & 1));
+
+    /* the walk survives the callback freeing the current and the next
+     * resource, and only visits resources that still exist */
+    count = 0;
+    freed = 0;
+    FindClientResourcesByType(&client, type_b, free_walk, &count);
+    assert(freed == NUM_RESOURCES / 2 - 1);
+    assert(count == NUM_RESOURCES / 4);
+
+    freed = 0;
+    FreeClientResources(&client);
+    assert(freed == 0);
+    assert(InitClientResources(&client));
+}
+
+int
+resource_test(void)
+{
+    resource_init();
+    resource_add_lookup_free();
+
+    return 0;
+}
@@ -5,15 +5,37 @@
 int
 main(int argc, char **argv)
 {
+#ifdef XORG_TESTS
+    /* timings are only of interest when working on the code measured */
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+        run_test(atom_benchmark);
+        run_test(picking_benchmark);
+        run_test(privates_benchmark);
+        run_test(property_benchmark);
+        run_test(resource_benchmark);
+        run_test(timer_benchmark);
+        run_test(valtree_benchmark);
+
+        return 0;
+    }
+#endif
+
     run_test(list_test);
     run_test(string_test);
 
 #ifdef XORG_TESTS
+    run_test(atom_test);
     run_test(fixes_test);
     run_test(input_test);
     run_test(misc_test);
+    run_test(picking_test);
+    run_test(privates_test);
+    run_test(property_test);
+    run_test(resource_test);
     run_test(signal_logging_test);
+    run_test(timer_test);
     run_test(touch_test);
+    run_test(valtree_test);
     run_test(xfree86_test);
     run_test(xkb_test);
     run_test(xtest_test);
@@ -1,14 +1,21 @@
 #ifndef TESTS_H
 #define TESTS_H
 
+int atom_test(void);
 int fixes_test(void);
 int hashtabletest_test(void);
 int input_test(void);
 int list_test(void);
 int misc_test(void);
+int picking_test(void);
+int privates_test(void);
+int property_test(void);
+int resource_test(void);
 int signal_logging_test(void);
 int string_test(void);
+int timer_test(void);
 int touch_test(void);
+int valtree_test(void);
 int xfree86_test(void);
 int xkb_test(void);
 int xtest_test(void);
@@ -27,6 +34,14 @@ int protocol_xiwarppointer_test(void);
 int protocol_eventconvert_test(void);
 int xi2_test(void);
 
+int atom_benchmark(void);
+int picking_benchmark(void);
+int privates_benchmark(void);
+int property_benchmark(void);
+int resource_benchmark(void);
+int timer_benchmark(void);
+int valtree_benchmark(void);
+
 #ifndef INSIDE_PROTOCOL_COMMON
 
 extern int enable_XISetEventMask_wrap;
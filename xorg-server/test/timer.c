@@ -0,0 +1,149 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "misc.h"
+#include "os.h"
+
+#include "tests-common.h"
+
+#define NUM_TIMERS 10000
+
+static OsTimerPtr timers[NUM_TIMERS];
+static CARD32 expiry[NUM_TIMERS];
+static int fired[NUM_TIMERS];
+static int last_fired;
+static int num_fired;
+
+static CARD32
+record_expiry(OsTimerPtr timer, CARD32 time, void *arg)
+{
+    int i = (intptr_t) arg;
+
+    assert(timers[i] == timer);
+    assert(!fired[i]);
+    fired[i] = 1;
+
+    /* expiry order, ties broken by the order the timers were set */
+    if (last_fired >= 0) {
+        int delta = expiry[i] - expiry[last_fired];
+
+        assert(delta > 0 || (delta == 0 && i > last_fired));
+    }
+    last_fired = i;
+    num_fired++;
+    return 0;
+}
+
+static CARD32
+rearm_once(OsTimerPtr timer, CARD32 time, void *arg)
+{
+    int *count = arg;
+
+    return (*count)++ ? 0 : 1;
+}
+
+static void
+timer_order(void)
+{
+    CARD32 start = GetTimeInMillis();
+    int i;
+
+    srand(0);
+    for (i = 0; i < NUM_TIMERS; i++) {
+        expiry[i] = start + 5 + rand() % 20;
+        timers[i] = TimerSet(NULL, TimerAbsolute, expiry[i],
+                             record_expiry, (void *) (intptr_t) i);
+        assert(timers[i]);
+    }
+
+    /* move some around, then cancel every third one */
+    for (i = 1; i < NUM_TIMERS; i += 7) {
+        expiry[i] = start + 5 + rand() % 20;
+        TimerSet(timers[i], TimerAbsolute, expiry[i],
+                 record_expiry, (void *) (intptr_t) i);
+    }
+    for (i = 0; i < NUM_TIMERS; i += 3)
+        TimerCancel(timers[i]);
+    /* ties are checked against the index, so set everything that is
+     * still pending again in index order */
+    for (i = 0; i < NUM_TIMERS; i++)
+        if (i % 3)
+            TimerSet(timers[i], TimerAbsolute, expiry[i],
+                     record_expiry, (void *) (intptr_t) i);
+
+    /* TimerForce runs a pending timer right away, and only once */
+    last_fired = -1;
+    assert(TimerForce(timers[1]));
+    assert(fired[1]);
+    assert(!TimerForce(timers[1]));
+    fired[1] = 0;
+    num_fired = 0;
+    last_fired = -1;
+    TimerSet(timers[1], TimerAbsolute, expiry[1],
+             record_expiry, (void *) (intptr_t) 1);
+    TimerCancel(timers[1]);
+
+    usleep(40 * 1000);
+    TimerCheck();
+
+    for (i = 0; i < NUM_TIMERS; i++)
+        assert(fired[i] == (i % 3 && i != 1));
+    assert(num_fired == NUM_TIMERS - (NUM_TIMERS + 2) / 3 - 1);
+
+    for (i = 0; i < NUM_TIMERS; i++)
+        TimerFree(timers[i]);
+}
+
+static void
+timer_rearm(void)
+{
+    OsTimerPtr timer;
+    int count = 0;
+
+    /* a timer returning non-zero is set again that many ms later */
+    timer = TimerSet(NULL, 0, 1, rearm_once, &count);
+    usleep(5 * 1000);
+    TimerCheck();
+    usleep(5 * 1000);
+    TimerCheck();
+    assert(count == 2);
+    TimerFree(timer);
+}
+
+int
+timer_test(void)
+{
+    TimerInit();
+    timer_order();
+    timer_rearm();
+
+    return 0;
+}
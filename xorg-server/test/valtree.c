@@ -0,0 +1,228 @@
+/**
+ * Copyright © 2026 The X.Org Foundation
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice (including the next
+ *  paragraph) shall be included in all copies or substantial portions of the
+ *  Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_DIX_CONFIG_H
+#include <dix-config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <X11/X.h>
+#include "misc.h"
+#include "dix.h"
+#include "dixstruct.h"
+#include "windowstr.h"
+#include "scrnintstr.h"
+#include "inputstr.h"
+#include "validate.h"
+#include "mi.h"
+
+#include "tests-common.h"
+
+/* Top level windows, some of them with a few children */
+#define NUM_WINDOWS 1000
+#define NUM_CHECKED 200
+#define SCREEN_WIDTH 1920
+#define SCREEN_HEIGHT 1080
+
+static ScreenRec screen;
+static WindowRec root;
+static ClientRec client;
+static WindowPtr windows[NUM_WINDOWS];
+
+static void
+window_exposures(WindowPtr pWin, RegionPtr prgn)
+{
+}
+
+static void
+paint_window(WindowPtr pWin, RegionPtr region, int what)
+{
+}
+
+static WindowPtr
+add_window(WindowPtr pParent, int x, int y, int w, int h, int bw)
+{
+    WindowPtr pWin = calloc(1, sizeof(WindowRec));
+
+    assert(pWin);
+    pWin->drawable.type = DRAWABLE_WINDOW;
+    pWin->drawable.class = InputOutput;
+    pWin->drawable.pScreen = &screen;
+    pWin->drawable.x = pParent->drawable.x + x + bw;
+    pWin->drawable.y = pParent->drawable.y + y + bw;
+    pWin->drawable.width = w;
+    pWin->drawable.height = h;
+    pWin->origin.x = x + bw;
+    pWin->origin.y = y + bw;
+    pWin->borderWidth = bw;
+    pWin->borderIsPixel = TRUE;
+    pWin->mapped = pWin->realized = pWin->viewable = TRUE;
+    pWin->visibility = VisibilityNotViewable;
+    RegionNull(&pWin->clipList);
+    RegionNull(&pWin->borderClip);
+    RegionNull(&pWin->winSize);
+    RegionNull(&pWin->borderSize);
+
+    /* on top of its siblings */
+    pWin->parent = pParent;
+    pWin->nextSib = pParent->firstChild;
+    if (pParent->firstChild)
+        pParent->firstChild->prevSib = pWin;
+    else
+        pParent->lastChild = pWin;
+    pParent->firstChild = pWin;
+
+    SetWinSize(pWin);
+    SetBorderSize(pWin);
+    return pWin;
+}
+
+static void
+mark_tree(WindowPtr pWin)
+{
+    WindowPtr pChild;
+
+    miMarkWindow(pWin);
+    for (pChild = pWin->firstChild; pChild; pChild = pChild->nextSib)
+        mark_tree(pChild);
+}
+
+static void
+valtree_init(void)
+{
+    BoxRec box = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    int i, j;
+
+    /* restacking checks the pointer of every device */
+    inputInfo.devices = NULL;
+
+    screen.width = SCREEN_WIDTH;
+    screen.height = SCREEN_HEIGHT;
+    screen.root = &root;
+    screen.MarkWindow = miMarkWindow;
+    screen.MarkOverlappedWindows = miMarkOverlappedWindows;
+    screen.ValidateTree = miValidateTree;
+    screen.HandleExposures = miHandleValidateExposures;
+    screen.WindowExposures = window_exposures;
+    screen.PaintWindow = paint_window;
+
+    root.drawable.type = DRAWABLE_WINDOW;
+    root.drawable.class = InputOutput;
+    root.drawable.pScreen = &screen;
+    root.drawable.width = SCREEN_WIDTH;
+    root.drawable.height = SCREEN_HEIGHT;
+    root.mapped = root.realized = root.viewable = TRUE;
+    root.visibility = VisibilityUnobscured;
+    RegionInit(&root.winSize, &box, 1);
+    RegionInit(&root.borderSize, &box, 1);
+    RegionInit(&root.clipList, &box, 1);
+    RegionInit(&root.borderClip, &box, 1);
+
+    srand(0);
+    for (i = 0; i < NUM_WINDOWS; i++) {
+        int w = rand() % 400 + 50, h = rand() % 300 + 50;
+
+        windows[i] = add_window(&root, rand() % SCREEN_WIDTH - 50,
+                                rand() % SCREEN_HEIGHT - 50, w, h,
+                                rand() % 3);
+        if (i % 4 == 0)
+            for (j = 0; j < 4; j++)
+                add_window(windows[i], rand() % w - 10, rand() % h - 10,
+                           rand() % 100 + 10, rand() % 100 + 10, rand() % 2);
+    }
+
+    /* validate the whole tree once, as mapping it would */
+    mark_tree(&root);
+    miValidateTree(&root, root.firstChild, VTMap);
+    miHandleValidateExposures(&root);
+}
+
+/* Empty regions out of mi keep whatever extents they had */
+static Bool
+same_region(RegionPtr a, RegionPtr b)
+{
+    if (!RegionNotEmpty(a) || !RegionNotEmpty(b))
+        return RegionNotEmpty(a) == RegionNotEmpty(b);
+    return RegionEqual(a, b);
+}
+
+/*
+ * Compute the clips of pWin from scratch, given the area its parent and
+ * the siblings above it leave for it, and compare them to the ones
+ * validation left in the window.
+ */
+static void
+check_clips(WindowPtr pWin, RegionPtr available)
+{
+    RegionRec borderClip, clipList;
+    WindowPtr pChild;
+
+    RegionNull(&borderClip);
+    RegionNull(&clipList);
+    RegionIntersect(&borderClip, available, &pWin->borderSize);
+    RegionIntersect(&clipList, &borderClip, &pWin->winSize);
+
+    for (pChild = pWin->firstChild; pChild; pChild = pChild->nextSib) {
+        check_clips(pChild, &clipList);
+        RegionSubtract(&clipList, &clipList, &pChild->borderSize);
+    }
+
+    assert(same_region(&borderClip, &pWin->borderClip));
+    assert(same_region(&clipList, &pWin->clipList));
+    assert(pWin->valdata == NULL);
+
+    RegionUninit(&borderClip);
+    RegionUninit(&clipList);
+}
+
+static void
+restack(WindowPtr pWin)
+{
+    XID mode = (rand() % 2) ? Above : Below;
+
+    assert(ConfigureWindow(pWin, CWStackMode, &mode, &client) == Success);
+}
+
+static void
+valtree_restack(void)
+{
+    int i;
+
+    check_clips(&root, &root.winSize);
+
+    for (i = 0; i < NUM_CHECKED; i++) {
+        restack(windows[rand() % NUM_WINDOWS]);
+        check_clips(&root, &root.winSize);
+    }
+}
+
+int
+valtree_test(void)
+{
+    valtree_init();
+    valtree_restack();
+
+    return 0;
+}
@@ -37,6 +37,14 @@ THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <X11/Xproto.h>
 #include <X11/keysym.h>
 #include <X11/extensions/XKM.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <X11/Xwindows.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <utime.h>
+#endif
 #include "inputstr.h"
 #include "scrnintstr.h"
 #include "windowstr.h"
@@ -44,6 +52,7 @@ THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <xkbsrv.h>
 #include <X11/extensions/XI.h>
 #include "xkb.h"
+#include "xsha1.h"
 
 #define	PRE_ERROR_MSG "\"The XKEYBOARD keymap compiler (xkbcomp) reports:\""
 #define	ERROR_PREFIX	"\"> \""
@@ -57,28 +66,130 @@ THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #endif
 
 static unsigned
-LoadXKM(unsigned want, unsigned need, const char *keymap, XkbDescPtr *xkbRtrn);
+LoadXKM(unsigned want, unsigned need, const char *keymap, Bool keep,
+        XkbDescPtr *xkbRtrn);
 
-static void
+/**
+ * Put dir in outdir as a directory compiled keymaps can be written to and
+ * read back from, with a trailing path separator.
+ */
+static Bool
+UsableOutputDirectory(const char *dir, char *outdir, size_t size)
+{
+    size_t len = strlen(dir);
+    Bool sep = len > 0 && (dir[len - 1] == '/' ||
+                           dir[len - 1] == PATHSEPARATOR[0]);
+
+#ifndef WIN32
+    if (access(dir, W_OK | X_OK) != 0)
+#else
+    if (access(dir, W_OK) != 0)
+#endif
+        return FALSE;
+    return snprintf(outdir, size, "%s%s", dir, sep ? "" : PATHSEPARATOR) < size;
+}
+
+#ifndef WIN32
+/**
+ * Put the user's own directory for compiled keymaps, $XDG_CACHE_HOME/xkb/
+ * or ~/.cache/xkb/, in outdir, creating it when it doesn't exist yet.
+ */
+static Bool
+UserOutputDirectory(char *outdir, size_t size)
+{
+    const char *cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    char dir[PATH_MAX];
+    char *p;
+
+    /* a setuid server doesn't write where the environment points it */
+    if (getuid() != geteuid())
+        return FALSE;
+    if (cache && cache[0] == '/') {
+        if (snprintf(dir, sizeof(dir), "%s/xkb", cache) >= sizeof(dir))
+            return FALSE;
+        p = dir + strlen(cache);
+    }
+    else if (home && home[0] == '/') {
+        if (snprintf(dir, sizeof(dir), "%s/.cache/xkb", home) >= sizeof(dir))
+            return FALSE;
+        p = dir + strlen(home);
+    }
+    else
+        return FALSE;
+
+    if (UsableOutputDirectory(dir, outdir, size))
+        return TRUE;
+    /* only below the user's directory, which must exist already */
+    for (p = strchr(p + 1, '/'); p; p = strchr(p + 1, '/')) {
+        *p = '\0';
+        (void) mkdir(dir, 0700);
+        *p = '/';
+    }
+    (void) mkdir(dir, 0700);
+    return UsableOutputDirectory(dir, outdir, size);
+}
+#endif
+
+/**
+ * Find the directory compiled keymaps are written to.  Returns TRUE if
+ * compiled keymaps can be kept there for later servers, FALSE if it is
+ * the shared /tmp.
+ */
+static Bool
 OutputDirectory(char *outdir, size_t size)
 {
+    if (XkbCacheDirectory &&
+        UsableOutputDirectory(XkbCacheDirectory, outdir, size))
+        return TRUE;
 #ifndef WIN32
     /* Can we write an xkm and then open it too? */
     if (access(XKM_OUTPUT_DIR, W_OK | X_OK) == 0 &&
         (strlen(XKM_OUTPUT_DIR) < size)) {
         (void) strcpy(outdir, XKM_OUTPUT_DIR);
+        return TRUE;
     }
+    else if (UserOutputDirectory(outdir, size))
+        return TRUE;
     else
 #else
     if (strlen(Win32TempDir()) + 1 < size) {
         (void) strcpy(outdir, Win32TempDir());
         (void) strcat(outdir, "\\");
+        return TRUE;
     }
     else
 #endif
     if (strlen("/tmp/") < size) {
         (void) strcpy(outdir, "/tmp/");
     }
+    return FALSE;
+}
+
+/**
+ * Build the path of the compiled keymap mapName in buf. Returns FALSE if
+ * it doesn't fit.
+ */
+static Bool
+XkmFileName(const char *mapName, char *buf, size_t size)
+{
+    char xkm_output_dir[PATH_MAX];
+
+    OutputDirectory(xkm_output_dir, sizeof(xkm_output_dir));
+    if ((XkbBaseDirectory != NULL) && (xkm_output_dir[0] != '/')
+#ifdef WIN32
+        && (!isalpha(xkm_output_dir[0]) || xkm_output_dir[1] != ':')
+#endif
+        ) {
+        if (snprintf(buf, size, "%s/%s%s.xkm", XkbBaseDirectory,
+                     xkm_output_dir, mapName) >= size)
+            buf[0] = '\0';
+    }
+    else {
+        if (snprintf(buf, size, "%s%s.xkm", xkm_output_dir, mapName) >= size)
+            buf[0] = '\0';
+    }
+    return buf[0] != '\0';
 }
 
 /**
@@ -199,6 +310,327 @@ RunXkbComp(xkbcomp_buffer_callback callback, void *userdata)
     return NULL;
 }
 
+typedef struct {
+    const char *keymap;
+    size_t len;
+} XkbKeymapString;
+
+static void
+xkb_write_keymap_string_cb(FILE *out, void *userdata)
+{
+    XkbKeymapString *s = userdata;
+    fwrite(s->keymap, s->len, 1, out);
+}
+
+/* Compiled keymaps kept in the output directory at most */
+#define XKB_KEYMAP_CACHE_SIZE 32
+
+typedef void (*XkbFileProc)(const char *path, const char *name, Bool dir,
+                            unsigned long long size, time_t mtime,
+                            void *data);
+
+/**
+ * Call func for every file and directory in dir, and in its
+ * subdirectories down to depth levels below it.
+ */
+static void
+XkbWalkDirectory(const char *dir, int depth, XkbFileProc func, void *data)
+{
+    char path[PATH_MAX];
+#ifdef WIN32
+    WIN32_FIND_DATAA fd;
+    HANDLE h;
+
+    if (snprintf(path, sizeof(path), "%s/*", dir) >= sizeof(path))
+        return;
+    h = FindFirstFileA(path, &fd);
+    if (h == INVALID_HANDLE_VALUE)
+        return;
+    do {
+        Bool isdir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        ULARGE_INTEGER t;
+
+        if (fd.cFileName[0] == '.' ||
+            snprintf(path, sizeof(path), "%s/%s", dir,
+                     fd.cFileName) >= sizeof(path))
+            continue;
+        /* 100ns ticks since 1601 */
+        t.LowPart = fd.ftLastWriteTime.dwLowDateTime;
+        t.HighPart = fd.ftLastWriteTime.dwHighDateTime;
+        func(path, fd.cFileName, isdir,
+             ((unsigned long long) fd.nFileSizeHigh << 32) | fd.nFileSizeLow,
+             (time_t) (t.QuadPart / 10000000 - 11644473600ULL), data);
+        if (isdir && depth > 0)
+            XkbWalkDirectory(path, depth - 1, func, data);
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    struct dirent *ent;
+    struct stat st;
+    DIR *d;
+
+    d = opendir(dir);
+    if (!d)
+        return;
+    while ((ent = readdir(d))) {
+        if (ent->d_name[0] == '.' ||
+            snprintf(path, sizeof(path), "%s/%s", dir,
+                     ent->d_name) >= sizeof(path) ||
+            stat(path, &st) != 0)
+            continue;
+        func(path, ent->d_name, S_ISDIR(st.st_mode), st.st_size,
+             st.st_mtime, data);
+        if (S_ISDIR(st.st_mode) && depth > 0)
+            XkbWalkDirectory(path, depth - 1, func, data);
+    }
+    closedir(d);
+#endif
+}
+
+typedef struct {
+    unsigned long long files;
+    unsigned long long size;
+    unsigned long long mtimes;
+} XkbDataStamp;
+
+static void
+XkbStampFile(const char *path, const char *name, Bool dir,
+             unsigned long long size, time_t mtime, void *data)
+{
+    XkbDataStamp *stamp = data;
+
+    stamp->files++;
+    stamp->size += size;
+    stamp->mtimes += mtime;
+}
+
+/**
+ * Add what the keymap source is compiled against to the keymap cache
+ * name: the component files it may include and xkbcomp itself.  Their
+ * sizes and times change with any update of either, even when the update
+ * puts back older files.  The files are only looked at once per server
+ * generation, a layout installed while the server runs is picked up at
+ * the next reset.
+ */
+static void
+XkbStampKeymapData(void *ctx)
+{
+    static const char *components[] = {
+        "keycodes", "types", "compat", "symbols", "geometry"
+    };
+    static XkbDataStamp stamps[2];
+    static unsigned long stampGeneration;
+    char path[PATH_MAX];
+    int i;
+
+    if (stampGeneration == serverGeneration) {
+        x_sha1_update(ctx, stamps, sizeof(stamps));
+        return;
+    }
+    memset(stamps, 0, sizeof(stamps));
+
+    /* not the whole base directory, compiled keymaps may be kept in it */
+    for (i = 0; XkbBaseDirectory && i < ARRAY_SIZE(components); i++) {
+        if (snprintf(path, sizeof(path), "%s/%s", XkbBaseDirectory,
+                     components[i]) < sizeof(path))
+            XkbWalkDirectory(path, 4, XkbStampFile, &stamps[0]);
+    }
+
+    if (XkbBinDirectory &&
+#ifdef WIN32
+        snprintf(path, sizeof(path), "%s/xkbcomp.exe", XkbBinDirectory)
+#else
+        snprintf(path, sizeof(path), "%s/xkbcomp", XkbBinDirectory)
+#endif
+        < sizeof(path)) {
+        struct stat st;
+
+        if (stat(path, &st) == 0)
+            XkbStampFile(path, NULL, FALSE, st.st_size, st.st_mtime,
+                         &stamps[1]);
+    }
+    stampGeneration = serverGeneration;
+    x_sha1_update(ctx, stamps, sizeof(stamps));
+}
+
+typedef struct {
+    char *path;
+    time_t mtime;
+} XkbCachedKeymap;
+
+typedef struct {
+    XkbCachedKeymap *keymaps;
+    int num;
+    int size;
+} XkbCachedKeymaps;
+
+static void
+XkbFindCachedKeymap(const char *path, const char *name, Bool dir,
+                    unsigned long long size, time_t mtime, void *data)
+{
+    XkbCachedKeymaps *cache = data;
+    int i;
+
+    /* server-<sha1>.xkm, not what a server compiles as server-<display> */
+    if (dir || strlen(name) != strlen("server-") + 40 + strlen(".xkm") ||
+        strncmp(name, "server-", strlen("server-")) ||
+        strcmp(name + strlen("server-") + 40, ".xkm"))
+        return;
+    for (i = strlen("server-"); i < strlen("server-") + 40; i++)
+        if (!isxdigit((unsigned char) name[i]))
+            return;
+
+    if (cache->num == cache->size) {
+        int size = cache->size ? 2 * cache->size : 64;
+        XkbCachedKeymap *keymaps =
+            reallocarray(cache->keymaps, size, sizeof(XkbCachedKeymap));
+
+        if (!keymaps)
+            return;
+        cache->keymaps = keymaps;
+        cache->size = size;
+    }
+    cache->keymaps[cache->num].path = strdup(path);
+    if (cache->keymaps[cache->num].path)
+        cache->keymaps[cache->num++].mtime = mtime;
+}
+
+static int
+XkbCompareCachedKeymaps(const void *a, const void *b)
+{
+    const XkbCachedKeymap *ka = a, *kb = b;
+
+    /* newest first */
+    return (ka->mtime < kb->mtime) - (ka->mtime > kb->mtime);
+}
+
+/**
+ * Remove all but the XKB_KEYMAP_CACHE_SIZE most recently used keymaps from
+ * the directory the keymap in cachefile was just put into.  Keymaps are
+ * touched whenever they are loaded from the cache, so their times say when
+ * they were last used.
+ */
+static void
+XkbPruneKeymapCache(const char *cachefile)
+{
+    XkbCachedKeymaps cache = { 0 };
+    char dir[PATH_MAX];
+    char *sep;
+    int i;
+
+    if (strlen(cachefile) >= sizeof(dir))
+        return;
+    strcpy(dir, cachefile);
+    sep = strrchr(dir, '/');
+#ifdef WIN32
+    if (strrchr(dir, '\\') > sep)
+        sep = strrchr(dir, '\\');
+#endif
+    if (!sep)
+        return;
+    *sep = '\0';
+
+    XkbWalkDirectory(dir, 0, XkbFindCachedKeymap, &cache);
+    if (cache.num > XKB_KEYMAP_CACHE_SIZE) {
+        qsort(cache.keymaps, cache.num, sizeof(XkbCachedKeymap),
+              XkbCompareCachedKeymaps);
+        for (i = XKB_KEYMAP_CACHE_SIZE; i < cache.num; i++)
+            unlink(cache.keymaps[i].path);
+    }
+    for (i = 0; i < cache.num; i++)
+        free(cache.keymaps[i].path);
+    free(cache.keymaps);
+}
+
+/**
+ * Compiled keymaps are kept in the output directory under a name derived
+ * from their source, so that a server starting with a keymap compiled
+ * before, by this server or another one, doesn't have to run xkbcomp.
+ *
+ * Puts the name the keymap source in map is kept under into name.
+ * Returns FALSE when there is no directory to keep compiled keymaps in.
+ */
+static Bool
+XkbKeymapCacheName(XkbKeymapString *map, char *name, size_t size)
+{
+    static unsigned long warnedGeneration;
+    char xkm_output_dir[PATH_MAX];
+    unsigned char sha1[20];
+    void *ctx;
+    int i;
+
+    if (!OutputDirectory(xkm_output_dir, sizeof(xkm_output_dir))) {
+        if (warnedGeneration != serverGeneration) {
+            LogMessage(X_WARNING, "XKB: No directory to keep compiled "
+                       "keymaps in, use -xkbcache to name one\n");
+            warnedGeneration = serverGeneration;
+        }
+        return FALSE;
+    }
+    if (size < sizeof("server-") + 2 * sizeof(sha1))
+        return FALSE;
+
+    /* the same source compiles differently against other xkb data */
+    ctx = x_sha1_init();
+    if (!ctx)
+        return FALSE;
+    if (XkbBaseDirectory)
+        x_sha1_update(ctx, (void *) XkbBaseDirectory, strlen(XkbBaseDirectory) + 1);
+    XkbStampKeymapData(ctx);
+    x_sha1_update(ctx, (void *) map->keymap, map->len);
+    x_sha1_final(ctx, sha1);
+
+    strcpy(name, "server-");
+    for (i = 0; i < sizeof(sha1); i++)
+        sprintf(name + strlen("server-") + 2 * i, "%02x", sha1[i]);
+    return TRUE;
+}
+
+/**
+ * Compile the keymap source in map, or find it in the keymap cache.
+ * Returns a strdup'd copy of the name of the compiled keymap, and sets
+ * cached if it is to be kept once loaded.  A NULL cached compiles the
+ * source without looking in the cache.
+ */
+static char *
+XkbCompileKeymapSource(XkbKeymapString *map, Bool *cached)
+{
+    char name[PATH_MAX], cachefile[PATH_MAX], xkmfile[PATH_MAX];
+    char *keymap;
+    FILE *file;
+
+    if (!cached)
+        return RunXkbComp(xkb_write_keymap_string_cb, map);
+
+    *cached = FALSE;
+    if (!XkbKeymapCacheName(map, name, sizeof(name)) ||
+        !XkmFileName(name, cachefile, sizeof(cachefile)))
+        cachefile[0] = '\0';
+
+    if (cachefile[0] && (file = fopen(cachefile, "rb"))) {
+        fclose(file);
+        /* keep it from being pruned as one of the least recently used */
+        (void) utime(cachefile, NULL);
+        DebugF("[xkb] Using compiled keymap %s\n", cachefile);
+        *cached = TRUE;
+        return xnfstrdup(name);
+    }
+
+    keymap = RunXkbComp(xkb_write_keymap_string_cb, map);
+
+    /* rename() replaces whatever another server may have put there
+     * meanwhile in one go, so readers see either file complete */
+    if (keymap && cachefile[0] &&
+        XkmFileName(keymap, xkmfile, sizeof(xkmfile)) &&
+        rename(xkmfile, cachefile) == 0) {
+        free(keymap);
+        keymap = xnfstrdup(name);
+        *cached = TRUE;
+        XkbPruneKeymapCache(cachefile);
+    }
+    return keymap;
+}
+
 typedef struct {
     XkbDescPtr xkb;
     XkbComponentNamesPtr names;
@@ -219,14 +651,21 @@ xkb_write_keymap_for_names_cb(FILE *out, void *userdata)
     XkbWriteXKBKeymapForNames(out, ctx->names, ctx->xkb, ctx->want, ctx->need);
 }
 
+/**
+ * Compile the keymap for names, or find it in the keymap cache, see
+ * XkbCompileKeymapSource().
+ */
 static Bool
 XkbDDXCompileKeymapByNames(XkbDescPtr xkb,
                            XkbComponentNamesPtr names,
                            unsigned want,
-                           unsigned need, char *nameRtrn, int nameRtrnLen)
+                           unsigned need, char *nameRtrn, int nameRtrnLen,
+                           Bool *cached)
 {
-    char *keymap;
-    Bool rc = FALSE;
+    FILE *out;
+    char *buf = NULL, *keymap = NULL;
+    long len;
+    XkbKeymapString map = { 0 };
     XkbKeymapNamesCtx ctx = {
         .xkb = xkb,
         .names = names,
@@ -234,30 +673,35 @@ XkbDDXCompileKeymapByNames(XkbDescPtr xkb,
         .need = need
     };
 
-    keymap = RunXkbComp(xkb_write_keymap_for_names_cb, &ctx);
+    /* write the keymap source out first, it is what the cache is keyed on */
+    if (cached)
+        *cached = FALSE;
+    out = cached ? tmpfile() : NULL;
+    if (out) {
+        xkb_write_keymap_for_names_cb(out, &ctx);
+        if (fseek(out, 0, SEEK_END) == 0 && (len = ftell(out)) > 0 &&
+            fseek(out, 0, SEEK_SET) == 0 && (buf = malloc(len)) &&
+            fread(buf, len, 1, out) == 1) {
+            map.keymap = buf;
+            map.len = len;
+            keymap = XkbCompileKeymapSource(&map, cached);
+        }
+        fclose(out);
+        free(buf);
+    }
+    if (!map.keymap)
+        keymap = RunXkbComp(xkb_write_keymap_for_names_cb, &ctx);
 
     if (keymap) {
         if(nameRtrn)
             strlcpy(nameRtrn, keymap, nameRtrnLen);
 
         free(keymap);
-        rc = TRUE;
+        return TRUE;
     } else if (nameRtrn)
         *nameRtrn = '\0';
 
-    return rc;
-}
-
-typedef struct {
-    const char *keymap;
-    size_t len;
-} XkbKeymapString;
-
-static void
-xkb_write_keymap_string_cb(FILE *out, void *userdata)
-{
-    XkbKeymapString *s = userdata;
-    fwrite(s->keymap, s->len, 1, out);
+    return FALSE;
 }
 
 static unsigned int
@@ -269,6 +713,7 @@ XkbDDXLoadKeymapFromString(DeviceIntPtr keybd,
 {
     unsigned int have;
     char *map_name;
+    Bool cached;
     XkbKeymapString map = {
         .keymap = keymap,
         .len = keymap_length
@@ -276,46 +721,34 @@ XkbDDXLoadKeymapFromString(DeviceIntPtr keybd,
 
     *xkbRtrn = NULL;
 
-    map_name = RunXkbComp(xkb_write_keymap_string_cb, &map);
+    map_name = XkbCompileKeymapSource(&map, &cached);
     if (!map_name) {
         LogMessage(X_ERROR, "XKB: Couldn't compile keymap\n");
         return 0;
     }
 
-    have = LoadXKM(want, need, map_name, xkbRtrn);
+    have = LoadXKM(want, need, map_name, cached, xkbRtrn);
     free(map_name);
 
+    /* another server may have pruned it from the cache since */
+    if (!*xkbRtrn && cached &&
+        (map_name = XkbCompileKeymapSource(&map, NULL))) {
+        have = LoadXKM(want, need, map_name, FALSE, xkbRtrn);
+        free(map_name);
+    }
+
     return have;
 }
 
 static FILE *
 XkbDDXOpenConfigFile(const char *mapName, char *fileNameRtrn, int fileNameRtrnLen)
 {
-    char buf[PATH_MAX], xkm_output_dir[PATH_MAX];
+    char buf[PATH_MAX];
     FILE *file;
 
     buf[0] = '\0';
-    if (mapName != NULL) {
-        OutputDirectory(xkm_output_dir, sizeof(xkm_output_dir));
-        if ((XkbBaseDirectory != NULL) && (xkm_output_dir[0] != '/')
-#ifdef WIN32
-            && (!isalpha(xkm_output_dir[0]) || xkm_output_dir[1] != ':')
-#endif
-            ) {
-            if (snprintf(buf, PATH_MAX, "%s/%s%s.xkm", XkbBaseDirectory,
-                         xkm_output_dir, mapName) >= PATH_MAX)
-                buf[0] = '\0';
-        }
-        else {
-            if (snprintf(buf, PATH_MAX, "%s%s.xkm", xkm_output_dir, mapName)
-                >= PATH_MAX)
-                buf[0] = '\0';
-        }
-        if (buf[0] != '\0')
-            file = fopen(buf, "rb");
-        else
-            file = NULL;
-    }
+    if (mapName != NULL && XkmFileName(mapName, buf, sizeof(buf)))
+        file = fopen(buf, "rb");
     else
         file = NULL;
     if ((fileNameRtrn != NULL) && (fileNameRtrnLen > 0)) {
@@ -325,7 +758,8 @@ XkbDDXOpenConfigFile(const char *mapName, char *fileNameRtrn, int fileNameRtrnLe
 }
 
 static unsigned
-LoadXKM(unsigned want, unsigned need, const char *keymap, XkbDescPtr *xkbRtrn)
+LoadXKM(unsigned want, unsigned need, const char *keymap, Bool keep,
+        XkbDescPtr *xkbRtrn)
 {
     FILE *file;
     char fileName[PATH_MAX];
@@ -333,14 +767,16 @@ LoadXKM(unsigned want, unsigned need, const char *keymap, XkbDescPtr *xkbRtrn)
 
     file = XkbDDXOpenConfigFile(keymap, fileName, PATH_MAX);
     if (file == NULL) {
-        LogMessage(X_ERROR, "Couldn't open compiled keymap file %s\n",
-                   fileName);
+        /* a kept keymap is compiled again when it is gone */
+        LogMessage(keep ? X_INFO : X_ERROR,
+                   "Couldn't open compiled keymap file %s\n", fileName);
         return 0;
     }
     missing = XkmReadFile(file, need, want, xkbRtrn);
     if (*xkbRtrn == NULL) {
         LogMessage(X_ERROR, "Error loading keymap %s\n", fileName);
         fclose(file);
+        /* a broken cached keymap goes too, so it gets compiled again */
         (void) unlink(fileName);
         return 0;
     }
@@ -349,7 +785,8 @@ LoadXKM(unsigned want, unsigned need, const char *keymap, XkbDescPtr *xkbRtrn)
                (*xkbRtrn)->defined);
     }
     fclose(file);
-    (void) unlink(fileName);
+    if (!keep)
+        (void) unlink(fileName);
     return (need | want) & (~missing);
 }
 
@@ -361,6 +798,8 @@ XkbDDXLoadKeymapByNames(DeviceIntPtr keybd,
                         XkbDescPtr *xkbRtrn, char *nameRtrn, int nameRtrnLen)
 {
     XkbDescPtr xkb;
+    Bool cached;
+    unsigned have;
 
     *xkbRtrn = NULL;
     if ((keybd == NULL) || (keybd->key == NULL) ||
@@ -376,12 +815,20 @@ XkbDDXLoadKeymapByNames(DeviceIntPtr keybd,
         return 0;
     }
     else if (!XkbDDXCompileKeymapByNames(xkb, names, want, need,
-                                         nameRtrn, nameRtrnLen)) {
+                                         nameRtrn, nameRtrnLen, &cached)) {
         LogMessage(X_ERROR, "XKB: Couldn't compile keymap\n");
         return 0;
     }
 
-    return LoadXKM(want, need, nameRtrn, xkbRtrn);
+    have = LoadXKM(want, need, nameRtrn, cached, xkbRtrn);
+
+    /* another server may have pruned it from the cache since */
+    if (!*xkbRtrn && cached &&
+        XkbDDXCompileKeymapByNames(xkb, names, want, need,
+                                   nameRtrn, nameRtrnLen, NULL))
+        have = LoadXKM(want, need, nameRtrn, FALSE, xkbRtrn);
+
+    return have;
 }
 
 Bool
@@ -89,6 +89,7 @@ typedef struct _SrvXkmInfo {
 
 const char *XkbBaseDirectory = XKB_BASE_DIRECTORY;
 const char *XkbBinDirectory = XKB_BIN_DIRECTORY;
+const char *XkbCacheDirectory = NULL;
 static int XkbWantAccessX = 0;
 
 static char *XkbRulesDflt = NULL;
@@ -767,6 +768,35 @@ XkbProcessArguments(int argc, char *argv[], int i)
             return -1;
         }
     }
+    else if (strcmp(argv[i], "-xkbcache") == 0) {
+        if (++i < argc) {
+#if !defined(WIN32) && !defined(__CYGWIN__)
+            if (getuid() != geteuid()) {
+                LogMessage(X_WARNING,
+                           "-xkbcache is not available for setuid X servers\n");
+                return -1;
+            }
+            else if (argv[i][0] != '/') {
+                LogMessage(X_ERROR, "-xkbcache needs an absolute path\n");
+                return -1;
+            }
+            else
+#endif
+            {
+                if (strlen(argv[i]) < PATH_MAX) {
+                    XkbCacheDirectory = argv[i];
+                    return 2;
+                }
+                else {
+                    LogMessage(X_ERROR, "-xkbcache pathname too long\n");
+                    return -1;
+                }
+            }
+        }
+        else {
+            return -1;
+        }
+    }
     else if ((strncmp(argv[i], "-accessx", 8) == 0) ||
              (strncmp(argv[i], "+accessx", 8) == 0)) {
         int j = 1;
@@ -831,6 +861,7 @@ XkbUseMsg(void)
     ErrorF
         ("[+-]accessx [ timeout [ timeout_mask [ feedback [ options_mask] ] ] ]\n");
     ErrorF("                       enable/disable accessx key sequences\n");
+    ErrorF("-xkbcache dir          keep compiled keymaps in dir\n");
 #ifndef _MSC_VER
     ErrorF("-ardelay               set XKB autorepeat delay\n");
     ErrorF("-arinterval            set XKB autorepeat interval\n");